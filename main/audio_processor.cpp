@@ -1,52 +1,221 @@
 #include "audio_processor.h"
+#include "beat_tracker.h"
 #include "config.h"
+#include "dsp_filters.h"
+#include "envelope_follower.h"
+#include "goertzel_bank.h"
+#include "percentile_tracker.h"
+#include "raw_capture.h"
+#include "sample_ring.h"
+#include "stream_stats.h"
 #include <Arduino.h>
 
-// Rolling buffer for audio smoothing
-volatile int audioBuffer[BUFFER_SIZE];
-volatile int bufferIndex = 0;
-volatile bool newSampleReady = false;
+// Latest raw ADC reading (written by the sampling ISR, for debugging).
 volatile int latestRawSample = 0;
 
+// Samples are in units of 2^-SAMPLE_FRACTION_BITS ADC counts (finer than a count when
+// the ADC is oversampled); everything published is in counts.
+static const int32_t SAMPLE_DC_OFFSET = (int32_t)DC_OFFSET << SAMPLE_FRACTION_BITS;
+static_assert(SAMPLE_FRACTION_BITS <= 6, "samples must fit 16 bits");
+
+static inline int32_t toCounts(int32_t x) {
+  return (x + ((1 << SAMPLE_FRACTION_BITS) >> 1)) >> SAMPLE_FRACTION_BITS;
+}
+
+// Window statistics. Owned by the consumer (loop() context): samples arrive through
+// the sample ring, so the ISR never touches these.
+// - long window: DC baseline used by auto-calibration, updated per sample
+// - short window: only the last BUFFER_SIZE samples are kept; nothing in the firmware
+//   reads them, so getShortWindowStats() summarizes them on call (debugging, tests)
+static SlidingWindowStats<STATS_LONG_WINDOW> longWindow;
+static uint16_t shortHistory[BUFFER_SIZE];
+static uint16_t shortHistoryPos = 0;
+
+// Fixed-point filter chains selected in config.h.
+typedef AMPLITUDE_FILTER_CHAIN AmplitudeFilter;
+static AUDIO_INPUT_FILTER_CHAIN inputFilter;
+static AmplitudeFilter amplitudeFilter;
+
+// Loudness detector on the AC part of the signal (mode and time constants in config.h).
+static EnvelopeFollower<ENVELOPE_MODE,
+                        timeConstantToQ15(ENVELOPE_AVERAGING_MS, SAMPLE_RATE),
+                        timeConstantToQ15(ENVELOPE_ATTACK_MS, SAMPLE_RATE),
+                        timeConstantToQ15(ENVELOPE_RELEASE_MS, SAMPLE_RATE)> envelope;
+
+#if ENABLE_BAND_ANALYZER
+// Band edges as bin indices (bin k = k * SAMPLE_RATE / BAND_BLOCK_SIZE Hz).
+static const uint16_t BAND_NYQUIST_BIN = BAND_BLOCK_SIZE / 2;
+static const uint16_t BAND_BASS_LAST_BIN = (uint32_t)BAND_BASS_MAX_HZ * BAND_BLOCK_SIZE / SAMPLE_RATE;
+static const uint16_t BAND_MID_LAST_BIN = (uint32_t)BAND_MID_MAX_HZ * BAND_BLOCK_SIZE / SAMPLE_RATE;
+static_assert(BAND_BASS_LAST_BIN >= 1 && BAND_BASS_LAST_BIN < BAND_MID_LAST_BIN &&
+              BAND_MID_LAST_BIN < BAND_NYQUIST_BIN, "band edges must leave every band at least one bin");
+
+// Bin 0 (DC) is left out: the DC baseline is tracked separately.
+static GoertzelBank<BAND_BLOCK_SIZE, 1, BAND_NYQUIST_BIN> bandBank;
+#endif
+static int bandLevels[AUDIO_BAND_COUNT];
+
+#if ENABLE_BEAT_TRACKER
+// Onset frames of BEAT_FRAME_MS; lags (in frames) from the tempo range.
+static const uint16_t BEAT_HOP = (uint32_t)BEAT_FRAME_MS * SAMPLE_RATE / 1000;
+static BeatTracker<BEAT_HOP,
+                   60000UL / (BEAT_MAX_BPM * BEAT_FRAME_MS),
+                   60000UL / (BEAT_MIN_BPM * BEAT_FRAME_MS),
+                   60000UL / (BEAT_PREFERRED_BPM * BEAT_FRAME_MS),
+                   (BEAT_ONSET_MIN_LEVEL << SAMPLE_FRACTION_BITS)> beatTracker;
+#endif
+
+// Noise floor and automatic gain, updated once per NOISE_FLOOR_FRAME_MS frame.
+static const uint16_t NOISE_FLOOR_FRAME = (uint32_t)NOISE_FLOOR_FRAME_MS * SAMPLE_RATE / 1000;
+static const uint16_t NOISE_FLOOR_ACQUIRE_FRAMES = NOISE_FLOOR_ACQUIRE_MS / NOISE_FLOOR_FRAME_MS;
+static_assert(NOISE_FLOOR_FRAME >= 1, "noise floor frame must hold at least one sample");
+static PercentileTracker noiseFloor;
+static uint16_t noiseFloorPhase = 0;
+static uint16_t noiseFloorFrames = 0;  // saturates at NOISE_FLOOR_ACQUIRE_FRAMES
+#if ENABLE_AGC
+static PercentileTracker agcReference;  // typical level above the floor
+#endif
+static uint32_t agcGain = 256;          // x 256
+
 // Audio processing variables
 static int smoothedAmplitude = 0;
-static int dcOffsetEstimate = DC_OFFSET;
+static int32_t filteredLevel = 0;  // amplitude filter output, in sample units
+static int dcOffsetEstimate = SAMPLE_DC_OFFSET;
 static bool autoCalibrationEnabled = true;
 
+// The DC baseline of the last DC_BASELINE_HOLDOFF_MS, one entry per frame, oldest at
+// dcHistoryHead: calibration stops only once a sound has been loud for a while, and by
+// then the sound has leaked into the long window.
+static const uint16_t DC_HISTORY_FRAMES = DC_BASELINE_HOLDOFF_MS / NOISE_FLOOR_FRAME_MS;
+static_assert(DC_HISTORY_FRAMES >= 1, "DC_BASELINE_HOLDOFF_MS must span at least one frame");
+static uint16_t dcHistory[DC_HISTORY_FRAMES];
+static uint16_t dcHistoryHead = 0;
+
+// Samples are drained from the ring in batches of this size.
+static const unsigned DRAIN_BATCH = 32;
+
 void initAudioProcessor() {
-  // Initialize audio buffer with DC offset (silence baseline)
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = DC_OFFSET;
-  }
-  bufferIndex = 0;
+  // Initialize windows with DC offset (silence baseline)
+  for (uint16_t i = 0; i < BUFFER_SIZE; i++) shortHistory[i] = SAMPLE_DC_OFFSET;
+  shortHistoryPos = 0;
+  longWindow.reset(SAMPLE_DC_OFFSET);
+  inputFilter.reset(SAMPLE_DC_OFFSET);
+  amplitudeFilter.reset(0);
+  envelope.reset(0);
+#if ENABLE_BAND_ANALYZER
+  bandBank.reset();
+#endif
+#if ENABLE_BEAT_TRACKER
+  beatTracker.reset();
+#endif
+  for (int b = 0; b < AUDIO_BAND_COUNT; b++) bandLevels[b] = 0;
+  noiseFloor.reset((uint32_t)NOISE_FLOOR_MIN << 8, (uint32_t)NOISE_FLOOR_MIN << 8);
+  noiseFloorPhase = 0;
+  noiseFloorFrames = 0;
+#if ENABLE_AGC
+  agcReference.reset((uint32_t)AGC_TARGET_LEVEL << 8, 1UL << 8);
+#endif
+  agcGain = 256;
   smoothedAmplitude = 0;
-  dcOffsetEstimate = DC_OFFSET;
+  filteredLevel = 0;
+  dcOffsetEstimate = SAMPLE_DC_OFFSET;
   autoCalibrationEnabled = true;
-  newSampleReady = false;
+  for (uint16_t i = 0; i < DC_HISTORY_FRAMES; i++) dcHistory[i] = SAMPLE_DC_OFFSET;
+  dcHistoryHead = 0;
+  sampleRingReset();
 }
 
-int processAudio() {
-  // Calculate average of buffer (smoothing)
-  long sum = 0;
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    sum += audioBuffer[i];
+// Once per frame: learn the room's noise floor (IDLE) or the music's level (ACTIVE).
+static void updateLevelTracking(int32_t level) {
+  const uint32_t levelQ8 = (uint32_t)(level > 0 ? level : 0) << (8 - SAMPLE_FRACTION_BITS);
+  if (noiseFloorFrames < NOISE_FLOOR_ACQUIRE_FRAMES) {
+    noiseFloorFrames++;
+    noiseFloor.push(levelQ8, NOISE_FLOOR_FALL_SHIFT, NOISE_FLOOR_FALL_SHIFT);
+  } else if (autoCalibrationEnabled) {
+    noiseFloor.push(levelQ8, NOISE_FLOOR_RISE_SHIFT, NOISE_FLOOR_FALL_SHIFT);
+  } else {
+    noiseFloor.push(levelQ8, NOISE_FLOOR_RISE_SHIFT + NOISE_FLOOR_ACTIVE_SLOWDOWN, NOISE_FLOOR_FALL_SHIFT);
+  }
+
+#if ENABLE_AGC
+  if (!autoCalibrationEnabled) {
+    const uint32_t floorQ8 = noiseFloor.valueQ8();
+    const uint32_t reference = agcReference.push(levelQ8 > floorQ8 ? levelQ8 - floorQ8 : 0, AGC_RISE_SHIFT, AGC_FALL_SHIFT);
+    const uint32_t gain = ((uint32_t)AGC_TARGET_LEVEL << 16) / reference;
+    agcGain = constrain(gain, AGC_MIN_GAIN_PCT * 256UL / 100, AGC_MAX_GAIN_PCT * 256UL / 100);
   }
-  int average = sum / BUFFER_SIZE;
-  
+#endif
+}
+
+// Run the smoothing pipeline for one raw sample.
+static void processSample(int sample) {
+  // O(1) window updates (running sums) instead of re-summing the buffer per sample.
+  const int32_t filtered = inputFilter.process(sample);
+  const uint16_t raw = (uint16_t)constrain(filtered, 0, 65535);
+  longWindow.push(raw);
+  shortHistory[shortHistoryPos] = raw;
+  shortHistoryPos = (uint16_t)((shortHistoryPos + 1 == BUFFER_SIZE) ? 0 : shortHistoryPos + 1);
+
   // Optional: slowly adapt DC offset estimate (helps with drift / mic bias).
   // This should generally be enabled only when the system believes it is quiet (IDLE).
   if (autoCalibrationEnabled) {
-    // IIR low-pass: ~1% new, 99% old.
-    dcOffsetEstimate = (dcOffsetEstimate * 99 + average) / 100;
+    // Baseline = exact mean of the last STATS_LONG_WINDOW samples.
+    dcOffsetEstimate = longWindow.mean();
+  }
+
+  // Envelope of the AC signal around the DC baseline: fast attack, steady release.
+  // (Averaging first and rectifying afterwards would cancel a real tone out.)
+  const int32_t ac = (int32_t)raw - dcOffsetEstimate;
+  const int32_t level = envelope.process(ac);
+  if (AmplitudeFilter::stages() > 0) {
+    filteredLevel = amplitudeFilter.process(level);
+    smoothedAmplitude = toCounts(filteredLevel);
+  }
+
+  if (++noiseFloorPhase == NOISE_FLOOR_FRAME) {
+    noiseFloorPhase = 0;
+    updateLevelTracking(AmplitudeFilter::stages() > 0 ? filteredLevel : envelope.output());
+    if (autoCalibrationEnabled) {
+      dcHistory[dcHistoryHead] = (uint16_t)dcOffsetEstimate;
+      dcHistoryHead = (dcHistoryHead + 1 < DC_HISTORY_FRAMES) ? dcHistoryHead + 1 : 0;
+    }
+  }
+
+#if ENABLE_BAND_ANALYZER
+  // Band levels are refreshed once per block; the per-sample cost is the bank update.
+  if (bandBank.push(ac)) {
+    bandLevels[AUDIO_BAND_BASS] = toCounts(bandBank.bandLevel(1, BAND_BASS_LAST_BIN));
+    bandLevels[AUDIO_BAND_MID] = toCounts(bandBank.bandLevel(BAND_BASS_LAST_BIN + 1, BAND_MID_LAST_BIN));
+    bandLevels[AUDIO_BAND_TREBLE] = toCounts(bandBank.bandLevel(BAND_MID_LAST_BIN + 1, BAND_NYQUIST_BIN));
+  }
+#endif
+
+#if ENABLE_BEAT_TRACKER
+  // Per sample an add; the onset / tempo work runs once per frame.
+  beatTracker.push(ac);
+#endif
+}
+
+int processAudio() {
+  // Drain everything the ISR has published so each sample is processed exactly once,
+  // even if loop() was blocked (e.g. in Serial.print) for several sample periods.
+  int batch[DRAIN_BATCH];
+  unsigned n;
+  while ((n = sampleRingDrain(batch, DRAIN_BATCH, nullptr)) > 0) {
+    for (unsigned i = 0; i < n; i++) {
+      processSample(batch[i]);
+    }
+#if ENABLE_RAW_CAPTURE
+    rawCaptureSamples(batch, n);
+#endif
+  }
+
+  // Without an amplitude filter the envelope is read once per call instead of per
+  // sample (the unused per-sample output, e.g. the RMS square root, optimizes away).
+  if (AmplitudeFilter::stages() == 0) {
+    smoothedAmplitude = toCounts(envelope.output());
   }
 
-  // Remove DC offset and get amplitude
-  int amplitude = abs(average - dcOffsetEstimate);
-  
-  // Apply exponential smoothing for even smoother transitions
-  // Alpha = 0.7 means 70% new value, 30% old value
-  smoothedAmplitude = (smoothedAmplitude * 3 + amplitude * 7) / 10;
-  
   return smoothedAmplitude;
 }
 
@@ -54,19 +223,125 @@ int getSmoothedAmplitude() {
   return smoothedAmplitude;
 }
 
+int getBandLevel(AudioBand band) {
+  if (band < 0 || band >= AUDIO_BAND_COUNT) return 0;
+  return bandLevels[band];
+}
+
+unsigned long getBandBlockCount() {
+#if ENABLE_BAND_ANALYZER
+  return bandBank.blocks();
+#else
+  return 0;
+#endif
+}
+
+unsigned long getOnsetCount() {
+#if ENABLE_BEAT_TRACKER
+  return beatTracker.onsets();
+#else
+  return 0;
+#endif
+}
+
+int getLastOnsetStrength() {
+#if ENABLE_BEAT_TRACKER
+  return beatTracker.lastOnsetStrength();
+#else
+  return 0;
+#endif
+}
+
+bool isBeatLocked() {
+#if ENABLE_BEAT_TRACKER
+  return beatTracker.locked();
+#else
+  return false;
+#endif
+}
+
+uint16_t getBeatPhase() {
+#if ENABLE_BEAT_TRACKER
+  return beatTracker.phase();
+#else
+  return 0;
+#endif
+}
+
+unsigned getBeatPeriodMs() {
+#if ENABLE_BEAT_TRACKER
+  return (unsigned)((beatTracker.periodQ8() * 1000UL / SAMPLE_RATE + 128) >> 8);
+#else
+  return 0;
+#endif
+}
+
+unsigned getMsToNextBeat() {
+#if ENABLE_BEAT_TRACKER
+  return (unsigned)(beatTracker.samplesToNextBeat() * 1000UL / SAMPLE_RATE);
+#else
+  return 0;
+#endif
+}
+
+int getNoiseFloor() {
+  return noiseFloor.value();
+}
+
+unsigned getAgcGain() {
+  return (unsigned)agcGain;
+}
+
+int normalizeLevel(int level) {
+  const int32_t above = (int32_t)level - noiseFloor.value();
+  if (above <= 0) return 0;
+#if ENABLE_AGC
+  const int32_t scaled = (int32_t)((above * agcGain + 128) >> 8);
+  return scaled < 32767 ? (int)scaled : 32767;
+#else
+  return (int)above;
+#endif
+}
+
 void setAutoCalibrationEnabled(bool enabled) {
+  // Hold the baseline from before the sound that ended calibration started.
+  if (autoCalibrationEnabled && !enabled) dcOffsetEstimate = dcHistory[dcHistoryHead];
   autoCalibrationEnabled = enabled;
 }
 
+int getLatestRawSample() {
+  return latestRawSample;
+}
+
 int getDcOffsetEstimate() {
-  return dcOffsetEstimate;
+  return toCounts(dcOffsetEstimate);
 }
 
-bool isNewSampleReady() {
-  return newSampleReady;
+template <uint16_t N>
+static AudioWindowStats summarize(const SlidingWindowStats<N> &w) {
+  AudioWindowStats out;
+  out.length = N;
+  out.mean = toCounts(w.mean());
+  out.min = toCounts(w.min());
+  out.max = toCounts(w.max());
+  out.variance = w.variance() >> (2 * SAMPLE_FRACTION_BITS);
+  return out;
 }
 
-void clearSampleReadyFlag() {
-  newSampleReady = false;
+AudioWindowStats getShortWindowStats() {
+  // Replaying the history, oldest first, replaces the whole window.
+  SlidingWindowStats<BUFFER_SIZE> window;
+  for (uint16_t i = 0; i < BUFFER_SIZE; i++) {
+    const uint16_t slot = (uint16_t)(shortHistoryPos + i);
+    window.push(shortHistory[slot >= BUFFER_SIZE ? slot - BUFFER_SIZE : slot]);
+  }
+  return summarize(window);
 }
 
+AudioWindowStats getLongWindowStats() {
+  return summarize(longWindow);
+}
+
+bool isNewSampleReady() {
+  return sampleRingAvailable() > 0;
+}
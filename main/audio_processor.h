@@ -1,31 +1,123 @@
 #ifndef AUDIO_PROCESSOR_H
 #define AUDIO_PROCESSOR_H
 
+#include <stdint.h>
+
+/**
+ * Summary of one sliding statistics window over raw ADC samples.
+ */
+struct AudioWindowStats {
+  unsigned length;    // window length in samples
+  int mean;
+  int min;
+  int max;
+  uint32_t variance;  // ADC counts^2
+};
+
+/**
+ * Frequency bands published by the band analyzer (edges in config.h).
+ */
+enum AudioBand {
+  AUDIO_BAND_BASS,
+  AUDIO_BAND_MID,
+  AUDIO_BAND_TREBLE,
+  AUDIO_BAND_COUNT
+};
+
 /**
  * Initialize the audio processing system
- * Sets up the rolling buffer with DC offset values
+ * Sets up the rolling buffer with DC offset values and flushes the sample ring
  */
 void initAudioProcessor();
 
 /**
- * Process the latest audio samples from the buffer
- * Calculates smoothed amplitude from the rolling buffer
- * Should be called when newSampleReady flag is set
+ * Process all pending audio samples from the sample ring
+ * Each sample is pushed through the statistics windows and the envelope follower exactly once
+ * Should be called when isNewSampleReady() returns true
  * 
- * @return The smoothed audio amplitude (0-512)
+ * @return The amplitude envelope (ADC counts around the DC baseline, 0-512 for a 10-bit ADC)
  */
 int processAudio();
 
 /**
  * Get the current smoothed amplitude value
+ * (envelope follower output: fast attack, steady release; see ENVELOPE_* in config.h)
  * 
  * @return The current smoothed amplitude
  */
 int getSmoothedAmplitude();
 
+/**
+ * Get the level of one frequency band from the last completed analysis block
+ * (BAND_BLOCK_SIZE samples): peak amplitude in ADC counts of a sine with the same
+ * energy in that band. 0 until the first block completes or if ENABLE_BAND_ANALYZER is 0.
+ */
+int getBandLevel(AudioBand band);
+
+/**
+ * Number of analysis blocks completed since initAudioProcessor()
+ * (lets callers react only when the band levels changed).
+ */
+unsigned long getBandBlockCount();
+
+/**
+ * Onsets detected by the beat tracker since initAudioProcessor() (callers react to
+ * a change, as with getBandBlockCount()); 0 if ENABLE_BEAT_TRACKER is 0.
+ */
+unsigned long getOnsetCount();
+
+/**
+ * Strength of the last onset: how far the level rose over its recent average, in
+ * 1/32 octave (32 = the level doubled).
+ */
+int getLastOnsetStrength();
+
+/**
+ * The beat tracker has a tempo and the onsets keep confirming it. The beat phase
+ * and period below are only meaningful while this is true.
+ */
+bool isBeatLocked();
+
+/**
+ * Position in the current beat: 0 on a predicted beat, rising to 65535 just before
+ * the next one. Advances with every processed sample.
+ */
+uint16_t getBeatPhase();
+
+/**
+ * Beat period in ms (0 until a tempo has been found), and the time left until the
+ * next predicted beat.
+ */
+unsigned getBeatPeriodMs();
+unsigned getMsToNextBeat();
+
+/**
+ * Noise floor in ADC counts: a running low percentile of the amplitude (at least
+ * NOISE_FLOOR_MIN). It follows the room while auto-calibration is enabled and only
+ * creeps up while it is disabled (see NOISE_FLOOR_* in config.h).
+ */
+int getNoiseFloor();
+
+/**
+ * Automatic gain x 256 (256 = 1): brings the typical level above the noise floor to
+ * AGC_TARGET_LEVEL. Learned while auto-calibration is disabled (ACTIVE), held while it
+ * is enabled; 256 if ENABLE_AGC is 0.
+ */
+unsigned getAgcGain();
+
+/**
+ * A level (the amplitude or a band level) on the normalized range the motors use:
+ * (level - noise floor) x gain, 0 at or below the floor. Not scaled if ENABLE_AGC
+ * is 0.
+ */
+int normalizeLevel(int level);
+
 /**
  * Enable/disable automatic DC offset calibration.
- * When enabled, the audio processor slowly adapts its DC offset estimate based on the rolling average.
+ * When enabled, the DC offset estimate tracks the mean of the long statistics window
+ * and the noise floor tracks the room. Disabling it holds the estimate from
+ * DC_BASELINE_HOLDOFF_MS earlier, before the sound that triggered it, and lets the
+ * AGC learn the sound's level.
  * Typically enabled in IDLE (quiet) to track baseline drift.
  */
 void setAutoCalibrationEnabled(bool enabled);
@@ -36,16 +128,28 @@ void setAutoCalibrationEnabled(bool enabled);
 int getDcOffsetEstimate();
 
 /**
- * Check if a new audio sample is ready for processing
- * 
- * @return true if new sample available, false otherwise
+ * Most recent raw ADC reading taken by the sampling interrupt (ADC_RESOLUTION_BITS wide,
+ * before any decimation).
  */
-bool isNewSampleReady();
+int getLatestRawSample();
+
+/**
+ * Statistics of the last BUFFER_SIZE samples, for debugging: computed on each call,
+ * not per sample, as nothing in the firmware depends on them.
+ */
+AudioWindowStats getShortWindowStats();
 
 /**
- * Clear the new sample ready flag
+ * Statistics of the long (STATS_LONG_WINDOW) window used as the DC baseline.
  */
-void clearSampleReadyFlag();
+AudioWindowStats getLongWindowStats();
+
+/**
+ * Check if new audio samples are waiting in the sample ring
+ * 
+ * @return true if at least one sample is available, false otherwise
+ */
+bool isNewSampleReady();
 
 #endif // AUDIO_PROCESSOR_H
 
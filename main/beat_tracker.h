@@ -0,0 +1,279 @@
+#ifndef BEAT_TRACKER_H
+#define BEAT_TRACKER_H
+
+#include <stdint.h>
+#include "const_math.h"
+
+/**
+ * Streaming onset detector and tempo / beat-phase tracker.
+ *
+ * Input is the AC signal (sample minus DC baseline), one sample at a time. Three
+ * stages, all incremental:
+ * - onsets: every HOP samples, the frame's mean |x| is compressed to log2 (1/32
+ *   octave steps) and compared with its recent average. The rise is the onset
+ *   detection function (ODF); an onset is a rise above both MIN_RISE and twice the
+ *   ODF's long-term mean, at least REFRACTORY_FRAMES after the previous one.
+ *   Frames quieter than MIN_LEVEL never rise, so hum and hiss make no onsets.
+ * - tempo: a leaky autocorrelation of the ODF over lags MIN_LAG..MAX_LAG frames
+ *   (one multiply-add per lag per frame), weighted by a log-normal preference for
+ *   PREFERRED_LAG against octave errors. The best lag, refined by parabolic
+ *   interpolation, is the beat period; small changes are smoothed in, a new tempo
+ *   replaces the old one only after it has won for SWITCH_FRAMES.
+ * - phase: a 32-bit beat phase advances every sample (wrapping once per beat). Each
+ *   onset adds its strength to a 16-bin histogram of where onsets fall in the beat;
+ *   if another bin clearly beats bin 0 the phase is re-anchored there (so a tracker
+ *   that first locked onto off-beats moves to the stronger beats), and onsets within
+ *   1/8 beat of the predicted beat pull the phase towards themselves.
+ *
+ * Per sample: an add, an abs and a compare; once per frame about three operations
+ * per lag and two divisions (the confidence ratio, and the parabolic refinement while
+ * the autocorrelation has a clear peak), plus two more when the period changes; the
+ * Cortex-M4 divides in hardware. No floating point at runtime (the preference weights
+ * are a constexpr table, in flash).
+ */
+
+// Q15 tempo preference per lag MIN_LAG..MIN_LAG + LAGS - 1: log-normal in the lag, one
+// octave wide, so half or double PREFERRED_LAG scores ~60%.
+template <uint16_t MIN_LAG, uint16_t LAGS, uint16_t PREFERRED_LAG>
+struct BeatTempoWeights {
+  uint16_t weight[LAGS];
+};
+
+template <uint16_t MIN_LAG, uint16_t LAGS, uint16_t PREFERRED_LAG>
+constexpr BeatTempoWeights<MIN_LAG, LAGS, PREFERRED_LAG> makeBeatTempoWeights() {
+  BeatTempoWeights<MIN_LAG, LAGS, PREFERRED_LAG> w = {};
+  for (uint16_t i = 0; i < LAGS; i++) {
+    const double octaves = constLn((double)(MIN_LAG + i) / PREFERRED_LAG) / CONST_MATH_LN2;
+    w.weight[i] = (uint16_t)constRound(32767.0 * constExp(-0.5 * octaves * octaves));
+  }
+  return w;
+}
+
+template <uint16_t HOP, uint16_t MIN_LAG, uint16_t MAX_LAG, uint16_t PREFERRED_LAG, uint16_t MIN_LEVEL>
+class BeatTracker {
+  static_assert(HOP >= 1, "frames need at least one sample");
+  static_assert(MIN_LAG >= 2 && MIN_LAG < MAX_LAG && MAX_LAG < 256, "lags must lie in [2, 255]");
+  static_assert(PREFERRED_LAG >= MIN_LAG && PREFERRED_LAG <= MAX_LAG, "preferred lag out of range");
+
+ public:
+  static const uint16_t LAGS = MAX_LAG - MIN_LAG + 1;
+
+  BeatTracker() { reset(); }
+
+  void reset() {
+    levelSum_ = 0;
+    index_ = 0;
+    average_ = 0;
+    odfMean_ = 0;
+    lastOdf_ = 0;
+    for (uint16_t i = 0; i < HISTORY; i++) odf_[i] = 0;
+    for (uint16_t i = 0; i < LAGS; i++) acf_[i] = 0;
+    for (uint16_t i = 0; i < PHASE_BINS; i++) hist_[i] = 0;
+    head_ = 0;
+    frames_ = 0;
+    framesSinceOnset_ = UINT16_MAX;
+    onsets_ = 0;
+    lastStrength_ = 0;
+    periodQ8_ = 0;
+    candidateQ8_ = 0;
+    switchFrames_ = 0;
+    confidence_ = 0;
+    locked_ = false;
+    phase_ = 0;
+    step_ = 0;
+  }
+
+  // Add one sample. Returns true when it completed a frame with an onset.
+  bool push(int32_t x) {
+    phase_ += step_;
+    levelSum_ += (uint32_t)(x >= 0 ? x : -x);
+    if (++index_ < HOP) return false;
+    index_ = 0;
+    return frame();
+  }
+
+  // Onsets detected since reset(), and the strength (rise, 1/32 octave) of the last one.
+  uint32_t onsets() const { return onsets_; }
+  uint16_t lastOnsetStrength() const { return lastStrength_; }
+
+  // Beat period in samples x 256 (0 until a tempo has been found).
+  uint32_t periodQ8() const { return periodQ8_; }
+
+  // Fraction of the beat since the last predicted beat, 0..65535.
+  uint16_t phase() const { return (uint16_t)(phase_ >> 16); }
+
+  // Samples until the next predicted beat.
+  uint32_t samplesToNextBeat() const {
+    return (uint32_t)(((uint64_t)(uint32_t)(0u - phase_) * periodQ8_) >> 40);
+  }
+
+  // Peak of the autocorrelation over its mean, x 256.
+  uint16_t confidence() const { return confidence_; }
+
+  // A tempo is known, the autocorrelation has a clear peak (LOCK_CONFIDENCE to lock,
+  // UNLOCK_CONFIDENCE to stay locked) and onsets are still coming.
+  bool locked() const { return locked_; }
+
+ private:
+  static const uint16_t HISTORY = 256;  // ODF frames kept (> MAX_LAG)
+  static const uint16_t PHASE_BINS = 16;
+  static const uint16_t MIN_RISE = 8;           // 1/4 octave
+  static const uint16_t REFRACTORY_FRAMES = MIN_LAG / 4;
+  static const int ACF_DECAY_SHIFT = 8;         // ~256 frames of memory
+  static const uint16_t LOCK_CONFIDENCE = 640;    // 2.5x the mean
+  static const uint16_t UNLOCK_CONFIDENCE = 512;  // 2x
+  static const uint16_t SWITCH_FRAMES = 64;
+
+  // log2(v + 1) in 1/32 octave steps (linear between powers of two).
+  static uint16_t log2Q5(uint32_t v) {
+    v += 1;
+    const int n = 31 - __builtin_clz(v);
+    const uint32_t mantissa = (n >= 5) ? (v >> (n - 5)) : (v << (5 - n));
+    return (uint16_t)(n * 32 + (mantissa & 31));
+  }
+
+  bool frame() {
+    const uint32_t level = levelSum_ / HOP;
+    levelSum_ = 0;
+    frames_++;
+    if (framesSinceOnset_ < UINT16_MAX) framesSinceOnset_++;
+
+    // Onset detection function: rise of the compressed level over its recent average.
+    const int32_t c = log2Q5(level);
+    const int32_t rise = c - (average_ >> 8);
+    average_ += ((c << 8) - average_) >> 2;
+    const uint16_t odf = (level >= MIN_LEVEL && rise > 0) ? (uint16_t)rise : 0;
+
+    const uint32_t threshold = (odfMean_ >> 7) > MIN_RISE ? (odfMean_ >> 7) : MIN_RISE;  // 2x mean
+    odfMean_ = odfMean_ - odfMean_ / 64 + ((uint32_t)odf << 8) / 64;
+    const bool onset = odf > threshold && lastOdf_ <= threshold && framesSinceOnset_ >= REFRACTORY_FRAMES;
+    lastOdf_ = odf;
+
+    // Autocorrelation, one lag per tempo candidate.
+    head_ = (uint16_t)((head_ + 1) & (HISTORY - 1));
+    odf_[head_] = odf;
+    uint32_t best = 0, sum = 0;
+    uint16_t bestIndex = 0;
+    uint64_t bestScore = 0;
+    for (uint16_t i = 0; i < LAGS; i++) {
+      const uint16_t past = odf_[(head_ - MIN_LAG - i) & (HISTORY - 1)];
+      acf_[i] += (uint32_t)odf * past - (acf_[i] >> ACF_DECAY_SHIFT);
+      sum += acf_[i] >> 8;
+      const uint64_t score = (uint64_t)acf_[i] * WEIGHTS.weight[i];
+      if (score > bestScore) {
+        bestScore = score;
+        bestIndex = i;
+        best = acf_[i];
+      }
+    }
+    const uint32_t mean = sum / LAGS;
+    const uint32_t ratio = (best >> 8) * 256 / (mean + 1);
+    confidence_ = (uint16_t)(ratio > UINT16_MAX ? UINT16_MAX : ratio);
+    // Lock on only while the period agrees with the current estimate.
+    const bool tracking = frames_ > MAX_LAG && confidence_ >= LOCK_CONFIDENCE && updatePeriod(bestIndex);
+    locked_ = (locked_ ? confidence_ >= UNLOCK_CONFIDENCE : tracking) && framesSinceOnset_ <= 2 * MAX_LAG;
+
+    if (onset) {
+      onsets_++;
+      lastStrength_ = odf;
+      framesSinceOnset_ = 0;
+      if (periodQ8_ != 0) alignPhase(odf);
+    }
+    return onset;
+  }
+
+  // Returns true if the estimate agrees with the period (after the update).
+  bool updatePeriod(uint16_t i) {
+    // Parabolic interpolation between the neighbouring lags, in 1/256 frame.
+    int32_t lagQ8 = (int32_t)(MIN_LAG + i) << 8;
+    if (i > 0 && i + 1 < LAGS) {
+      const int32_t a = (int32_t)(acf_[i - 1] >> 8), b = (int32_t)(acf_[i] >> 8), c = (int32_t)(acf_[i + 1] >> 8);
+      const int32_t curvature = a - 2 * b + c;
+      if (curvature < 0) {
+        int32_t offset = (a - c) * 128 / curvature;
+        lagQ8 += offset > 128 ? 128 : (offset < -128 ? -128 : offset);
+      }
+    }
+    const uint32_t estimate = (uint32_t)lagQ8 * HOP;
+
+    uint32_t period = periodQ8_;
+    if (period == 0) {
+      period = estimate;
+    } else {
+      const int32_t diff = (int32_t)(estimate - period);
+      if ((uint32_t)(diff >= 0 ? diff : -diff) <= period / 8) {
+        period += diff / 8;
+        switchFrames_ = 0;
+      } else {
+        // A different tempo: take it once it has won for long enough.
+        const int32_t fromCandidate = (int32_t)(estimate - candidateQ8_);
+        if (switchFrames_ > 0 && (uint32_t)(fromCandidate >= 0 ? fromCandidate : -fromCandidate) > candidateQ8_ / 8) {
+          switchFrames_ = 0;
+        }
+        candidateQ8_ = estimate;
+        if (++switchFrames_ >= SWITCH_FRAMES) {
+          period = estimate;
+          switchFrames_ = 0;
+        }
+      }
+    }
+    if (period != periodQ8_) {
+      // 2^40 / period (one beat of phase over the period) in two 32-bit divisions.
+      periodQ8_ = period;
+      const uint32_t q = UINT32_MAX / period;
+      step_ = (q << 8) + ((UINT32_MAX - q * period) << 8) / period;
+    }
+    return switchFrames_ == 0;
+  }
+
+  void alignPhase(uint16_t strength) {
+    // The rise shows in the frame that contains the onset: on average half a frame late.
+    const uint32_t at = phase_ - step_ * (HOP / 2);
+    const uint16_t bin = (uint16_t)((at + (1UL << 27)) >> 28) & (PHASE_BINS - 1);
+    for (uint16_t b = 0; b < PHASE_BINS; b++) hist_[b] -= hist_[b] >> 3;
+    hist_[bin] += (uint32_t)strength << 8;
+
+    uint16_t top = 0;
+    for (uint16_t b = 1; b < PHASE_BINS; b++) {
+      if (hist_[b] > hist_[top]) top = b;
+    }
+    if (top != 0 && hist_[top] > hist_[0] + (hist_[0] >> 1)) {
+      // Onsets cluster elsewhere in the beat: that is where the beat is.
+      phase_ -= (uint32_t)top << 28;
+      uint32_t rotated[PHASE_BINS];
+      for (uint16_t b = 0; b < PHASE_BINS; b++) rotated[b] = hist_[(b + top) & (PHASE_BINS - 1)];
+      for (uint16_t b = 0; b < PHASE_BINS; b++) hist_[b] = rotated[b];
+      return;
+    }
+
+    // Close to the predicted beat: pull the phase a quarter of the way towards it.
+    const int32_t error = (int32_t)at;
+    if (error > -(1L << 29) && error < (1L << 29)) phase_ -= (uint32_t)(error / 4);
+  }
+
+  static constexpr BeatTempoWeights<MIN_LAG, LAGS, PREFERRED_LAG> WEIGHTS =
+      makeBeatTempoWeights<MIN_LAG, LAGS, PREFERRED_LAG>();
+
+  uint32_t levelSum_;
+  uint16_t index_;
+  int32_t average_;        // recent compressed level, x 256
+  uint32_t odfMean_;       // long-term ODF mean, x 256
+  uint16_t lastOdf_;
+  uint16_t odf_[HISTORY];
+  uint32_t acf_[LAGS];
+  uint32_t hist_[PHASE_BINS];
+  uint16_t head_;
+  uint32_t frames_;
+  uint16_t framesSinceOnset_;
+  uint32_t onsets_;
+  uint16_t lastStrength_;
+  uint32_t periodQ8_;
+  uint32_t candidateQ8_;
+  uint16_t switchFrames_;
+  uint16_t confidence_;
+  bool locked_;
+  uint32_t phase_;         // 2^32 = one beat
+  uint32_t step_;          // phase per sample
+};
+
+#endif // BEAT_TRACKER_H
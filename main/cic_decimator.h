@@ -0,0 +1,70 @@
+#ifndef CIC_DECIMATOR_H
+#define CIC_DECIMATOR_H
+
+#include <stdint.h>
+
+/**
+ * Cascaded integrator-comb (CIC) decimator: ORDER integrators run at the input rate,
+ * every RATIO-th input the ORDER combs run once and produce an output at the input
+ * rate / RATIO. The response is a moving average of RATIO inputs applied ORDER times
+ * (sinc^ORDER), with nulls on every multiple of the output rate, where the aliases
+ * would land; the gain is RATIO^ORDER, removed by a shift since RATIO is a power of two.
+ *
+ * Per input: ORDER adds. Per output: ORDER subtracts and a rounding shift. No multiply.
+ *
+ * The integrators are allowed to wrap: in two's complement the combs' differences come
+ * out right anyway, as long as the true (unshifted) output fits in 32 bits, i.e.
+ * input bits + ORDER * log2(RATIO) <= 31. Averaging RATIO noisy inputs gains up to
+ * log2(RATIO) / 2 bits of resolution; the output keeps the input's scale.
+ */
+template <uint8_t ORDER, uint16_t RATIO>
+class CicDecimator {
+  static_assert(ORDER >= 1 && ORDER <= 4, "CIC order must be 1-4");
+  static_assert(RATIO >= 2 && RATIO <= 256 && (RATIO & (RATIO - 1)) == 0,
+                "decimation ratio must be a power of two in [2, 256]");
+
+ public:
+  // log2 of the filter's gain (RATIO^ORDER).
+  static const uint8_t GAIN_BITS = ORDER * (RATIO >= 256 ? 8 : RATIO >= 128 ? 7 : RATIO >= 64 ? 6 :
+                                            RATIO >= 32 ? 5 : RATIO >= 16 ? 4 : RATIO >= 8 ? 3 :
+                                            RATIO >= 4 ? 2 : 1);
+
+  CicDecimator() { reset(0); }
+
+  // As if the input had been `level` forever: the next outputs are `level`.
+  void reset(int32_t level) {
+    for (uint8_t k = 0; k < ORDER; k++) integrator_[k] = comb_[k] = 0;
+    phase_ = 0;
+    output_ = 0;
+    for (uint16_t n = 0; n < ORDER * RATIO; n++) push(level);
+  }
+
+  // Add one input. Returns true when it completed an output (read it with output()).
+  bool push(int32_t x) {
+    uint32_t acc = integrator_[0] += (uint32_t)x;
+    for (uint8_t k = 1; k < ORDER; k++) acc = integrator_[k] += acc;
+    if (++phase_ < RATIO) return false;
+
+    phase_ = 0;
+    for (uint8_t k = 0; k < ORDER; k++) {
+      const uint32_t delayed = comb_[k];
+      comb_[k] = acc;
+      acc -= delayed;
+    }
+    output_ = (int32_t)acc;
+    return true;
+  }
+
+  // Last output at the input's scale, rounded.
+  int32_t output() const {
+    return (output_ + (int32_t)((1UL << GAIN_BITS) >> 1)) >> GAIN_BITS;
+  }
+
+ private:
+  uint32_t integrator_[ORDER];
+  uint32_t comb_[ORDER];
+  int32_t output_;  // x RATIO^ORDER
+  uint16_t phase_;
+};
+
+#endif // CIC_DECIMATOR_H
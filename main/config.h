@@ -7,8 +7,94 @@
 
 // Audio processing constants
 #define SAMPLE_RATE 1000              // 1kHz sampling rate (1000 samples/second)
-#define BUFFER_SIZE 20                 // Small rolling buffer for smoothing
+#define BUFFER_SIZE 20                 // Short statistics window (samples), for debugging
+#define STATS_LONG_WINDOW 512          // Long statistics window (samples) for the DC baseline
+#define DC_BASELINE_HOLDOFF_MS 250     // When calibration stops (ACTIVE), the baseline reverts to this long ago
 #define DC_OFFSET 512                  // Typical ADC midpoint (may need calibration)
+// Compile-time filter chains (any FilterChain<...> of the filters in dsp_filters.h;
+// FilterChain<> is a pass-through). Coefficients are Q15, e.g. q15(0.7).
+// - input: every sample, before the window statistics (output must stay in the samples' range,
+//   so no DC-removing stages here; the DC baseline comes from the long window)
+// - amplitude: extra smoothing of the envelope follower output (pass-through by default)
+#define AUDIO_INPUT_FILTER_CHAIN FilterChain<>
+#define AMPLITUDE_FILTER_CHAIN FilterChain<>
+// Envelope follower on (sample - DC baseline), see envelope_follower.h.
+// ENVELOPE_RMS tracks loudness; ENVELOPE_RECTIFIED is average-responding; ENVELOPE_PEAK holds peaks.
+#define ENVELOPE_MODE ENVELOPE_RMS
+#define ENVELOPE_AVERAGING_MS 10       // Detector averaging (about one period of the lowest tone of interest)
+#define ENVELOPE_ATTACK_MS 5           // Rise time constant (fast: motor reacts to onsets)
+#define ENVELOPE_RELEASE_MS 150        // Decay time constant (steady fall-off between sounds)
+// Band analyzer (Goertzel bank, see goertzel_bank.h): bass / mid / treble levels per block.
+// Bins are SAMPLE_RATE / BAND_BLOCK_SIZE apart (31.25Hz); bands stop at Nyquist (SAMPLE_RATE / 2).
+#define ENABLE_BAND_ANALYZER 1
+#define BAND_BLOCK_SIZE 32             // Samples per analysis block (power of two): 32ms latency
+#define BAND_BASS_MAX_HZ 150           // Bass: first bin above DC up to here
+#define BAND_MID_MAX_HZ 300            // Mid: up to here; treble: the rest up to Nyquist
+// Beat tracker (beat_tracker.h): onsets from the rise of the level per frame, tempo from
+// the onsets' autocorrelation, and a running beat phase (getBeatPhase()).
+#define ENABLE_BEAT_TRACKER 1
+#define BEAT_FRAME_MS 8                // Onset detection frame: the tracker's time resolution
+#define BEAT_MIN_BPM 60                // Tempo search range
+#define BEAT_MAX_BPM 180
+#define BEAT_PREFERRED_BPM 120         // Ties between half / double tempo go towards this
+#define BEAT_ONSET_MIN_LEVEL 10        // Frames quieter than this (mean |AC|, ADC counts) make no onsets
+// Noise floor (percentile_tracker.h): a running low percentile of the amplitude, one step
+// per NOISE_FLOOR_FRAME_MS. The ACTIVE thresholds are relative to it. While the DC baseline
+// calibrates (IDLE) it settles near the 20th percentile, rising ~1.3 s and falling ~0.3 s
+// per e-fold; in ACTIVE it rises 2^NOISE_FLOOR_ACTIVE_SLOWDOWN times slower, so only minutes
+// of unbroken sound become the room's floor. For NOISE_FLOOR_ACQUIRE_MS after start-up it
+// rises as fast as it falls, to find the room during the IDLE warm-up.
+#define NOISE_FLOOR_FRAME_MS 10
+#define NOISE_FLOOR_RISE_SHIFT 7       // Step up: floor / 2^7 per frame
+#define NOISE_FLOOR_FALL_SHIFT 5       // Step down: floor / 2^5 per frame
+#define NOISE_FLOOR_ACTIVE_SLOWDOWN 4
+#define NOISE_FLOOR_ACQUIRE_MS 500
+#define NOISE_FLOOR_MIN 1              // ADC counts: the floor never reads lower
+// Automatic gain: the motors get (level - noise floor) x gain, the gain bringing a running
+// ~89th percentile of that to AGC_TARGET_LEVEL. It learns in ACTIVE (up ~0.6 s, down ~5 s
+// per e-fold) and holds in IDLE, so the next sound starts at the last music's gain.
+// ENABLE_AGC 0 hands the motors the unscaled levels above the floor.
+#define ENABLE_AGC 1
+#define AGC_TARGET_LEVEL 300           // On the motor curves' 0-512 input range
+#define AGC_RISE_SHIFT 6
+#define AGC_FALL_SHIFT 9
+#define AGC_MIN_GAIN_PCT 50
+#define AGC_MAX_GAIN_PCT 800
+// Sampling backend
+// TIMER_ISR: timer interrupt + blocking analogRead() per sample (practical up to ~1kHz).
+// BLOCK_DMA: timer event -> ADC conversion in hardware, DMA fills ping-pong blocks,
+//   one interrupt per SAMPLE_BLOCK_SIZE samples (sampling_hal.h); makes 8-16kHz practical.
+#define SAMPLING_BACKEND_TIMER_ISR 0
+#define SAMPLING_BACKEND_BLOCK_DMA 1
+#ifndef SAMPLING_BACKEND
+#define SAMPLING_BACKEND SAMPLING_BACKEND_TIMER_ISR
+#endif
+#define SAMPLE_BLOCK_SIZE 32           // Samples per DMA block (BLOCK_DMA backend)
+// Oversampling: ADC_OVERSAMPLING conversions per sample at the ADC's 14-bit resolution,
+// decimated to SAMPLE_RATE by an order-ADC_CIC_ORDER CIC filter (cic_decimator.h) in the
+// sampling interrupt. Samples then carry SAMPLE_FRACTION_BITS below the 10-bit ADC count
+// that DC_OFFSET and every level and threshold are given in, so a sound a few counts loud
+// is measured in 1/16 counts. 1 = off: one 10-bit conversion per sample. At 16x the ADC
+// converts at 16kHz: use the BLOCK_DMA backend (SAMPLE_BLOCK_SIZE conversions per block).
+#ifndef ADC_OVERSAMPLING
+#define ADC_OVERSAMPLING 1
+#endif
+#define ADC_CIC_ORDER 2                // Response at 100 / 250 / 450 Hz: -0.3 / -1.8 / -6.2 dB (16x)
+#if ADC_OVERSAMPLING > 1
+#define ADC_RESOLUTION_BITS 14
+#else
+#define ADC_RESOLUTION_BITS 10
+#endif
+#define SAMPLE_FRACTION_BITS (ADC_RESOLUTION_BITS - 10)
+// ISR -> loop() sample ring (must be a power of two).
+// 128 samples = 128ms of headroom at 1kHz before the ISR starts dropping samples.
+// Blocks land all at once (SAMPLE_BLOCK_SIZE samples late), so the block backend doubles it.
+// Scale this with SAMPLE_RATE: it must cover the slowest loop() pass.
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+#define SAMPLE_RING_SIZE 256
+#else
+#define SAMPLE_RING_SIZE 128
+#endif
 
 // Motor control constants
 #define MIN_MOTOR_SPEED 80             // Minimum speed to prevent motor stalling
@@ -26,12 +112,51 @@
 // Debug output interval (milliseconds)
 #define DEBUG_INTERVAL 100
 
+// Binary telemetry (telemetry.h) instead of the periodic text debug output above.
+// One 21-byte status record per interval plus one per state change, queued and sent
+// without blocking; tools/telemetry_decode.py converts the stream to CSV.
+#define ENABLE_BINARY_TELEMETRY 1
+#define TELEMETRY_INTERVAL_MS 50       // 20 records/s = 420 bytes/s, under half of 9600 baud
+#define TELEMETRY_RING_SIZE 1024       // Bytes queued for Serial (power of two): 48 records, or ~300 ms of capture
+#define SERIAL_BAUD 115200             // USB CDC on the Minima ignores it; raw capture needs ~3.5 KB/s
+
+// Raw capture (raw_capture.h): the serial command 'c' restarts the signal chain and
+// streams every sample the audio task processes, plus every supervisor tick, as
+// telemetry frames (~3.5 KB/s at 1 kHz). tools/capture_record.py records them and
+// tests/replay_capture replays them through the firmware on the desktop. One flag test
+// per sample batch while idle; 0 compiles it out.
+#define ENABLE_RAW_CAPTURE 1
+#if ENABLE_RAW_CAPTURE && !ENABLE_BINARY_TELEMETRY
+#error "ENABLE_RAW_CAPTURE sends telemetry frames: it needs ENABLE_BINARY_TELEMETRY"
+#endif
+
+// Cooperative scheduler (scheduler.h): loop() runs the due tasks, then sleeps (WFI).
+// Audio processing runs when the sampling interrupt signals it, the supervisor every
+// MOTOR_UPDATE_INTERVAL, status output every TELEMETRY_INTERVAL_MS (DEBUG_INTERVAL
+// for text output). A run finishing later than its deadline counts as a miss.
+#define SERIAL_POLL_INTERVAL_MS 5      // commands and output flushing (64-byte TX buffer)
+#define AUDIO_TASK_DEADLINE_MS 5       // from the sampling interrupt to samples processed
+
+// Per-stage loop() timing (loop_profiler.h), reported by the serial command 'p'.
+// Two cycle-counter reads and a histogram update per stage; 0 compiles the probes out.
+#define ENABLE_LOOP_PROFILER 1
+
+// --- Runtime configuration (runtime_config.h) ---
+// The FSM thresholds and timeouts, the beat accent, the health monitoring limits below
+// and each motor's curve and motion profile are defaults: they can be changed over Serial ('$set name
+// value', applied at the next supervisor tick) and saved to the data flash ('$save').
+// A valid saved config replaces them at boot.
+#define RUNTIME_CONFIG_STORE_ADDRESS 0  // EEPROM offset of the saved record
+
 // --- Audio thresholding / FSM tuning ---
-// If amplitude stays below this threshold for > IDLE_TIMEOUT_MS, the system enters IDLE (motor off).
-#define SILENCE_THRESHOLD 5
-// Hysteresis: require a slightly higher threshold to enter ACTIVE than to remain ACTIVE.
-#define ACTIVE_ENTER_THRESHOLD 15
-#define ACTIVE_EXIT_THRESHOLD 8
+// Hysteresis: the amplitude must reach the enter threshold to wake the sculpture, and
+// stay under the exit threshold for IDLE_TIMEOUT_MS to put it back to IDLE. Both follow
+// the noise floor (ACTIVE_*_FLOOR_PCT of it), so a loud lobby and a quiet hall need no
+// retuning, but never drop below ACTIVE_*_THRESHOLD (ADC counts, just above ADC noise).
+#define ACTIVE_ENTER_THRESHOLD 10
+#define ACTIVE_EXIT_THRESHOLD 5
+#define ACTIVE_ENTER_FLOOR_PCT 400
+#define ACTIVE_EXIT_FLOOR_PCT 250
 // Debounce entering ACTIVE (ms) to avoid chatter on noise.
 #define ACTIVE_ENTER_DEBOUNCE_MS 50
 // Time with no meaningful audio before entering IDLE (motor off).
@@ -40,13 +165,88 @@
 // This gives DC offset auto-calibration time to converge so we don't false-trigger ACTIVE.
 #define IDLE_CALIBRATION_WARMUP_MS 500
 
+// --- Beat-synchronous motion ---
+// While the beat tracker is locked, ACTIVE raises every motor's level by BEAT_ACCENT_PCT
+// for BEAT_ACCENT_MS, starting BEAT_LEAD_MS before each predicted beat: the motor lags
+// its PWM, so driving it early makes it peak on the beat. BEAT_ACCENT_PCT 0 turns it off.
+#define BEAT_LEAD_MS 60
+#define BEAT_ACCENT_MS 100
+#define BEAT_ACCENT_PCT 50
+
 // --- Safety / health monitoring ---
 // If the audio sampling timer stops advancing for this long, enter FAULT.
 #define SAMPLE_STALL_TIMEOUT_MS 250
+// A sampling period more than SAMPLE_JITTER_LIMIT_US away from nominal counts as a
+// jitter violation (sample_jitter.h); SAMPLE_JITTER_FAULT_COUNT violations within
+// SAMPLE_JITTER_WINDOW_MS enter FAULT. One late sample makes two violations (a long
+// period, then a short one). SAMPLE_JITTER_FAULT_COUNT 0 keeps the statistics only.
+#define SAMPLE_JITTER_LIMIT_US 100
+#define SAMPLE_JITTER_FAULT_COUNT 10
+#define SAMPLE_JITTER_WINDOW_MS 1000
+// Supervisor state transitions kept for the 'p' report (time, from, to, cause).
+#define SUPERVISOR_TRACE_SIZE 16
+
+// --- Motor smoothing (motion_profile.h) ---
+// Jerk-limited PWM trajectories, one step per MOTOR_UPDATE_INTERVAL. Row: {name,
+// max velocity PWM/s, max acceleration PWM/s^2, max jerk PWM/s^3, floor PWM, kick PWM,
+// kick ms}. Below the floor the motor stalls: starts jump to it (after the kick pulse,
+// if any) and stops ramp down to it, then cut. Kick PWM 0 disables the kick.
+// "smooth": at most 8 PWM per tick, full acceleration after 40ms; "snappy": 2.5x the
+// speed and twice the acceleration.
+#define MOTOR_MOTION_SMOOTH 0
+#define MOTOR_MOTION_SNAPPY 1
+#define MOTOR_MOTION_PROFILES { \
+  {"smooth", 800, 10000, 250000, MIN_MOTOR_SPEED, 200, 30}, \
+  {"snappy", 2000, 20000, 500000, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, 20}, \
+}
+
+// --- Motor response curves (pwm_curve.h) ---
+// Level -> PWM lookup tables built at compile time, one per profile; each motor picks
+// a profile by index. Row: {name, shape, param, input low, input high, min PWM, max PWM,
+// point count, {points}}. Levels at or below `input low` stop the motor.
+// Shapes: PWM_CURVE_LINEAR; PWM_CURVE_LOG (param = curvature k); PWM_CURVE_GAMMA
+// (param = gamma x 100); PWM_CURVE_PIECEWISE (points {x, y} in permille of the ranges).
+// Profile 0 is the linear map clampAndMapAmplitudeToTargetPwm() documents.
+#define MOTOR_CURVE_LINEAR 0
+#define MOTOR_CURVE_LOG 1
+#define MOTOR_CURVE_GAMMA 2
+#define MOTOR_CURVE_CUSTOM 3
+#define MOTOR_CURVE_PROFILES { \
+  {"linear", PWM_CURVE_LINEAR, 0, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, 0, {}}, \
+  {"log", PWM_CURVE_LOG, 20, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, 0, {}}, \
+  {"gamma", PWM_CURVE_GAMMA, 50, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, 0, {}}, \
+  {"custom", PWM_CURVE_PIECEWISE, 0, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, \
+   4, {{0, 0}, {150, 400}, {500, 800}, {1000, 1000}}}, \
+}
+
+// --- Motor bank (motor_bank.h) ---
+// One row per motor: {pin, source, curve profile, motion profile}.
+// Sources: MOTOR_SOURCE_AMPLITUDE (broadband) or MOTOR_SOURCE_BASS / _MID / _TREBLE
+// (band analyzer). All channels are updated in one pass every MOTOR_UPDATE_INTERVAL.
+#define MOTOR_CHANNELS 1
+#define MOTOR_CHANNEL_CONFIG \
+  { {MOTOR_PIN, MOTOR_SOURCE_AMPLITUDE, MOTOR_CURVE_LINEAR, MOTOR_MOTION_SMOOTH} }
 
-// --- Motor smoothing ---
-// Max PWM delta per MOTOR_UPDATE_INTERVAL tick (slew-rate limiting for smooth motion).
-#define PWM_SLEW_STEP 8
+// --- Closed-loop speed control (speed_control.h) ---
+// A tachometer or encoder on TACH_PIN measures SPEED_CONTROL_CHANNEL's motor. The PWM
+// the motor bank computes for that channel becomes an RPM setpoint (PWM x
+// SPEED_MAX_RPM / 255) and the feed-forward of a PID (speed_pid.h) that a timer
+// interrupt runs SPEED_CONTROL_HZ times a second, so the speed no longer depends on
+// supply voltage, load or temperature. With no tach pulses for SPEED_FEEDBACK_TIMEOUT_MS
+// while driven, the motor falls back to the plain PWM (open loop) until they return.
+// Needs the sensor: 0 drives every motor open loop.
+#define ENABLE_SPEED_CONTROL 0
+#define TACH_PIN 3                     // interrupt-capable pin, one rising edge per pulse
+#define SPEED_CONTROL_CHANNEL 0
+#define SPEED_TACH_PULSES_PER_REV 12
+#define SPEED_TACH_MIN_PERIOD_US 100   // edges closer than this are glitches (max 50000 RPM at 12/rev)
+#define SPEED_TACH_TIMEOUT_MS 250      // no pulse for this long: the motor is standing
+#define SPEED_MAX_RPM 2600             // the motor's speed at PWM 255 on nominal supply
+#define SPEED_CONTROL_HZ 200
+#define SPEED_FEEDBACK_TIMEOUT_MS 500
+// {kp %, ki %/s, kd %ms, full-scale RPM, integrator limit PWM}; tuned on the motor model
+// (tests/motor_plant.h), check the step response on the real motor.
+#define SPEED_PID_GAINS {150, 1500, 0, SPEED_MAX_RPM, 128}
 
 // On-device test mode:
 // - 0: run normal program
@@ -0,0 +1,26 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Persistent bytes for the runtime configuration record (runtime_config.h).
+ *
+ * The store only moves bytes; the record carries its own magic, version and CRC, so
+ * erased or half-written storage is detected by the reader, not here.
+ *
+ * Implementations:
+ * - config_store_ra4m1.cpp: UNO R4, the EEPROM library (emulated in the RA4M1 data
+ *   flash) at RUNTIME_CONFIG_STORE_ADDRESS. Writing blocks while the flash programs.
+ * - tests/config_store_host.cpp: desktop, a file (see tests/config_store_host.h)
+ */
+
+// Read `length` bytes. Returns false if the store cannot provide them.
+bool configStoreRead(uint8_t *data, size_t length);
+
+// Write `length` bytes (only the ones that changed, where the medium allows) and read
+// them back. Returns false if the store is missing or the bytes did not stick.
+bool configStoreWrite(const uint8_t *data, size_t length);
+
+#endif // CONFIG_STORE_H
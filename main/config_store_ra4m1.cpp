@@ -0,0 +1,28 @@
+#include "config_store.h"
+#include "config.h"
+
+// UNO R4 (RA4M1) implementation of the config store. Only built for the Renesas core;
+// the desktop build links tests/config_store_host.cpp instead.
+#if defined(ARDUINO_ARCH_RENESAS)
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+bool configStoreRead(uint8_t *data, size_t length) {
+  if (RUNTIME_CONFIG_STORE_ADDRESS + length > EEPROM.length()) return false;
+  for (size_t i = 0; i < length; i++) data[i] = EEPROM.read(RUNTIME_CONFIG_STORE_ADDRESS + i);
+  return true;
+}
+
+bool configStoreWrite(const uint8_t *data, size_t length) {
+  if (RUNTIME_CONFIG_STORE_ADDRESS + length > EEPROM.length()) return false;
+  // update() skips bytes that already hold the value: a re-save of an unchanged
+  // config costs no flash wear.
+  for (size_t i = 0; i < length; i++) EEPROM.update(RUNTIME_CONFIG_STORE_ADDRESS + i, data[i]);
+  for (size_t i = 0; i < length; i++) {
+    if (EEPROM.read(RUNTIME_CONFIG_STORE_ADDRESS + i) != data[i]) return false;
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef CONST_MATH_H
+#define CONST_MATH_H
+
+/**
+ * Math for tables the compiler builds (std::cos, std::log and std::exp are not constexpr).
+ *
+ * Only meant for constant expressions: a `static constexpr` table computed with
+ * these goes to flash, and no floating point or libm is linked into the firmware.
+ * Accurate to a few ulp over the ranges the tables use.
+ */
+
+static constexpr double CONST_MATH_PI = 3.14159265358979323846;
+static constexpr double CONST_MATH_LN2 = 0.69314718055994530942;
+
+// Nearest integer, halves away from zero (like lround).
+constexpr long constRound(double x) {
+  return (long)(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+// Cosine: reduce to [-pi, pi], then the Taylor series.
+constexpr double constCos(double x) {
+  x -= 2.0 * CONST_MATH_PI * constRound(x / (2.0 * CONST_MATH_PI));
+  const double x2 = x * x;
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 2; n < 40; n += 2) {
+    term *= -x2 / ((n - 1) * n);
+    sum += term;
+  }
+  return sum;
+}
+
+// Natural log for x > 0: scale into [1, 2), then 2 * atanh((x - 1) / (x + 1)).
+constexpr double constLn(double x) {
+  int k = 0;
+  while (x >= 2.0) { x *= 0.5; k++; }
+  while (x < 1.0) { x *= 2.0; k--; }
+  const double t = (x - 1.0) / (x + 1.0);
+  const double t2 = t * t;
+  double term = t;
+  double sum = 0.0;
+  for (int n = 1; n < 40; n += 2) {
+    sum += term / n;
+    term *= t2;
+  }
+  return 2.0 * sum + k * CONST_MATH_LN2;
+}
+
+// e^x: split off whole powers of two, Taylor series for the rest (|r| < ln 2).
+constexpr double constExp(double x) {
+  int k = (int)(x / CONST_MATH_LN2);
+  const double r = x - k * CONST_MATH_LN2;
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 1; n < 30; n++) {
+    term *= r / n;
+    sum += term;
+  }
+  while (k > 0) { sum *= 2.0; k--; }
+  while (k < 0) { sum *= 0.5; k++; }
+  return sum;
+}
+
+#endif // CONST_MATH_H
@@ -0,0 +1,48 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/**
+ * Free-running 32-bit CPU cycle counter for timing probes.
+ *
+ * UNO R4: the Cortex-M4 DWT cycle counter (CYCCNT), one count per 48MHz cycle,
+ * readable in a single load. It wraps every ~89s; the difference of two readings
+ * is still correct in unsigned arithmetic as long as they are less than that apart.
+ *
+ * Elsewhere (the desktop build) it is derived from micros() in the same units,
+ * so probes read virtual time there.
+ */
+
+static const uint32_t CYCLE_COUNTER_HZ = 48000000UL;
+static const uint32_t CYCLES_PER_MICROSECOND = CYCLE_COUNTER_HZ / 1000000UL;
+
+// Start the counter (idempotent). Call once before the first cycleCounterNow().
+inline void cycleCounterInit() {
+#if defined(ARDUINO_ARCH_RENESAS)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+inline uint32_t cycleCounterNow() {
+#if defined(ARDUINO_ARCH_RENESAS)
+  return DWT->CYCCNT;
+#else
+  return (uint32_t)micros() * CYCLES_PER_MICROSECOND;
+#endif
+}
+
+inline uint32_t cyclesToMicros(uint32_t cycles) {
+  return cycles / CYCLES_PER_MICROSECOND;
+}
+
+// log2 histogram bucket of a duration: k significant bits -> bucket k, i.e.
+// [2^(k-1), 2^k) cycles (bucket 0: zero cycles), clamped to the last of `buckets`.
+inline int cycleHistogramBucket(uint32_t cycles, int buckets) {
+  const int bits = (cycles == 0) ? 0 : 32 - __builtin_clz(cycles);
+  return (bits < buckets) ? bits : buckets - 1;
+}
+
+#endif // CYCLE_COUNTER_H
@@ -0,0 +1,204 @@
+#ifndef DSP_FILTERS_H
+#define DSP_FILTERS_H
+
+#include <stdint.h>
+#include "fixed_point.h"
+
+/**
+ * Header-only fixed-point filters for the audio path.
+ *
+ * Every filter processes integer samples (ADC counts or amplitudes, |x| <= 32767)
+ * with coefficients fixed at compile time as template parameters, so the per-sample
+ * path is a handful of multiply-adds and shifts: no division, no floating point.
+ *
+ * Filter state keeps extra fractional bits (or feeds the rounding error back), so
+ * unlike `(y * 3 + x * 7) / 10` a filter settles on exactly the input level instead
+ * of stalling up to one count short of it.
+ *
+ * Every filter provides:
+ *   int32_t process(int32_t x)  one sample in, one sample out
+ *   int32_t reset(int32_t x)    settle as if x had been the input forever;
+ *                               returns the settled output
+ *
+ * Filters compose at compile time with FilterChain<...>, e.g.
+ *   FilterChain<DcBlocker<q15(0.995)>, EmaFilter<q15(0.2)>> chain;
+ */
+
+/**
+ * Q15 weight of a one-pole smoother with the given time constant (ms) at the given
+ * sample rate: 1 / (tau_samples + 0.5). Within 2% of the exact 1 - exp(-1 / tau) for
+ * tau >= 2 samples; 0 ms saturates to (almost) 1, i.e. the output follows the input.
+ */
+constexpr q15_t timeConstantToQ15(double ms, double sampleRateHz) {
+  return q15(1.0 / (0.5 + ms * sampleRateHz / 1000.0));
+}
+
+/**
+ * Exponential moving average: y += alpha * (x - y).
+ * ALPHA is the Q15 weight of each new sample (larger = faster, 0 < ALPHA < 1).
+ */
+template <q15_t ALPHA>
+class EmaFilter {
+  static_assert(ALPHA > 0, "EMA weight must be positive");
+
+ public:
+  EmaFilter() { reset(0); }
+
+  int32_t reset(int32_t x) {
+    state_ = x * (1 << FRAC_BITS);
+    return x;
+  }
+
+  int32_t process(int32_t x) {
+    const int64_t diff = (int64_t)x * (1 << FRAC_BITS) - state_;
+    state_ += (int32_t)((diff * ALPHA + (1 << 14)) >> 15);
+    return output();
+  }
+
+  // Current output rounded to the nearest integer.
+  int32_t output() const { return (state_ + (1 << (FRAC_BITS - 1))) >> FRAC_BITS; }
+
+ private:
+  static const int FRAC_BITS = 16;  // y * 2^16 still fits int32 for |y| <= 32767
+  int32_t state_;
+};
+
+/**
+ * One-pole high-pass, the complement of EmaFilter: y = x - ema(x).
+ * Cutoff is roughly ALPHA * SAMPLE_RATE / (2 * pi) for small ALPHA.
+ */
+template <q15_t ALPHA>
+class OnePoleHighPass {
+ public:
+  OnePoleHighPass() { reset(0); }
+
+  int32_t reset(int32_t x) {
+    lowPass_.reset(x);
+    return 0;
+  }
+
+  int32_t process(int32_t x) { return x - lowPass_.process(x); }
+
+ private:
+  EmaFilter<ALPHA> lowPass_;
+};
+
+/**
+ * DC blocker: y[n] = x[n] - x[n-1] + POLE * y[n-1].
+ * POLE (Q15, just below 1) sets the corner: (1 - POLE) * SAMPLE_RATE / (2 * pi).
+ * The rounding error is fed back into the next sample, so a constant input
+ * settles to exactly zero instead of a small truncation offset.
+ */
+template <q15_t POLE>
+class DcBlocker {
+  static_assert(POLE > 0, "DC blocker pole must be in (0, 1)");
+
+ public:
+  DcBlocker() { reset(0); }
+
+  int32_t reset(int32_t x) {
+    prevIn_ = x;
+    prevOut_ = 0;
+    error_ = 0;
+    return 0;
+  }
+
+  int32_t process(int32_t x) {
+    const int64_t acc = (int64_t)(x - prevIn_) * (1 << 15) + (int64_t)prevOut_ * POLE + error_;
+    const int32_t y = (int32_t)(acc >> 15);
+    error_ = (int32_t)(acc - (int64_t)y * (1 << 15));
+    prevIn_ = x;
+    prevOut_ = y;
+    return y;
+  }
+
+ private:
+  int32_t prevIn_;
+  int32_t prevOut_;
+  int32_t error_;
+};
+
+/**
+ * Biquad coefficients are Q2.29 (range [-4, 4)), enough for any stable
+ * low/high/band-pass, notch or modest peaking section.
+ */
+typedef int32_t biquad_coef_t;
+static const int BIQUAD_COEF_FRAC_BITS = 29;
+
+constexpr biquad_coef_t biquadCoef(double x) {
+  const double scaled = x * (double)(1L << BIQUAD_COEF_FRAC_BITS);
+  return (biquad_coef_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+/**
+ * Second-order IIR section, direct form I:
+ *   y = b0*x + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+ * (normalized so a0 = 1, RBJ "Audio EQ Cookbook" sign convention).
+ * Accumulates in 64 bits with first-order error feedback, which avoids the
+ * limit cycles and DC offset that plain truncation causes at low cutoffs.
+ */
+template <biquad_coef_t B0, biquad_coef_t B1, biquad_coef_t B2, biquad_coef_t A1, biquad_coef_t A2>
+class Biquad {
+ public:
+  Biquad() { reset(0); }
+
+  // Settles on the DC response (b0 + b1 + b2) / (1 + a1 + a2); the division
+  // only happens here, never per sample.
+  int32_t reset(int32_t x) {
+    const int64_t num = (int64_t)B0 + B1 + B2;
+    const int64_t den = ((int64_t)1 << BIQUAD_COEF_FRAC_BITS) + A1 + A2;
+    const int32_t y = (den == 0) ? 0 : (int32_t)(x * num / den);
+    x1_ = x2_ = x;
+    y1_ = y2_ = y;
+    error_ = 0;
+    return y;
+  }
+
+  int32_t process(int32_t x) {
+    const int64_t acc = (int64_t)B0 * x + (int64_t)B1 * x1_ + (int64_t)B2 * x2_
+                      - (int64_t)A1 * y1_ - (int64_t)A2 * y2_ + error_;
+    const int64_t wide = acc >> BIQUAD_COEF_FRAC_BITS;
+    const int32_t y = sat32(wide);
+    error_ = (y == wide) ? (int32_t)(acc - wide * (1L << BIQUAD_COEF_FRAC_BITS)) : 0;
+    x2_ = x1_;
+    x1_ = x;
+    y2_ = y1_;
+    y1_ = y;
+    return y;
+  }
+
+ private:
+  int32_t x1_, x2_;
+  int32_t y1_, y2_;
+  int32_t error_;
+};
+
+/**
+ * Compile-time pipeline: each sample runs through the stages left to right.
+ * FilterChain<> is a pass-through. The stages are plain members, so the whole
+ * chain inlines into the caller with no virtual calls or function pointers.
+ */
+template <typename... Stages>
+class FilterChain;
+
+template <>
+class FilterChain<> {
+ public:
+  int32_t reset(int32_t x) { return x; }
+  int32_t process(int32_t x) { return x; }
+  static constexpr unsigned stages() { return 0; }
+};
+
+template <typename First, typename... Rest>
+class FilterChain<First, Rest...> {
+ public:
+  int32_t reset(int32_t x) { return rest_.reset(first_.reset(x)); }
+  int32_t process(int32_t x) { return rest_.process(first_.process(x)); }
+  static constexpr unsigned stages() { return 1 + FilterChain<Rest...>::stages(); }
+
+ private:
+  First first_;
+  FilterChain<Rest...> rest_;
+};
+
+#endif // DSP_FILTERS_H
@@ -0,0 +1,86 @@
+#ifndef ENVELOPE_FOLLOWER_H
+#define ENVELOPE_FOLLOWER_H
+
+#include <stdint.h>
+#include "fixed_point.h"
+
+/**
+ * Detector used by EnvelopeFollower.
+ * - RECTIFIED: average of |x| (2/pi of the peak for a sine)
+ * - RMS: square root of the average of x^2 (1/sqrt(2) of the peak for a sine);
+ *   follows perceived loudness rather than spikes
+ * - PEAK: |x| with no averaging, so the envelope rides on the signal's peaks
+ */
+enum EnvelopeMode {
+  ENVELOPE_RECTIFIED,
+  ENVELOPE_RMS,
+  ENVELOPE_PEAK
+};
+
+/**
+ * Per-sample envelope detector with independent attack and release.
+ *
+ * Input is the AC signal (sample minus its DC baseline, |x| <= 32767); output is
+ * its envelope in the same units (ADC counts). Two one-pole stages run per sample:
+ * - detector: |x| or x^2 averaged with the AVERAGE weight (skipped in PEAK mode);
+ *   this needs to span about one period of the lowest tone of interest
+ * - ballistics: the envelope moves towards the detector level with the ATTACK
+ *   weight when rising and the RELEASE weight when falling
+ * All weights are Q15, usually built with timeConstantToQ15(ms, SAMPLE_RATE).
+ *
+ * Constant cost per sample: two 64-bit multiply-adds and a compare, plus a
+ * fixed-iteration integer square root in RMS mode. No division.
+ */
+template <EnvelopeMode MODE, q15_t AVERAGE, q15_t ATTACK, q15_t RELEASE>
+class EnvelopeFollower {
+  static_assert(AVERAGE > 0 && ATTACK > 0 && RELEASE > 0, "filter weights must be positive");
+
+ public:
+  EnvelopeFollower() { reset(0); }
+
+  // Start from a given envelope level (0 = silence).
+  int32_t reset(int32_t level) {
+    detector_ = envelope_ = toDetector(level);
+    return output();
+  }
+
+  int32_t process(int32_t x) {
+    // Clip |x| to 32767 so the 64-bit products below cannot overflow.
+    const int32_t magnitude = (x >= 0) ? (x > Q15_MAX ? Q15_MAX : x) : (x < -Q15_MAX ? Q15_MAX : -x);
+    const int64_t target = toDetector(magnitude);
+
+    if (MODE == ENVELOPE_PEAK) {
+      detector_ = target;
+    } else {
+      detector_ += step(target - detector_, AVERAGE);
+    }
+    envelope_ += step(detector_ - envelope_, (detector_ > envelope_) ? ATTACK : RELEASE);
+    return output();
+  }
+
+  // Current envelope, rounded to the nearest count.
+  int32_t output() const {
+    const int64_t level = (envelope_ + (1 << (FRAC_BITS - 1))) >> FRAC_BITS;
+    if (MODE == ENVELOPE_RMS) return isqrt32((uint32_t)level);
+    return (int32_t)level;
+  }
+
+ private:
+  // Extra fractional bits so slow releases keep decaying all the way to zero.
+  static const int FRAC_BITS = 16;
+
+  // |x| or x^2 (RMS) in fixed point.
+  static int64_t toDetector(int32_t magnitude) {
+    const int64_t level = (MODE == ENVELOPE_RMS) ? (int64_t)magnitude * magnitude : magnitude;
+    return level * (1 << FRAC_BITS);
+  }
+
+  static int64_t step(int64_t diff, q15_t weight) {
+    return (diff * weight + (1 << 14)) >> 15;
+  }
+
+  int64_t detector_;  // averaged |x| or x^2
+  int64_t envelope_;  // after attack/release ballistics
+};
+
+#endif // ENVELOPE_FOLLOWER_H
@@ -0,0 +1,92 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+/**
+ * Saturating Q15 / Q31 fixed-point helpers.
+ *
+ * Q15 = int16_t with 15 fractional bits ([-1, 1 - 2^-15]);
+ * Q31 = int32_t with 31 fractional bits ([-1, 1 - 2^-31]).
+ *
+ * Products are rounded to nearest (not truncated, which would bias every
+ * multiply towards -infinity) and every result saturates instead of wrapping.
+ * Right shifts of negative values assume an arithmetic shift, which is what
+ * GCC does on both the Cortex-M4 and the desktop test host.
+ *
+ * Coefficients are converted at compile time with q15()/q31(), e.g.
+ * `EmaFilter<q15(0.7)>`, so no floating point is ever executed at runtime.
+ */
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+static const q15_t Q15_MAX = INT16_MAX;
+static const q15_t Q15_MIN = INT16_MIN;
+static const q31_t Q31_MAX = INT32_MAX;
+static const q31_t Q31_MIN = INT32_MIN;
+
+// Compile-time conversion from a real value in [-1, 1) to Q15 (rounded, saturated).
+constexpr q15_t q15(double x) {
+  const double scaled = x * 32768.0;
+  if (scaled >= 32767.0) return Q15_MAX;
+  if (scaled <= -32768.0) return Q15_MIN;
+  return (q15_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+// Compile-time conversion from a real value in [-1, 1) to Q31 (rounded, saturated).
+constexpr q31_t q31(double x) {
+  const double scaled = x * 2147483648.0;
+  if (scaled >= 2147483647.0) return Q31_MAX;
+  if (scaled <= -2147483648.0) return Q31_MIN;
+  return (q31_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+// Clamp a wider intermediate into the Q15 / Q31 range.
+inline q15_t sat16(int32_t x) {
+  return (q15_t)(x > Q15_MAX ? Q15_MAX : (x < Q15_MIN ? Q15_MIN : x));
+}
+
+inline q31_t sat32(int64_t x) {
+  return (q31_t)(x > Q31_MAX ? Q31_MAX : (x < Q31_MIN ? Q31_MIN : x));
+}
+
+inline q15_t qadd15(q15_t a, q15_t b) { return sat16((int32_t)a + b); }
+inline q15_t qsub15(q15_t a, q15_t b) { return sat16((int32_t)a - b); }
+inline q31_t qadd31(q31_t a, q31_t b) { return sat32((int64_t)a + b); }
+inline q31_t qsub31(q31_t a, q31_t b) { return sat32((int64_t)a - b); }
+
+// a * b, rounded to nearest. Only -1 * -1 can overflow; it saturates to just below +1.
+inline q15_t qmul15(q15_t a, q15_t b) {
+  return sat16(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+inline q31_t qmul31(q31_t a, q31_t b) {
+  return sat32(((int64_t)a * b + (1LL << 30)) >> 31);
+}
+
+// x * coef for an integer sample x and a Q15 coefficient, rounded to nearest.
+inline int32_t scaleQ15(int32_t x, q15_t coef) {
+  return (int32_t)(((int64_t)x * coef + (1 << 14)) >> 15);
+}
+
+// Integer square root rounded to nearest. Fixed 16 iterations (constant time).
+inline uint16_t isqrt32(uint32_t n) {
+  uint32_t root = 0;
+  uint32_t rem = n;
+  uint32_t bit = 1UL << 30;
+  while (bit != 0) {
+    if (rem >= root + bit) {
+      rem -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  // rem = n - root^2; round up when n is closer to (root + 1)^2.
+  if (rem > root) root++;
+  return (uint16_t)(root > 0xFFFF ? 0xFFFF : root);
+}
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,202 @@
+#ifndef FSM_H
+#define FSM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Table-driven finite state machine.
+ *
+ * The machine is described by two constexpr tables, passed as template arguments and
+ * checked with static_assert:
+ * - one FsmStateDef per state (indexed by the state's enum value): entry / exit
+ *   actions, run once on each edge, and a `during` action run by tick() while the
+ *   machine stays in the state
+ * - FsmTransition rows: (source states, event, guard) -> target, plus a cause string.
+ *   dispatch() takes the first row, in table order, whose source mask contains the
+ *   current state, whose event matches and whose guard (nullptr = always) holds, so
+ *   earlier rows have priority
+ *
+ * The rows are grouped by (state, event) at compile time (FsmRowIndex), so dispatch()
+ * only visits the candidates. A transition runs exit(from), records {time, from, to,
+ * cause} in a TRACE-entry ring, then runs entry(to). A transition to the current
+ * state is ignored. Actions and guards are plain functions of the current time; the
+ * state they work on lives with the code that owns the machine. Guards must not have
+ * side effects.
+ *
+ * States must be an enum with values 0..STATES-1 (at most 32), events an enum from 0.
+ */
+
+typedef void (*FsmAction)(unsigned long nowMs);
+typedef bool (*FsmGuard)(unsigned long nowMs);
+
+struct FsmStateDef {
+  uint8_t state;  // the state's enum value; checked against the index by fsmStatesInOrder()
+  const char *name;
+  FsmAction entry;
+  FsmAction exit;
+  FsmAction during;
+};
+
+template <typename Event>
+struct FsmTransition {
+  uint32_t from;  // bit mask of source states, see fsmStateMask()
+  Event event;
+  FsmGuard guard;
+  uint8_t to;
+  const char *cause;
+};
+
+struct FsmTraceEntry {
+  uint32_t timestampMs;
+  uint8_t from;
+  uint8_t to;
+  const char *cause;
+};
+
+// Mask of one or more source states: fsmStateMask(A, B, C).
+constexpr uint32_t fsmStateMask() { return 0; }
+template <typename State, typename... More>
+constexpr uint32_t fsmStateMask(State s, More... more) {
+  return (1UL << static_cast<uint32_t>(s)) | fsmStateMask(more...);
+}
+
+// The state table lists every state exactly once, in enum order.
+template <size_t STATES>
+constexpr bool fsmStatesInOrder(const FsmStateDef (&states)[STATES]) {
+  for (size_t i = 0; i < STATES; i++) {
+    if (states[i].state != i) return false;
+  }
+  return true;
+}
+
+// Every transition leaves from at least one state and goes to a valid one.
+template <size_t STATES, typename Event, size_t ROWS>
+constexpr bool fsmTransitionsValid(const FsmTransition<Event> (&rows)[ROWS]) {
+  for (size_t i = 0; i < ROWS; i++) {
+    if (rows[i].from == 0 || (rows[i].from >> STATES) != 0 || rows[i].to >= STATES) return false;
+  }
+  return true;
+}
+
+// Rows grouped by (state, event), in table order: dispatch() visits only the rows
+// that can fire, and an event with no row in the current state costs one compare.
+template <size_t STATES, size_t EVENTS, size_t ROWS>
+struct FsmRowIndex {
+  uint8_t begin[STATES * EVENTS + 1];  // rows of slot (state * EVENTS + event): row[begin[slot]..begin[slot + 1])
+  uint8_t row[STATES * ROWS];
+};
+
+template <typename Event, size_t ROWS>
+constexpr size_t fsmEventCount(const FsmTransition<Event> (&rows)[ROWS]) {
+  size_t count = 0;
+  for (size_t i = 0; i < ROWS; i++) {
+    if ((size_t)rows[i].event + 1 > count) count = (size_t)rows[i].event + 1;
+  }
+  return count;
+}
+
+template <size_t STATES, size_t EVENTS, typename Event, size_t ROWS>
+constexpr FsmRowIndex<STATES, EVENTS, ROWS> fsmBuildRowIndex(const FsmTransition<Event> (&rows)[ROWS]) {
+  FsmRowIndex<STATES, EVENTS, ROWS> index{};
+  size_t n = 0;
+  for (size_t slot = 0; slot < STATES * EVENTS; slot++) {
+    index.begin[slot] = (uint8_t)n;
+    for (size_t i = 0; i < ROWS; i++) {
+      if ((rows[i].from >> (slot / EVENTS)) & 1 && (size_t)rows[i].event == slot % EVENTS) index.row[n++] = (uint8_t)i;
+    }
+  }
+  index.begin[STATES * EVENTS] = (uint8_t)n;
+  return index;
+}
+
+template <typename State, typename Event, const auto &STATE_TABLE, const auto &TRANSITION_TABLE, size_t TRACE>
+class Fsm {
+ public:
+  static constexpr size_t STATES = sizeof(STATE_TABLE) / sizeof(STATE_TABLE[0]);
+  static constexpr size_t ROWS = sizeof(TRANSITION_TABLE) / sizeof(TRANSITION_TABLE[0]);
+
+  static constexpr size_t EVENTS = fsmEventCount(TRANSITION_TABLE);
+
+  static_assert(STATES > 0 && STATES <= 32, "state masks are 32 bits");
+  static_assert(STATES * ROWS < 256, "row index entries are 8 bits");
+  static_assert(TRACE > 0, "the trace needs at least one entry");
+  static_assert(fsmStatesInOrder(STATE_TABLE), "the state table must list every state in enum order");
+  static_assert(fsmTransitionsValid<STATES>(TRANSITION_TABLE), "transition with no source or an invalid target");
+
+  Fsm() : state_(0), enteredMs_(0), cause_(""), traceCount_(0) {}
+
+  // Enter `initial` (running its entry action) and clear the trace.
+  void start(State initial, unsigned long nowMs) {
+    traceCount_ = 0;
+    state_ = static_cast<uint8_t>(initial);
+    enteredMs_ = nowMs;
+    cause_ = "start";
+    run(STATE_TABLE[state_].entry, nowMs);
+  }
+
+  // Take the first enabled transition for `event`. Returns true if the state changed.
+  bool dispatch(Event event, unsigned long nowMs) {
+    if ((size_t)event >= EVENTS) return false;
+    const size_t slot = state_ * EVENTS + (size_t)event;
+    for (size_t k = INDEX.begin[slot]; k < INDEX.begin[slot + 1]; k++) {
+      const FsmTransition<Event> &row = TRANSITION_TABLE[INDEX.row[k]];
+      if (row.guard != nullptr && !row.guard(nowMs)) continue;
+      return transition(static_cast<State>(row.to), row.cause, nowMs);
+    }
+    return false;
+  }
+
+  // Run the current state's `during` action.
+  void tick(unsigned long nowMs) { run(STATE_TABLE[state_].during, nowMs); }
+
+  State state() const { return static_cast<State>(state_); }
+  const char *stateName(State s) const { return (size_t)s < STATES ? STATE_TABLE[s].name : "UNKNOWN"; }
+  unsigned long enteredMs() const { return enteredMs_; }
+
+  // Cause of the transition into the current state (readable from entry actions).
+  const char *cause() const { return cause_; }
+
+  // Recorded transitions, at most TRACE; index 0 is the oldest kept.
+  size_t traceSize() const { return traceCount_ < TRACE ? (size_t)traceCount_ : TRACE; }
+  const FsmTraceEntry &traceAt(size_t index) const {
+    const uint32_t first = (traceCount_ > TRACE) ? traceCount_ - TRACE : 0;
+    return trace_[(first + index) % TRACE];
+  }
+  // Transitions since start(), including those no longer in the ring.
+  uint32_t transitionCount() const { return traceCount_; }
+
+ private:
+  static constexpr FsmRowIndex<STATES, EVENTS, ROWS> INDEX = fsmBuildRowIndex<STATES, EVENTS>(TRANSITION_TABLE);
+
+  static void run(FsmAction action, unsigned long nowMs) {
+    if (action != nullptr) action(nowMs);
+  }
+
+  bool transition(State to, const char *cause, unsigned long nowMs) {
+    const uint8_t next = static_cast<uint8_t>(to);
+    if (next == state_) return false;
+    run(STATE_TABLE[state_].exit, nowMs);
+
+    FsmTraceEntry &entry = trace_[traceCount_ % TRACE];
+    entry.timestampMs = (uint32_t)nowMs;
+    entry.from = state_;
+    entry.to = next;
+    entry.cause = cause;
+    traceCount_++;
+
+    state_ = next;
+    enteredMs_ = nowMs;
+    cause_ = cause;
+    run(STATE_TABLE[state_].entry, nowMs);
+    return true;
+  }
+
+  uint8_t state_;
+  unsigned long enteredMs_;
+  const char *cause_;
+  uint32_t traceCount_;
+  FsmTraceEntry trace_[TRACE];
+};
+
+#endif // FSM_H
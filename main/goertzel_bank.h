@@ -0,0 +1,134 @@
+#ifndef GOERTZEL_BANK_H
+#define GOERTZEL_BANK_H
+
+#include <stdint.h>
+#include "const_math.h"
+#include "fixed_point.h"
+
+/**
+ * Block Goertzel filter bank: spectral power of DFT bins FIRST_BIN..LAST_BIN over
+ * consecutive, non-overlapping blocks of BLOCK samples (bin k = k * SAMPLE_RATE / BLOCK Hz).
+ *
+ * Samples stream in one at a time, so the cost is spread evenly over the block:
+ * per sample, one window multiply plus one multiply-add per bin; once per block,
+ * three multiplies per bin to read out the powers. No division, no floating point
+ * at runtime (the coefficients and the Hann window are constexpr tables, in flash).
+ *
+ * For a few bands at a 1kHz sample rate this is cheaper than a radix-2 FFT of the
+ * same block (BINS vs log2(BLOCK) * 2 complex multiplies per sample) and it needs
+ * no sample buffer.
+ *
+ * Input is the AC signal (sample minus DC baseline, |x| <= 32767).
+ */
+
+// The bank's constant tables: 2 cos(w) per bin in Q(FRAC_BITS) (range [-2, 2]) and
+// the Hann window.
+template <uint16_t BLOCK, uint16_t FIRST_BIN, uint16_t BINS, int FRAC_BITS>
+struct GoertzelTables {
+  int32_t coef[BINS];
+  q15_t window[BLOCK];
+};
+
+template <uint16_t BLOCK, uint16_t FIRST_BIN, uint16_t BINS, int FRAC_BITS>
+constexpr GoertzelTables<BLOCK, FIRST_BIN, BINS, FRAC_BITS> makeGoertzelTables() {
+  GoertzelTables<BLOCK, FIRST_BIN, BINS, FRAC_BITS> t = {};
+  for (uint16_t i = 0; i < BINS; i++) {
+    t.coef[i] = (int32_t)constRound(2.0 * constCos(2.0 * CONST_MATH_PI * (FIRST_BIN + i) / BLOCK) * (1 << FRAC_BITS));
+  }
+  for (uint16_t n = 0; n < BLOCK; n++) {
+    t.window[n] = q15(0.5 - 0.5 * constCos(2.0 * CONST_MATH_PI * n / BLOCK));
+  }
+  return t;
+}
+
+template <uint16_t BLOCK, uint16_t FIRST_BIN, uint16_t LAST_BIN>
+class GoertzelBank {
+  static_assert(BLOCK >= 8 && BLOCK <= 1024 && (BLOCK & (BLOCK - 1)) == 0,
+                "block length must be a power of two in [8, 1024]");
+  static_assert(FIRST_BIN <= LAST_BIN && LAST_BIN <= BLOCK / 2, "bins must lie in [0, BLOCK / 2]");
+
+ public:
+  static const uint16_t BINS = LAST_BIN - FIRST_BIN + 1;
+
+  GoertzelBank() { reset(); }
+
+  // Discard the block in progress and the last results.
+  void reset() {
+    for (uint16_t i = 0; i < BINS; i++) {
+      s1_[i] = s2_[i] = 0;
+      power_[i] = 0;
+    }
+    index_ = 0;
+    blocks_ = 0;
+  }
+
+  // Add one sample. Returns true when it completed a block (new powers are available).
+  bool push(int32_t x) {
+    const int32_t xw = scaleQ15(x, TABLES.window[index_]);
+    for (uint16_t i = 0; i < BINS; i++) {
+      const int32_t s = xw + (int32_t)(((int64_t)TABLES.coef[i] * s1_[i]) >> COEF_FRAC_BITS) - s2_[i];
+      s2_[i] = s1_[i];
+      s1_[i] = s;
+    }
+    if (++index_ < BLOCK) return false;
+
+    for (uint16_t i = 0; i < BINS; i++) {
+      const int64_t s1 = s1_[i];
+      const int64_t s2 = s2_[i];
+      // |X[k]|^2 = s1^2 + s2^2 - 2cos(w) s1 s2
+      const int64_t p = s1 * s1 + s2 * s2 - ((TABLES.coef[i] * s1) >> COEF_FRAC_BITS) * s2;
+      power_[i] = (p > 0) ? (uint64_t)p : 0;
+      s1_[i] = s2_[i] = 0;
+    }
+    index_ = 0;
+    blocks_++;
+    return true;
+  }
+
+  // |X[k]|^2 of the last completed block (0 before the first one).
+  uint64_t binPower(uint16_t bin) const {
+    return (bin >= FIRST_BIN && bin <= LAST_BIN) ? power_[bin - FIRST_BIN] : 0;
+  }
+
+  /**
+   * Level of bins first..last in the last completed block, in input counts: the peak
+   * amplitude of a sine with the same power. Undoes the Hann window's coherent gain
+   * (1/2) and its spreading of one tone over neighbouring bins (ENBW = 1.5 bins).
+   * Meant to be called once per completed block, not per sample.
+   */
+  uint16_t bandLevel(uint16_t first, uint16_t last) const {
+    uint64_t sum = 0;
+    for (uint32_t bin = first; bin <= last; bin++) sum += binPower((uint16_t)bin);
+    // A = 4 * sqrt(P / 1.5) / BLOCK  ->  A^2 = P * 32/3 / BLOCK^2, with 32/3 ~ 10923 / 2^10.
+    // Multiply first while it cannot overflow, so quiet bands keep their resolution.
+    const uint64_t ampSq = (sum < (1ULL << 49))
+        ? (sum * 10923) >> (10 + 2 * BLOCK_BITS)
+        : ((sum >> (2 * BLOCK_BITS)) * 10923) >> 10;
+    return isqrt32(ampSq > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)ampSq);
+  }
+
+  // Samples accumulated in the current block.
+  uint16_t fill() const { return index_; }
+
+  // Completed blocks since reset().
+  uint32_t blocks() const { return blocks_; }
+
+  static uint16_t length() { return BLOCK; }
+
+ private:
+  static const int COEF_FRAC_BITS = 14;
+
+  static constexpr int log2Of(uint16_t n) { return (n <= 1) ? 0 : 1 + log2Of(n / 2); }
+  static const int BLOCK_BITS = log2Of(BLOCK);
+
+  static constexpr GoertzelTables<BLOCK, FIRST_BIN, BINS, COEF_FRAC_BITS> TABLES =
+      makeGoertzelTables<BLOCK, FIRST_BIN, BINS, COEF_FRAC_BITS>();
+
+  int32_t s1_[BINS];
+  int32_t s2_[BINS];
+  uint64_t power_[BINS];
+  uint16_t index_;
+  uint32_t blocks_;
+};
+
+#endif // GOERTZEL_BANK_H
@@ -0,0 +1,150 @@
+#include "loop_profiler.h"
+#include "sample_jitter.h"
+#include "scheduler.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+static StageStats stats[LOOP_STAGE_COUNT];
+
+static const char *const STAGE_NAMES[LOOP_STAGE_COUNT] = {
+  "watchdog", "serial_commands", "status_print", "process_audio",
+  "supervisor_tick", "telemetry_flush", "loop_total"
+};
+
+// Report in progress: one line at a time, written as the UART makes room.
+static const int REPORT_DONE = -1;
+static int reportLine = REPORT_DONE;  // 0 = header, two lines per stage, two for sampling, one per task, extension
+static char lineBuf[200];
+static size_t lineLen = 0;
+static size_t lineSent = 0;
+static ReportLineFormatter reportExtension = nullptr;
+
+void initLoopProfiler() {
+  cycleCounterInit();
+  loopProfilerReset();
+}
+
+void loopProfilerReset() {
+  for (int s = 0; s < LOOP_STAGE_COUNT; s++) {
+    StageStats &st = stats[s];
+    st.count = 0;
+    st.minCycles = 0xFFFFFFFFUL;
+    st.maxCycles = 0;
+    st.totalCycles = 0;
+    for (int b = 0; b < LOOP_PROFILER_BUCKETS; b++) st.histogram[b] = 0;
+  }
+  reportLine = REPORT_DONE;
+  lineLen = lineSent = 0;
+}
+
+int loopProfilerBucket(uint32_t cycles) {
+  return cycleHistogramBucket(cycles, LOOP_PROFILER_BUCKETS);
+}
+
+void loopProfilerRecord(LoopStage stage, uint32_t cycles) {
+  StageStats &st = stats[stage];
+  st.count++;
+  if (cycles < st.minCycles) st.minCycles = cycles;
+  if (cycles > st.maxCycles) st.maxCycles = cycles;
+  st.totalCycles += cycles;
+  st.histogram[loopProfilerBucket(cycles)]++;
+}
+
+const StageStats &getStageStats(LoopStage stage) {
+  return stats[stage];
+}
+
+const char *getLoopStageName(LoopStage stage) {
+  return (stage >= 0 && stage < LOOP_STAGE_COUNT) ? STAGE_NAMES[stage] : "?";
+}
+
+uint32_t getStageMeanCycles(LoopStage stage) {
+  const StageStats &st = stats[stage];
+  return st.count ? (uint32_t)(st.totalCycles / st.count) : 0;
+}
+
+// Format report line `line` into lineBuf. Returns false past the last line.
+static bool formatReportLine(int line) {
+  int n;
+  if (line == 0) {
+    n = snprintf(lineBuf, sizeof(lineBuf), "prof: cycles at %lu MHz, profiler %s; hist k = [2^(k-1), 2^k) cycles\n",
+                 (unsigned long)(CYCLE_COUNTER_HZ / 1000000UL), ENABLE_LOOP_PROFILER ? "on" : "compiled out");
+  } else if (line <= 2 * LOOP_STAGE_COUNT) {
+    const LoopStage stage = (LoopStage)((line - 1) / 2);
+    const StageStats &st = stats[stage];
+    if ((line - 1) % 2 == 0) {
+      if (st.count == 0) {
+        n = snprintf(lineBuf, sizeof(lineBuf), "prof %s n=0\n", STAGE_NAMES[stage]);
+      } else {
+        n = snprintf(lineBuf, sizeof(lineBuf), "prof %s n=%lu min=%lu mean=%lu max=%lu (max %lu us)\n",
+                     STAGE_NAMES[stage], (unsigned long)st.count, (unsigned long)st.minCycles,
+                     (unsigned long)getStageMeanCycles(stage), (unsigned long)st.maxCycles,
+                     (unsigned long)cyclesToMicros(st.maxCycles));
+      }
+    } else {
+      n = snprintf(lineBuf, sizeof(lineBuf), "prof %s hist", STAGE_NAMES[stage]);
+      for (int b = 0; b < LOOP_PROFILER_BUCKETS && n < (int)sizeof(lineBuf) - 16; b++) {
+        if (st.histogram[b] == 0) continue;
+        n += snprintf(lineBuf + n, sizeof(lineBuf) - n, " %d:%lu", b, (unsigned long)st.histogram[b]);
+      }
+      n += snprintf(lineBuf + n, sizeof(lineBuf) - n, "\n");
+    }
+  } else if (line == 2 * LOOP_STAGE_COUNT + 1) {
+    const SampleJitterStats &js = getSampleJitterStats();
+    n = snprintf(lineBuf, sizeof(lineBuf),
+                 "prof sample_period n=%lu min=%lu mean=%lu max=%lu nominal=%lu jitter_max=%lu (%lu us) over_limit=%lu\n",
+                 (unsigned long)js.periods, (unsigned long)(js.periods ? js.minPeriodCycles : 0),
+                 (unsigned long)getSampleMeanPeriodCycles(), (unsigned long)js.maxPeriodCycles,
+                 (unsigned long)SAMPLE_PERIOD_CYCLES, (unsigned long)js.worstJitterCycles,
+                 (unsigned long)getSampleJitterWorstMicros(), (unsigned long)js.overLimit);
+  } else if (line == 2 * LOOP_STAGE_COUNT + 2) {
+    const SampleJitterStats &js = getSampleJitterStats();
+    n = snprintf(lineBuf, sizeof(lineBuf), "prof sample_jitter hist");
+    for (int b = 0; b < SAMPLE_JITTER_BUCKETS && n < (int)sizeof(lineBuf) - 16; b++) {
+      if (js.histogram[b] == 0) continue;
+      n += snprintf(lineBuf + n, sizeof(lineBuf) - n, " %d:%lu", b, (unsigned long)js.histogram[b]);
+    }
+    n += snprintf(lineBuf + n, sizeof(lineBuf) - n, "\n");
+  } else if (line <= 2 * LOOP_STAGE_COUNT + 2 + TASK_COUNT) {
+    const TaskId task = (TaskId)(line - 2 * LOOP_STAGE_COUNT - 3);
+    const TaskStats &ts = getTaskStats(task);
+    n = snprintf(lineBuf, sizeof(lineBuf), "prof task %s period=%lu ms runs=%lu misses=%lu worst_response=%lu us\n",
+                 getTaskName(task), (unsigned long)getTaskPeriodMs(task), (unsigned long)ts.runs,
+                 (unsigned long)ts.misses, (unsigned long)ts.worstResponseUs);
+  } else if (reportExtension != nullptr) {
+    n = reportExtension(line - 2 * LOOP_STAGE_COUNT - 3 - TASK_COUNT, lineBuf, sizeof(lineBuf));
+    if (n < 0) return false;
+  } else {
+    return false;
+  }
+  lineLen = (n < (int)sizeof(lineBuf)) ? (size_t)n : sizeof(lineBuf) - 1;
+  lineSent = 0;
+  return true;
+}
+
+void loopProfilerSetReportExtension(ReportLineFormatter fn) {
+  reportExtension = fn;
+}
+
+void loopProfilerRequestReport() {
+  reportLine = 0;
+  formatReportLine(reportLine);
+}
+
+bool loopProfilerReportPending() {
+  return reportLine != REPORT_DONE;
+}
+
+bool loopProfilerServiceReport() {
+  while (reportLine != REPORT_DONE) {
+    const int room = Serial.availableForWrite();
+    if (room <= 0) return true;
+    size_t chunk = lineLen - lineSent;
+    if (chunk > (size_t)room) chunk = (size_t)room;
+    Serial.write(reinterpret_cast<const uint8_t *>(lineBuf) + lineSent, chunk);
+    lineSent += chunk;
+    if (lineSent < lineLen) return true;
+    if (!formatReportLine(++reportLine)) reportLine = REPORT_DONE;
+  }
+  return false;
+}
@@ -0,0 +1,101 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "cycle_counter.h"
+
+/**
+ * Per-stage timing of loop(): count, min / max / mean and a log2 histogram of the
+ * CPU cycles each stage took, so rare latency spikes show up next to the typical case.
+ *
+ * Stages are timed with PROFILE_STAGE(stage) at the top of a scope; the probe records
+ * when the scope ends. With ENABLE_LOOP_PROFILER 0 the macro expands to nothing.
+ *
+ * Histogram bucket k counts durations with k significant bits, i.e. in
+ * [2^(k-1), 2^k) cycles (bucket 0: zero cycles); the last bucket also takes
+ * everything longer.
+ *
+ * The report (serial command 'p') is written a piece at a time from loop(), only as
+ * fast as the UART accepts it, so asking for it does not itself cause a spike.
+ */
+
+enum LoopStage {
+  STAGE_WATCHDOG = 0,
+  STAGE_SERIAL_COMMANDS,
+  STAGE_STATUS_PRINT,
+  STAGE_PROCESS_AUDIO,
+  STAGE_SUPERVISOR_TICK,
+  STAGE_TELEMETRY_FLUSH,
+  STAGE_LOOP_TOTAL,   // one pass over the due tasks (the sleep after it is not counted)
+  LOOP_STAGE_COUNT
+};
+
+static const int LOOP_PROFILER_BUCKETS = 24;  // up to 2^23 cycles = 175ms at 48MHz
+
+struct StageStats {
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+  uint32_t histogram[LOOP_PROFILER_BUCKETS];
+};
+
+// Start the cycle counter and clear all statistics.
+void initLoopProfiler();
+
+// Clear all statistics (and cancel a report in progress).
+void loopProfilerReset();
+
+// Add one measurement.
+void loopProfilerRecord(LoopStage stage, uint32_t cycles);
+
+const StageStats &getStageStats(LoopStage stage);
+const char *getLoopStageName(LoopStage stage);
+
+// Mean cycles per call (0 before the first call).
+uint32_t getStageMeanCycles(LoopStage stage);
+
+// Histogram bucket a duration falls into.
+int loopProfilerBucket(uint32_t cycles);
+
+// Start writing the statistics, the sampling jitter (sample_jitter.h) and the task
+// deadline counters (scheduler.h) to Serial.
+void loopProfilerRequestReport();
+
+// A requested report has not been completely written yet.
+bool loopProfilerReportPending();
+
+// Continue a pending report without blocking; call every loop(). Returns true while
+// there is more to write.
+bool loopProfilerServiceReport();
+
+// Extra report lines after the task lines (the supervisor's transition trace):
+// fn(index, buf, size) writes line `index`, newline included, and returns its length,
+// or -1 past the last line. nullptr = none.
+typedef int (*ReportLineFormatter)(int index, char *buf, size_t size);
+void loopProfilerSetReportExtension(ReportLineFormatter fn);
+
+// Times the enclosing scope.
+class ScopedStageTimer {
+ public:
+  explicit ScopedStageTimer(LoopStage stage) : stage_(stage), start_(cycleCounterNow()) {}
+  ~ScopedStageTimer() { loopProfilerRecord(stage_, cycleCounterNow() - start_); }
+
+ private:
+  LoopStage stage_;
+  uint32_t start_;
+};
+
+#if ENABLE_LOOP_PROFILER
+#define PROFILE_STAGE_CONCAT2(a, b) a##b
+#define PROFILE_STAGE_CONCAT(a, b) PROFILE_STAGE_CONCAT2(a, b)
+#define PROFILE_STAGE(stage) ScopedStageTimer PROFILE_STAGE_CONCAT(stageTimer_, __LINE__)(stage)
+#else
+#define PROFILE_STAGE(stage) \
+  do {                       \
+  } while (0)
+#endif
+
+#endif // LOOP_PROFILER_H
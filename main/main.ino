@@ -12,9 +12,95 @@
 #include "watchdog_utils.h"
 #include "tests_on_device.h"
 #include "system_supervisor.h"
+#include "sample_ring.h"
+#include "telemetry.h"
+#include "loop_profiler.h"
+#include "sample_jitter.h"
+#include "scheduler.h"
+#include "runtime_config.h"
+#include "speed_control.h"
+
+// --- Tasks (scheduler.h); loop() runs whichever are due, then sleeps ---
+
+// Process every sample the ISR has queued (signaled by the sampling interrupt)
+static void audioTask() {
+  PROFILE_STAGE(STAGE_PROCESS_AUDIO);
+  processAudio();
+}
+
+// Run the system FSM (decides IDLE/ACTIVE/FAULT/SHUTDOWN and motor PWM)
+static void supervisorTask() {
+  PROFILE_STAGE(STAGE_SUPERVISOR_TICK);
+  systemSupervisorTick(millis(), getAudioSampleCount(), getSmoothedAmplitude());
+}
+
+// User commands, then Serial output, never blocking. A profiler report ('p'), a
+// config reply ('$') or a FAULT line has the port to itself until it is written,
+// starting between two telemetry frames; telemetry keeps queueing meanwhile.
+static void serialTask() {
+  {
+    PROFILE_STAGE(STAGE_SERIAL_COMMANDS);
+    systemSupervisorHandleSerial(millis());
+  }
+  {
+    PROFILE_STAGE(STAGE_TELEMETRY_FLUSH);
+    if (loopProfilerReportPending()) {
+      if (telemetryFinishFrame()) loopProfilerServiceReport();
+    } else if (runtimeConfigReplyPending()) {
+      if (telemetryFinishFrame()) runtimeConfigServiceReply();
+    } else if (systemSupervisorTextPending()) {
+      if (telemetryFinishFrame()) systemSupervisorServiceText();
+    } else {
+      telemetryFlush();
+    }
+  }
+}
+
+// Periodic status: a telemetry record, or the text debug lines
+static void statusTask() {
+  PROFILE_STAGE(STAGE_STATUS_PRINT);
+  systemSupervisorReport(millis());
+
+#if !ENABLE_BINARY_TELEMETRY
+  // Debug: verify the sampling callback is firing (prints once per second)
+  static unsigned long lastSampleCount = 0;
+  static unsigned long lastTimerDebug = 0;
+  if (millis() - lastTimerDebug >= 1000) {
+    unsigned long nowCount = getAudioSampleCount();
+    Serial.print("Samples/sec: ");
+    Serial.print(nowCount - lastSampleCount);
+    Serial.print(" ring_hwm=");
+    Serial.print(getSampleRingHighWaterMark());
+    Serial.print(" ring_overruns=");
+    Serial.print(getSampleRingOverrunCount());
+    Serial.print(" jitter_max_us=");
+    Serial.print(getSampleJitterWorstMicros());
+    Serial.print(" bass=");
+    Serial.print(getBandLevel(AUDIO_BAND_BASS));
+    Serial.print(" mid=");
+    Serial.print(getBandLevel(AUDIO_BAND_MID));
+    Serial.print(" treble=");
+    Serial.println(getBandLevel(AUDIO_BAND_TREBLE));
+    lastSampleCount = nowCount;
+    lastTimerDebug = millis();
+  }
+#endif
+}
+
+static void initTasks() {
+  initScheduler();
+  schedulerAddEvent(TASK_AUDIO, "audio", audioTask, AUDIO_TASK_DEADLINE_MS);
+  schedulerAddPeriodic(TASK_SUPERVISOR, "supervisor", supervisorTask, MOTOR_UPDATE_INTERVAL);
+  schedulerAddPeriodic(TASK_SERIAL, "serial", serialTask, SERIAL_POLL_INTERVAL_MS);
+#if ENABLE_BINARY_TELEMETRY
+  schedulerAddPeriodic(TASK_STATUS, "status", statusTask, TELEMETRY_INTERVAL_MS);
+#else
+  schedulerAddPeriodic(TASK_STATUS, "status", statusTask, DEBUG_INTERVAL);
+#endif
+}
 
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(SERIAL_BAUD);
 
 #if ENABLE_ON_DEVICE_TESTS
   // Run unit tests at boot, then idle.
@@ -26,45 +112,47 @@ void setup() {
 #endif
   
   // Initialize all subsystems
+  initRuntimeConfig();
   initAudioProcessor();
   initMotorController();
   initAudioTimer();
+#if ENABLE_SPEED_CONTROL
+  initSpeedControl();  // after the sampling timer, which gets the first free channel
+#endif
   initWatchdog();
+  initTelemetry();
+  initLoopProfiler();
   initSystemSupervisor();
+  initTasks();
   
   Serial.println("=== Real-Time Audio Wave Visualization ===");
   Serial.println("System initialized. Processing audio in real-time...");
   Serial.print("Sampling rate: ");
   Serial.print(SAMPLE_RATE);
   Serial.println(" Hz");
-  Serial.println("Commands: 's' shutdown, 'w' wake, 'r' reset from fault");
+  if (runtimeConfigLoadResult() == RUNTIME_CONFIG_OK) {
+    Serial.println("Config: loaded from storage");
+  } else {
+    Serial.print("Config: defaults (");
+    Serial.print(runtimeConfigResultText(runtimeConfigLoadResult()));
+    Serial.println(")");
+  }
+  Serial.println("Commands: 's' shutdown, 'w' wake, 'r' reset from fault, 'p' loop timing, 'c' raw capture, '$list' config");
 }
 
 void loop() {
-  // Feed watchdog timer to prevent system reset
-  resetWatchdog();
+  {
+    PROFILE_STAGE(STAGE_LOOP_TOTAL);
 
-  // Handle user commands (non-blocking)
-  systemSupervisorHandleSerial(millis());
-  
-  // Debug: verify the sampling callback is firing (prints once per second)
-  static unsigned long lastSampleCount = 0;
-  static unsigned long lastTimerDebug = 0;
-  if (millis() - lastTimerDebug >= 1000) {
-    unsigned long nowCount = getAudioSampleCount();
-    Serial.print("Samples/sec: ");
-    Serial.println(nowCount - lastSampleCount);
-    lastSampleCount = nowCount;
-    lastTimerDebug = millis();
-  }
+    // Feed watchdog timer to prevent system reset
+    {
+      PROFILE_STAGE(STAGE_WATCHDOG);
+      resetWatchdog();
+    }
 
-  // Process audio if new sample is available
-  if (isNewSampleReady()) {
-    processAudio();
-    clearSampleReadyFlag();
+    schedulerRunReady();
   }
 
-  // Run the system FSM (decides IDLE/ACTIVE/FAULT/SHUTDOWN and motor PWM)
-  const unsigned long nowMs = millis();
-  systemSupervisorTick(nowMs, getAudioSampleCount(), getSmoothedAmplitude());
-}
\ No newline at end of file
+  // Nothing due: sleep until the next interrupt (a sample or block, or the 1ms tick).
+  schedulerSleep();
+}
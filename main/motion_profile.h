@@ -0,0 +1,237 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Jerk-limited (S-curve) PWM trajectories in fixed point, one step per motor update.
+ *
+ * Position, velocity and acceleration are Q8 PWM, PWM/tick and PWM/tick^2 (one tick
+ * = one motor update). Each step the acceleration moves by at most the jerk limit,
+ * so the motor never sees a step change in acceleration; velocity and acceleration
+ * stay within their limits. A step takes the highest acceleration from which the
+ * motion can still stop on the target and ramp out below the velocity limit, so it
+ * does not overshoot. Accelerating and cruising cost one stop-distance check, braking
+ * a bitwise search over the jerk step (no loops over the distance); a parked motor
+ * returns at once.
+ *
+ * Below floorPwm the motor stalls, so a start jumps straight to the floor (after an
+ * optional kick pulse of kickPwm for kickTicks updates that breaks static friction)
+ * and a stop ramps down to the floor and then cuts the output.
+ */
+
+#define MOTION_Q 8
+#define MOTION_ONE (1L << MOTION_Q)
+// Ticks from zero to full acceleration (acceleration / jerk); shorter ramps are too
+// coarse to shape at the update rate.
+#define MOTION_MIN_RAMP_TICKS 4
+#define MOTION_MAX_RAMP_TICKS 50
+
+/**
+ * A motion profile in physical units (PWM counts per second, per second^2, per
+ * second^3); makeMotionLimits() converts it for a given update interval.
+ */
+struct MotionProfileSpec {
+  const char *name;
+  uint32_t maxVelocity;  // PWM/s
+  uint32_t maxAccel;     // PWM/s^2
+  uint32_t maxJerk;      // PWM/s^3
+  uint8_t floorPwm;      // lowest PWM that keeps the motor turning (0: none)
+  uint8_t kickPwm;       // start pulse (0 or kickMs 0: no kick)
+  uint16_t kickMs;
+};
+
+/** The same limits per update tick, Q8. */
+struct MotionLimits {
+  int32_t maxVelocity;
+  int32_t maxAccel;
+  int32_t maxJerk;
+  int32_t accelSaturation;  // velocity gained while full acceleration ramps out: A^2 / 2J
+  uint8_t floorPwm;
+  uint8_t kickPwm;
+  uint8_t kickTicks;
+};
+
+/** Trajectory state of one motor (all Q8). */
+struct MotionState {
+  int32_t pos;
+  int32_t vel;
+  int32_t acc;
+};
+
+constexpr int32_t motionPerTick(uint32_t perSecond, uint32_t tickMs, int power) {
+  // perSecond * 256 * (tickMs / 1000)^power, rounded, at least 1
+  uint64_t num = (uint64_t)perSecond * MOTION_ONE;
+  uint64_t den = 1;
+  for (int i = 0; i < power; i++) {
+    num *= tickMs;
+    den *= 1000;
+  }
+  const uint64_t q = (num + den / 2) / den;
+  return q < 1 ? 1 : (int32_t)q;
+}
+
+constexpr MotionLimits makeMotionLimits(const MotionProfileSpec &spec, uint32_t tickMs) {
+  MotionLimits m = {};
+  m.maxVelocity = motionPerTick(spec.maxVelocity, tickMs, 1);
+  m.maxAccel = motionPerTick(spec.maxAccel, tickMs, 2);
+  m.maxJerk = motionPerTick(spec.maxJerk, tickMs, 3);
+  m.accelSaturation = (int32_t)((int64_t)m.maxAccel * m.maxAccel / (2 * m.maxJerk));
+  m.floorPwm = spec.floorPwm;
+  m.kickPwm = spec.kickPwm;
+  m.kickTicks = (uint8_t)(spec.kickPwm ? (spec.kickMs + tickMs - 1) / tickMs : 0);
+  return m;
+}
+
+// The limits fit the fixed-point ranges: velocity and acceleration at most 255 PWM per
+// tick, the jerk ramp MOTION_MIN_RAMP_TICKS to MOTION_MAX_RAMP_TICKS, the kick under 256
+// ticks. motionStep() keeps every such profile within its limits and on the target.
+constexpr bool motionProfileValid(const MotionProfileSpec &spec, uint32_t tickMs) {
+  if (spec.maxVelocity == 0 || spec.maxAccel == 0 || spec.maxJerk == 0 || tickMs == 0) return false;
+  const MotionLimits m = makeMotionLimits(spec, tickMs);
+  if (m.maxVelocity > 255 * MOTION_ONE || m.maxAccel > 255 * MOTION_ONE) return false;
+  if (m.maxAccel > (int64_t)m.maxJerk * MOTION_MAX_RAMP_TICKS) return false;
+  if (m.maxAccel < (int64_t)m.maxJerk * MOTION_MIN_RAMP_TICKS) return false;
+  return (spec.kickMs + tickMs - 1) / tickMs < 256;
+}
+
+template <size_t N>
+constexpr bool motionProfilesValid(const MotionProfileSpec (&specs)[N], uint32_t tickMs) {
+  for (size_t i = 0; i < N; i++) {
+    if (!motionProfileValid(specs[i], tickMs)) return false;
+  }
+  return true;
+}
+
+// One MotionLimits per spec, in the same order.
+template <size_t N>
+struct MotionLimitsSet {
+  MotionLimits limits[N];
+};
+
+template <size_t N>
+constexpr MotionLimitsSet<N> makeMotionLimitsSet(const MotionProfileSpec (&specs)[N], uint32_t tickMs) {
+  MotionLimitsSet<N> set = {};
+  for (size_t i = 0; i < N; i++) set.limits[i] = makeMotionLimits(specs[i], tickMs);
+  return set;
+}
+
+// floor(sqrt(x)), 16 fixed iterations.
+inline uint32_t motionIsqrt(uint32_t x) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  for (int i = 0; i < 16; i++) {
+    const uint32_t trial = root + bit;
+    root >>= 1;
+    if (x >= trial) {
+      x -= trial;
+      root += bit;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Distance to stop from velocity v >= 0 at zero acceleration, rounded up:
+// v^2/2A + vA/2J once full deceleration is reached (v >= A^2/J), v*sqrt(v/J) before.
+inline int64_t motionBrakeDistance(const MotionLimits &m, int64_t v) {
+  if (v <= 0) return 0;
+  const int64_t a = m.maxAccel;
+  const int64_t j = m.maxJerk;
+  if (v * j >= a * a) return (v * v * j + v * a * a + 2 * a * j - 1) / (2 * a * j);
+  // v / j < (A/J)^2 <= MOTION_MAX_RAMP_TICKS^2 here, so the Q16 ratio fits 32 bits.
+  return (v * (motionIsqrt((uint32_t)((v << 16) / j)) + 1) + MOTION_ONE - 1) >> MOTION_Q;
+}
+
+// Distance covered while stopping from velocity v (towards the target) and
+// acceleration a: a forward acceleration is ramped out first; a braking one is
+// treated as part of the braking from the velocity where it began to ramp in.
+inline int64_t motionStopDistance(const MotionLimits &m, int64_t v, int64_t a) {
+  const int64_t j = m.maxJerk;
+  if (a >= 0) {
+    const int64_t ramp = (v * a + (a * a * a + 3 * j - 1) / (3 * j)) / j;
+    return ramp + motionBrakeDistance(m, v + a * a / (2 * j));
+  }
+  const int64_t start = v + (a * a + 2 * j - 1) / (2 * j);
+  if (v <= 0 || start <= 0) return 0;
+  const int64_t covered = (-start * a + a * a * a / (6 * j)) / j;
+  const int64_t left = motionBrakeDistance(m, start) - covered;
+  return left > 0 ? left : 0;
+}
+
+// Whether acceleration a this tick (towards the target, from velocity vel) still
+// stops within `distance`.
+inline bool motionStopsWithin(const MotionLimits &m, int32_t vel, int32_t a, int32_t distance) {
+  const int64_t v = (int64_t)vel + a;
+  return v + motionStopDistance(m, v, a) <= distance;
+}
+
+/**
+ * One update towards `target` (Q8 PWM): the highest acceleration, within one jerk
+ * step of the last, from which the motion can still stop on the target and ramp
+ * out below the velocity limit. Settles exactly on the target once within a PWM
+ * count and nearly at rest.
+ */
+inline void motionStep(MotionState &s, int32_t target, const MotionLimits &m) {
+  // Parked on the target: nothing to plan (the common case for a settled motor).
+  if (s.pos == target && s.vel == 0 && s.acc == 0) return;
+
+  const int32_t jerk = m.maxJerk;
+  const bool accSmall = s.acc <= jerk && s.acc >= -jerk;
+
+  // Plan with the target in the positive direction.
+  const int32_t dir = (target > s.pos || (target == s.pos && s.vel < 0)) ? 1 : -1;
+  const int32_t distance = (target - s.pos) * dir;
+  const int32_t vel = s.vel * dir;
+  const int32_t acc = s.acc * dir;
+
+  int32_t lo = acc - jerk > -m.maxAccel ? acc - jerk : -m.maxAccel;
+  int32_t hi = acc + jerk < m.maxAccel ? acc + jerk : m.maxAccel;
+
+  // Ramping a out adds a^2/2J - a/2 or so to the velocity: keep a^2/2J + a within the
+  // room left below the limit (one tick closes it when within one jerk step).
+  const int32_t room = m.maxVelocity - vel;
+  if (room < m.accelSaturation + m.maxAccel) {
+    int32_t cap = room;
+    if (room > jerk) {
+      // Below (A + J)^2, which can pass 32 bits for the steepest profiles.
+      const uint64_t x = (uint64_t)jerk * jerk + 2 * (uint64_t)jerk * (uint32_t)room;
+      const uint32_t root = x > 0xFFFFFFFFULL ? motionIsqrt((uint32_t)(x >> 2)) << 1
+                                              : motionIsqrt((uint32_t)x);
+      cap = (int32_t)root - jerk;
+    }
+    if (hi > cap) hi = cap > lo ? cap : lo;
+  }
+
+  // The highest acceleration in [lo, hi] that still stops in time; lo (the hardest
+  // braking allowed) when none does.
+  int32_t chosen = lo;
+  if (motionStopsWithin(m, vel, hi, distance)) {
+    chosen = hi;
+  } else if (motionStopsWithin(m, vel, lo, distance)) {
+    int32_t step = 1;
+    while (step < hi - lo) step <<= 1;
+    for (; step > 0; step >>= 1) {
+      if (chosen + step < hi && motionStopsWithin(m, vel, chosen + step, distance)) chosen += step;
+    }
+  }
+
+  s.acc = chosen * dir;
+  s.vel += s.acc;
+  if (s.vel > m.maxVelocity) s.vel = m.maxVelocity;
+  else if (s.vel < -m.maxVelocity) s.vel = -m.maxVelocity;
+  s.pos += s.vel;
+
+  // Within a PWM count, crawling and (before and after this step) barely accelerating:
+  // park on the target, still within one jerk step of the previous acceleration.
+  const int32_t left = target - s.pos;
+  if (left <= MOTION_ONE && left >= -MOTION_ONE && s.vel <= 2 * jerk && s.vel >= -2 * jerk &&
+      s.acc <= jerk && s.acc >= -jerk && accSmall) {
+    s.pos = target;
+    s.vel = 0;
+    s.acc = 0;
+  }
+}
+
+#endif // MOTION_PROFILE_H
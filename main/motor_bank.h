@@ -0,0 +1,219 @@
+#ifndef MOTOR_BANK_H
+#define MOTOR_BANK_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "motion_profile.h"
+#include "pwm_curve.h"
+
+/**
+ * Level a motor channel follows (see MotorBank::update()).
+ */
+enum MotorSource {
+  MOTOR_SOURCE_AMPLITUDE,  // broadband envelope (getSmoothedAmplitude())
+  MOTOR_SOURCE_BASS,       // band levels (getBandLevel())
+  MOTOR_SOURCE_MID,
+  MOTOR_SOURCE_TREBLE,
+  MOTOR_SOURCE_COUNT
+};
+
+/**
+ * One motor channel: its PWM pin, the level it follows, the response curve (an index
+ * into the bank's PwmCurve set) that maps that level to a target PWM, and the motion
+ * profile (an index into its MotionLimits set) the PWM follows towards that target.
+ */
+struct MotorChannelConfig {
+  uint8_t pin;
+  uint8_t source;  // MotorSource
+  uint8_t curve;   // response curve profile index
+  uint8_t motion;  // motion profile index
+};
+
+/**
+ * Where a channel's PWM goes instead of analogWrite(pin, pwm), e.g. a speed loop
+ * that drives the pin itself (speed_control.h).
+ */
+typedef void (*MotorOutputFn)(uint8_t channel, uint8_t pin, uint8_t pwm);
+
+/**
+ * CHANNELS motors updated together, once per MOTOR_UPDATE_INTERVAL.
+ *
+ * State is kept as parallel arrays (pin, source, curve table, motion limits, trajectory,
+ * target, current PWM) rather than one struct per motor, so update() is a single pass
+ * over contiguous arrays: one table read per channel for the target, one fixed-cost
+ * jerk-limited step (motion_profile.h), and analogWrite() only for channels whose PWM
+ * changed. Curves and motion limits are compile-time tables shared by all channels;
+ * the bank keeps a pointer to each channel's entries.
+ */
+template <uint8_t CHANNELS>
+class MotorBank {
+  static_assert(CHANNELS >= 1 && CHANNELS <= 32, "1 to 32 motor channels");
+
+ public:
+  // `curves` and `motions` (at least one each) must outlive the bank; channels start
+  // on the first of each.
+  MotorBank(const PwmCurve *curves, uint8_t curveCount, const MotionLimits *motions, uint8_t motionCount)
+      : curves_(curves), curveCount_(curveCount), motions_(motions), motionCount_(motionCount), output_(nullptr) {
+    for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+      pin_[ch] = 0;
+      source_[ch] = MOTOR_SOURCE_AMPLITUDE;
+      curve_[ch] = 0;
+      table_[ch] = curves_[0].pwm;
+      motion_[ch] = 0;
+      limits_[ch] = &motions_[0];
+      pos_[ch] = vel_[ch] = acc_[ch] = 0;
+      running_[ch] = 0;
+      kickLeft_[ch] = 0;
+      target_[ch] = 0;
+      current_[ch] = 0;
+    }
+  }
+
+  // Set a channel's pin, source, curve and motion profile (the PWM output and its
+  // trajectory are left as they are). An unknown source or profile falls back to the first.
+  void configure(uint8_t ch, const MotorChannelConfig &config) {
+    if (ch >= CHANNELS) return;
+    pin_[ch] = config.pin;
+    source_[ch] = (config.source < MOTOR_SOURCE_COUNT) ? config.source : (uint8_t)MOTOR_SOURCE_AMPLITUDE;
+    curve_[ch] = (config.curve < curveCount_) ? config.curve : 0;
+    table_[ch] = curves_[curve_[ch]].pwm;
+    motion_[ch] = (config.motion < motionCount_) ? config.motion : 0;
+    limits_[ch] = &motions_[motion_[ch]];
+  }
+
+  // Route every PWM change through `output` (nullptr: analogWrite() on the channel's pin).
+  void setOutput(MotorOutputFn output) { output_ = output; }
+
+  MotorChannelConfig config(uint8_t ch) const {
+    MotorChannelConfig c = {};
+    if (ch >= CHANNELS) return c;
+    c.pin = pin_[ch];
+    c.source = source_[ch];
+    c.curve = curve_[ch];
+    c.motion = motion_[ch];
+    return c;
+  }
+
+  // Target PWM for `level` on channel ch.
+  uint8_t mapLevel(uint8_t ch, int level) const {
+    return table_[ch][level < 0 ? 0 : (level > PWM_CURVE_MAX_LEVEL ? PWM_CURVE_MAX_LEVEL : level)];
+  }
+
+  // One update of every channel from the source levels (indexed by MotorSource).
+  //
+  // A stopped channel with a target starts at its floor PWM, after the kick pulse if
+  // its profile has one (the update that starts it counts as the first kick tick).
+  // With a target of 0 the channel ramps down to the floor and then cuts the output.
+  // Targets between 0 and the floor hold the floor.
+  void update(const int levels[MOTOR_SOURCE_COUNT]) {
+    for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+      const MotionLimits &m = *limits_[ch];
+      const uint8_t target = mapLevel(ch, levels[source_[ch]]);
+      const int32_t floor = (int32_t)m.floorPwm << MOTION_Q;
+      target_[ch] = target;
+
+      uint8_t next;
+      if (kickLeft_[ch]) {
+        // Kick pulse; the trajectory waits at the floor.
+        kickLeft_[ch]--;
+        next = m.kickPwm;
+      } else if (!running_[ch] && target == 0) {
+        next = 0;
+      } else if (!running_[ch] && m.kickTicks) {
+        running_[ch] = 1;
+        pos_[ch] = floor;
+        kickLeft_[ch] = (uint8_t)(m.kickTicks - 1);
+        next = m.kickPwm;
+      } else {
+        MotionState s = {running_[ch] ? pos_[ch] : floor, vel_[ch], acc_[ch]};
+        const int32_t goal = (int32_t)target << MOTION_Q;
+        motionStep(s, goal > floor ? goal : floor, m);
+        running_[ch] = !(target == 0 && s.pos == floor && s.vel == 0 && s.acc == 0);
+        pos_[ch] = running_[ch] ? s.pos : 0;
+        vel_[ch] = s.vel;
+        acc_[ch] = s.acc;
+        // A running motor never drops into the stall band, even while the trajectory
+        // settles a fraction of a count below the floor.
+        int32_t rounded = (pos_[ch] + MOTION_ONE / 2) >> MOTION_Q;
+        if (running_[ch] && rounded < m.floorPwm) rounded = m.floorPwm;
+        next = (uint8_t)(rounded < 0 ? 0 : (rounded > 255 ? 255 : rounded));
+      }
+      if (next != current_[ch]) {
+        current_[ch] = next;
+        write(ch, next);
+      }
+    }
+  }
+
+  // Write a PWM value to one channel now, bypassing mapping and motion profile
+  // (the trajectory continues from there at rest).
+  void setPwm(uint8_t ch, int pwm) {
+    if (ch >= CHANNELS) return;
+    const uint8_t value = (uint8_t)(pwm < 0 ? 0 : (pwm > 255 ? 255 : pwm));
+    target_[ch] = current_[ch] = value;
+    pos_[ch] = (int32_t)value << MOTION_Q;
+    vel_[ch] = acc_[ch] = 0;
+    running_[ch] = value != 0;
+    kickLeft_[ch] = 0;
+    write(ch, value);
+  }
+
+  // Every output to 0, written unconditionally.
+  void stopAll() {
+    for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+      target_[ch] = current_[ch] = 0;
+      pos_[ch] = vel_[ch] = acc_[ch] = 0;
+      running_[ch] = 0;
+      kickLeft_[ch] = 0;
+      write(ch, 0);
+    }
+  }
+
+  // No channel is driving its motor.
+  bool stopped() const {
+    uint8_t any = 0;
+    for (uint8_t ch = 0; ch < CHANNELS; ch++) any |= current_[ch];
+    return any == 0;
+  }
+
+  uint8_t pwm(uint8_t ch) const { return (ch < CHANNELS) ? current_[ch] : 0; }
+  uint8_t target(uint8_t ch) const { return (ch < CHANNELS) ? target_[ch] : 0; }
+  // Trajectory state (Q8 PWM, PWM/tick, PWM/tick^2), for tests.
+  MotionState motion(uint8_t ch) const {
+    MotionState s = {};
+    if (ch < CHANNELS) s = {pos_[ch], vel_[ch], acc_[ch]};
+    return s;
+  }
+  static uint8_t channels() { return CHANNELS; }
+
+ private:
+  void write(uint8_t ch, uint8_t pwm) {
+    if (output_ != nullptr) {
+      output_(ch, pin_[ch], pwm);
+    } else {
+      analogWrite(pin_[ch], pwm);
+    }
+  }
+
+  const PwmCurve *curves_;
+  uint8_t curveCount_;
+  const MotionLimits *motions_;
+  uint8_t motionCount_;
+  MotorOutputFn output_;
+  const uint8_t *table_[CHANNELS];        // curves_[curve_[ch]].pwm
+  const MotionLimits *limits_[CHANNELS];  // &motions_[motion_[ch]]
+  int32_t pos_[CHANNELS];
+  int32_t vel_[CHANNELS];
+  int32_t acc_[CHANNELS];
+  uint8_t pin_[CHANNELS];
+  uint8_t source_[CHANNELS];
+  uint8_t curve_[CHANNELS];
+  uint8_t motion_[CHANNELS];
+  uint8_t running_[CHANNELS];   // trajectory active (the output may still read 0 at floor 0)
+  uint8_t kickLeft_[CHANNELS];
+  uint8_t target_[CHANNELS];
+  uint8_t current_[CHANNELS];
+};
+
+#endif // MOTOR_BANK_H
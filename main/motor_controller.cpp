@@ -1,24 +1,120 @@
 #include "motor_controller.h"
 #include "config.h"
+#include "speed_control.h"
 #include <Arduino.h>
 
+#if !ENABLE_BINARY_TELEMETRY
 static unsigned long lastDebugTime = 0;
+#endif
+
+static constexpr PwmCurveSpec CURVE_SPECS[] = MOTOR_CURVE_PROFILES;
+static_assert(pwmCurveSpecsValid(CURVE_SPECS), "MOTOR_CURVE_PROFILES: invalid curve");
+static constexpr size_t CURVE_COUNT = sizeof(CURVE_SPECS) / sizeof(CURVE_SPECS[0]);
+static_assert(CURVE_COUNT >= 1 && CURVE_COUNT <= 255, "1 to 255 curve profiles");
+
+// Every profile's table, evaluated by the compiler (flash, not RAM).
+static constexpr PwmCurveSet<CURVE_COUNT> CURVES = makePwmCurves(CURVE_SPECS);
+
+// updateMotorSpeed(): the whole 0..512 range onto [MIN_MOTOR_SPEED..MAX_MOTOR_SPEED].
+static constexpr PwmCurveSpec FULL_RANGE_SPEC = {
+  "full range", PWM_CURVE_LINEAR, 0, 0, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED, 0, {}
+};
+static constexpr PwmCurve FULL_RANGE_CURVE = makePwmCurve(FULL_RANGE_SPEC);
+
+static constexpr MotionProfileSpec MOTION_SPECS[] = MOTOR_MOTION_PROFILES;
+static_assert(motionProfilesValid(MOTION_SPECS, MOTOR_UPDATE_INTERVAL), "MOTOR_MOTION_PROFILES: limits out of range");
+static constexpr size_t MOTION_COUNT = sizeof(MOTION_SPECS) / sizeof(MOTION_SPECS[0]);
+static_assert(MOTION_COUNT >= 1 && MOTION_COUNT <= 255, "1 to 255 motion profiles");
+static constexpr MotionLimitsSet<MOTION_COUNT> MOTIONS = makeMotionLimitsSet(MOTION_SPECS, MOTOR_UPDATE_INTERVAL);
+
+static MotorBank<MOTOR_CHANNELS> motors(CURVES.curves, CURVE_COUNT, MOTIONS.limits, MOTION_COUNT);
+
+static const MotorChannelConfig CHANNEL_CONFIG[] = MOTOR_CHANNEL_CONFIG;
+static_assert(sizeof(CHANNEL_CONFIG) / sizeof(CHANNEL_CONFIG[0]) == MOTOR_CHANNELS,
+              "MOTOR_CHANNEL_CONFIG needs one row per motor channel");
+
+static bool validChannel(int channel) {
+  return channel >= 0 && channel < MOTOR_CHANNELS;
+}
 
 void initMotorController() {
-  pinMode(MOTOR_PIN, OUTPUT);
+#if ENABLE_SPEED_CONTROL
+  // SPEED_CONTROL_CHANNEL's PWM is the speed loop's command; it drives that pin.
+  motors.setOutput(speedControlMotorOutput);
+#endif
+  for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+    motors.configure(ch, CHANNEL_CONFIG[ch]);
+    pinMode(CHANNEL_CONFIG[ch].pin, OUTPUT);
+  }
   stopMotor();
 }
 
+void updateMotorBank(const int levels[MOTOR_SOURCE_COUNT]) {
+  motors.update(levels);
+}
+
+void configureMotorChannel(int channel, const MotorChannelConfig &config) {
+  if (!validChannel(channel)) return;
+  motors.configure(channel, config);
+  pinMode(config.pin, OUTPUT);
+}
+
+MotorChannelConfig getMotorChannelConfig(int channel) {
+  return validChannel(channel) ? motors.config(channel) : MotorChannelConfig();
+}
+
+int getMotorChannelPwm(int channel) {
+  return validChannel(channel) ? motors.pwm(channel) : 0;
+}
+
+int getMotorChannelTarget(int channel) {
+  return validChannel(channel) ? motors.target(channel) : 0;
+}
+
+MotionState getMotorChannelMotion(int channel) {
+  return validChannel(channel) ? motors.motion(channel) : MotionState();
+}
+
+bool motorsStopped() {
+  return motors.stopped();
+}
+
+int getMotorCurveCount() {
+  return (int)CURVE_COUNT;
+}
+
+const char *getMotorCurveName(int curve) {
+  return (curve >= 0 && curve < (int)CURVE_COUNT) ? CURVE_SPECS[curve].name : "";
+}
+
+int mapLevelOnCurve(int curve, int level) {
+  if (curve < 0 || curve >= (int)CURVE_COUNT) return 0;
+  return CURVES.curves[curve](level);
+}
+
+int getMotorMotionCount() {
+  return (int)MOTION_COUNT;
+}
+
+const char *getMotorMotionName(int motion) {
+  return (motion >= 0 && motion < (int)MOTION_COUNT) ? MOTION_SPECS[motion].name : "";
+}
+
+const MotionLimits *getMotorMotionLimits(int motion) {
+  return (motion >= 0 && motion < (int)MOTION_COUNT) ? &MOTIONS.limits[motion] : nullptr;
+}
+
 void updateMotorSpeed(int amplitude) {
   // Map audio amplitude to motor speed
   // Higher amplitude = faster motor speed
-  // Using a wider range for better responsiveness
-  int motorSpeed = map(amplitude, 0, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
-  motorSpeed = constrain(motorSpeed, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
+  // Using a wider range for better responsiveness (never below MIN_MOTOR_SPEED)
+  int motorSpeed = FULL_RANGE_CURVE(amplitude);
+  if (motorSpeed < MIN_MOTOR_SPEED) motorSpeed = MIN_MOTOR_SPEED;
   
   // Apply motor speed
   analogWrite(MOTOR_PIN, motorSpeed);
   
+#if !ENABLE_BINARY_TELEMETRY
   // Debug output (every DEBUG_INTERVAL ms to avoid flooding serial)
   unsigned long currentTime = millis();
   if (currentTime - lastDebugTime >= DEBUG_INTERVAL) {
@@ -28,14 +124,19 @@ void updateMotorSpeed(int amplitude) {
     Serial.println(motorSpeed);
     lastDebugTime = currentTime;
   }
+#endif
 }
 
 void stopMotor() {
-  analogWrite(MOTOR_PIN, 0);
+  motors.stopAll();
 }
 
 void setMotorSpeed(int speed) {
-  speed = constrain(speed, 0, 255);
-  analogWrite(MOTOR_PIN, speed);
+  motors.setPwm(0, speed);
 }
 
+int clampAndMapAmplitudeToTargetPwm(int amplitude) {
+  // In ACTIVE, treat values below ACTIVE_EXIT_THRESHOLD as "no drive" (target 0);
+  // [ACTIVE_EXIT_THRESHOLD..512] -> [MIN_MOTOR_SPEED..MAX_MOTOR_SPEED] (the linear profile's table).
+  return CURVES.curves[MOTOR_CURVE_LINEAR](amplitude);
+}
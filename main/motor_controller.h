@@ -1,12 +1,65 @@
 #ifndef MOTOR_CONTROLLER_H
 #define MOTOR_CONTROLLER_H
 
+#include "motor_bank.h"
+
 /**
  * Initialize the motor controller
- * Sets up the motor pin as output
+ * Configures the MOTOR_CHANNELS motors from MOTOR_CHANNEL_CONFIG, sets their pins
+ * as outputs and stops them
  */
 void initMotorController();
 
+/**
+ * Update every motor channel once (call every MOTOR_UPDATE_INTERVAL)
+ * Each channel maps its source level to a target PWM, takes one jerk-limited
+ * step of its motion profile towards it and writes its pin only if the PWM changed
+ *
+ * @param levels Current level of each MotorSource (amplitude, bass, mid, treble)
+ */
+void updateMotorBank(const int levels[MOTOR_SOURCE_COUNT]);
+
+/**
+ * Replace one channel's pin / curve / motion profile configuration
+ */
+void configureMotorChannel(int channel, const MotorChannelConfig &config);
+MotorChannelConfig getMotorChannelConfig(int channel);
+
+/**
+ * Per-channel state: the PWM currently written (with ENABLE_SPEED_CONTROL, for
+ * SPEED_CONTROL_CHANNEL the speed command; see getSpeedControlPwm()) and the mapped target
+ * (0 for channels outside [0, MOTOR_CHANNELS))
+ */
+int getMotorChannelPwm(int channel);
+int getMotorChannelTarget(int channel);
+MotionState getMotorChannelMotion(int channel);
+
+/**
+ * True when every channel's PWM is 0
+ */
+bool motorsStopped();
+
+/**
+ * Response curve profiles (MOTOR_CURVE_PROFILES), selected per channel by index
+ * in MotorChannelConfig::curve
+ */
+int getMotorCurveCount();
+const char *getMotorCurveName(int curve);
+
+/**
+ * Target PWM for `level` on a curve profile (0 for an unknown profile)
+ */
+int mapLevelOnCurve(int curve, int level);
+
+/**
+ * Motion profiles (MOTOR_MOTION_PROFILES), selected per channel by index in
+ * MotorChannelConfig::motion; limits are per MOTOR_UPDATE_INTERVAL tick (nullptr
+ * for an unknown profile)
+ */
+int getMotorMotionCount();
+const char *getMotorMotionName(int motion);
+const MotionLimits *getMotorMotionLimits(int motion);
+
 /**
  * Update motor speed based on audio amplitude
  * Maps amplitude (0-512) to motor speed (MIN_MOTOR_SPEED - MAX_MOTOR_SPEED)
@@ -16,16 +69,26 @@ void initMotorController();
 void updateMotorSpeed(int amplitude);
 
 /**
- * Stop the motor
+ * Stop every motor channel
  */
 void stopMotor();
 
 /**
- * Set motor speed directly (for testing)
+ * Set motor speed directly on channel 0 (for testing)
  * 
  * @param speed PWM value (0-255)
  */
 void setMotorSpeed(int speed);
 
+/**
+ * Map an ACTIVE-state amplitude to a target PWM
+ * Amplitudes at or below ACTIVE_EXIT_THRESHOLD map to 0 (no drive);
+ * [ACTIVE_EXIT_THRESHOLD..512] maps to [MIN_MOTOR_SPEED..MAX_MOTOR_SPEED]
+ * 
+ * @param amplitude The smoothed audio amplitude
+ * @return Target PWM value (0-255)
+ */
+int clampAndMapAmplitudeToTargetPwm(int amplitude);
+
 #endif // MOTOR_CONTROLLER_H
 
@@ -0,0 +1,56 @@
+#ifndef PERCENTILE_TRACKER_H
+#define PERCENTILE_TRACKER_H
+
+#include <stdint.h>
+
+/**
+ * Running percentile of a non-negative level, without storing any history.
+ *
+ * Each push() moves the estimate a fixed fraction of itself towards the input: up by
+ * value / 2^riseShift when the input is above it, down by value / 2^fallShift when
+ * below. It settles where the two balance, with a fraction
+ *   2^-riseShift / (2^-riseShift + 2^-fallShift)
+ * of the inputs below it: rise 7 / fall 5 tracks the 20th percentile (a noise floor),
+ * rise 6 / fall 9 about the 89th (a typical loud level). Steps are relative,
+ * so it adapts as fast at 20 counts as at 2000, and the shifts may change from call to
+ * call (e.g. adapt faster right after a reset). A step stops at the input, which only
+ * matters for inputs steadier than one step.
+ *
+ * Values are Q8 (256 = 1 count), kept within [minimum, 2^24). Cost per push: a
+ * compare, a shift and an add.
+ */
+class PercentileTracker {
+ public:
+  PercentileTracker() { reset(0, 0); }
+
+  void reset(uint32_t initialQ8, uint32_t minimumQ8) {
+    minimum_ = minimumQ8;
+    value_ = initialQ8 < minimumQ8 ? minimumQ8 : initialQ8;
+  }
+
+  uint32_t push(uint32_t levelQ8, uint8_t riseShift, uint8_t fallShift) {
+    if (levelQ8 > value_) {
+      const uint32_t step = (value_ >> riseShift) + 1;
+      const uint32_t target = levelQ8 < MAX_Q8 ? levelQ8 : MAX_Q8;
+      value_ = (target - value_ > step) ? value_ + step : target;
+    } else if (levelQ8 < value_) {
+      const uint32_t step = (value_ >> fallShift) + 1;
+      const uint32_t target = levelQ8 > minimum_ ? levelQ8 : minimum_;
+      value_ = (value_ - target > step) ? value_ - step : target;
+    }
+    return value_;
+  }
+
+  uint32_t valueQ8() const { return value_; }
+
+  // Rounded to the nearest count.
+  int32_t value() const { return (int32_t)((value_ + 128) >> 8); }
+
+ private:
+  static const uint32_t MAX_Q8 = 1UL << 24;
+
+  uint32_t value_;
+  uint32_t minimum_;
+};
+
+#endif // PERCENTILE_TRACKER_H
@@ -0,0 +1,147 @@
+#ifndef PWM_CURVE_H
+#define PWM_CURVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "const_math.h"
+
+/**
+ * Level -> PWM response curves as lookup tables built at compile time.
+ *
+ * A PwmCurveSpec describes the curve: the input range it responds to, the PWM range
+ * it drives, and the shape in between. makePwmCurve() evaluates it for every level
+ * 0..PWM_CURVE_MAX_LEVEL (constexpr, so a `static constexpr PwmCurve` lives in flash),
+ * and mapping a level is then a clamp and one table read.
+ *
+ * Levels at or below inputLow give 0 (motor off); above, the shape maps
+ * [inputLow..inputHigh] onto [minPwm..maxPwm]:
+ * - PWM_CURVE_LINEAR: straight line, identical to Arduino map() (integer, truncating)
+ * - PWM_CURVE_LOG: ln(1 + k*x) / ln(1 + k) with k = param; lifts quiet levels, compresses loud ones
+ * - PWM_CURVE_GAMMA: x^(param / 100); below 100 lifts quiet levels, above 100 holds them back
+ * - PWM_CURVE_PIECEWISE: straight segments through points (x, y) in permille of the
+ *   input and PWM spans; the first point must be (0, y) and the last (1000, y)
+ */
+
+#define PWM_CURVE_MAX_LEVEL 512  // Amplitude and band levels are ADC counts around the DC baseline
+#define PWM_CURVE_MAX_POINTS 8
+
+enum PwmCurveShape {
+  PWM_CURVE_LINEAR,
+  PWM_CURVE_LOG,
+  PWM_CURVE_GAMMA,
+  PWM_CURVE_PIECEWISE
+};
+
+struct PwmCurvePoint {
+  uint16_t x;  // permille of [inputLow..inputHigh]
+  uint16_t y;  // permille of [minPwm..maxPwm]
+};
+
+struct PwmCurveSpec {
+  const char *name;
+  uint8_t shape;  // PwmCurveShape
+  uint16_t param;
+  uint16_t inputLow;
+  uint16_t inputHigh;
+  uint8_t minPwm;
+  uint8_t maxPwm;
+  uint8_t pointCount;  // PWM_CURVE_PIECEWISE only
+  PwmCurvePoint points[PWM_CURVE_MAX_POINTS];
+};
+
+struct PwmCurve {
+  uint8_t pwm[PWM_CURVE_MAX_LEVEL + 1];
+
+  // Target PWM for `level`; anything outside [0..PWM_CURVE_MAX_LEVEL] is clamped first.
+  constexpr uint8_t operator()(int level) const {
+    return pwm[level < 0 ? 0 : (level > PWM_CURVE_MAX_LEVEL ? PWM_CURVE_MAX_LEVEL : level)];
+  }
+};
+
+// Shape value at x in (0, 1], in [0, 1].
+constexpr double pwmCurveShape(const PwmCurveSpec &spec, double x) {
+  switch (spec.shape) {
+    case PWM_CURVE_LOG:
+      return constLn(1.0 + spec.param * x) / constLn(1.0 + spec.param);
+    case PWM_CURVE_GAMMA:
+      return constExp(constLn(x) * spec.param / 100.0);
+    case PWM_CURVE_PIECEWISE: {
+      const double xm = x * 1000.0;
+      for (uint8_t i = 1; i < spec.pointCount; i++) {
+        const PwmCurvePoint a = spec.points[i - 1];
+        const PwmCurvePoint b = spec.points[i];
+        if (xm <= b.x) {
+          if (b.x == a.x) return b.y / 1000.0;
+          return (a.y + (xm - a.x) * ((double)b.y - a.y) / (b.x - a.x)) / 1000.0;
+        }
+      }
+      return spec.points[spec.pointCount - 1].y / 1000.0;
+    }
+    default:
+      return x;
+  }
+}
+
+// The spec is usable: ranges in order, a known shape with a sensible parameter and,
+// for a piecewise curve, 2+ points from x = 0 to x = 1000 with x non-decreasing.
+constexpr bool pwmCurveSpecValid(const PwmCurveSpec &spec) {
+  if (spec.inputHigh <= spec.inputLow || spec.inputHigh > PWM_CURVE_MAX_LEVEL) return false;
+  if (spec.maxPwm < spec.minPwm) return false;
+  switch (spec.shape) {
+    case PWM_CURVE_LINEAR:
+      return true;
+    case PWM_CURVE_LOG:
+    case PWM_CURVE_GAMMA:
+      return spec.param > 0;
+    case PWM_CURVE_PIECEWISE:
+      if (spec.pointCount < 2 || spec.pointCount > PWM_CURVE_MAX_POINTS) return false;
+      if (spec.points[0].x != 0 || spec.points[spec.pointCount - 1].x != 1000) return false;
+      for (uint8_t i = 0; i < spec.pointCount; i++) {
+        if (spec.points[i].y > 1000) return false;
+        if (i > 0 && spec.points[i].x < spec.points[i - 1].x) return false;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <size_t N>
+constexpr bool pwmCurveSpecsValid(const PwmCurveSpec (&specs)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    if (!pwmCurveSpecValid(specs[i])) return false;
+  }
+  return true;
+}
+
+constexpr PwmCurve makePwmCurve(const PwmCurveSpec &spec) {
+  PwmCurve curve = {};
+  const int inSpan = spec.inputHigh - spec.inputLow;
+  const int outSpan = spec.maxPwm - spec.minPwm;
+  for (int level = 0; level <= PWM_CURVE_MAX_LEVEL; level++) {
+    if (level <= spec.inputLow) continue;
+    const int x = (level > spec.inputHigh ? spec.inputHigh : level) - spec.inputLow;
+    if (spec.shape == PWM_CURVE_LINEAR) {
+      curve.pwm[level] = (uint8_t)(spec.minPwm + x * outSpan / inSpan);
+    } else {
+      const double y = pwmCurveShape(spec, (double)x / inSpan);
+      curve.pwm[level] = (uint8_t)(spec.minPwm + (int)(y * outSpan + 0.5));
+    }
+  }
+  return curve;
+}
+
+// One table per spec, in the same order (for a profile set declared as an array).
+template <size_t N>
+struct PwmCurveSet {
+  PwmCurve curves[N];
+};
+
+template <size_t N>
+constexpr PwmCurveSet<N> makePwmCurves(const PwmCurveSpec (&specs)[N]) {
+  PwmCurveSet<N> set = {};
+  for (size_t i = 0; i < N; i++) set.curves[i] = makePwmCurve(specs[i]);
+  return set;
+}
+
+#endif // PWM_CURVE_H
@@ -0,0 +1,151 @@
+#include "raw_capture.h"
+#include "motor_controller.h"
+#include "runtime_config.h"
+#include "telemetry.h"
+#include <string.h>
+
+// Largest frame: a full sample buffer plus a TICK or CONFIG.
+static const size_t TICK_DATA_SIZE = 3 * 5 + 1 + MOTOR_CHANNELS;
+static const size_t START_DATA_SIZE = 1 + 2 + 1 + 1 + 3 * 4 + RUNTIME_CONFIG_RECORD_SIZE;
+static const size_t MAX_EVENT_DATA = (TICK_DATA_SIZE > RUNTIME_CONFIG_RECORD_SIZE) ? TICK_DATA_SIZE
+                                                                                   : RUNTIME_CONFIG_RECORD_SIZE;
+static const size_t MAX_PAYLOAD = 2 + 1 + 2 + RAW_CAPTURE_SAMPLE_BYTES + MAX_EVENT_DATA;
+static const size_t START_PAYLOAD = 2 + 1 + 1 + START_DATA_SIZE;  // no samples before START
+static const size_t FRAME_BUFFER = (MAX_PAYLOAD > START_PAYLOAD) ? MAX_PAYLOAD : START_PAYLOAD;
+static_assert(FRAME_BUFFER <= TELEMETRY_MAX_PAYLOAD,
+              "capture frames must fit a telemetry frame (fewer MOTOR_CHANNELS or RAW_CAPTURE_SAMPLE_BYTES)");
+static_assert(2 * (FRAME_BUFFER + 5) <= TELEMETRY_RING_SIZE, "TELEMETRY_RING_SIZE must hold two capture frames");
+
+static bool active = false;
+static uint16_t sequence = 0;
+static unsigned long lostFrames = 0;
+
+// Delta bases: the previous sample, and the inputs of the previous event.
+static int lastSample = 0;
+static uint32_t lastMs = 0;
+static uint32_t lastIsrCount = 0;
+static uint32_t lastJitterCount = 0;
+
+// Samples since the last frame, already encoded.
+static uint8_t sampleBytes[RAW_CAPTURE_SAMPLE_BYTES];
+static size_t sampleByteCount = 0;
+static unsigned sampleCount = 0;
+
+static size_t putVarint(uint8_t *p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+// One frame: header, the buffered samples, then `data` for the event.
+static void sendFrame(RawCaptureEvent event, const uint8_t *data, size_t length) {
+  uint8_t frame[FRAME_BUFFER];
+  size_t n = 0;
+  put16(frame, sequence++);
+  n += 2;
+  frame[n++] = (uint8_t)event;
+  n += putVarint(frame + n, sampleCount);
+  memcpy(frame + n, sampleBytes, sampleByteCount);
+  n += sampleByteCount;
+  if (length > 0) memcpy(frame + n, data, length);
+  n += length;
+  if (!telemetrySendFrame(TELEMETRY_TYPE_CAPTURE, frame, n)) lostFrames++;
+  sampleByteCount = 0;
+  sampleCount = 0;
+}
+
+void rawCaptureStart(uint32_t nowMs, uint32_t isrSampleCount, uint32_t jitterCount) {
+  active = true;
+  sequence = 0;
+  lostFrames = 0;
+  lastSample = 0;
+  lastMs = nowMs;
+  lastIsrCount = isrSampleCount;
+  lastJitterCount = jitterCount;
+  sampleByteCount = 0;
+  sampleCount = 0;
+
+  uint8_t data[START_DATA_SIZE];
+  data[0] = RAW_CAPTURE_VERSION;
+  put16(data + 1, SAMPLE_RATE);
+  data[3] = MOTOR_CHANNELS;
+  data[4] = SAMPLE_FRACTION_BITS;
+  put32(data + 5, nowMs);
+  put32(data + 9, isrSampleCount);
+  put32(data + 13, jitterCount);
+  runtimeConfigEncode(runtimeConfig(), data + 17);
+  sendFrame(RAW_CAPTURE_START, data, sizeof(data));
+}
+
+void rawCaptureStop() {
+  if (!active) return;
+  sendFrame(RAW_CAPTURE_STOP, nullptr, 0);
+  active = false;
+}
+
+bool rawCaptureActive() {
+  return active;
+}
+
+void rawCaptureSamples(const int *samples, unsigned count) {
+  if (!active) return;
+  for (unsigned i = 0; i < count; i++) {
+    // Zigzag: small differences of either sign take one byte.
+    const int32_t delta = (int32_t)samples[i] - lastSample;
+    const uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    lastSample = samples[i];
+    sampleByteCount += putVarint(sampleBytes + sampleByteCount, zigzag);
+    sampleCount++;
+    // Room for one more sample (at most 3 bytes: the ADC values are 16-bit).
+    if (sampleByteCount + 3 > RAW_CAPTURE_SAMPLE_BYTES) sendFrame(RAW_CAPTURE_SAMPLES, nullptr, 0);
+  }
+}
+
+void rawCaptureTick(uint32_t nowMs, uint32_t isrSampleCount, uint32_t jitterCount, uint8_t state) {
+  if (!active) return;
+  uint8_t data[TICK_DATA_SIZE];
+  size_t n = 0;
+  n += putVarint(data + n, nowMs - lastMs);
+  n += putVarint(data + n, isrSampleCount - lastIsrCount);
+  n += putVarint(data + n, jitterCount - lastJitterCount);
+  data[n++] = state;
+  for (int ch = 0; ch < MOTOR_CHANNELS; ch++) data[n++] = (uint8_t)getMotorChannelPwm(ch);
+  lastMs = nowMs;
+  lastIsrCount = isrSampleCount;
+  lastJitterCount = jitterCount;
+  sendFrame(RAW_CAPTURE_TICK, data, n);
+}
+
+void rawCaptureCommand(uint32_t nowMs, uint8_t command) {
+  if (!active) return;
+  uint8_t data[6];
+  size_t n = putVarint(data, nowMs - lastMs);
+  data[n++] = command;
+  lastMs = nowMs;
+  sendFrame(RAW_CAPTURE_COMMAND, data, n);
+}
+
+void rawCaptureConfig() {
+  if (!active) return;
+  uint8_t data[RUNTIME_CONFIG_RECORD_SIZE];
+  runtimeConfigEncode(runtimeConfig(), data);
+  sendFrame(RAW_CAPTURE_CONFIG, data, sizeof(data));
+}
+
+unsigned long getRawCaptureLostFrames() {
+  return lostFrames;
+}
@@ -0,0 +1,90 @@
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * Raw capture: everything the control path consumes, streamed over Serial so a field
+ * problem can be brought home and replayed through the firmware on the desktop
+ * (tests/capture_replay.h), reproducing the state and PWM of every supervisor tick.
+ *
+ * The serial command 'c' starts a capture: the signal chain restarts (audio
+ * processor, motors and supervisor re-initialize, the FSM goes through INIT) so the
+ * replay starts from the same state; 'c' again stops it. While it runs the log holds,
+ * in the order loop() saw them:
+ * - every sample the audio task processes (what the sampling ISR published, in order;
+ *   in 2^-SAMPLE_FRACTION_BITS ADC counts, after decimation if oversampling)
+ * - every supervisor tick: its inputs (time, ISR sample count, jitter violations) and
+ *   the resulting state and channel PWMs
+ * - the commands ('s', 'w', 'r') and runtime config changes the supervisor acted on
+ *
+ * Each event goes out as one telemetry frame (telemetry.h) of type
+ * TELEMETRY_TYPE_CAPTURE, queued with the status frames and sent without blocking:
+ *   u16 sequence                 +1 per capture frame (a gap = a frame was dropped)
+ *   u8  event                    RawCaptureEvent
+ *   varint n, then n samples     processed since the previous frame, each a zigzag
+ *                                varint of the difference to the sample before it
+ *                                (the first one after START: to 0)
+ *   event data:
+ *     START    u8 RAW_CAPTURE_VERSION, u16 SAMPLE_RATE, u8 MOTOR_CHANNELS,
+ *              u8 SAMPLE_FRACTION_BITS,
+ *              u32 time ms, u32 ISR sample count, u32 jitter violations,
+ *              the active runtime config record (RUNTIME_CONFIG_RECORD_SIZE)
+ *     SAMPLES  nothing (the sample buffer filled up between two events)
+ *     TICK     varint time, varint ISR sample count, varint jitter violations (each
+ *              the change since the previous START / TICK / COMMAND), u8 state,
+ *              u8 PWM per motor channel (after the tick)
+ *     COMMAND  varint time (change), u8 command byte
+ *     CONFIG   the runtime config record now active (from the next tick on)
+ *     STOP     nothing
+ * Varints are little-endian base-128 (7 bits per byte, high bit = more).
+ *
+ * Budget at 1 kHz: about 35 bytes per 10 ms tick, ~3.5 KB/s (SERIAL_BAUD 115200
+ * carries 11.5 KB/s); oversampled, the finer samples take about one byte more each,
+ * ~4.5 KB/s. A frame that does not fit in the telemetry queue is dropped and
+ * counted; the replay is exact up to the first gap.
+ */
+
+#define RAW_CAPTURE_VERSION 2
+
+enum RawCaptureEvent {
+  RAW_CAPTURE_START = 1,
+  RAW_CAPTURE_SAMPLES,
+  RAW_CAPTURE_TICK,
+  RAW_CAPTURE_COMMAND,
+  RAW_CAPTURE_CONFIG,
+  RAW_CAPTURE_STOP
+};
+
+// Encoded samples buffered between two events (a SAMPLES frame is sent when full).
+static const size_t RAW_CAPTURE_SAMPLE_BYTES = 160;
+
+// Start streaming. The caller has just re-initialized the signal chain at nowMs;
+// isrSampleCount and jitterCount are getAudioSampleCount() and
+// getSampleJitterOverLimitCount() at that point.
+void rawCaptureStart(uint32_t nowMs, uint32_t isrSampleCount, uint32_t jitterCount);
+
+// Send what is buffered and a STOP frame.
+void rawCaptureStop();
+
+bool rawCaptureActive();
+
+// Audio task: raw samples, in the order they are processed.
+void rawCaptureSamples(const int *samples, unsigned count);
+
+// Supervisor: one tick with its inputs, and the state it left the FSM in (the channel
+// PWMs are read from the motor controller).
+void rawCaptureTick(uint32_t nowMs, uint32_t isrSampleCount, uint32_t jitterCount, uint8_t state);
+
+// Supervisor: a command byte it acted on at nowMs.
+void rawCaptureCommand(uint32_t nowMs, uint8_t command);
+
+// Supervisor: the runtime config just became active.
+void rawCaptureConfig();
+
+// Capture frames the telemetry queue had no room for since rawCaptureStart().
+unsigned long getRawCaptureLostFrames();
+
+#endif // RAW_CAPTURE_H
@@ -0,0 +1,468 @@
+#include "runtime_config.h"
+#include "config_store.h"
+#include "motor_controller.h"
+#include <Arduino.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RC_PARAM(name, type, field, perChannel, lo, hi) \
+  {name, type, perChannel, (uint8_t)((perChannel) ? MOTOR_CHANNELS : 1), (uint16_t)offsetof(RuntimeConfig, field), lo, hi}
+
+static constexpr RuntimeConfigParam PARAMS[] = {
+  //        name                          type                field                    per channel  min                        max
+  RC_PARAM("active_enter_threshold",     RUNTIME_CONFIG_U16, activeEnterThreshold,    false,        1,                         512),
+  RC_PARAM("active_exit_threshold",      RUNTIME_CONFIG_U16, activeExitThreshold,     false,        0,                         511),
+  RC_PARAM("active_enter_floor_pct",     RUNTIME_CONFIG_U16, activeEnterFloorPct,     false,        100,                       5000),
+  RC_PARAM("active_exit_floor_pct",      RUNTIME_CONFIG_U16, activeExitFloorPct,      false,        100,                       5000),
+  RC_PARAM("active_enter_debounce_ms",   RUNTIME_CONFIG_U16, activeEnterDebounceMs,   false,        0,                         10000),
+  RC_PARAM("idle_timeout_ms",            RUNTIME_CONFIG_U32, idleTimeoutMs,           false,        100,                       3600000UL),
+  RC_PARAM("idle_calibration_warmup_ms", RUNTIME_CONFIG_U16, idleCalibrationWarmupMs, false,        0,                         10000),
+  RC_PARAM("beat_lead_ms",               RUNTIME_CONFIG_U16, beatLeadMs,              false,        0,                         1000),
+  RC_PARAM("beat_accent_ms",             RUNTIME_CONFIG_U16, beatAccentMs,            false,        0,                         1000),
+  RC_PARAM("beat_accent_pct",            RUNTIME_CONFIG_U16, beatAccentPct,           false,        0,                         400),
+  RC_PARAM("sample_stall_timeout_ms",    RUNTIME_CONFIG_U16, sampleStallTimeoutMs,    false,        2 * MOTOR_UPDATE_INTERVAL, 10000),
+  RC_PARAM("sample_jitter_fault_count",  RUNTIME_CONFIG_U16, sampleJitterFaultCount,  false,        0,                         1000),
+  RC_PARAM("sample_jitter_window_ms",    RUNTIME_CONFIG_U16, sampleJitterWindowMs,    false,        100,                       60000),
+  RC_PARAM("motor_curve",                RUNTIME_CONFIG_U8,  motorCurve,              true,         0,                         254),
+  RC_PARAM("motor_motion",               RUNTIME_CONFIG_U8,  motorMotion,             true,         0,                         254),
+};
+static constexpr size_t PARAM_COUNT = sizeof(PARAMS) / sizeof(PARAMS[0]);
+
+static constexpr size_t typeBytes(uint8_t type) {
+  return type == RUNTIME_CONFIG_U8 ? 1 : (type == RUNTIME_CONFIG_U16 ? 2 : 4);
+}
+
+static constexpr size_t payloadBytes() {
+  size_t n = 0;
+  for (size_t i = 0; i < PARAM_COUNT; i++) n += typeBytes(PARAMS[i].type) * PARAMS[i].count;
+  return n;
+}
+static_assert(payloadBytes() == RUNTIME_CONFIG_PAYLOAD_SIZE, "RUNTIME_CONFIG_PAYLOAD_SIZE does not match the parameter table");
+
+static const MotorChannelConfig CHANNEL_DEFAULTS[] = MOTOR_CHANNEL_CONFIG;
+
+static RuntimeConfig defaults;
+static RuntimeConfig active;
+static RuntimeConfig pending;
+static bool pendingChanged = false;
+static uint32_t generation = 0;
+static RuntimeConfigResult bootLoadResult = RUNTIME_CONFIG_NOT_STORED;
+
+// --- parameter access ---
+
+static uint32_t readElement(const RuntimeConfig &config, const RuntimeConfigParam &p, uint8_t index) {
+  const uint8_t *at = reinterpret_cast<const uint8_t *>(&config) + p.offset + index * typeBytes(p.type);
+  switch (p.type) {
+    case RUNTIME_CONFIG_U8:
+      return *at;
+    case RUNTIME_CONFIG_U16: {
+      uint16_t v;
+      memcpy(&v, at, sizeof(v));
+      return v;
+    }
+    default: {
+      uint32_t v;
+      memcpy(&v, at, sizeof(v));
+      return v;
+    }
+  }
+}
+
+static void writeElement(RuntimeConfig &config, const RuntimeConfigParam &p, uint8_t index, uint32_t value) {
+  uint8_t *at = reinterpret_cast<uint8_t *>(&config) + p.offset + index * typeBytes(p.type);
+  switch (p.type) {
+    case RUNTIME_CONFIG_U8:
+      *at = (uint8_t)value;
+      break;
+    case RUNTIME_CONFIG_U16: {
+      const uint16_t v = (uint16_t)value;
+      memcpy(at, &v, sizeof(v));
+      break;
+    }
+    default:
+      memcpy(at, &value, sizeof(value));
+      break;
+  }
+}
+
+// "name" or "name.<index>" -> parameter and element; nullptr if unknown.
+static const RuntimeConfigParam *findParam(const char *name, uint8_t &index) {
+  const char *dot = strchr(name, '.');
+  const size_t len = dot ? (size_t)(dot - name) : strlen(name);
+  long element = 0;
+  if (dot) {
+    char *end = nullptr;
+    element = strtol(dot + 1, &end, 10);
+    if (end == dot + 1 || *end != '\0') return nullptr;
+  }
+  for (size_t i = 0; i < PARAM_COUNT; i++) {
+    if (strlen(PARAMS[i].name) != len || strncmp(PARAMS[i].name, name, len) != 0) continue;
+    if (element < 0 || element >= PARAMS[i].count || (dot && !PARAMS[i].perChannel)) return nullptr;
+    index = (uint8_t)element;
+    return &PARAMS[i];
+  }
+  return nullptr;
+}
+
+// --- record encoding ---
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+uint32_t runtimeConfigCrc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+  }
+  return ~crc;
+}
+
+void runtimeConfigEncode(const RuntimeConfig &config, uint8_t *out) {
+  put32(out, RUNTIME_CONFIG_MAGIC);
+  put16(out + 4, RUNTIME_CONFIG_VERSION);
+  put16(out + 6, (uint16_t)RUNTIME_CONFIG_PAYLOAD_SIZE);
+  uint8_t *p = out + 8;
+  for (size_t i = 0; i < PARAM_COUNT; i++) {
+    const RuntimeConfigParam &param = PARAMS[i];
+    for (uint8_t e = 0; e < param.count; e++) {
+      const uint32_t v = readElement(config, param, e);
+      if (param.type == RUNTIME_CONFIG_U8) *p = (uint8_t)v;
+      else if (param.type == RUNTIME_CONFIG_U16) put16(p, (uint16_t)v);
+      else put32(p, v);
+      p += typeBytes(param.type);
+    }
+  }
+  put32(p, runtimeConfigCrc32(out, RUNTIME_CONFIG_RECORD_SIZE - 4));
+}
+
+RuntimeConfigResult runtimeConfigDecode(const uint8_t *in, RuntimeConfig &config) {
+  if (get32(in) != RUNTIME_CONFIG_MAGIC || get16(in + 4) != RUNTIME_CONFIG_VERSION ||
+      get16(in + 6) != RUNTIME_CONFIG_PAYLOAD_SIZE) {
+    return RUNTIME_CONFIG_BAD_RECORD;
+  }
+  if (get32(in + RUNTIME_CONFIG_RECORD_SIZE - 4) != runtimeConfigCrc32(in, RUNTIME_CONFIG_RECORD_SIZE - 4)) {
+    return RUNTIME_CONFIG_BAD_CRC;
+  }
+  RuntimeConfig decoded = defaults;
+  const uint8_t *p = in + 8;
+  for (size_t i = 0; i < PARAM_COUNT; i++) {
+    const RuntimeConfigParam &param = PARAMS[i];
+    for (uint8_t e = 0; e < param.count; e++) {
+      uint32_t v;
+      if (param.type == RUNTIME_CONFIG_U8) v = *p;
+      else if (param.type == RUNTIME_CONFIG_U16) v = get16(p);
+      else v = get32(p);
+      writeElement(decoded, param, e, v);
+      p += typeBytes(param.type);
+    }
+  }
+  const RuntimeConfigResult check = runtimeConfigCheck(decoded);
+  if (check != RUNTIME_CONFIG_OK) return check;
+  config = decoded;
+  return RUNTIME_CONFIG_OK;
+}
+
+// --- config ---
+
+void initRuntimeConfig() {
+  defaults.activeEnterThreshold = ACTIVE_ENTER_THRESHOLD;
+  defaults.activeExitThreshold = ACTIVE_EXIT_THRESHOLD;
+  defaults.activeEnterFloorPct = ACTIVE_ENTER_FLOOR_PCT;
+  defaults.activeExitFloorPct = ACTIVE_EXIT_FLOOR_PCT;
+  defaults.activeEnterDebounceMs = ACTIVE_ENTER_DEBOUNCE_MS;
+  defaults.idleTimeoutMs = IDLE_TIMEOUT_MS;
+  defaults.idleCalibrationWarmupMs = IDLE_CALIBRATION_WARMUP_MS;
+  defaults.beatLeadMs = BEAT_LEAD_MS;
+  defaults.beatAccentMs = BEAT_ACCENT_MS;
+  defaults.beatAccentPct = BEAT_ACCENT_PCT;
+  defaults.sampleStallTimeoutMs = SAMPLE_STALL_TIMEOUT_MS;
+  defaults.sampleJitterFaultCount = SAMPLE_JITTER_FAULT_COUNT;
+  defaults.sampleJitterWindowMs = SAMPLE_JITTER_WINDOW_MS;
+  for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+    defaults.motorCurve[ch] = CHANNEL_DEFAULTS[ch].curve;
+    defaults.motorMotion[ch] = CHANNEL_DEFAULTS[ch].motion;
+  }
+
+  active = pending = defaults;
+  bootLoadResult = runtimeConfigLoad();
+  active = pending;
+  pendingChanged = false;
+  generation = 0;
+}
+
+const RuntimeConfig &runtimeConfig() {
+  return active;
+}
+
+const RuntimeConfig &runtimeConfigPending() {
+  return pending;
+}
+
+const RuntimeConfig &runtimeConfigDefaults() {
+  return defaults;
+}
+
+bool runtimeConfigApplyPending() {
+  if (!pendingChanged) return false;
+  pendingChanged = false;
+  if (memcmp(&active, &pending, sizeof(active)) == 0) return false;
+  active = pending;
+  generation++;
+  return true;
+}
+
+uint32_t runtimeConfigGeneration() {
+  return generation;
+}
+
+RuntimeConfigResult runtimeConfigCheck(const RuntimeConfig &config) {
+  for (size_t i = 0; i < PARAM_COUNT; i++) {
+    for (uint8_t e = 0; e < PARAMS[i].count; e++) {
+      const uint32_t v = readElement(config, PARAMS[i], e);
+      if (v < PARAMS[i].minValue || v > PARAMS[i].maxValue) return RUNTIME_CONFIG_OUT_OF_RANGE;
+    }
+  }
+  if (config.activeEnterThreshold <= config.activeExitThreshold) return RUNTIME_CONFIG_INCONSISTENT;
+  if (config.activeEnterFloorPct <= config.activeExitFloorPct) return RUNTIME_CONFIG_INCONSISTENT;
+  for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+    if (config.motorCurve[ch] >= getMotorCurveCount()) return RUNTIME_CONFIG_INCONSISTENT;
+    if (config.motorMotion[ch] >= getMotorMotionCount()) return RUNTIME_CONFIG_INCONSISTENT;
+  }
+  return RUNTIME_CONFIG_OK;
+}
+
+RuntimeConfigResult runtimeConfigStage(const RuntimeConfig &config) {
+  const RuntimeConfigResult check = runtimeConfigCheck(config);
+  if (check != RUNTIME_CONFIG_OK) return check;
+  pending = config;
+  pendingChanged = true;
+  return RUNTIME_CONFIG_OK;
+}
+
+RuntimeConfigResult runtimeConfigGet(const char *name, uint32_t &value) {
+  uint8_t index = 0;
+  const RuntimeConfigParam *param = findParam(name, index);
+  if (param == nullptr) return RUNTIME_CONFIG_UNKNOWN_NAME;
+  value = readElement(pending, *param, index);
+  return RUNTIME_CONFIG_OK;
+}
+
+RuntimeConfigResult runtimeConfigSet(const char *name, uint32_t value) {
+  uint8_t index = 0;
+  const RuntimeConfigParam *param = findParam(name, index);
+  if (param == nullptr) return RUNTIME_CONFIG_UNKNOWN_NAME;
+  if (value < param->minValue || value > param->maxValue) return RUNTIME_CONFIG_OUT_OF_RANGE;
+  RuntimeConfig edited = pending;
+  writeElement(edited, *param, index, value);
+  return runtimeConfigStage(edited);
+}
+
+RuntimeConfigResult runtimeConfigLoad() {
+  uint8_t record[RUNTIME_CONFIG_RECORD_SIZE];
+  if (!configStoreRead(record, sizeof(record))) return RUNTIME_CONFIG_NOT_STORED;
+  RuntimeConfig stored;
+  const RuntimeConfigResult result = runtimeConfigDecode(record, stored);
+  if (result != RUNTIME_CONFIG_OK) return result;
+  return runtimeConfigStage(stored);
+}
+
+RuntimeConfigResult runtimeConfigSave() {
+  uint8_t record[RUNTIME_CONFIG_RECORD_SIZE];
+  runtimeConfigEncode(pending, record);
+  return configStoreWrite(record, sizeof(record)) ? RUNTIME_CONFIG_OK : RUNTIME_CONFIG_STORE_FAILED;
+}
+
+RuntimeConfigResult runtimeConfigLoadResult() {
+  return bootLoadResult;
+}
+
+const char *runtimeConfigResultText(RuntimeConfigResult result) {
+  switch (result) {
+    case RUNTIME_CONFIG_OK: return "ok";
+    case RUNTIME_CONFIG_UNKNOWN_NAME: return "unknown name";
+    case RUNTIME_CONFIG_OUT_OF_RANGE: return "out of range";
+    case RUNTIME_CONFIG_INCONSISTENT: return "inconsistent (enter <= exit threshold or floor %, or no such profile)";
+    case RUNTIME_CONFIG_NOT_STORED: return "nothing stored";
+    case RUNTIME_CONFIG_BAD_RECORD: return "stored record from another version";
+    case RUNTIME_CONFIG_BAD_CRC: return "stored record corrupt (CRC)";
+    case RUNTIME_CONFIG_STORE_FAILED: return "storage write failed";
+  }
+  return "?";
+}
+
+size_t getRuntimeConfigParamCount() {
+  return PARAM_COUNT;
+}
+
+const RuntimeConfigParam &getRuntimeConfigParam(size_t index) {
+  return PARAMS[index < PARAM_COUNT ? index : 0];
+}
+
+// --- serial console ---
+
+static const size_t COMMAND_MAX = 63;
+static char command[COMMAND_MAX + 1];
+static size_t commandLen = 0;
+static bool inCommand = false;
+static bool commandOverflow = false;
+static bool commandWaiting = false;  // complete, waiting for the previous reply
+
+// Reply in progress: a single line, or $list one element per line.
+static char replyBuf[120];
+static size_t replyLen = 0;
+static size_t replySent = 0;
+static bool replyActive = false;
+static bool listing = false;
+static size_t listParam = 0;
+static uint8_t listElement = 0;
+
+static void reply(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const int n = vsnprintf(replyBuf, sizeof(replyBuf), fmt, args);
+  va_end(args);
+  replyLen = (n < 0) ? 0 : ((size_t)n < sizeof(replyBuf) ? (size_t)n : sizeof(replyBuf) - 1);
+  replySent = 0;
+  replyActive = true;
+}
+
+static void replyResult(const char *what, RuntimeConfigResult result) {
+  if (result == RUNTIME_CONFIG_OK) {
+    reply("cfg %s\n", what);
+  } else {
+    reply("cfg error: %s\n", runtimeConfigResultText(result));
+  }
+}
+
+// Format the next $list line; false once every element is listed.
+static bool nextListLine() {
+  if (listParam >= PARAM_COUNT) return false;
+  const RuntimeConfigParam &p = PARAMS[listParam];
+  char name[48];
+  if (!p.perChannel) snprintf(name, sizeof(name), "%s", p.name);
+  else snprintf(name, sizeof(name), "%s.%u", p.name, (unsigned)listElement);
+  reply("cfg %s=%lu [%lu..%lu]\n", name, (unsigned long)readElement(pending, p, listElement),
+        (unsigned long)p.minValue, (unsigned long)p.maxValue);
+  if (++listElement >= p.count) {
+    listElement = 0;
+    listParam++;
+  }
+  return true;
+}
+
+static void runCommand(char *line) {
+  char *verb = strtok(line, " \t");
+  char *name = strtok(nullptr, " \t");
+  char *value = strtok(nullptr, " \t");
+  if (verb == nullptr) verb = line;  // empty line
+
+  if (strcmp(verb, "list") == 0) {
+    listing = true;
+    listParam = 0;
+    listElement = 0;
+    const char *origin = (generation != 0 || pendingChanged) ? "changed since boot"
+                         : (bootLoadResult == RUNTIME_CONFIG_OK ? "loaded from storage" : "defaults");
+    reply("cfg v%u %s; $set applies next tick, $save keeps it\n", (unsigned)RUNTIME_CONFIG_VERSION, origin);
+  } else if (strcmp(verb, "get") == 0 && name != nullptr) {
+    uint32_t v = 0;
+    const RuntimeConfigResult result = runtimeConfigGet(name, v);
+    if (result == RUNTIME_CONFIG_OK) reply("cfg %s=%lu\n", name, (unsigned long)v);
+    else replyResult("get", result);
+  } else if (strcmp(verb, "set") == 0 && name != nullptr && value != nullptr) {
+    char *end = nullptr;
+    errno = 0;
+    const unsigned long v = strtoul(value, &end, 10);
+    // Past 32 bits strtoul() saturates with ERANGE where unsigned long is 32 bits, and
+    // does not truncate-check at all where it is 64 (the host): refuse both alike.
+    const bool parsed = end != value && *end == '\0' && value[0] != '-' && errno != ERANGE && (uint32_t)v == v;
+    const RuntimeConfigResult result = parsed ? runtimeConfigSet(name, (uint32_t)v) : RUNTIME_CONFIG_OUT_OF_RANGE;
+    if (result == RUNTIME_CONFIG_OK) reply("cfg %s=%lu (pending)\n", name, v);
+    else replyResult("set", result);
+  } else if (strcmp(verb, "save") == 0) {
+    replyResult("saved", runtimeConfigSave());
+  } else if (strcmp(verb, "load") == 0) {
+    replyResult("loaded (pending)", runtimeConfigLoad());
+  } else if (strcmp(verb, "defaults") == 0) {
+    replyResult("defaults (pending)", runtimeConfigStage(defaults));
+  } else {
+    reply("cfg error: %s\n", "commands: $list, $get <name>, $set <name> <value>, $save, $load, $defaults");
+  }
+}
+
+static void finishCommand() {
+  command[commandLen] = '\0';
+  if (commandOverflow) {
+    reply("cfg error: %s\n", "line too long");
+  } else {
+    runCommand(command);
+  }
+  commandLen = 0;
+  commandOverflow = false;
+}
+
+bool runtimeConfigConsoleFeed(char c) {
+  if (!inCommand) {
+    if (c != '$') return false;
+    inCommand = true;
+    commandLen = 0;
+    commandOverflow = false;
+    return true;
+  }
+  if (c == '\r' || c == '\n') {
+    inCommand = false;
+    if (replyActive) commandWaiting = true;
+    else finishCommand();
+  } else if (commandLen < COMMAND_MAX) {
+    command[commandLen++] = c;
+  } else {
+    commandOverflow = true;
+  }
+  return true;
+}
+
+bool runtimeConfigConsoleBusy() {
+  return commandWaiting;
+}
+
+bool runtimeConfigReplyPending() {
+  return replyActive || commandWaiting;
+}
+
+bool runtimeConfigServiceReply() {
+  while (replyActive || commandWaiting) {
+    if (!replyActive) {
+      commandWaiting = false;
+      finishCommand();
+      continue;
+    }
+    const int room = Serial.availableForWrite();
+    if (room <= 0) return true;
+    size_t chunk = replyLen - replySent;
+    if (chunk > (size_t)room) chunk = (size_t)room;
+    Serial.write(reinterpret_cast<const uint8_t *>(replyBuf) + replySent, chunk);
+    replySent += chunk;
+    if (replySent < replyLen) return true;
+    replyActive = false;
+    if (listing && !nextListLine()) listing = false;
+  }
+  return false;
+}
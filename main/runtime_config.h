@@ -0,0 +1,162 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * Tuning values that can change at runtime, over Serial, without reflashing.
+ *
+ * Defaults come from config.h. The firmware reads the active copy, runtimeConfig(),
+ * from RAM; storage is touched only at boot and on an explicit save. Changes are
+ * staged in a pending copy and validated there; the supervisor swaps the pending
+ * copy in with runtimeConfigApplyPending() at the start of its tick, so a tick never
+ * sees half of an edit (the cooperative scheduler runs tasks to completion).
+ *
+ * Persistence (config_store.h) is one record, little-endian:
+ *   u32 magic (RUNTIME_CONFIG_MAGIC)
+ *   u16 version (RUNTIME_CONFIG_VERSION)
+ *   u16 payload length
+ *   payload: every parameter in table order (u8 / u16 / u32 each)
+ *   u32 CRC-32 (IEEE, reflected, as zlib) over everything before it
+ * A record that is missing, from another version or layout, fails its CRC or holds
+ * out-of-range values is ignored and the defaults are used. Bump
+ * RUNTIME_CONFIG_VERSION whenever the parameter table changes.
+ *
+ * Serial console: a line starting with '$' is a config command (other characters
+ * stay single-key supervisor commands). Replies are "cfg ..." text lines, written
+ * between telemetry frames.
+ *   $list                  every parameter: value and range
+ *   $get <name>            one parameter (motor parameters: <name>.<channel>)
+ *   $set <name> <value>    stage a change; it applies at the next supervisor tick
+ *   $save                  write the pending config to storage (blocks while flash programs)
+ *   $load                  stage the stored config
+ *   $defaults              stage the config.h defaults (storage unchanged until $save)
+ */
+
+#define RUNTIME_CONFIG_MAGIC 0x4746434BUL  // "KCFG"
+#define RUNTIME_CONFIG_VERSION 3
+
+struct RuntimeConfig {
+  // Supervisor thresholds (amplitude: at least ADC counts, and % of the noise floor)
+  // and timing (ms)
+  uint16_t activeEnterThreshold;
+  uint16_t activeExitThreshold;
+  uint16_t activeEnterFloorPct;
+  uint16_t activeExitFloorPct;
+  uint16_t activeEnterDebounceMs;
+  uint32_t idleTimeoutMs;
+  uint16_t idleCalibrationWarmupMs;
+  // Beat-synchronous motion (ms, % of the level; 0 %: off)
+  uint16_t beatLeadMs;
+  uint16_t beatAccentMs;
+  uint16_t beatAccentPct;
+  // Health monitoring
+  uint16_t sampleStallTimeoutMs;
+  uint16_t sampleJitterFaultCount;  // 0: statistics only
+  uint16_t sampleJitterWindowMs;
+  // Per motor channel: response curve and motion profile indices
+  uint8_t motorCurve[MOTOR_CHANNELS];
+  uint8_t motorMotion[MOTOR_CHANNELS];
+};
+
+enum RuntimeConfigType {
+  RUNTIME_CONFIG_U8,
+  RUNTIME_CONFIG_U16,
+  RUNTIME_CONFIG_U32
+};
+
+// One named parameter: a single value, or one per motor channel ("name.<channel>").
+struct RuntimeConfigParam {
+  const char *name;
+  uint8_t type;  // RuntimeConfigType
+  bool perChannel;
+  uint8_t count;  // MOTOR_CHANNELS per channel, else 1
+  uint16_t offset;  // into RuntimeConfig
+  uint32_t minValue;
+  uint32_t maxValue;
+};
+
+enum RuntimeConfigResult {
+  RUNTIME_CONFIG_OK = 0,
+  RUNTIME_CONFIG_UNKNOWN_NAME,
+  RUNTIME_CONFIG_OUT_OF_RANGE,
+  RUNTIME_CONFIG_INCONSISTENT,  // each value in range, but not together (e.g. enter <= exit)
+  RUNTIME_CONFIG_NOT_STORED,    // storage empty or unreadable
+  RUNTIME_CONFIG_BAD_RECORD,    // wrong magic, version or length
+  RUNTIME_CONFIG_BAD_CRC,
+  RUNTIME_CONFIG_STORE_FAILED
+};
+
+// Payload bytes of the parameter table, and the whole stored record.
+static const size_t RUNTIME_CONFIG_PAYLOAD_SIZE = 2 + 2 + 2 + 2 + 2 + 4 + 2 + 2 + 2 + 2 + 2 + 2 + 2 + 2 * MOTOR_CHANNELS;
+static const size_t RUNTIME_CONFIG_RECORD_SIZE = 8 + RUNTIME_CONFIG_PAYLOAD_SIZE + 4;
+
+// Defaults, then the stored config if it is valid (see runtimeConfigLoadResult()).
+void initRuntimeConfig();
+
+// The config in effect. Hot paths read this, never storage.
+const RuntimeConfig &runtimeConfig();
+
+// The config that becomes active at the next runtimeConfigApplyPending().
+const RuntimeConfig &runtimeConfigPending();
+
+// The config.h defaults.
+const RuntimeConfig &runtimeConfigDefaults();
+
+// Make the pending config active if it changed. Call between ticks; returns true
+// if the active config changed.
+bool runtimeConfigApplyPending();
+
+// +1 every time the active config changes (0 after init).
+uint32_t runtimeConfigGeneration();
+
+// Every value in range and consistent with the others and with the compiled-in
+// curve and motion profiles.
+RuntimeConfigResult runtimeConfigCheck(const RuntimeConfig &config);
+
+// Stage a whole config (rejected unless runtimeConfigCheck() passes).
+RuntimeConfigResult runtimeConfigStage(const RuntimeConfig &config);
+
+// Read / stage one parameter element by name: "name", or "name.<channel>" for
+// per-motor parameters (a plain name means channel 0). Get reads the pending config.
+RuntimeConfigResult runtimeConfigGet(const char *name, uint32_t &value);
+RuntimeConfigResult runtimeConfigSet(const char *name, uint32_t value);
+
+// Stage the stored config / write the pending one.
+RuntimeConfigResult runtimeConfigLoad();
+RuntimeConfigResult runtimeConfigSave();
+
+// What initRuntimeConfig() found in storage (RUNTIME_CONFIG_OK: it was loaded).
+RuntimeConfigResult runtimeConfigLoadResult();
+
+const char *runtimeConfigResultText(RuntimeConfigResult result);
+
+// The parameter table.
+size_t getRuntimeConfigParamCount();
+const RuntimeConfigParam &getRuntimeConfigParam(size_t index);
+
+// Record encoding (out / in: RUNTIME_CONFIG_RECORD_SIZE bytes).
+void runtimeConfigEncode(const RuntimeConfig &config, uint8_t *out);
+RuntimeConfigResult runtimeConfigDecode(const uint8_t *in, RuntimeConfig &config);
+uint32_t runtimeConfigCrc32(const uint8_t *data, size_t length);
+
+// --- Serial console ---
+
+// Feed one received character. Returns true if it belongs to a '$' command line
+// (the caller handles it otherwise).
+bool runtimeConfigConsoleFeed(char c);
+
+// A complete command is waiting for the previous reply to be written; stop reading
+// Serial until it has run.
+bool runtimeConfigConsoleBusy();
+
+// Reply text is waiting to be written.
+bool runtimeConfigReplyPending();
+
+// Continue writing the reply without blocking; runs a waiting command once the
+// previous reply is out. Returns true while there is more to write.
+bool runtimeConfigServiceReply();
+
+#endif // RUNTIME_CONFIG_H
@@ -0,0 +1,77 @@
+#include "sample_jitter.h"
+
+#include <atomic>
+
+// Written by the ISR only, including the clear a reset asks for.
+static SampleJitterStats stats;
+static uint32_t lastCycles = 0;
+static bool havePrevious = false;
+static volatile bool resetRequested = true;
+
+// What the loop side sees while a reset is pending: no periods yet.
+static const SampleJitterStats CLEARED = {0, 0xFFFFFFFFUL, 0, 0, 0, 0, {}};
+
+// Single-core MCU: the ISR only interleaves with loop(), so a signal fence is enough
+// to keep the compiler from moving the stats updates across the period count.
+static inline void jitterFence() {
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+static const uint32_t LIMIT_CYCLES = (uint32_t)SAMPLE_JITTER_LIMIT_US * CYCLES_PER_MICROSECOND;
+
+void sampleJitterReset() {
+  resetRequested = true;
+}
+
+void sampleJitterRecord(uint32_t nowCycles, uint32_t nominalCycles) {
+  if (resetRequested) {
+    stats = CLEARED;
+    havePrevious = false;
+    resetRequested = false;
+  }
+  const uint32_t period = nowCycles - lastCycles;
+  lastCycles = nowCycles;
+  if (!havePrevious) {
+    havePrevious = true;
+    return;
+  }
+
+  const uint32_t jitter = (period >= nominalCycles) ? period - nominalCycles : nominalCycles - period;
+  if (period < stats.minPeriodCycles) stats.minPeriodCycles = period;
+  if (period > stats.maxPeriodCycles) stats.maxPeriodCycles = period;
+  stats.totalPeriodCycles += period;
+  if (jitter > stats.worstJitterCycles) stats.worstJitterCycles = jitter;
+  if (jitter > LIMIT_CYCLES) stats.overLimit++;
+  stats.histogram[cycleHistogramBucket(jitter, SAMPLE_JITTER_BUCKETS)]++;
+  jitterFence();
+  stats.periods++;  // last: getSampleMeanPeriodCycles() checks it around its read
+}
+
+const SampleJitterStats &getSampleJitterStats() {
+  // Nothing recorded since the reset yet; the ISR clears the stats on its next call.
+  return resetRequested ? CLEARED : stats;
+}
+
+uint32_t getSampleJitterOverLimitCount() {
+  return getSampleJitterStats().overLimit;
+}
+
+uint32_t getSampleJitterWorstMicros() {
+  return cyclesToMicros(getSampleJitterStats().worstJitterCycles);
+}
+
+uint32_t getSampleMeanPeriodCycles() {
+  // The 64-bit total takes two loads: retry if a period was recorded (or the stats
+  // cleared) between them, which changes the count read before and after.
+  for (int attempt = 0; attempt < 4; attempt++) {
+    const SampleJitterStats &st = getSampleJitterStats();
+    const uint32_t periods = st.periods;
+    jitterFence();
+    const uint64_t total = st.totalPeriodCycles;
+    jitterFence();
+    if (st.periods == periods) {
+      return periods ? (uint32_t)(total / periods) : 0;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef SAMPLE_JITTER_H
+#define SAMPLE_JITTER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "cycle_counter.h"
+
+/**
+ * Sampling period jitter: the sampling interrupt timestamps every delivery with the
+ * cycle counter, and each period is compared with its nominal length. The deviation
+ * |period - nominal| goes into a log2 histogram; the worst case and the number of
+ * periods beyond SAMPLE_JITTER_LIMIT_US are kept for reports and health checks.
+ *
+ * A sample delivered late shows up twice: one long period, then one short one.
+ *
+ * Producer: the sampling ISR, once per ADC conversion (or the block interrupt, which
+ * delivers SAMPLE_BLOCK_SIZE conversions per period). Consumers read single 32-bit
+ * fields, so each value is consistent on its own; a report may mix values from two
+ * periods. The 64-bit total is only read through getSampleMeanPeriodCycles(), which
+ * checks the period count around it.
+ */
+
+static const int SAMPLE_JITTER_BUCKETS = 16;  // up to 2^15 cycles = 680us at 48MHz
+
+struct SampleJitterStats {
+  uint32_t periods;           // periods measured
+  uint32_t minPeriodCycles;
+  uint32_t maxPeriodCycles;
+  uint64_t totalPeriodCycles;  // two loads on the target: use getSampleMeanPeriodCycles()
+  uint32_t worstJitterCycles;  // largest |period - nominal|
+  uint32_t overLimit;          // periods with |period - nominal| > SAMPLE_JITTER_LIMIT_US
+  uint32_t histogram[SAMPLE_JITTER_BUCKETS];  // of |period - nominal|, see cycleHistogramBucket()
+};
+
+// Nominal cycles between two ADC conversions (samples, unless ADC_OVERSAMPLING > 1).
+static const uint32_t SAMPLE_PERIOD_CYCLES = CYCLE_COUNTER_HZ / ((uint32_t)SAMPLE_RATE * ADC_OVERSAMPLING);
+
+// Clear the statistics. Safe while the ISR runs: only the ISR clears them, on its
+// next call, which then only takes a timestamp (there is no previous one to compare
+// to). Until then the loop side reads cleared statistics.
+void sampleJitterReset();
+
+// ISR side: a delivery happened at `nowCycles`, `nominalCycles` after the previous one.
+void sampleJitterRecord(uint32_t nowCycles, uint32_t nominalCycles);
+
+// Loop side.
+const SampleJitterStats &getSampleJitterStats();
+uint32_t getSampleJitterOverLimitCount();
+uint32_t getSampleJitterWorstMicros();
+
+// Mean period in cycles (0 before the first period).
+uint32_t getSampleMeanPeriodCycles();
+
+#endif // SAMPLE_JITTER_H
@@ -0,0 +1,172 @@
+#include "sample_ring.h"
+#include "config.h"
+
+#include <atomic>
+
+static_assert((SAMPLE_RING_SIZE & (SAMPLE_RING_SIZE - 1)) == 0, "SAMPLE_RING_SIZE must be a power of two");
+static_assert(SAMPLE_RING_SIZE >= 2, "SAMPLE_RING_SIZE must be at least 2");
+
+static const uint32_t RING_MASK = SAMPLE_RING_SIZE - 1;
+
+// Slot storage is written only by the producer and read only after the matching
+// head update is observed, so the slots themselves do not need to be volatile.
+static int ringSlots[SAMPLE_RING_SIZE];
+
+// head: written by the ISR only. tail: written by the consumer only.
+static volatile uint32_t ringHead = 0;
+static volatile uint32_t ringTail = 0;
+
+// Counters owned by the producer. sampleRingReset() only asks for them to be
+// cleared; the producer does it before its next push.
+static volatile unsigned long ringOverruns = 0;
+static volatile unsigned ringHighWater = 0;
+static volatile bool countersResetRequested = false;
+
+// Samples published since boot, saturating at SAMPLE_RING_SIZE (once there, every slot
+// holds a sample). Written by the producer only; unlike the head it never wraps.
+static volatile uint32_t ringPublished = 0;
+
+// Single-core MCU: the ISR and loop() never run in parallel, they only interleave.
+// A signal fence stops the compiler from reordering slot accesses across the
+// head/tail updates, which is all the ordering an ISR/mainline pair needs.
+static inline void ringFence() {
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+void sampleRingReset() {
+  ringTail = ringHead;
+  countersResetRequested = true;
+  ringFence();
+}
+
+void sampleRingRestartAt(uint32_t seq) {
+  ringHead = seq;
+  ringTail = seq;
+  ringPublished = 0;
+  ringOverruns = 0;
+  ringHighWater = 0;
+  countersResetRequested = false;
+  ringFence();
+}
+
+static inline void notePublished(uint32_t n) {
+  const uint32_t published = ringPublished;
+  if (published < SAMPLE_RING_SIZE) {
+    ringPublished = (n < SAMPLE_RING_SIZE - published) ? published + n : SAMPLE_RING_SIZE;
+  }
+}
+
+static inline void applyCountersReset() {
+  if (!countersResetRequested) return;
+  ringOverruns = 0;
+  ringHighWater = 0;
+  countersResetRequested = false;
+}
+
+bool sampleRingPush(int sample) {
+  applyCountersReset();
+  const uint32_t head = ringHead;
+  const uint32_t used = head - ringTail;
+  if (used >= SAMPLE_RING_SIZE) {
+    ringOverruns = ringOverruns + 1;
+    return false;
+  }
+
+  ringSlots[head & RING_MASK] = sample;
+  ringFence();
+  ringHead = head + 1;
+  notePublished(1);
+
+  if (used + 1 > ringHighWater) ringHighWater = used + 1;
+  return true;
+}
+
+unsigned sampleRingPushBlock(const uint16_t *samples, unsigned count) {
+  applyCountersReset();
+  const uint32_t head = ringHead;
+  const uint32_t used = head - ringTail;
+  const uint32_t space = SAMPLE_RING_SIZE - used;
+  const unsigned accepted = (count < space) ? count : (unsigned)space;
+  if (accepted < count) ringOverruns = ringOverruns + (count - accepted);
+
+  for (unsigned i = 0; i < accepted; i++) {
+    ringSlots[(head + i) & RING_MASK] = samples[i];
+  }
+  ringFence();
+  ringHead = head + accepted;
+  notePublished(accepted);
+
+  if (used + accepted > ringHighWater) ringHighWater = used + accepted;
+  return accepted;
+}
+
+unsigned sampleRingAvailable() {
+  return (unsigned)(ringHead - ringTail);
+}
+
+bool sampleRingPop(int *sample) {
+  const uint32_t tail = ringTail;
+  if (ringHead == tail) return false;
+  ringFence();
+  *sample = ringSlots[tail & RING_MASK];
+  ringFence();
+  ringTail = tail + 1;
+  return true;
+}
+
+unsigned sampleRingDrain(int *dst, unsigned maxCount, uint32_t *firstSeq) {
+  const uint32_t tail = ringTail;
+  unsigned n = (unsigned)(ringHead - tail);
+  if (n > maxCount) n = maxCount;
+  ringFence();
+
+  for (unsigned i = 0; i < n; i++) {
+    dst[i] = ringSlots[(tail + i) & RING_MASK];
+  }
+  if (firstSeq) *firstSeq = tail;
+
+  ringFence();
+  ringTail = tail + n;
+  return n;
+}
+
+unsigned sampleRingSnapshot(int *dst, unsigned count, uint32_t *endSeq) {
+  if (count == 0 || count >= SAMPLE_RING_SIZE) return 0;
+
+  // Seqlock-style read: the slots for [h1 - count, h1) are valid if the producer
+  // has not published (or started writing) anything that wraps onto them.
+  // Not enough samples published since boot (the head alone cannot tell: it wraps).
+  if (count > ringPublished) return 0;
+
+  for (int attempt = 0; attempt < 4; attempt++) {
+    const uint32_t h1 = ringHead;
+    ringFence();
+
+    const uint32_t start = h1 - count;
+    for (unsigned i = 0; i < count; i++) {
+      dst[i] = ringSlots[(start + i) & RING_MASK];
+    }
+
+    ringFence();
+    const uint32_t h2 = ringHead;
+    // A write in progress at h2 targets slot (h2 - SIZE); count it as a conflict too.
+    if ((h2 + 1) - start <= SAMPLE_RING_SIZE) {
+      if (endSeq) *endSeq = h1;
+      return count;
+    }
+  }
+  return 0;
+}
+
+uint32_t sampleRingHeadSequence() {
+  return ringHead;
+}
+
+// A reset the producer has not applied yet reads as cleared counters.
+unsigned long getSampleRingOverrunCount() {
+  return countersResetRequested ? 0 : ringOverruns;
+}
+
+unsigned getSampleRingHighWaterMark() {
+  return countersResetRequested ? 0 : ringHighWater;
+}
@@ -0,0 +1,65 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer/single-consumer ring for raw audio samples.
+ *
+ * Producer: the sampling ISR (audioTimerCallback) calls sampleRingPush(), or the
+ * block-capture interrupt (sampling_hal.h) calls sampleRingPushBlock().
+ * Consumer: loop() context (processAudio) drains with sampleRingPop()/sampleRingDrain().
+ *
+ * Head and tail are free-running 32-bit sequence numbers; the slot index is
+ * (sequence & (SAMPLE_RING_SIZE - 1)), so SAMPLE_RING_SIZE must be a power of two.
+ * When the ring is full the ISR drops the new sample and counts an overrun
+ * (the producer never touches the consumer's tail), so every sample that is
+ * accepted is delivered exactly once.
+ */
+
+// Reset the ring: a consumer-side flush (tail := head), so it is safe to call while
+// the sampling ISR is running. The producer's overrun and high-water counters are
+// cleared by the producer itself on its next push, and read as 0 until then.
+void sampleRingReset();
+
+// Producer (ISR) side. Returns false and counts an overrun if the ring is full.
+bool sampleRingPush(int sample);
+
+// Producer side, a whole block at once: copies as many samples as fit and publishes
+// them with a single head update. Samples that do not fit are dropped (the newest
+// ones) and counted as overruns. Returns the number of samples accepted.
+unsigned sampleRingPushBlock(const uint16_t *samples, unsigned count);
+
+// Consumer side: number of samples waiting to be processed.
+unsigned sampleRingAvailable();
+
+// Consumer side: pop one sample. Returns false if the ring is empty.
+bool sampleRingPop(int *sample);
+
+// Consumer side: pop up to maxCount samples into dst in arrival order.
+// If firstSeq is non-null it receives the sequence number of dst[0].
+// Returns the number of samples copied.
+unsigned sampleRingDrain(int *dst, unsigned maxCount, uint32_t *firstSeq);
+
+// Copy the most recent `count` published samples (oldest first) into dst without
+// consuming them. The copy is validated against the producer's sequence number and
+// retried if the ISR overwrote any slot mid-copy, so dst is never torn.
+// count must be < SAMPLE_RING_SIZE. If endSeq is non-null it receives the sequence
+// number one past dst[count - 1]. Returns count, or 0 if fewer than count samples were
+// published since boot or no consistent copy was possible.
+unsigned sampleRingSnapshot(int *dst, unsigned count, uint32_t *endSeq);
+
+// Sequence number of the next sample the ISR will publish (== samples accepted since reset).
+uint32_t sampleRingHeadSequence();
+
+// Empty the ring, forget what it held and number the next sample `seq` (for tests, e.g.
+// a sequence number about to wrap). Not safe while the producer runs.
+void sampleRingRestartAt(uint32_t seq);
+
+// Samples dropped because the ring was full.
+unsigned long getSampleRingOverrunCount();
+
+// Maximum ring occupancy observed since reset.
+unsigned getSampleRingHighWaterMark();
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,42 @@
+#ifndef SAMPLING_HAL_H
+#define SAMPLING_HAL_H
+
+#include <stdint.h>
+
+class FspTimer;
+
+/**
+ * Block sampling HAL (SAMPLING_BACKEND_BLOCK_DMA in config.h).
+ *
+ * The sampling timer runs without an interrupt of its own. Each period its overflow
+ * event starts one ADC conversion through the event link controller (ELC), and the
+ * conversion-end event triggers a DMA transfer of the result into one half of a
+ * ping-pong buffer. When a half holds SAMPLE_BLOCK_SIZE samples, DMA moves on to the
+ * other half and raises the only interrupt, which hands the full half to the block
+ * handler. The CPU takes one interrupt per block instead of one per sample and never
+ * busy-waits on a conversion, which is what makes 8-16kHz sample rates practical.
+ *
+ * The handler runs in interrupt context and must be done with the block before the
+ * other half fills (SAMPLE_BLOCK_SIZE sample periods); copying it into the sample
+ * ring is the intended use.
+ *
+ * Implementations:
+ * - sampling_hal_ra4m1.cpp: UNO R4 (GPT -> ELC -> ADC0 -> DMAC)
+ * - tests/sampling_hal_host.cpp: desktop; each timer period "converts" the simulated
+ *   analog input on the virtual clock, so blocks carry exactly-timed samples
+ */
+
+typedef void (*SampleBlockHandler)(const uint16_t *samples, uint16_t count);
+
+// Link the periodic timer `timer` (GPT channel `timerChannel`, begun at the sample rate
+// but not yet started) to conversions of analog input `pin`. Sampling starts with the
+// timer. Returns false if the ADC / DMA could not be set up.
+bool samplingHalBegin(FspTimer &timer, uint8_t timerChannel, int pin, SampleBlockHandler onBlock);
+
+// Unlink the timer and release the ADC / DMA (the timer itself is left to the caller).
+void samplingHalEnd();
+
+// Blocks handed to the handler since samplingHalBegin().
+unsigned long samplingHalBlockCount();
+
+#endif // SAMPLING_HAL_H
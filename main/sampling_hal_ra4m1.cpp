@@ -0,0 +1,121 @@
+#include "sampling_hal.h"
+#include "config.h"
+
+// UNO R4 (RA4M1) implementation of the block sampling HAL. Only built for the
+// Renesas core with the block backend selected; the desktop build links
+// tests/sampling_hal_host.cpp instead.
+#if defined(ARDUINO_ARCH_RENESAS) && SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+
+#include <Arduino.h>
+#include <FspTimer.h>
+#include <IRQManager.h>
+#include <pinDefinitions.h>
+#include "r_dmac.h"
+
+// Register values not covered by the FSP calls used here (RA4M1 hardware manual).
+static const uint8_t ADSTRGR_TRSA_ELC_AD00 = 0x09;     // ADC0 start trigger: ELC_AD00
+static const uint8_t ADCER_ADPRC_10BIT = 0x1;          // 10-bit results, same as analogRead()
+static const uint8_t ADCER_ADPRC_14BIT = 0x3;          // 14-bit results (ADC_OVERSAMPLING > 1)
+static const unsigned ELC_EVENTS_PER_GPT_CHANNEL = 8;  // GPTn events are 8 apart in elc_event_t
+static const uint8_t DMA_CHANNEL = 0;
+static const uint8_t DMA_IRQ_PRIORITY = 12;
+
+static uint16_t blockBuffer[2][SAMPLE_BLOCK_SIZE];
+static volatile uint8_t fillingHalf = 0;
+static volatile unsigned long blockCount = 0;
+static SampleBlockHandler blockHandler = nullptr;
+static const volatile uint16_t *adcResult = nullptr;
+
+static dmac_instance_ctrl_t dmaCtrl;
+static transfer_info_t dmaInfo;
+static dmac_extended_cfg_t dmaExtend;
+static const transfer_cfg_t dmaCfg = {&dmaInfo, &dmaExtend};
+static bool dmaOpen = false;
+
+// DMA transfer end: the filling half is full. Re-arm DMA on the other half first
+// (the next conversion is one sample period away), then hand the full one over.
+static void blockDone(dmac_callback_args_t *args) {
+  (void)args;
+  const uint8_t full = fillingHalf;
+  fillingHalf = full ^ 1;
+  R_DMAC_Reset(&dmaCtrl, (void const *)adcResult, blockBuffer[full ^ 1], SAMPLE_BLOCK_SIZE);
+  blockCount = blockCount + 1;
+  if (blockHandler != nullptr) blockHandler(blockBuffer[full], SAMPLE_BLOCK_SIZE);
+}
+
+bool samplingHalBegin(FspTimer &timer, uint8_t timerChannel, int pin, SampleBlockHandler onBlock) {
+  (void)timer;  // linked by GPT channel; the timer only has to be begun (and started later)
+
+  std::array<uint16_t, 3> pinCfg = getPinCfgs(pin, PIN_CFG_REQ_ADC);
+  if (pinCfg[0] == 0 || IS_ADC1(pinCfg[0])) return false;  // only ADC0 is linked below
+  const uint8_t adcChannel = GET_CHANNEL(pinCfg[0]);
+
+  blockHandler = onBlock;
+  blockCount = 0;
+  fillingHalf = 0;
+
+  // Let the core mux the pin and power up ADC0, then take over its scan setup:
+  // single scan of one channel, started by the ELC instead of software.
+  analogRead(pin);
+  R_ADC0->ADCSR = 0;
+  R_ADC0->ADANSA[0] = 0;
+  R_ADC0->ADANSA[1] = 0;
+  R_ADC0->ADANSA[adcChannel / 16] = (uint16_t)(1u << (adcChannel % 16));
+  R_ADC0->ADCER_b.ADPRC = (ADC_RESOLUTION_BITS == 14) ? ADCER_ADPRC_14BIT : ADCER_ADPRC_10BIT;
+  R_ADC0->ADCER_b.ADRFMT = 0;  // right-aligned
+  R_ADC0->ADSTRGR_b.TRSA = ADSTRGR_TRSA_ELC_AD00;
+  adcResult = &R_ADC0->ADDR[adcChannel];
+
+  // Timer overflow -> ADC0 conversion start.
+  R_ELC->ELSR[ELC_PERIPHERAL_ADC0].HA =
+      (uint16_t)(ELC_EVENT_GPT0_COUNTER_OVERFLOW + ELC_EVENTS_PER_GPT_CHANNEL * timerChannel);
+  R_ELC->ELCR = R_ELC_ELCR_ELCON_Msk;
+
+  // ADC0 scan end -> one 16-bit transfer from the result register into the filling
+  // half; the transfer-end interrupt fires after SAMPLE_BLOCK_SIZE of them.
+  dmaInfo.transfer_settings_word_b.dest_addr_mode = TRANSFER_ADDR_MODE_INCREMENTED;
+  dmaInfo.transfer_settings_word_b.repeat_area = TRANSFER_REPEAT_AREA_DESTINATION;
+  dmaInfo.transfer_settings_word_b.irq = TRANSFER_IRQ_END;
+  dmaInfo.transfer_settings_word_b.chain_mode = TRANSFER_CHAIN_MODE_DISABLED;
+  dmaInfo.transfer_settings_word_b.src_addr_mode = TRANSFER_ADDR_MODE_FIXED;
+  dmaInfo.transfer_settings_word_b.size = TRANSFER_SIZE_2_BYTE;
+  dmaInfo.transfer_settings_word_b.mode = TRANSFER_MODE_NORMAL;
+  dmaInfo.p_src = (void const *)adcResult;
+  dmaInfo.p_dest = blockBuffer[0];
+  dmaInfo.num_blocks = 0;
+  dmaInfo.length = SAMPLE_BLOCK_SIZE;
+
+  dmaExtend.offset = 0;
+  dmaExtend.src_buffer_size = 1;
+  dmaExtend.irq = FSP_INVALID_VECTOR;  // assigned by the core's IRQ manager
+  dmaExtend.ipl = DMA_IRQ_PRIORITY;
+  dmaExtend.channel = DMA_CHANNEL;
+  dmaExtend.p_callback = blockDone;
+  dmaExtend.p_context = nullptr;
+  dmaExtend.activation_source = ELC_EVENT_ADC0_SCAN_END;
+
+  if (!IRQManager::getInstance().addDMA(dmaExtend)) return false;
+  if (R_DMAC_Open(&dmaCtrl, &dmaCfg) != FSP_SUCCESS) return false;
+  dmaOpen = true;
+  if (R_DMAC_Enable(&dmaCtrl) != FSP_SUCCESS) {
+    samplingHalEnd();
+    return false;
+  }
+
+  R_ADC0->ADCSR_b.TRGE = 1;  // accept the ELC trigger; conversions begin with the timer
+  return true;
+}
+
+void samplingHalEnd() {
+  R_ADC0->ADCSR_b.TRGE = 0;
+  R_ELC->ELSR[ELC_PERIPHERAL_ADC0].HA = 0;
+  if (dmaOpen) R_DMAC_Close(&dmaCtrl);
+  dmaOpen = false;
+  blockHandler = nullptr;
+}
+
+unsigned long samplingHalBlockCount() {
+  return blockCount;
+}
+
+#endif // ARDUINO_ARCH_RENESAS && SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
@@ -0,0 +1,125 @@
+#include "scheduler.h"
+#include <Arduino.h>
+
+struct Task {
+  const char *name;
+  TaskFn fn;
+  uint32_t periodUs;    // 0: event task
+  uint32_t deadlineUs;
+  uint32_t releaseUs;   // periodic: next release
+  volatile bool signaled;
+  volatile uint32_t signalUs;
+  TaskStats stats;
+};
+
+static Task tasks[TASK_COUNT];
+
+static const uint32_t US_PER_MS = 1000UL;
+
+// `t` is at or after `since` (modulo 2^32).
+static inline bool reached(uint32_t t, uint32_t since) {
+  return (int32_t)(t - since) >= 0;
+}
+
+void initScheduler() {
+  for (int i = 0; i < TASK_COUNT; i++) {
+    Task &t = tasks[i];
+    t.name = "";
+    t.fn = nullptr;
+    t.periodUs = 0;
+    t.deadlineUs = 0;
+    t.releaseUs = 0;
+    t.signaled = false;
+    t.signalUs = 0;
+    t.stats.runs = 0;
+    t.stats.misses = 0;
+    t.stats.worstResponseUs = 0;
+  }
+}
+
+void schedulerAddPeriodic(TaskId id, const char *name, TaskFn fn, uint32_t periodMs, uint32_t deadlineMs) {
+  Task &t = tasks[id];
+  t.name = name;
+  t.periodUs = (periodMs > 0 ? periodMs : 1) * US_PER_MS;
+  t.deadlineUs = (deadlineMs > 0) ? deadlineMs * US_PER_MS : t.periodUs;
+  t.releaseUs = (uint32_t)micros();
+  t.fn = fn;
+}
+
+void schedulerAddEvent(TaskId id, const char *name, TaskFn fn, uint32_t deadlineMs) {
+  Task &t = tasks[id];
+  t.name = name;
+  t.periodUs = 0;
+  t.deadlineUs = deadlineMs * US_PER_MS;
+  t.signaled = false;
+  t.fn = fn;
+}
+
+void schedulerSignal(TaskId id) {
+  Task &t = tasks[id];
+  if (t.signaled) return;
+  t.signalUs = (uint32_t)micros();
+  t.signaled = true;
+}
+
+bool schedulerRunReady() {
+  bool ran = false;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    Task &t = tasks[i];
+    if (t.fn == nullptr) continue;
+
+    uint32_t release;
+    if (t.periodUs == 0) {
+      if (!t.signaled) continue;
+      release = t.signalUs;
+      t.signaled = false;  // a signal during the run releases it again
+    } else {
+      const uint32_t now = (uint32_t)micros();
+      if (!reached(now, t.releaseUs)) continue;
+      // Releases that passed entirely while the CPU was busy are missed; run for the latest.
+      const uint32_t skipped = (now - t.releaseUs) / t.periodUs;
+      t.stats.misses += skipped;
+      release = t.releaseUs + skipped * t.periodUs;
+      t.releaseUs = release + t.periodUs;
+    }
+
+    t.fn();
+
+    const uint32_t response = (uint32_t)micros() - release;
+    t.stats.runs++;
+    if (response > t.stats.worstResponseUs) t.stats.worstResponseUs = response;
+    if (response > t.deadlineUs) t.stats.misses++;
+    ran = true;
+  }
+  return ran;
+}
+
+bool schedulerWorkPending() {
+  const uint32_t now = (uint32_t)micros();
+  for (int i = 0; i < TASK_COUNT; i++) {
+    const Task &t = tasks[i];
+    if (t.fn == nullptr) continue;
+    if (t.periodUs == 0 ? t.signaled : reached(now, t.releaseUs)) return true;
+  }
+  return false;
+}
+
+void schedulerSleep() {
+  // With interrupts masked, an interrupt that arrives between the check and the WFI
+  // still ends the sleep (it stays pending), and its handler runs right after.
+  __disable_irq();
+  if (!schedulerWorkPending()) __WFI();
+  __enable_irq();
+}
+
+const TaskStats &getTaskStats(TaskId id) {
+  return tasks[id].stats;
+}
+
+const char *getTaskName(TaskId id) {
+  return tasks[id].name;
+}
+
+uint32_t getTaskPeriodMs(TaskId id) {
+  return tasks[id].periodUs / US_PER_MS;
+}
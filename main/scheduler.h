@@ -0,0 +1,66 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * Cooperative run-to-completion scheduler for loop().
+ *
+ * Tasks are either periodic (released every periodMs, starting when they are added)
+ * or event-driven (released by schedulerSignal(), e.g. from the sampling interrupt).
+ * schedulerRunReady() runs every released task once, in TaskId order (lower id =
+ * higher priority); schedulerSleep() then halts the CPU (WFI) until the next
+ * interrupt, so loop() no longer spins polling millis() and the sample ring.
+ * Periodic releases are noticed on the 1ms millis() tick interrupt.
+ *
+ * Each task has a relative deadline. A run that completes more than deadlineMs after
+ * its release counts as a miss, and so does every periodic release that passed
+ * entirely while the CPU was busy elsewhere (the task then runs once, for the latest
+ * release, and keeps its original phase). Times are micros(), compared modulo 2^32.
+ *
+ * On the desktop build __WFI() advances the virtual clock to the next interrupt.
+ */
+
+enum TaskId {
+  TASK_AUDIO = 0,     // drain the sample ring (signaled by the sampling interrupt)
+  TASK_SUPERVISOR,    // FSM + motor control, every MOTOR_UPDATE_INTERVAL
+  TASK_SERIAL,        // serial commands and output flushing
+  TASK_STATUS,        // periodic telemetry / debug status
+  TASK_COUNT
+};
+
+typedef void (*TaskFn)();
+
+struct TaskStats {
+  uint32_t runs;
+  uint32_t misses;           // deadline misses, including skipped periodic releases
+  uint32_t worstResponseUs;  // longest release -> completion time
+};
+
+// Remove all tasks and clear their statistics.
+void initScheduler();
+
+// Periodic task, first released now. deadlineMs 0 means "by the next release".
+void schedulerAddPeriodic(TaskId id, const char *name, TaskFn fn, uint32_t periodMs, uint32_t deadlineMs = 0);
+
+// Event task, released by schedulerSignal().
+void schedulerAddEvent(TaskId id, const char *name, TaskFn fn, uint32_t deadlineMs);
+
+// Release an event task (ISR-safe). Signals that arrive before it runs are merged;
+// its response time counts from the first one.
+void schedulerSignal(TaskId id);
+
+// Run every released task once. Returns true if any task ran.
+bool schedulerRunReady();
+
+// A task is released and waiting to run.
+bool schedulerWorkPending();
+
+// Sleep until the next interrupt unless a task is already waiting.
+void schedulerSleep();
+
+const TaskStats &getTaskStats(TaskId id);
+const char *getTaskName(TaskId id);
+uint32_t getTaskPeriodMs(TaskId id);  // 0 for event tasks
+
+#endif // SCHEDULER_H
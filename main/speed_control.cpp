@@ -0,0 +1,193 @@
+#include "speed_control.h"
+#include "config.h"
+#include "cycle_counter.h"
+#include "speed_pid.h"
+#include <Arduino.h>
+#include <FspTimer.h>
+
+static constexpr SpeedPidSpec PID_SPEC = SPEED_PID_GAINS;
+static_assert(speedPidSpecValid(PID_SPEC, SPEED_CONTROL_HZ), "SPEED_PID_GAINS: gains out of range");
+static constexpr SpeedPidGains PID_GAINS = makeSpeedPidGains(PID_SPEC, SPEED_CONTROL_HZ);
+
+// RPM x cycles between edges per pulse: 60 s x CYCLE_COUNTER_HZ / pulses per revolution.
+static const uint32_t RPM_CYCLES = 60UL * CYCLE_COUNTER_HZ / SPEED_TACH_PULSES_PER_REV;
+static const uint32_t MIN_PERIOD_CYCLES = SPEED_TACH_MIN_PERIOD_US * CYCLES_PER_MICROSECOND;
+static const uint32_t TACH_TIMEOUT_CYCLES = SPEED_TACH_TIMEOUT_MS * (CYCLE_COUNTER_HZ / 1000UL);
+static const uint32_t FEEDBACK_TIMEOUT_TICKS = (uint32_t)SPEED_FEEDBACK_TIMEOUT_MS * SPEED_CONTROL_HZ / 1000;
+static_assert(SPEED_TACH_TIMEOUT_MS < 60000, "tach timeout must stay well inside the cycle counter's wrap");
+
+FspTimer speedTimer;
+static bool speedControlOk = false;
+
+// Tach interrupt -> control interrupt.
+static volatile uint32_t tachCount = 0;
+static volatile uint32_t tachLastEdge = 0;
+
+// Loop command (written by setSpeedCommand(), read by the control interrupt).
+static volatile uint8_t commandPin = 0;
+static volatile uint8_t commandPwm = 0;
+
+// Owned by the control interrupt.
+static SpeedPid pid;
+static uint32_t measuredCount = 0;  // tachCount at the last edge used
+static uint32_t measuredEdge = 0;   // its timestamp
+static bool edgeValid = false;      // measuredEdge is recent enough to measure from
+static uint32_t ticksWithoutPulse = 0;
+static volatile uint16_t measuredRpm = 0;
+static volatile uint16_t setpointRpm = 0;
+static volatile uint8_t outputPwm = 0;
+static volatile bool feedbackLost = false;
+static volatile unsigned long feedbackLossCount = 0;
+
+void speedTachPulse() {
+  const uint32_t now = cycleCounterNow();
+  if (tachCount != 0 && now - tachLastEdge < MIN_PERIOD_CYCLES) return;
+  tachLastEdge = now;
+  tachCount++;
+}
+
+// Speed from the edges since the last call; returns whether there were any.
+static bool measureSpeed(uint32_t now) {
+  // Count and edge of the same pulse: read again if one landed in between.
+  uint32_t count, edge;
+  do {
+    count = tachCount;
+    edge = tachLastEdge;
+  } while (count != tachCount);
+
+  if (count != measuredCount) {
+    if (edgeValid) {
+      measuredRpm = (uint16_t)((uint64_t)(count - measuredCount) * RPM_CYCLES / (edge - measuredEdge));
+    }
+    measuredCount = count;
+    measuredEdge = edge;
+    edgeValid = true;
+    return true;
+  }
+  if (edgeValid) {
+    const uint32_t since = now - measuredEdge;
+    if (since >= TACH_TIMEOUT_CYCLES) {
+      // Standing: the next pulse starts a new measurement.
+      edgeValid = false;
+      measuredRpm = 0;
+    } else if (since > 0 && RPM_CYCLES / since < measuredRpm) {
+      // No pulse yet: the motor is at most this fast.
+      measuredRpm = (uint16_t)(RPM_CYCLES / since);
+    }
+  }
+  return false;
+}
+
+static void speedControlCallback(timer_callback_args_t *args) {
+  (void)args;
+  const uint8_t pin = commandPin;
+  const uint8_t ff = commandPwm;
+  const uint16_t setpoint = (uint16_t)((uint32_t)ff * SPEED_MAX_RPM / 255);
+  setpointRpm = setpoint;
+
+  const bool pulsed = measureSpeed(cycleCounterNow());
+  if (pulsed || setpoint == 0) {
+    ticksWithoutPulse = 0;
+    feedbackLost = false;
+  } else if (!feedbackLost && ++ticksWithoutPulse >= FEEDBACK_TIMEOUT_TICKS) {
+    feedbackLost = true;
+    feedbackLossCount++;
+  }
+
+  uint8_t pwm;
+  if (feedbackLost) {
+    pid.reset();
+    pwm = ff;
+  } else {
+    pwm = pid.update(setpoint, measuredRpm, ff, PID_GAINS);
+  }
+  if (pwm != outputPwm) {
+    outputPwm = pwm;
+    analogWrite(pin, pwm);
+  }
+}
+
+void setSpeedCommand(uint8_t pin, uint8_t pwm) {
+  commandPin = pin;
+  commandPwm = pwm;
+  if (!speedControlOk) {
+    outputPwm = pwm;
+    analogWrite(pin, pwm);
+  } else if (pwm == 0) {
+    // Stop now rather than at the next control tick (which then writes 0 as well).
+    outputPwm = 0;
+    analogWrite(pin, 0);
+  }
+}
+
+void speedControlMotorOutput(uint8_t channel, uint8_t pin, uint8_t pwm) {
+  if (channel == SPEED_CONTROL_CHANNEL) {
+    setSpeedCommand(pin, pwm);
+  } else {
+    analogWrite(pin, pwm);
+  }
+}
+
+void initSpeedControl() {
+  speedControlOk = false;
+  detachInterrupt(digitalPinToInterrupt(TACH_PIN));
+  tachCount = 0;
+  tachLastEdge = 0;
+  pid.reset();
+  measuredCount = 0;
+  measuredEdge = 0;
+  edgeValid = false;
+  ticksWithoutPulse = 0;
+  measuredRpm = setpointRpm = 0;
+  outputPwm = 0;
+  feedbackLost = false;
+  feedbackLossCount = 0;
+
+  cycleCounterInit();
+  pinMode(TACH_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(TACH_PIN), speedTachPulse, RISING);
+
+  uint8_t timer_type = GPT_TIMER;
+  const int8_t timer_channel = FspTimer::get_available_timer(timer_type);
+  if (timer_channel < 0 ||
+      !speedTimer.begin(TIMER_MODE_PERIODIC, timer_type, static_cast<uint8_t>(timer_channel),
+                        static_cast<float>(SPEED_CONTROL_HZ), 50.0f, speedControlCallback) ||
+      !speedTimer.setup_overflow_irq()) {
+    Serial.println("ERROR: No timer for speed control, motors run open loop!");
+    return;
+  }
+  speedTimer.enable_overflow_irq();
+  if (!speedTimer.open() || !speedTimer.start()) {
+    Serial.println("ERROR: Failed to start the speed control timer, motors run open loop!");
+    return;
+  }
+  speedControlOk = true;
+}
+
+bool isSpeedControlOk() {
+  return speedControlOk;
+}
+
+uint16_t getSpeedSetpointRpm() {
+  return setpointRpm;
+}
+
+uint16_t getMeasuredRpm() {
+  return measuredRpm;
+}
+
+uint8_t getSpeedControlPwm() {
+  return outputPwm;
+}
+
+bool isSpeedFeedbackLost() {
+  return feedbackLost;
+}
+
+unsigned long getSpeedFeedbackLossCount() {
+  return feedbackLossCount;
+}
+
+unsigned long getTachPulseCount() {
+  return tachCount;
+}
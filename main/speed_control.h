@@ -0,0 +1,39 @@
+#ifndef SPEED_CONTROL_H
+#define SPEED_CONTROL_H
+
+#include <stdint.h>
+
+/**
+ * Closed-loop motor speed control (ENABLE_SPEED_CONTROL).
+ *
+ * The tach interrupt on TACH_PIN timestamps every pulse with the cycle counter. A
+ * timer interrupt at SPEED_CONTROL_HZ turns the pulses since its last run into RPM
+ * (pulse count over the time between their edges, so the resolution does not depend
+ * on the control period), runs the PID (speed_pid.h) and writes the motor's PWM.
+ * Between pulses a slowing motor is bounded by the time since the last edge.
+ */
+
+// Attach the tach interrupt and start the control timer. If the timer fails,
+// commands drive the motor open loop.
+void initSpeedControl();
+
+// Run the motor on `pin` at the speed `pwm` gives on nominal supply: the setpoint is
+// pwm x SPEED_MAX_RPM / 255, the feed-forward pwm. 0 stops it at once.
+void setSpeedCommand(uint8_t pin, uint8_t pwm);
+
+// Output hook for the motor bank (MotorOutputFn): SPEED_CONTROL_CHANNEL's PWM becomes
+// a speed command, every other channel is written directly.
+void speedControlMotorOutput(uint8_t channel, uint8_t pin, uint8_t pwm);
+
+// The tach pulse interrupt (attached to TACH_PIN; exposed for tests).
+void speedTachPulse();
+
+bool isSpeedControlOk();
+uint16_t getSpeedSetpointRpm();
+uint16_t getMeasuredRpm();
+uint8_t getSpeedControlPwm();            // PWM last written by the loop
+bool isSpeedFeedbackLost();               // driven without tach pulses: open loop
+unsigned long getSpeedFeedbackLossCount();
+unsigned long getTachPulseCount();
+
+#endif // SPEED_CONTROL_H
@@ -0,0 +1,119 @@
+#ifndef SPEED_PID_H
+#define SPEED_PID_H
+
+#include <stdint.h>
+
+/**
+ * Fixed-point PID speed controller with feed-forward, one step per control tick.
+ *
+ * Error in RPM, output in PWM counts (0-255). The feed-forward is the open-loop PWM
+ * for the setpoint (the motor curves' map), so the loop only has to correct what
+ * supply, load and temperature change, and a setpoint change reaches the motor at
+ * once instead of through the integrator. Gains are normalized to full scale: a
+ * proportional gain of 100 % turns an error of maxRpm into 255 PWM.
+ *
+ * Terms are Q16 PWM. The derivative acts on the measurement (no kick when the
+ * setpoint moves). Anti-windup: the integrator is clamped to +/- integralLimitPwm
+ * and does not integrate further while the output is saturated in the direction
+ * of the error, so it recovers at once when the motor catches up.
+ */
+
+#define SPEED_PID_Q 16
+
+/** Gains in physical units; makeSpeedPidGains() converts them for a control rate. */
+struct SpeedPidSpec {
+  uint16_t kpPct;           // PWM full scale per RPM full scale, x100
+  uint16_t kiPctPerS;       // the same per second of accumulated error
+  uint16_t kdPctMs;         // the same per RPM full scale per millisecond
+  uint16_t maxRpm;          // RPM at PWM 255 (full scale)
+  uint8_t integralLimitPwm; // the integrator's share of the output, +/-
+};
+
+/** The same per control tick, Q16 PWM per RPM. */
+struct SpeedPidGains {
+  int32_t kp;
+  int32_t ki;
+  int32_t kd;
+  int32_t integralLimit;  // Q16 PWM
+  int32_t errorLimit;     // RPM: errors are clamped to this (2 x full scale)
+};
+
+constexpr int32_t speedPidGain(uint64_t pct, uint64_t num, uint64_t den, uint16_t maxRpm) {
+  // pct / 100 * 255 / maxRpm * 2^16 * num / den, rounded
+  return (int32_t)((pct * 255ULL * (1ULL << SPEED_PID_Q) * num + 50ULL * maxRpm * den) / (100ULL * maxRpm * den));
+}
+
+constexpr SpeedPidGains makeSpeedPidGains(const SpeedPidSpec &spec, uint32_t hz) {
+  SpeedPidGains g = {};
+  g.kp = speedPidGain(spec.kpPct, 1, 1, spec.maxRpm);
+  g.ki = speedPidGain(spec.kiPctPerS, 1, hz, spec.maxRpm);
+  g.kd = speedPidGain(spec.kdPctMs, hz, 1000, spec.maxRpm);
+  g.integralLimit = (int32_t)spec.integralLimitPwm << SPEED_PID_Q;
+  g.errorLimit = 2 * (int32_t)spec.maxRpm;
+  return g;
+}
+
+// Each term stays under 2^28 (so their sum fits 32 bits) for errors and measurement
+// steps up to errorLimit, and the integral gain is not rounded to nothing.
+constexpr bool speedPidSpecValid(const SpeedPidSpec &spec, uint32_t hz) {
+  if (spec.maxRpm == 0 || hz == 0 || spec.kpPct == 0) return false;
+  const SpeedPidGains g = makeSpeedPidGains(spec, hz);
+  const int64_t limit = 1LL << 28;
+  if ((int64_t)g.kp * g.errorLimit >= limit || (int64_t)g.kd * g.errorLimit >= limit) return false;
+  return spec.kiPctPerS == 0 || g.ki >= 16;
+}
+
+class SpeedPid {
+ public:
+  SpeedPid() { reset(); }
+
+  void reset() {
+    integral_ = 0;
+    lastMeasured_ = 0;
+    primed_ = false;
+  }
+
+  // One control tick. A setpoint of 0 stops the motor and clears the loop's state.
+  uint8_t update(int32_t setpointRpm, int32_t measuredRpm, uint8_t feedForwardPwm, const SpeedPidGains &g) {
+    if (setpointRpm <= 0) {
+      reset();
+      return 0;
+    }
+    int32_t error = setpointRpm - measuredRpm;
+    if (error > g.errorLimit) error = g.errorLimit;
+    if (error < -g.errorLimit) error = -g.errorLimit;
+
+    int32_t derivative = 0;
+    if (primed_) {
+      int32_t step = measuredRpm - lastMeasured_;
+      if (step > g.errorLimit) step = g.errorLimit;
+      if (step < -g.errorLimit) step = -g.errorLimit;
+      derivative = -g.kd * step;
+    }
+    lastMeasured_ = measuredRpm;
+    primed_ = true;
+
+    const int32_t base = ((int32_t)feedForwardPwm << SPEED_PID_Q) + g.kp * error + derivative;
+    const int32_t unclamped = base + integral_;
+    const bool saturatedHigh = unclamped >= (255L << SPEED_PID_Q) && error > 0;
+    const bool saturatedLow = unclamped <= 0 && error < 0;
+    if (!saturatedHigh && !saturatedLow) {
+      integral_ += g.ki * error;
+      if (integral_ > g.integralLimit) integral_ = g.integralLimit;
+      if (integral_ < -g.integralLimit) integral_ = -g.integralLimit;
+    }
+
+    const int32_t out = (base + integral_ + (1L << (SPEED_PID_Q - 1))) >> SPEED_PID_Q;
+    return (uint8_t)(out < 0 ? 0 : (out > 255 ? 255 : out));
+  }
+
+  // Integrator, Q16 PWM (for tests and the report).
+  int32_t integral() const { return integral_; }
+
+ private:
+  int32_t integral_;
+  int32_t lastMeasured_;
+  bool primed_;
+};
+
+#endif // SPEED_PID_H
@@ -0,0 +1,112 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Sliding-window streaming statistics over raw (unsigned) ADC samples.
+ *
+ * push() is O(1) for sum / sum of squares / mean and amortized O(1) for min/max
+ * (monotonic wedges, Lemire 2006): each sample enters and leaves each wedge once.
+ *
+ * All accumulators are exact integers updated by add-new / subtract-oldest, so they
+ * cannot drift no matter how long the sculpture runs, and they are bounded by the
+ * window contents (WINDOW * 65535 fits in 32 bits, WINDOW * 65535^2 in 64 bits),
+ * so they cannot overflow either.
+ *
+ * Several instances with different WINDOW lengths can be fed the same stream,
+ * e.g. a short window for responsiveness and a long one for the DC baseline.
+ */
+template <uint16_t WINDOW>
+class SlidingWindowStats {
+  static_assert(WINDOW >= 1, "window must hold at least one sample");
+
+ public:
+  SlidingWindowStats() { reset(0); }
+
+  // Fill the whole window with `fill` (e.g. DC_OFFSET as a silence baseline).
+  void reset(uint16_t fill) {
+    for (uint16_t i = 0; i < WINDOW; i++) history_[i] = fill;
+    pos_ = 0;
+    sum_ = (uint32_t)fill * WINDOW;
+    sumSq_ = (uint64_t)fill * fill * WINDOW;
+
+    // With a constant window, the newest slot alone is both the min and the max.
+    minHead_ = maxHead_ = 0;
+    minCount_ = maxCount_ = 1;
+    minWedge_[0] = maxWedge_[0] = (uint16_t)(WINDOW - 1);
+  }
+
+  // Add one sample, evicting the oldest.
+  void push(uint16_t sample) {
+    const uint16_t slot = pos_;
+    const uint16_t oldest = history_[slot];
+
+    sum_ += (uint32_t)sample - oldest;
+    sumSq_ += (uint64_t)sample * sample;
+    sumSq_ -= (uint64_t)oldest * oldest;
+
+    // The sample leaving the window is the oldest entry, so it can only be a wedge front.
+    if (minCount_ > 0 && minWedge_[minHead_] == slot) popFront(minHead_, minCount_);
+    if (maxCount_ > 0 && maxWedge_[maxHead_] == slot) popFront(maxHead_, maxCount_);
+
+    history_[slot] = sample;
+    pos_ = (uint16_t)((slot + 1 == WINDOW) ? 0 : slot + 1);
+
+    while (minCount_ > 0 && history_[back(minHead_, minCount_, minWedge_)] >= sample) minCount_--;
+    pushBack(minHead_, minCount_, minWedge_, slot);
+
+    while (maxCount_ > 0 && history_[back(maxHead_, maxCount_, maxWedge_)] <= sample) maxCount_--;
+    pushBack(maxHead_, maxCount_, maxWedge_, slot);
+  }
+
+  static uint16_t length() { return WINDOW; }
+
+  uint32_t sum() const { return sum_; }
+  uint64_t sumSquares() const { return sumSq_; }
+
+  // Rounded mean of the window.
+  uint16_t mean() const { return (uint16_t)((sum_ + WINDOW / 2) / WINDOW); }
+
+  uint16_t min() const { return history_[minWedge_[minHead_]]; }
+  uint16_t max() const { return history_[maxWedge_[maxHead_]]; }
+
+  // Population variance in ADC counts^2 (computed on demand, not per sample).
+  uint32_t variance() const {
+    const uint64_t n = WINDOW;
+    const uint64_t num = sumSq_ * n - (uint64_t)sum_ * sum_;
+    return (uint32_t)(num / (n * n));
+  }
+
+ private:
+  // Callers only pass head + count or head + 1 with head, count <= WINDOW, so a
+  // single conditional subtract is enough (no division in the per-sample path).
+  static uint16_t wrap(uint32_t i) { return (uint16_t)((i >= WINDOW) ? i - WINDOW : i); }
+
+  static uint16_t back(uint16_t head, uint16_t count, const uint16_t *wedge) {
+    return wedge[wrap((uint32_t)head + count - 1)];
+  }
+
+  static void popFront(uint16_t &head, uint16_t &count) {
+    head = wrap((uint32_t)head + 1);
+    count--;
+  }
+
+  static void pushBack(uint16_t head, uint16_t &count, uint16_t *wedge, uint16_t slot) {
+    wedge[wrap((uint32_t)head + count)] = slot;
+    count++;
+  }
+
+  uint16_t history_[WINDOW];
+  uint16_t pos_;
+  uint32_t sum_;
+  uint64_t sumSq_;
+
+  // Monotonic wedges of history slots: values increase (min) / decrease (max) front to back.
+  uint16_t minWedge_[WINDOW];
+  uint16_t maxWedge_[WINDOW];
+  uint16_t minHead_, minCount_;
+  uint16_t maxHead_, maxCount_;
+};
+
+#endif // STREAM_STATS_H
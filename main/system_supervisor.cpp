@@ -4,244 +4,418 @@
 #include "audio_processor.h"
 #include "motor_controller.h"
 #include "timer_setup.h"
-
-// FSM state
-static SystemState state = SYSTEM_INIT;
-static unsigned long stateEnterMs = 0;
+#include "telemetry.h"
+#include "loop_profiler.h"
+#include "sample_jitter.h"
+#include "runtime_config.h"
+#include "raw_capture.h"
+#include "speed_control.h"
+#include <stdio.h>
+
+// Events fed to the state machine.
+enum SupervisorEvent {
+  EV_TICK,              // periodic, guards decide
+  EV_SAMPLING_STALLED,  // no new samples for sample_stall_timeout_ms
+  EV_SAMPLING_JITTER,   // too many late/early samples in the jitter window
+  EV_CMD_SHUTDOWN,      // 's'
+  EV_CMD_WAKE,          // 'w'
+  EV_CMD_RESET          // 'r'
+};
 
 // Health monitoring
 static unsigned long lastSampleCount = 0;
 static unsigned long lastSampleAdvanceMs = 0;
+static unsigned long jitterWindowStartMs = 0;
+static uint32_t jitterWindowStartCount = 0;
+static uint32_t lastJitterCount = 0;  // getSampleJitterOverLimitCount() as of the last tick
 
 // Audio threshold timing
 static unsigned long aboveEnterSinceMs = 0;
 static unsigned long lastNonSilentMs = 0;
 
-// Motor control smoothing
+// Motor update cadence
 static unsigned long lastMotorTickMs = 0;
-static int currentPwm = 0;
 
 // Fault latch
 static bool faultLatched = false;
 static const char *faultReason = "";
 
-static void latchFault(const char *reason) {
-  faultLatched = true;
-  faultReason = reason ? reason : "unknown";
-  state = SYSTEM_FAULT;
-  currentPwm = 0;
-  stopMotor();
-  setAutoCalibrationEnabled(false);
-  Serial.print("FAULT: ");
-  Serial.println(faultReason);
-}
-
-static void enterState(SystemState next, unsigned long nowMs) {
-  if (state == next) return;
-
-  state = next;
-  stateEnterMs = nowMs;
-
-  switch (state) {
-    case SYSTEM_INIT:
-      aboveEnterSinceMs = 0;
-      lastNonSilentMs = nowMs;
-      currentPwm = 0;
-      stopMotor();
-      setAutoCalibrationEnabled(true);
-      Serial.println("STATE: INIT");
-      break;
-
-    case SYSTEM_IDLE:
-      aboveEnterSinceMs = 0;
-      currentPwm = 0;
-      stopMotor();
-      setAutoCalibrationEnabled(true);
-      Serial.println("STATE: IDLE (motor off)");
-      break;
-
-    case SYSTEM_ACTIVE:
-      aboveEnterSinceMs = 0;
-      lastNonSilentMs = nowMs;
-      setAutoCalibrationEnabled(false);
-      Serial.println("STATE: ACTIVE");
-      break;
-
-    case SYSTEM_FAULT:
-      currentPwm = 0;
-      stopMotor();
-      setAutoCalibrationEnabled(false);
-      Serial.println("STATE: FAULT (motor off)");
-      break;
-
-    case SYSTEM_SHUTDOWN:
-      currentPwm = 0;
-      stopMotor();
-      setAutoCalibrationEnabled(false);
-      Serial.println("STATE: SHUTDOWN (motor off)");
-      break;
-  }
+// "FAULT: <reason>" line, written by the serial task between telemetry frames.
+static char faultText[64];
+static size_t faultTextLen = 0;
+static size_t faultTextSent = 0;
+
+// Status reporting
+static int lastAmplitude = 0;
+
+// Thresholds and timeouts: the active runtime config (runtime_config.h). It lives at a
+// fixed address and only changes at the top of systemSupervisorTick().
+static const RuntimeConfig &config = runtimeConfig();
+
+// Milliseconds from `since` to `now`, across the 32-bit millis() wrap. (unsigned long
+// is 64 bits on the desktop build, so a plain `now - since` breaks at the wrap there.)
+static inline unsigned long elapsedMs(unsigned long now, unsigned long since) {
+  return (uint32_t)(now - since);
 }
 
-static int clampAndMapAmplitudeToTargetPwm(int amplitude) {
-  // In ACTIVE, treat values below ACTIVE_EXIT_THRESHOLD as "no drive" (target 0).
-  if (amplitude <= ACTIVE_EXIT_THRESHOLD) return 0;
+// Guards (no side effects).
+static bool timerFailed(unsigned long nowMs);
+static bool loudLongEnough(unsigned long nowMs);
+static bool silentAndStopped(unsigned long nowMs);
+
+// State actions.
+static void enterInit(unsigned long nowMs);
+static void enterIdle(unsigned long nowMs);
+static void duringIdle(unsigned long nowMs);
+static void enterActive(unsigned long nowMs);
+static void duringActive(unsigned long nowMs);
+static void exitActive(unsigned long nowMs);
+static void enterFault(unsigned long nowMs);
+static void enterShutdown(unsigned long nowMs);
+
+static constexpr FsmStateDef STATES[] = {
+  // state            name        entry          exit        during
+  {SYSTEM_INIT,     "INIT",     enterInit,     nullptr,    nullptr},
+  {SYSTEM_IDLE,     "IDLE",     enterIdle,     nullptr,    duringIdle},
+  {SYSTEM_ACTIVE,   "ACTIVE",   enterActive,   exitActive, duringActive},
+  {SYSTEM_FAULT,    "FAULT",    enterFault,    nullptr,    nullptr},
+  {SYSTEM_SHUTDOWN, "SHUTDOWN", enterShutdown, nullptr,    nullptr},
+};
+
+static constexpr uint32_t RUNNING = fsmStateMask(SYSTEM_INIT, SYSTEM_IDLE, SYSTEM_ACTIVE);
+static constexpr uint32_t ANY_BUT_SHUTDOWN = fsmStateMask(SYSTEM_INIT, SYSTEM_IDLE, SYSTEM_ACTIVE, SYSTEM_FAULT);
+static constexpr uint32_t ANY_BUT_INIT = fsmStateMask(SYSTEM_IDLE, SYSTEM_ACTIVE, SYSTEM_FAULT, SYSTEM_SHUTDOWN);
+
+// First matching row wins, so faults come before the normal TICK rows.
+static constexpr FsmTransition<SupervisorEvent> TRANSITIONS[] = {
+  // from                               event                 guard             to               cause
+  {RUNNING,                             EV_SAMPLING_STALLED,  nullptr,          SYSTEM_FAULT,    "audio sampling stalled (timer not advancing)"},
+  {RUNNING,                             EV_SAMPLING_JITTER,   nullptr,          SYSTEM_FAULT,    "audio sampling jitter over limit"},
+  {fsmStateMask(SYSTEM_INIT),           EV_TICK,              timerFailed,      SYSTEM_FAULT,    "audio timer failed to start"},
+  {fsmStateMask(SYSTEM_INIT),           EV_TICK,              nullptr,          SYSTEM_IDLE,     "startup checks passed"},
+  {fsmStateMask(SYSTEM_IDLE),           EV_TICK,              loudLongEnough,   SYSTEM_ACTIVE,   "audio above enter threshold"},
+  {fsmStateMask(SYSTEM_ACTIVE),         EV_TICK,              silentAndStopped, SYSTEM_IDLE,     "silence timeout"},
+  {ANY_BUT_SHUTDOWN,                    EV_CMD_SHUTDOWN,      nullptr,          SYSTEM_SHUTDOWN, "shutdown command"},
+  {fsmStateMask(SYSTEM_SHUTDOWN),       EV_CMD_WAKE,          nullptr,          SYSTEM_IDLE,     "wake command"},
+  {ANY_BUT_INIT,                        EV_CMD_RESET,         nullptr,          SYSTEM_INIT,     "reset command"},
+};
+
+static Fsm<SystemState, SupervisorEvent, STATES, TRANSITIONS, SUPERVISOR_TRACE_SIZE> fsm;
+static_assert(decltype(fsm)::STATES == SYSTEM_SHUTDOWN + 1, "one STATES row per SystemState");
+
+#if ENABLE_BINARY_TELEMETRY
+static void sendTelemetry(unsigned long nowMs) {
+  TelemetryRecord record;
+  record.timestampMs = (uint32_t)nowMs;
+  record.rawSample = (uint16_t)getLatestRawSample();
+  record.amplitude = (uint16_t)constrain(lastAmplitude, 0, 65535);
+  record.dcOffset = (uint16_t)getDcOffsetEstimate();
+  record.pwm = (uint8_t)getMotorChannelPwm(0);
+  record.state = (uint8_t)fsm.state();
+  telemetrySend(record);
+}
+#endif
+
+// State changes: an immediate telemetry record, or the text line without telemetry.
+static void reportState(const char *text, unsigned long nowMs) {
+#if ENABLE_BINARY_TELEMETRY
+  (void)text;
+  sendTelemetry(nowMs);
+#else
+  (void)nowMs;
+  Serial.println(text);
+#endif
+}
 
-  // Map amplitude range [ACTIVE_EXIT_THRESHOLD..512] -> [MIN_MOTOR_SPEED..MAX_MOTOR_SPEED]
-  int a = constrain(amplitude, ACTIVE_EXIT_THRESHOLD, 512);
-  long target = map(a, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
-  return constrain((int)target, 0, 255);
+// An ACTIVE threshold: floorPct % of the noise floor, but at least `minimum` counts.
+static int activeThreshold(uint16_t minimum, uint16_t floorPct) {
+  const long relative = (long)getNoiseFloor() * floorPct / 100;
+  return relative > minimum ? (int)relative : (int)minimum;
 }
 
-static int slewTowards(int current, int target) {
-  if (current == target) return current;
-  if (target > current) {
-    int next = current + PWM_SLEW_STEP;
-    return (next > target) ? target : next;
-  } else {
-    int next = current - PWM_SLEW_STEP;
-    return (next < target) ? target : next;
-  }
+static bool timerFailed(unsigned long nowMs) {
+  (void)nowMs;
+  return !isAudioTimerOk();
 }
 
-void initSystemSupervisor() {
-  state = SYSTEM_INIT;
-  stateEnterMs = millis();
+static bool loudLongEnough(unsigned long nowMs) {
+  return aboveEnterSinceMs != 0 && elapsedMs(nowMs, aboveEnterSinceMs) >= config.activeEnterDebounceMs;
+}
+
+// Enter IDLE only after sustained silence for t_idle AND every motor has ramped down to 0.
+static bool silentAndStopped(unsigned long nowMs) {
+  return elapsedMs(nowMs, lastNonSilentMs) > config.idleTimeoutMs && motorsStopped();
+}
+
+static void enterInit(unsigned long nowMs) {
+  // Restart stall detection so a recovery ('r') is judged on fresh samples,
+  // not on the timestamp of the stall that caused the fault.
+  lastSampleAdvanceMs = nowMs;
+  jitterWindowStartMs = nowMs;
+  jitterWindowStartCount = lastJitterCount;
+  aboveEnterSinceMs = 0;
+  lastNonSilentMs = nowMs;
   faultLatched = false;
   faultReason = "";
+  stopMotor();
+  setAutoCalibrationEnabled(true);
+  reportState("STATE: INIT", nowMs);
+}
 
-  lastSampleCount = getAudioSampleCount();
-  lastSampleAdvanceMs = millis();
+static void enterIdle(unsigned long nowMs) {
+  // The motor is already off: it only runs in ACTIVE, and exitActive() stops it.
+  aboveEnterSinceMs = 0;
+  setAutoCalibrationEnabled(true);
+  reportState("STATE: IDLE (motor off)", nowMs);
+}
 
+// IDLE -> ACTIVE needs the amplitude above the enter threshold for the debounce time.
+static void duringIdle(unsigned long nowMs) {
+  // Give the DC offset estimator time to converge before allowing ACTIVE.
+  if (elapsedMs(nowMs, fsm.enteredMs()) < config.idleCalibrationWarmupMs) {
+    aboveEnterSinceMs = 0;
+  } else if (lastAmplitude >= activeThreshold(config.activeEnterThreshold, config.activeEnterFloorPct)) {
+    if (aboveEnterSinceMs == 0) aboveEnterSinceMs = nowMs;
+  } else {
+    aboveEnterSinceMs = 0;
+  }
+}
+
+static void enterActive(unsigned long nowMs) {
   aboveEnterSinceMs = 0;
-  lastNonSilentMs = millis();
+  lastNonSilentMs = nowMs;
+  setAutoCalibrationEnabled(false);
+  reportState("STATE: ACTIVE", nowMs);
+}
+
+// Beat-synchronous accent: while the beat tracker is locked, true for beat_accent_ms
+// from beat_lead_ms before each predicted beat, so the motor (which lags its PWM)
+// peaks on the beat rather than after it.
+static bool inBeatAccent() {
+  if (config.beatAccentPct == 0 || !isBeatLocked()) return false;
+  const unsigned period = getBeatPeriodMs();
+  if (period == 0) return false;
+  // Time since the lead point of the next beat, or failing that, of the previous one.
+  const unsigned sinceLead = (config.beatLeadMs % period + period - getMsToNextBeat()) % period;
+  return sinceLead < config.beatAccentMs;
+}
+
+// Smooth motor drive (every channel of the motor bank); on dropout the PWMs ramp down
+// before silentAndStopped() allows IDLE.
+static void duringActive(unsigned long nowMs) {
+  if (lastAmplitude > activeThreshold(config.activeExitThreshold, config.activeExitFloorPct)) {
+    lastNonSilentMs = nowMs;
+  }
+
+  // Update motor at fixed cadence. The cadence is kept in phase, so a tick that
+  // runs a little late does not push the next update back.
+  if (elapsedMs(nowMs, lastMotorTickMs) >= MOTOR_UPDATE_INTERVAL) {
+    // Above the noise floor, scaled by the AGC to the range the motor curves expect.
+    int levels[MOTOR_SOURCE_COUNT] = {
+      normalizeLevel(lastAmplitude), normalizeLevel(getBandLevel(AUDIO_BAND_BASS)),
+      normalizeLevel(getBandLevel(AUDIO_BAND_MID)), normalizeLevel(getBandLevel(AUDIO_BAND_TREBLE))
+    };
+    if (inBeatAccent()) {
+      for (int s = 0; s < MOTOR_SOURCE_COUNT; s++) levels[s] += (int)((long)levels[s] * config.beatAccentPct / 100);
+    }
+    updateMotorBank(levels);
 
+    lastMotorTickMs += MOTOR_UPDATE_INTERVAL;
+    if (elapsedMs(nowMs, lastMotorTickMs) >= MOTOR_UPDATE_INTERVAL) lastMotorTickMs = nowMs;
+  }
+}
+
+static void exitActive(unsigned long nowMs) {
+  (void)nowMs;
+  stopMotor();
+}
+
+static void enterFault(unsigned long nowMs) {
+  faultLatched = true;
+  faultReason = fsm.cause();
+  setAutoCalibrationEnabled(false);
+  const int n = snprintf(faultText, sizeof(faultText), "FAULT: %s\n", faultReason);
+  faultTextLen = (n < 0) ? 0 : ((size_t)n < sizeof(faultText) ? (size_t)n : sizeof(faultText) - 1);
+  faultTextSent = 0;
+#if ENABLE_BINARY_TELEMETRY
+  sendTelemetry(nowMs);
+#else
+  (void)nowMs;
+#endif
+}
+
+static void enterShutdown(unsigned long nowMs) {
+  setAutoCalibrationEnabled(false);
+  reportState("STATE: SHUTDOWN (motor off)", nowMs);
+}
+
+// 'p' report lines: "prof fsm <ms> FROM -> TO (cause)", oldest first.
+static int formatTraceLine(int index, char *buf, size_t size) {
+  if (index < 0 || (size_t)index >= fsm.traceSize()) return -1;
+  const FsmTraceEntry &t = fsm.traceAt((size_t)index);
+  return snprintf(buf, size, "prof fsm %lu %s -> %s (%s)\n", (unsigned long)t.timestampMs,
+                  STATES[t.from].name, STATES[t.to].name, t.cause);
+}
+
+// Point every motor channel at the curve and motion profile the runtime config selects.
+static void applyMotorProfiles() {
+  for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+    MotorChannelConfig channel = getMotorChannelConfig(ch);
+    channel.curve = config.motorCurve[ch];
+    channel.motion = config.motorMotion[ch];
+    configureMotorChannel(ch, channel);
+  }
+}
+
+static void startSupervisor(unsigned long nowMs) {
+  lastSampleCount = getAudioSampleCount();
+  lastJitterCount = getSampleJitterOverLimitCount();
   lastMotorTickMs = 0;
-  currentPwm = 0;
+  lastAmplitude = 0;
+  applyMotorProfiles();
+
+  fsm.start(SYSTEM_INIT, nowMs);
+  loopProfilerSetReportExtension(formatTraceLine);
+}
+
+void initSystemSupervisor() {
+  startSupervisor(millis());
 }
 
+#if ENABLE_RAW_CAPTURE
+// 'c': restart the signal chain, so a replay (which initializes the same way) starts
+// from the same state, and stream from here; 'c' again stops.
+static void toggleCapture(unsigned long nowMs) {
+  if (rawCaptureActive()) {
+    rawCaptureStop();
+    return;
+  }
+  initAudioProcessor();
+  initMotorController();
+  startSupervisor(nowMs);
+  rawCaptureStart((uint32_t)nowMs, (uint32_t)lastSampleCount, lastJitterCount);
+}
+#endif
+
 void systemSupervisorHandleSerial(unsigned long nowMs) {
-  while (Serial.available() > 0) {
+  // A config command waiting for its turn holds the rest of the input in the RX buffer.
+  while (Serial.available() > 0 && !runtimeConfigConsoleBusy()) {
     const int c = Serial.read();
-    if (c == 's' || c == 'S') {
-      enterState(SYSTEM_SHUTDOWN, nowMs);
+    if (runtimeConfigConsoleFeed((char)c)) {
+      // '$' config command line (runtime_config.h)
+    } else if (c == 's' || c == 'S') {
+      fsm.dispatch(EV_CMD_SHUTDOWN, nowMs);
+#if ENABLE_RAW_CAPTURE
+      rawCaptureCommand((uint32_t)nowMs, (uint8_t)c);
+#endif
     } else if (c == 'w' || c == 'W') {
-      if (state == SYSTEM_SHUTDOWN) enterState(SYSTEM_IDLE, nowMs);
+      fsm.dispatch(EV_CMD_WAKE, nowMs);
+#if ENABLE_RAW_CAPTURE
+      rawCaptureCommand((uint32_t)nowMs, (uint8_t)c);
+#endif
+    } else if (c == 'p' || c == 'P') {
+      // Per-stage loop() timing report (written from loop() without blocking).
+      loopProfilerRequestReport();
     } else if (c == 'r' || c == 'R') {
       // Clear FAULT and attempt recovery by re-entering INIT.
-      faultLatched = false;
-      faultReason = "";
-      enterState(SYSTEM_INIT, nowMs);
+      fsm.dispatch(EV_CMD_RESET, nowMs);
+#if ENABLE_RAW_CAPTURE
+      rawCaptureCommand((uint32_t)nowMs, (uint8_t)c);
+    } else if (c == 'c' || c == 'C') {
+      toggleCapture(nowMs);
+#endif
     }
   }
 }
 
-void systemSupervisorTick(unsigned long nowMs, unsigned long audioSampleCount, int amplitude) {
+// One tick on its inputs. The jitter count is read once per tick (lastJitterCount), so
+// a capture records exactly what the tick saw.
+static void superviseTick(unsigned long nowMs, unsigned long audioSampleCount, int amplitude) {
+  const uint32_t jitterCount = lastJitterCount;
+  lastAmplitude = amplitude;
+
   // Health monitoring: detect stalled sampling timer.
   if (audioSampleCount != lastSampleCount) {
     lastSampleCount = audioSampleCount;
     lastSampleAdvanceMs = nowMs;
-  } else if ((state != SYSTEM_SHUTDOWN) && (state != SYSTEM_FAULT)) {
-    if (nowMs - lastSampleAdvanceMs > SAMPLE_STALL_TIMEOUT_MS) {
-      latchFault("audio sampling stalled (timer not advancing)");
-      return;
-    }
+  } else if (elapsedMs(nowMs, lastSampleAdvanceMs) > config.sampleStallTimeoutMs) {
+    if (fsm.dispatch(EV_SAMPLING_STALLED, nowMs)) return;
   }
 
-  // INIT validation: timer must be OK.
-  if (state == SYSTEM_INIT) {
-    if (!isAudioTimerOk()) {
-      latchFault("audio timer failed to start");
-      return;
-    }
-    // After validation, go to IDLE.
-    enterState(SYSTEM_IDLE, nowMs);
+  // Health monitoring: too many sampling periods off by more than SAMPLE_JITTER_LIMIT_US.
+  if (config.sampleJitterFaultCount > 0 && (jitterCount >= jitterWindowStartCount) &&
+      (jitterCount - jitterWindowStartCount >= config.sampleJitterFaultCount)) {
+    if (fsm.dispatch(EV_SAMPLING_JITTER, nowMs)) return;
   }
-
-  // SHUTDOWN is a latched intentional stop.
-  if (state == SYSTEM_SHUTDOWN) {
-    stopMotor();
-    return;
+  if (elapsedMs(nowMs, jitterWindowStartMs) >= config.sampleJitterWindowMs) {
+    jitterWindowStartMs = nowMs;
+    jitterWindowStartCount = jitterCount;
   }
 
-  // FAULT keeps motor off until reset/recovery.
-  if (state == SYSTEM_FAULT) {
-    stopMotor();
-    return;
-  }
-
-  // IDLE -> ACTIVE if amplitude is above enter threshold for debounce time.
-  if (state == SYSTEM_IDLE) {
-    // In IDLE, allow baseline drift calibration.
-    setAutoCalibrationEnabled(true);
-    stopMotor();
-
-    // Give the DC offset estimator time to converge before allowing ACTIVE.
-    if (nowMs - stateEnterMs < IDLE_CALIBRATION_WARMUP_MS) {
-      aboveEnterSinceMs = 0;
-      return;
-    }
+  fsm.tick(nowMs);
+  fsm.dispatch(EV_TICK, nowMs);
+}
 
-    if (amplitude >= ACTIVE_ENTER_THRESHOLD) {
-      if (aboveEnterSinceMs == 0) aboveEnterSinceMs = nowMs;
-      if (nowMs - aboveEnterSinceMs >= ACTIVE_ENTER_DEBOUNCE_MS) {
-        enterState(SYSTEM_ACTIVE, nowMs);
-      }
-    } else {
-      aboveEnterSinceMs = 0;
-    }
-    return;
+void systemSupervisorTick(unsigned long nowMs, unsigned long audioSampleCount, int amplitude) {
+  // Config edits take effect here, between ticks, all at once.
+  if (runtimeConfigApplyPending()) {
+    applyMotorProfiles();
+#if ENABLE_RAW_CAPTURE
+    rawCaptureConfig();
+#endif
   }
+  lastJitterCount = getSampleJitterOverLimitCount();
+  superviseTick(nowMs, audioSampleCount, amplitude);
+#if ENABLE_RAW_CAPTURE
+  rawCaptureTick((uint32_t)nowMs, (uint32_t)audioSampleCount, lastJitterCount, (uint8_t)fsm.state());
+#endif
+}
 
-  // ACTIVE behavior: smooth motor drive; dropout -> ramp down, then enter IDLE after t_idle.
-  if (state == SYSTEM_ACTIVE) {
-    setAutoCalibrationEnabled(false);
-
-    if (amplitude > ACTIVE_EXIT_THRESHOLD) {
-      lastNonSilentMs = nowMs;
-    }
-
-    // Update motor at fixed cadence.
-    if (nowMs - lastMotorTickMs >= MOTOR_UPDATE_INTERVAL) {
-      const int target = clampAndMapAmplitudeToTargetPwm(amplitude);
-      currentPwm = slewTowards(currentPwm, target);
-      setMotorSpeed(currentPwm);
-
-      // Debug (state-level) — keeps logs consistent with the FSM.
-      static unsigned long lastDbg = 0;
-      if (nowMs - lastDbg >= DEBUG_INTERVAL) {
-        Serial.print("State=ACTIVE Amp=");
-        Serial.print(amplitude);
-        Serial.print(" DC=");
-        Serial.print(getDcOffsetEstimate());
-        Serial.print(" PWM=");
-        Serial.println(currentPwm);
-        lastDbg = nowMs;
-      }
-
-      lastMotorTickMs = nowMs;
-    }
-
-    // Enter IDLE only after sustained silence for t_idle AND motor has ramped down to 0.
-    if ((nowMs - lastNonSilentMs > IDLE_TIMEOUT_MS) && (currentPwm == 0)) {
-      enterState(SYSTEM_IDLE, nowMs);
-    }
+void systemSupervisorReport(unsigned long nowMs) {
+#if ENABLE_BINARY_TELEMETRY
+  sendTelemetry(nowMs);
+#else
+  (void)nowMs;
+  // Debug (state-level) — keeps logs consistent with the FSM.
+  if (fsm.state() == SYSTEM_ACTIVE) {
+    Serial.print("State=ACTIVE Amp=");
+    Serial.print(lastAmplitude);
+    Serial.print(" DC=");
+    Serial.print(getDcOffsetEstimate());
+    Serial.print(" Floor=");
+    Serial.print(getNoiseFloor());
+#if ENABLE_SPEED_CONTROL
+    Serial.print(" RPM=");
+    Serial.print(getMeasuredRpm());
+    Serial.print("/");
+    Serial.print(getSpeedSetpointRpm());
+#endif
+    Serial.print(" PWM=");
+    Serial.println(getMotorChannelPwm(0));
   }
+#endif
 }
 
 SystemState getSystemState() {
-  return state;
+  return fsm.state();
 }
 
 const char *getSystemStateName(SystemState s) {
-  switch (s) {
-    case SYSTEM_INIT: return "INIT";
-    case SYSTEM_IDLE: return "IDLE";
-    case SYSTEM_ACTIVE: return "ACTIVE";
-    case SYSTEM_FAULT: return "FAULT";
-    case SYSTEM_SHUTDOWN: return "SHUTDOWN";
-    default: return "UNKNOWN";
-  }
+  return fsm.stateName(s);
+}
+
+bool systemSupervisorTextPending() {
+  return faultTextSent < faultTextLen;
+}
+
+bool systemSupervisorServiceText() {
+  const int room = Serial.availableForWrite();
+  if (room <= 0) return systemSupervisorTextPending();
+  size_t chunk = faultTextLen - faultTextSent;
+  if (chunk > (size_t)room) chunk = (size_t)room;
+  Serial.write(reinterpret_cast<const uint8_t *>(faultText) + faultTextSent, chunk);
+  faultTextSent += chunk;
+  return systemSupervisorTextPending();
 }
 
 bool isFaultLatched() {
@@ -252,4 +426,10 @@ const char *getLastFaultReason() {
   return faultReason;
 }
 
+size_t getSupervisorTraceSize() {
+  return fsm.traceSize();
+}
 
+const FsmTraceEntry &getSupervisorTraceEntry(size_t index) {
+  return fsm.traceAt(index);
+}
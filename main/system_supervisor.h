@@ -2,6 +2,7 @@
 #define SYSTEM_SUPERVISOR_H
 
 #include <Arduino.h>
+#include "fsm.h"
 
 /**
  * System-level finite state machine for the audio-reactive kinetic sculpture.
@@ -12,6 +13,10 @@
  * - ACTIVE: motor speed reacts to audio amplitude
  * - FAULT: motor off due to detected fault (e.g., sampling timer stalled)
  * - SHUTDOWN: intentional stop (motor off) until user wakes/reset
+ *
+ * The transitions are a constexpr table (fsm.h) in system_supervisor.cpp. Outputs
+ * change on edges only: the motor is driven in ACTIVE and stopped when leaving it,
+ * so IDLE, FAULT and SHUTDOWN ticks do not touch the hardware.
  */
 enum SystemState {
   SYSTEM_INIT = 0,
@@ -24,19 +29,34 @@ enum SystemState {
 // Initialize supervisor state machine.
 void initSystemSupervisor();
 
-// Tick supervisor: call frequently from loop().
+// Tick supervisor: call every MOTOR_UPDATE_INTERVAL (the scheduler's supervisor task).
+// Staged runtime config changes take effect at the start of the tick.
 // - nowMs: current millis()
 // - audioSampleCount: monotonic count from ISR (used for health monitoring)
 // - amplitude: current smoothed amplitude from audio processor
 void systemSupervisorTick(unsigned long nowMs, unsigned long audioSampleCount, int amplitude);
 
+// Periodic status output (the scheduler's status task): one telemetry record with
+// ENABLE_BINARY_TELEMETRY, otherwise a text debug line while ACTIVE.
+void systemSupervisorReport(unsigned long nowMs);
+
 // Handle user commands from Serial (non-blocking).
 // Commands:
 // - 's'/'S': enter SHUTDOWN (motor off)
 // - 'w'/'W': wake from SHUTDOWN (go to IDLE)
 // - 'r'/'R': clear FAULT and re-enter INIT (attempt recovery)
+// - 'p'/'P': print per-stage loop() timing statistics (loop_profiler.h)
+// - 'c'/'C': start / stop a raw capture; starting restarts the signal chain (raw_capture.h)
+// - '$...' + newline: runtime config command (runtime_config.h)
 void systemSupervisorHandleSerial(unsigned long nowMs);
 
+// A FAULT line ("FAULT: <reason>") has not been completely written yet.
+bool systemSupervisorTextPending();
+
+// Continue it without blocking; call between telemetry frames (telemetryFinishFrame()),
+// like the profiler report. Returns true while there is more to write.
+bool systemSupervisorServiceText();
+
 // Current state getter (for tests/debugging).
 SystemState getSystemState();
 
@@ -49,6 +69,10 @@ bool isFaultLatched();
 // Returns the last fault reason string (may be empty).
 const char *getLastFaultReason();
 
+// Recent state transitions (at most SUPERVISOR_TRACE_SIZE), index 0 = oldest.
+size_t getSupervisorTraceSize();
+const FsmTraceEntry &getSupervisorTraceEntry(size_t index);
+
 #endif // SYSTEM_SUPERVISOR_H
 
 
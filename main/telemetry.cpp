@@ -0,0 +1,154 @@
+#include "telemetry.h"
+#include "config.h"
+#include <Arduino.h>
+
+static_assert((TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1)) == 0, "TELEMETRY_RING_SIZE must be a power of two");
+static_assert(TELEMETRY_RING_SIZE >= 2 * TELEMETRY_FRAME_SIZE, "TELEMETRY_RING_SIZE must hold at least two frames");
+
+static const uint32_t RING_MASK = TELEMETRY_RING_SIZE - 1;
+
+// Producer (telemetrySend) and consumer (telemetryFlush) both run in loop(),
+// so plain free-running indices are enough here.
+static uint8_t ringBytes[TELEMETRY_RING_SIZE];
+static uint32_t ringHead = 0;
+static uint32_t ringTail = 0;
+
+static uint16_t frameBytesLeft = 0;  // of the frame at the tail (0: at a frame boundary)
+
+static uint16_t nextSequence = 0;
+static unsigned long dropCount = 0;
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+void initTelemetry() {
+  ringHead = 0;
+  ringTail = 0;
+  frameBytesLeft = 0;
+  nextSequence = 0;
+  dropCount = 0;
+}
+
+static uint8_t crc8Update(uint8_t crc, const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint8_t telemetryCrc8(const uint8_t *data, size_t length) {
+  return crc8Update(0, data, length);
+}
+
+size_t telemetryEncode(const TelemetryRecord &record, uint16_t sequence, uint16_t drops, uint8_t *out) {
+  out[0] = TELEMETRY_SYNC0;
+  out[1] = TELEMETRY_SYNC1;
+  out[2] = TELEMETRY_TYPE_STATUS;
+  out[3] = (uint8_t)TELEMETRY_PAYLOAD_SIZE;
+  uint8_t *p = out + 4;
+  put16(p + 0, sequence);
+  put32(p + 2, record.timestampMs);
+  put16(p + 6, record.rawSample);
+  put16(p + 8, record.amplitude);
+  put16(p + 10, record.dcOffset);
+  p[12] = record.pwm;
+  p[13] = record.state;
+  put16(p + 14, drops);
+  out[TELEMETRY_FRAME_SIZE - 1] = telemetryCrc8(out + 2, TELEMETRY_FRAME_SIZE - 3);
+  return TELEMETRY_FRAME_SIZE;
+}
+
+static void queueBytes(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    ringBytes[(ringHead + i) & RING_MASK] = data[i];
+  }
+  ringHead += length;
+}
+
+bool telemetrySend(const TelemetryRecord &record) {
+  const uint16_t sequence = nextSequence++;
+  if (TELEMETRY_RING_SIZE - (ringHead - ringTail) < TELEMETRY_FRAME_SIZE) {
+    dropCount++;
+    return false;
+  }
+
+  uint8_t frame[TELEMETRY_FRAME_SIZE];
+  const uint16_t drops = (dropCount > 0xFFFF) ? 0xFFFF : (uint16_t)dropCount;
+  telemetryEncode(record, sequence, drops, frame);
+  queueBytes(frame, TELEMETRY_FRAME_SIZE);
+  return true;
+}
+
+bool telemetrySendFrame(uint8_t type, const uint8_t *payload, size_t length) {
+  if (length > TELEMETRY_MAX_PAYLOAD || TELEMETRY_RING_SIZE - (ringHead - ringTail) < length + 5) {
+    dropCount++;
+    return false;
+  }
+
+  uint8_t header[4] = {TELEMETRY_SYNC0, TELEMETRY_SYNC1, type, (uint8_t)length};
+  const uint8_t crc = crc8Update(telemetryCrc8(header + 2, 2), payload, length);
+  queueBytes(header, sizeof(header));
+  queueBytes(payload, length);
+  queueBytes(&crc, 1);
+  return true;
+}
+
+// Frames are written whole or in pieces; track where the one at the tail ends (its
+// length byte is still in the ring: only loop() writes, after this returns).
+static void advanceFrames(uint32_t from, unsigned written) {
+  while (written > 0) {
+    if (frameBytesLeft == 0) frameBytesLeft = (uint16_t)(ringBytes[(from + 3) & RING_MASK] + 5);
+    const unsigned step = (written < frameBytesLeft) ? written : frameBytesLeft;
+    frameBytesLeft -= step;
+    from += step;
+    written -= step;
+  }
+}
+
+// Write up to `limit` queued bytes, no more than the UART takes without blocking.
+static unsigned writeQueued(uint32_t limit) {
+  const uint32_t from = ringTail;
+  unsigned written = 0;
+  int room = Serial.availableForWrite();
+  // At most two contiguous runs (before and after the wrap point).
+  while (room > 0 && ringTail != ringHead && written < limit) {
+    const uint32_t index = ringTail & RING_MASK;
+    uint32_t run = ringHead - ringTail;
+    if (run > TELEMETRY_RING_SIZE - index) run = TELEMETRY_RING_SIZE - index;
+    if (run > (uint32_t)room) run = (uint32_t)room;
+    if (run > limit - written) run = limit - written;
+    Serial.write(ringBytes + index, run);
+    ringTail += run;
+    room -= (int)run;
+    written += run;
+  }
+  advanceFrames(from, written);
+  return written;
+}
+
+unsigned telemetryFlush() {
+  return writeQueued(0xFFFFFFFFUL);
+}
+
+bool telemetryFinishFrame() {
+  if (frameBytesLeft != 0) writeQueued(frameBytesLeft);
+  return frameBytesLeft == 0;
+}
+
+unsigned telemetryPending() {
+  return ringHead - ringTail;
+}
+
+unsigned long getTelemetryDropCount() {
+  return dropCount;
+}
@@ -0,0 +1,87 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Non-blocking binary telemetry over Serial (replaces the periodic text debug output).
+ *
+ * Records are encoded into frames and queued in a byte ring; the scheduler's serial
+ * task calls telemetryFlush() every SERIAL_POLL_INTERVAL_MS, which hands the UART only
+ * as many bytes as its TX buffer can take without blocking. A frame that does not fit
+ * in the ring is dropped and counted, so a slow link costs data, never control-loop time.
+ *
+ * Frame (length + 5 bytes, multi-byte fields little-endian):
+ *   0xA5 0x5A                      sync
+ *   type                           record type
+ *   length                         payload bytes (0..TELEMETRY_MAX_PAYLOAD)
+ *   payload
+ *   crc8                           CRC-8 (poly 0x07, init 0) over type, length and payload
+ *
+ * Status frame (TELEMETRY_TYPE_STATUS, TELEMETRY_FRAME_SIZE bytes), payload:
+ *     u16 sequence                 +1 per record, dropped ones included (gaps = drops)
+ *     u32 timestamp                millis()
+ *     u16 raw sample               latest ADC reading
+ *     u16 amplitude                envelope, ADC counts
+ *     u16 dc estimate              DC baseline, ADC counts
+ *     u8  pwm                      motor PWM (0-255)
+ *     u8  state                    SystemState
+ *     u16 drops                    frames dropped so far (saturates at 65535)
+ * Raw capture frames (TELEMETRY_TYPE_CAPTURE) are described in raw_capture.h; decoders
+ * skip types they do not know by their length.
+ *
+ * Text shares the stream: the boot banner, and the profiler report, config replies
+ * and FAULT reasons, which wait for telemetryFinishFrame() so they land between two
+ * frames. Decoders resync on the sync bytes and drop frames failing the CRC.
+ * tools/telemetry_decode.py turns a stream into CSV.
+ */
+
+static const uint8_t TELEMETRY_SYNC0 = 0xA5;
+static const uint8_t TELEMETRY_SYNC1 = 0x5A;
+static const uint8_t TELEMETRY_TYPE_STATUS = 0x01;
+static const uint8_t TELEMETRY_TYPE_CAPTURE = 0x02;
+static const size_t TELEMETRY_MAX_PAYLOAD = 255;
+static const size_t TELEMETRY_PAYLOAD_SIZE = 16;  // status frames
+static const size_t TELEMETRY_FRAME_SIZE = 4 + TELEMETRY_PAYLOAD_SIZE + 1;
+
+struct TelemetryRecord {
+  uint32_t timestampMs;
+  uint16_t rawSample;
+  uint16_t amplitude;
+  uint16_t dcOffset;
+  uint8_t pwm;
+  uint8_t state;
+};
+
+// Empty the queue and reset the sequence number and drop counter.
+void initTelemetry();
+
+// Queue one record. Returns false (and counts a drop) if the queue has no room for it.
+bool telemetrySend(const TelemetryRecord &record);
+
+// Queue one frame of any type (length <= TELEMETRY_MAX_PAYLOAD). Returns false (and
+// counts a drop) if the queue has no room for it.
+bool telemetrySendFrame(uint8_t type, const uint8_t *payload, size_t length);
+
+// Write queued bytes to Serial without blocking (at most Serial.availableForWrite()).
+// Returns the number of bytes written.
+unsigned telemetryFlush();
+
+// Write only the rest of a partly sent frame (without blocking). Returns true once
+// no frame is partly sent, i.e. other output may go to Serial without splitting one.
+bool telemetryFinishFrame();
+
+// Bytes waiting to be written.
+unsigned telemetryPending();
+
+// Frames dropped because the queue was full.
+unsigned long getTelemetryDropCount();
+
+// Encode one frame into out[TELEMETRY_FRAME_SIZE]; returns TELEMETRY_FRAME_SIZE.
+size_t telemetryEncode(const TelemetryRecord &record, uint16_t sequence, uint16_t drops, uint8_t *out);
+
+// CRC-8 (poly 0x07, init 0x00) as used by the frame trailer.
+uint8_t telemetryCrc8(const uint8_t *data, size_t length);
+
+#endif // TELEMETRY_H
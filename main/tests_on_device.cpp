@@ -6,6 +6,8 @@
 #include "watchdog_utils.h"
 #include "system_supervisor.h"
 #include "timer_setup.h"
+#include "sample_ring.h"
+#include "runtime_config.h"
 
 #include <Arduino.h>
 
@@ -63,8 +65,24 @@ static void runTest(const char *name, bool (*testFunc)()) {
   }
 }
 
-// Access internals for a couple of unit tests (OK for tests-only code)
-extern volatile int audioBuffer[];
+// Queue `count` copies of `value` as if the sampling ISR had produced them.
+static void feedSamples(int value, int count) {
+  for (int i = 0; i < count; i++) {
+    sampleRingPush(value);
+  }
+}
+
+// Queue and process `count` samples in ring-sized chunks (so none are dropped).
+static int feedAndProcess(int value, int count) {
+  int amp = getSmoothedAmplitude();
+  while (count > 0) {
+    const int chunk = (count < SAMPLE_RING_SIZE) ? count : SAMPLE_RING_SIZE;
+    feedSamples(value, chunk);
+    amp = processAudio();
+    count -= chunk;
+  }
+  return amp;
+}
 
 static bool test_config_constants() {
   ASSERT_TRUE(SAMPLE_RATE > 0 && SAMPLE_RATE <= 10000);
@@ -74,6 +92,7 @@ static bool test_config_constants() {
   ASSERT_TRUE(MOTOR_UPDATE_INTERVAL > 0);
   ASSERT_TRUE(IDLE_TIMEOUT_MS > 0);
   ASSERT_TRUE(ACTIVE_ENTER_THRESHOLD > ACTIVE_EXIT_THRESHOLD);
+  ASSERT_TRUE(ACTIVE_ENTER_FLOOR_PCT > ACTIVE_EXIT_FLOOR_PCT && ACTIVE_EXIT_FLOOR_PCT >= 100);
   ASSERT_TRUE(SAMPLE_STALL_TIMEOUT_MS > 0);
   return true;
 }
@@ -89,21 +108,34 @@ static bool test_audio_processor_smoothing() {
   initAudioProcessor();
   setAutoCalibrationEnabled(false);
 
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = 700; // above DC offset
-  }
+  feedSamples(700, BUFFER_SIZE); // above DC offset
+  ASSERT_TRUE(isNewSampleReady());
 
   int amp = processAudio();
+  ASSERT_TRUE(!isNewSampleReady());
   ASSERT_TRUE(amp > 0);
   ASSERT_RANGE(amp, 50, 300);
 
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = DC_OFFSET;
-  }
-  for (int i = 0; i < 50; i++) {
-    amp = processAudio();
-  }
-  ASSERT_RANGE(amp, 0, 20);
+  // Release is deliberately slower than attack: still up shortly after, gone after ~5 time constants.
+  amp = feedAndProcess(DC_OFFSET, 20);
+  ASSERT_TRUE(amp > 20);
+  amp = feedAndProcess(DC_OFFSET, ENVELOPE_RELEASE_MS * (SAMPLE_RATE / 1000) * 6);
+  ASSERT_RANGE(amp, 0, 2);
+  return true;
+}
+
+static bool test_sample_ring_overrun_accounting() {
+  initAudioProcessor();
+  ASSERT_EQUAL(0UL, getSampleRingOverrunCount());
+
+  // Fill past capacity without draining: extra samples are dropped and counted.
+  feedSamples(DC_OFFSET, SAMPLE_RING_SIZE + 3);
+  ASSERT_EQUAL((unsigned)SAMPLE_RING_SIZE, sampleRingAvailable());
+  ASSERT_EQUAL((unsigned)SAMPLE_RING_SIZE, getSampleRingHighWaterMark());
+  ASSERT_EQUAL(3UL, getSampleRingOverrunCount());
+
+  processAudio();
+  ASSERT_EQUAL(0u, sampleRingAvailable());
   return true;
 }
 
@@ -123,16 +155,12 @@ static bool test_integration_audio_to_motor() {
   setAutoCalibrationEnabled(false);
   initMotorController();
 
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = 520;
-  }
+  feedSamples(520, BUFFER_SIZE);
   int amp = processAudio();
   updateMotorSpeed(amp);
   delay(5);
 
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = 800;
-  }
+  feedSamples(800, BUFFER_SIZE);
   amp = processAudio();
   updateMotorSpeed(amp);
   delay(5);
@@ -170,15 +198,16 @@ static bool test_supervisor_idle_to_active_and_back() {
   unsigned long now = millis();
   for (int i = 0; i < 10; i++) {
     sampleCount = getAudioSampleCount();
-    systemSupervisorTick(now, sampleCount, ACTIVE_ENTER_THRESHOLD + 10);
+    systemSupervisorTick(now, sampleCount, runtimeConfig().activeEnterThreshold + 10);
     delay(10);
     now = millis();
   }
   ASSERT_TRUE(getSystemState() == SYSTEM_ACTIVE);
 
   // Now simulate silence; wait past IDLE timeout and ensure we eventually return to IDLE.
+  // (The thresholds in effect may come from a saved runtime config, not config.h.)
   unsigned long start = millis();
-  while (millis() - start < (IDLE_TIMEOUT_MS + 500)) {
+  while (millis() - start < (runtimeConfig().idleTimeoutMs + 500)) {
     sampleCount = getAudioSampleCount();
     systemSupervisorTick(millis(), sampleCount, 0);
     delay(10);
@@ -199,6 +228,7 @@ bool runAllTests() {
   runTest("config_constants", test_config_constants);
   runTest("audio_processor_initialization", test_audio_processor_initialization);
   runTest("audio_processor_smoothing", test_audio_processor_smoothing);
+  runTest("sample_ring_overrun_accounting", test_sample_ring_overrun_accounting);
   runTest("motor_controller_basic", test_motor_controller_basic);
   runTest("watchdog_smoke", test_watchdog_smoke);
   runTest("supervisor_idle_active_idle", test_supervisor_idle_to_active_and_back);
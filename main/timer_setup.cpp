@@ -1,12 +1,14 @@
 #include "timer_setup.h"
+#include "cic_decimator.h"
 #include "config.h"
+#include "sample_ring.h"
+#include "sampling_hal.h"
+#include "sample_jitter.h"
+#include "scheduler.h"
 #include <Arduino.h>
 #include <FspTimer.h>
 
-// External references to audio buffer (defined in audio_processor.cpp)
-extern volatile int audioBuffer[];
-extern volatile int bufferIndex;
-extern volatile bool newSampleReady;
+// Latest raw reading (defined in audio_processor.cpp)
 extern volatile int latestRawSample;
 
 // Timer instance for Renesas RA4M1
@@ -14,23 +16,64 @@ FspTimer audioTimer;
 static volatile unsigned long audioSampleCount = 0;
 static bool audioTimerOk = false;
 
+#if ADC_OVERSAMPLING > 1
+// Conversions -> samples at SAMPLE_RATE (owned by the sampling interrupt).
+typedef CicDecimator<ADC_CIC_ORDER, ADC_OVERSAMPLING> AdcDecimator;
+static_assert(ADC_RESOLUTION_BITS + AdcDecimator::GAIN_BITS <= 31, "CIC output must fit 31 bits");
+static AdcDecimator adcDecimator;
+#endif
+
 // Timer callback function - samples audio at precise intervals
 void audioTimerCallback(timer_callback_args_t *args) {
   (void)args; // Unused parameter
   
-  audioSampleCount++;
+  // Timestamp first, so the jitter reflects interrupt latency, not the ADC read.
+  sampleJitterRecord(cycleCounterNow(), SAMPLE_PERIOD_CYCLES);
 
   // Read audio sample
   latestRawSample = analogRead(MIC_PIN);
-  
-  // Add to rolling buffer
-  audioBuffer[bufferIndex] = latestRawSample;
-  bufferIndex = (bufferIndex + 1) % BUFFER_SIZE;
-  
-  // Flag that new sample is ready
-  newSampleReady = true;
+#if ADC_OVERSAMPLING > 1
+  // Every ADC_OVERSAMPLING-th conversion completes a sample.
+  if (!adcDecimator.push(latestRawSample)) return;
+  const int sample = adcDecimator.output();
+#else
+  const int sample = latestRawSample;
+#endif
+  audioSampleCount++;
+
+  // Publish to the loop() consumer (drops and counts an overrun if the ring is full)
+  sampleRingPush(sample);
+  schedulerSignal(TASK_AUDIO);
 }
 
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+static_assert(SAMPLE_BLOCK_SIZE % ADC_OVERSAMPLING == 0, "a block must hold whole samples");
+
+// Block sampling: called once per SAMPLE_BLOCK_SIZE conversions (sampling_hal.h)
+static void audioBlockCallback(const uint16_t *samples, uint16_t count) {
+  // The ADC is paced by hardware; this measures the block interrupt's period.
+  sampleJitterRecord(cycleCounterNow(), SAMPLE_PERIOD_CYCLES * count);
+  latestRawSample = samples[count - 1];
+
+#if ADC_OVERSAMPLING > 1
+  uint16_t decimated[SAMPLE_BLOCK_SIZE / ADC_OVERSAMPLING];
+  uint16_t produced = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (adcDecimator.push(samples[i]) && produced < SAMPLE_BLOCK_SIZE / ADC_OVERSAMPLING) {
+      decimated[produced++] = (uint16_t)adcDecimator.output();
+    }
+  }
+  samples = decimated;
+  count = produced;
+#endif
+  audioSampleCount += count;
+
+  // One publish for the whole block (drops and counts overruns if the ring is full)
+  sampleRingPushBlock(samples, count);
+  schedulerSignal(TASK_AUDIO);
+}
+#endif
+
 unsigned long getAudioSampleCount() {
   return audioSampleCount;
 }
@@ -40,7 +83,7 @@ bool isAudioTimerOk() {
 }
 
 void initAudioTimer() {
-  // Setup timer for 1kHz sampling (1000 Hz) using the Arduino Renesas core's FspTimer.
+  // Setup timer for 1kHz sampling (1000 Hz, times ADC_OVERSAMPLING) using the Arduino Renesas core's FspTimer.
   // Important: pick a real channel using get_available_timer(); passing -1 does NOT auto-select.
 
   uint8_t timer_type = GPT_TIMER;
@@ -51,18 +94,39 @@ void initAudioTimer() {
     return;
   }
 
+  cycleCounterInit();
+  sampleJitterReset();
+#if ADC_OVERSAMPLING > 1
+  analogReadResolution(ADC_RESOLUTION_BITS);
+  adcDecimator.reset((int32_t)DC_OFFSET << SAMPLE_FRACTION_BITS);
+#endif
+
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+  // Block sampling: the timer only paces the ADC through the event link, no timer IRQ.
+  GPTimerCbk_f sampleCallback = nullptr;
+#else
+  GPTimerCbk_f sampleCallback = audioTimerCallback;
+#endif
+
   // Periodic mode: we only care about frequency; duty is ignored but must be provided.
   if (!audioTimer.begin(TIMER_MODE_PERIODIC,
                         timer_type,
                         static_cast<uint8_t>(timer_channel),
-                        static_cast<float>(SAMPLE_RATE),
+                        static_cast<float>(SAMPLE_RATE * ADC_OVERSAMPLING),
                         50.0f,
-                        audioTimerCallback)) {
+                        sampleCallback)) {
     Serial.println("ERROR: Failed to initialize audio timer (begin)!");
     audioTimerOk = false;
     return;
   }
 
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+  if (!samplingHalBegin(audioTimer, static_cast<uint8_t>(timer_channel), MIC_PIN, audioBlockCallback)) {
+    Serial.println("ERROR: Failed to set up block sampling (ADC/DMA)!");
+    audioTimerOk = false;
+    return;
+  }
+#else
   if (!audioTimer.setup_overflow_irq()) {
     Serial.println("ERROR: Failed to setup timer overflow IRQ!");
     audioTimerOk = false;
@@ -71,6 +135,7 @@ void initAudioTimer() {
 
   // Some cores require explicitly enabling the IRQ.
   audioTimer.enable_overflow_irq();
+#endif
 
   if (!audioTimer.open()) {
     Serial.println("ERROR: Failed to open audio timer!");
@@ -4,10 +4,14 @@
 /**
  * Initialize a hardware timer for precise audio sampling at SAMPLE_RATE Hz.
  * On Arduino UNO R4 (Renesas RA4M1), this uses the Arduino Renesas core's FspTimer.
+ * With SAMPLING_BACKEND_BLOCK_DMA the timer has no interrupt of its own: it triggers
+ * the ADC through sampling_hal.h and samples arrive in SAMPLE_BLOCK_SIZE blocks.
+ * With ADC_OVERSAMPLING > 1 the timer runs that many times faster, the ADC at 14 bits,
+ * and a CIC decimator (cic_decimator.h) turns the conversions into samples.
  */
 void initAudioTimer();
 
-// Returns the number of audio samples captured since boot.
+// Returns the number of audio samples captured since boot (after decimation).
 // Useful for debugging whether the timer callback is running.
 unsigned long getAudioSampleCount();
 
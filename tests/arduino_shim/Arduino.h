@@ -0,0 +1,8 @@
+// Desktop stand-in for the Arduino core header, so unmodified main/ sources
+// compile against the mocks in tests/mock_arduino.*.
+#ifndef ARDUINO_SHIM_ARDUINO_H
+#define ARDUINO_SHIM_ARDUINO_H
+
+#include "../mock_arduino.h"
+
+#endif // ARDUINO_SHIM_ARDUINO_H
@@ -0,0 +1,91 @@
+#include "FspTimer.h"
+#include "../virtual_clock.h"
+
+static bool failNextBegin = false;
+static bool noChannelAvailable = false;
+static int8_t nextChannel = 0;
+
+FspTimer::FspTimer()
+    : eventLink_(nullptr), eventLinkCtx_(nullptr), irqLatency_(nullptr), irqLatencyCtx_(nullptr), freqHz_(0.0f), callback_(nullptr), ctx_(nullptr), handle_(-1), epoch_(0) {}
+
+bool FspTimer::is_running() const {
+  return handle_ >= 0 && epoch_ == virtualClockEpoch();
+}
+
+int8_t FspTimer::get_available_timer(uint8_t &type) {
+  (void)type;
+  if (noChannelAvailable) return -1;
+  return nextChannel++;
+}
+
+bool FspTimer::begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc,
+                     GPTimerCbk_f callback, void *ctx) {
+  (void)mode;
+  (void)type;
+  (void)channel;
+  (void)duty_perc;
+  if (failNextBegin) {
+    failNextBegin = false;
+    return false;
+  }
+  if (freq_hz <= 0.0f) return false;
+  freqHz_ = freq_hz;
+  callback_ = callback;
+  ctx_ = ctx;
+  return true;
+}
+
+bool FspTimer::setup_overflow_irq() {
+  return callback_ != nullptr;
+}
+
+bool FspTimer::open() {
+  return freqHz_ > 0.0f;
+}
+
+bool FspTimer::start() {
+  if (is_running()) return true;
+  const uint64_t periodNanos = (uint64_t)(1e9 / (double)freqHz_ + 0.5);
+  handle_ = virtualClockAddPeriodic(periodNanos, &FspTimer::fire, this);
+  epoch_ = virtualClockEpoch();
+  return handle_ >= 0;
+}
+
+bool FspTimer::stop() {
+  if (is_running()) virtualClockRemove(handle_);
+  handle_ = -1;
+  return true;
+}
+
+void FspTimer::end() {
+  stop();
+  callback_ = nullptr;
+}
+
+void FspTimer::fire(void *self) {
+  FspTimer *t = static_cast<FspTimer *>(self);
+  if (t->eventLink_ != nullptr) t->eventLink_(t->eventLinkCtx_);
+  if (t->callback_ == nullptr) return;
+  if (t->irqLatency_ != nullptr) virtualClockAdvanceBy(t->irqLatency_(t->irqLatencyCtx_));
+  timer_callback_args_t args;
+  args.p_context = t->ctx_;
+  t->callback_(&args);
+}
+
+void fspTimerMockFailNextBegin() {
+  failNextBegin = true;
+}
+
+void fspTimerMockSetNoChannelAvailable(bool none) {
+  noChannelAvailable = none;
+}
+
+void fspTimerMockLinkEvent(FspTimer &timer, void (*fn)(void *ctx), void *ctx) {
+  timer.eventLink_ = fn;
+  timer.eventLinkCtx_ = ctx;
+}
+
+void fspTimerMockSetIrqLatency(FspTimer &timer, uint64_t (*fn)(void *ctx), void *ctx) {
+  timer.irqLatency_ = fn;
+  timer.irqLatencyCtx_ = ctx;
+}
@@ -0,0 +1,72 @@
+// Desktop stand-in for the Arduino Renesas core's FspTimer.
+// A started timer registers a periodic interrupt on the virtual clock
+// (tests/virtual_clock.h), which calls the user callback at the configured rate.
+#ifndef ARDUINO_SHIM_FSPTIMER_H
+#define ARDUINO_SHIM_FSPTIMER_H
+
+#include <cstdint>
+
+#define GPT_TIMER 0
+#define AGT_TIMER 1
+
+enum timer_mode_t {
+  TIMER_MODE_PERIODIC = 1
+};
+
+struct timer_callback_args_t {
+  void const *p_context;
+};
+
+typedef void (*GPTimerCbk_f)(timer_callback_args_t *args);
+
+class FspTimer {
+public:
+  FspTimer();
+
+  static int8_t get_available_timer(uint8_t &type);
+
+  bool begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc,
+             GPTimerCbk_f callback, void *ctx = nullptr);
+  bool setup_overflow_irq();
+  void enable_overflow_irq() {}
+  bool open();
+  bool start();
+  bool stop();
+  void end();
+
+  bool is_running() const;
+
+  // Invoked by the virtual clock at every period.
+  static void fire(void *self);
+
+  // Peripheral linked to this timer's overflow event (see fspTimerMockLinkEvent).
+  void (*eventLink_)(void *ctx);
+  void *eventLinkCtx_;
+
+  // Interrupt entry latency model (see fspTimerMockSetIrqLatency).
+  uint64_t (*irqLatency_)(void *ctx);
+  void *irqLatencyCtx_;
+
+private:
+  float freqHz_;
+  GPTimerCbk_f callback_;
+  void *ctx_;
+  int handle_;
+  uint32_t epoch_;  // virtual clock epoch handle_ belongs to
+};
+
+// Test hooks: make the next begin() fail / report no free channel.
+void fspTimerMockFailNextBegin();
+void fspTimerMockSetNoChannelAvailable(bool none);
+
+// Stand-in for the ELC: run `fn` on every period of `timer` (before its callback, if
+// any), the way hardware linked to the overflow event (ADC start, DMA) reacts to it.
+// Pass nullptr to unlink.
+void fspTimerMockLinkEvent(FspTimer &timer, void (*fn)(void *ctx), void *ctx);
+
+// Delay the callback of `timer` by fn(ctx) nanoseconds of virtual time on every period,
+// as if its interrupt were held off (by a higher-priority handler, a critical section).
+// The period itself stays exact; linked events are not delayed. nullptr = no latency.
+void fspTimerMockSetIrqLatency(FspTimer &timer, uint64_t (*fn)(void *ctx), void *ctx);
+
+#endif // ARDUINO_SHIM_FSPTIMER_H
@@ -0,0 +1,232 @@
+#include "capture_replay.h"
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+#include "main/audio_processor.h"
+#include "main/motor_controller.h"
+#include "main/raw_capture.h"
+#include "main/sample_jitter.h"
+#include "main/sample_ring.h"
+#include "main/system_supervisor.h"
+#include "main/telemetry.h"
+#include "main/timer_setup.h"
+
+// Bounds-checked little-endian reader over one frame payload.
+struct PayloadReader {
+    const uint8_t *p;
+    size_t left;
+    bool ok;
+
+    uint8_t u8() {
+        if (left < 1) return fail();
+        left--;
+        return *p++;
+    }
+    uint32_t le(int bytes) {
+        uint32_t v = 0;
+        for (int i = 0; i < bytes; i++) v |= (uint32_t)u8() << (8 * i);
+        return v;
+    }
+    uint32_t varint() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            const uint8_t b = u8();
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        return fail();
+    }
+    bool record(RuntimeConfig &config) {
+        if (left < RUNTIME_CONFIG_RECORD_SIZE) return fail();
+        const bool valid = runtimeConfigDecode(p, config) == RUNTIME_CONFIG_OK;
+        p += RUNTIME_CONFIG_RECORD_SIZE;
+        left -= RUNTIME_CONFIG_RECORD_SIZE;
+        return valid || fail();
+    }
+    uint8_t fail() {
+        ok = false;
+        left = 0;
+        return 0;
+    }
+};
+
+bool decodeCapture(const std::string &bytes, CaptureLog &log) {
+    log = CaptureLog();
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(bytes.data());
+    const size_t size = bytes.size();
+    uint16_t expected = 0;
+    int lastSample = 0;
+    uint32_t lastMs = 0, lastIsr = 0, lastJitter = 0;
+    bool done = false;
+
+    size_t i = 0;
+    while (!done && i + 5 <= size) {
+        if (b[i] != TELEMETRY_SYNC0 || b[i + 1] != TELEMETRY_SYNC1) {
+            i++;
+            continue;
+        }
+        const size_t frameSize = (size_t)b[i + 3] + 5;
+        if (i + frameSize > size) break;
+        if (telemetryCrc8(b + i + 2, frameSize - 3) != b[i + frameSize - 1]) {
+            log.badFrames++;
+            i++;
+            continue;
+        }
+        const uint8_t type = b[i + 2];
+        PayloadReader r = {b + i + 4, frameSize - 5, true};
+        i += frameSize;
+        if (type != TELEMETRY_TYPE_CAPTURE) continue;
+
+        const uint16_t sequence = (uint16_t)r.le(2);
+        CaptureEvent ev = {};
+        ev.type = r.u8();
+        if (!log.started) {
+            if (ev.type != RAW_CAPTURE_START) continue;  // joined mid-capture
+        } else if (sequence != expected) {
+            log.lostFrames = (uint16_t)(sequence - expected);
+            break;
+        }
+        expected = (uint16_t)(sequence + 1);
+
+        const uint32_t n = r.varint();
+        for (uint32_t k = 0; k < n && r.ok; k++) {
+            const uint32_t zigzag = r.varint();
+            lastSample += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            ev.samples.push_back(lastSample);
+        }
+
+        switch (ev.type) {
+            case RAW_CAPTURE_START: {
+                const uint8_t version = r.u8();
+                const uint16_t rate = (uint16_t)r.le(2);
+                const uint8_t channels = r.u8();
+                const uint8_t fractionBits = r.u8();
+                if (r.ok && (version != RAW_CAPTURE_VERSION || rate != SAMPLE_RATE || channels != MOTOR_CHANNELS ||
+                             fractionBits != SAMPLE_FRACTION_BITS)) {
+                    log.error = "capture from another build (format " + std::to_string(version) + ", " +
+                                std::to_string(rate) + " Hz, " + std::to_string(channels) + " motor channels, " +
+                                std::to_string(fractionBits) + " sample fraction bits)";
+                    return false;
+                }
+                log.started = true;
+                log.startMs = lastMs = r.le(4);
+                log.startIsrSampleCount = lastIsr = r.le(4);
+                log.startJitterCount = lastJitter = r.le(4);
+                r.record(log.config);
+                break;
+            }
+            case RAW_CAPTURE_TICK:
+                lastMs = ev.timeMs = lastMs + r.varint();
+                lastIsr = ev.isrSampleCount = lastIsr + r.varint();
+                lastJitter = ev.jitterCount = lastJitter + r.varint();
+                ev.state = r.u8();
+                for (int ch = 0; ch < MOTOR_CHANNELS; ch++) ev.pwm[ch] = r.u8();
+                log.ticks++;
+                break;
+            case RAW_CAPTURE_COMMAND:
+                lastMs = ev.timeMs = lastMs + r.varint();
+                ev.command = r.u8();
+                break;
+            case RAW_CAPTURE_CONFIG:
+                r.record(ev.config);
+                break;
+            case RAW_CAPTURE_STOP:
+                log.stopped = true;
+                done = true;
+                break;
+            case RAW_CAPTURE_SAMPLES:
+                break;
+            default:
+                r.fail();
+        }
+        if (!r.ok || r.left != 0) {
+            log.error = "malformed capture frame " + std::to_string(sequence);
+            return false;
+        }
+        log.samples += ev.samples.size();
+        if (ev.type != RAW_CAPTURE_START) log.events.push_back(ev);
+    }
+
+    if (!log.started) {
+        log.error = "no capture start in the stream";
+        return false;
+    }
+    return true;
+}
+
+// Make getSampleJitterOverLimitCount() reach `target` with periods far off nominal.
+static void injectJitterViolations(uint32_t target, uint32_t &cycles) {
+    while (getSampleJitterOverLimitCount() < target) {
+        cycles += 3 * SAMPLE_PERIOD_CYCLES;
+        sampleJitterRecord(cycles, SAMPLE_PERIOD_CYCLES);
+    }
+}
+
+// Through the sample ring, as the ISR delivers them.
+static void processSamples(const std::vector<int> &samples) {
+    size_t k = 0;
+    while (k < samples.size()) {
+        for (unsigned batch = 0; batch < 32 && k < samples.size(); batch++) sampleRingPush(samples[k++]);
+        processAudio();
+    }
+}
+
+ReplayResult replayCapture(const CaptureLog &log) {
+    ReplayResult result;
+
+    // The timer counts as started (INIT checks it) but never fires: the log is the ISR.
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    initAudioTimer();
+    uint64_t clockMs = log.startMs;
+    virtualClockReset(clockMs * 1000000ULL);
+    uint32_t jitterCycles = 0;
+    sampleJitterReset();
+    sampleJitterRecord(jitterCycles, SAMPLE_PERIOD_CYCLES);
+
+    // Same as the capture start: runtime config from the log, then the signal chain.
+    initRuntimeConfig();
+    runtimeConfigStage(log.config);
+    runtimeConfigApplyPending();
+    initTelemetry();
+    initAudioProcessor();
+    initMotorController();
+    initSystemSupervisor();
+    const unsigned long isrBase = getAudioSampleCount();
+
+    for (const CaptureEvent &ev : log.events) {
+        processSamples(ev.samples);
+        result.samples += ev.samples.size();
+        if (ev.type == RAW_CAPTURE_TICK || ev.type == RAW_CAPTURE_COMMAND) {
+            clockMs += (uint32_t)(ev.timeMs - (uint32_t)clockMs);
+            virtualClockAdvanceTo(clockMs * 1000000ULL);
+        }
+
+        if (ev.type == RAW_CAPTURE_TICK) {
+            injectJitterViolations(ev.jitterCount - log.startJitterCount, jitterCycles);
+            ReplayTick t;
+            t.timeMs = ev.timeMs;
+            t.amplitude = getSmoothedAmplitude();
+            systemSupervisorTick((unsigned long)clockMs, isrBase + (ev.isrSampleCount - log.startIsrSampleCount),
+                                 t.amplitude);
+            t.state = (uint8_t)getSystemState();
+            t.matches = t.state == ev.state;
+            for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+                t.pwm[ch] = (uint8_t)getMotorChannelPwm(ch);
+                if (t.pwm[ch] != ev.pwm[ch]) t.matches = false;
+            }
+            if (!t.matches) {
+                if (result.mismatches == 0) result.firstMismatch = result.ticks.size();
+                result.mismatches++;
+            }
+            result.ticks.push_back(t);
+        } else if (ev.type == RAW_CAPTURE_COMMAND) {
+            const char command[2] = {(char)ev.command, '\0'};
+            mockSerialInject(command);
+            systemSupervisorHandleSerial((unsigned long)clockMs);
+        } else if (ev.type == RAW_CAPTURE_CONFIG) {
+            runtimeConfigStage(ev.config);  // active from the next tick, as in the field
+        }
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef CAPTURE_REPLAY_H
+#define CAPTURE_REPLAY_H
+
+#include "main/config.h"
+#include "main/runtime_config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Desktop side of the raw capture (main/raw_capture.h).
+ *
+ * decodeCapture() pulls the capture frames out of a recorded serial stream (status
+ * frames and text around them are skipped) and rebuilds the event log: samples,
+ * ticks, commands and config changes with absolute values. replayCapture() then
+ * drives the real audio processor, motor bank and supervisor with it, as fast as the
+ * host runs: the sampling ISR's inputs (sample count, jitter violations) come from the
+ * log, the virtual clock jumps from tick to tick, and after every tick the state and
+ * channel PWMs are compared with what the sculpture did.
+ *
+ * The replay is only meaningful with the firmware revision (config.h, profiles) that
+ * recorded the log; its runtime config comes from the log itself.
+ */
+
+struct CaptureEvent {
+    uint8_t type;                   // RawCaptureEvent
+    std::vector<int> samples;       // processed before the event
+    uint32_t timeMs;                // TICK, COMMAND: millis() in the field
+    uint32_t isrSampleCount;        // TICK
+    uint32_t jitterCount;           // TICK
+    uint8_t state;                  // TICK: after the tick
+    uint8_t pwm[MOTOR_CHANNELS];    // TICK: after the tick
+    uint8_t command;                // COMMAND
+    RuntimeConfig config;           // CONFIG
+};
+
+struct CaptureLog {
+    bool started = false;           // a START frame was found
+    bool stopped = false;           // ... and its STOP frame (else: cut short or still running)
+    uint32_t startMs = 0;
+    uint32_t startIsrSampleCount = 0;
+    uint32_t startJitterCount = 0;
+    RuntimeConfig config = {};      // active at START
+    std::vector<CaptureEvent> events;  // after START, up to STOP or the first lost frame
+    size_t samples = 0;
+    size_t ticks = 0;
+    unsigned lostFrames = 0;        // capture frames missing at the first sequence gap
+    unsigned badFrames = 0;         // frames failing the CRC (anywhere in the stream)
+    std::string error;              // why the log cannot be replayed ("" if it can)
+};
+
+// Decode the first capture in `bytes`. Returns false (log.error says why) if there is
+// none, or it was recorded by a build with another format, sample rate or channel count.
+bool decodeCapture(const std::string &bytes, CaptureLog &log);
+
+struct ReplayTick {
+    uint32_t timeMs;
+    int amplitude;                  // what the supervisor was given
+    uint8_t state;                  // replayed
+    uint8_t pwm[MOTOR_CHANNELS];    // replayed
+    bool matches;                   // same state and PWMs as in the field
+};
+
+struct ReplayResult {
+    std::vector<ReplayTick> ticks;
+    size_t samples = 0;
+    size_t mismatches = 0;
+    size_t firstMismatch = SIZE_MAX;  // index into ticks
+};
+
+// Replay a decoded log. Resets the mocks, the virtual clock and every firmware module
+// the capture start resets (and the runtime config); the stream's own capture must
+// not be running.
+ReplayResult replayCapture(const CaptureLog &log);
+
+#endif // CAPTURE_REPLAY_H
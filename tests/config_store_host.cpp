@@ -0,0 +1,30 @@
+// Desktop implementation of the config store (main/config_store.h), backed by a file.
+#include "main/config_store.h"
+#include "config_store_host.h"
+
+#include <cstdio>
+#include <string>
+
+static std::string storePath;
+
+void configStoreHostSetPath(const char *path) {
+    storePath = path ? path : "";
+}
+
+bool configStoreRead(uint8_t *data, size_t length) {
+    if (storePath.empty()) return false;
+    FILE *f = std::fopen(storePath.c_str(), "rb");
+    if (!f) return false;
+    const size_t got = std::fread(data, 1, length, f);
+    std::fclose(f);
+    return got == length;
+}
+
+bool configStoreWrite(const uint8_t *data, size_t length) {
+    if (storePath.empty()) return false;
+    FILE *f = std::fopen(storePath.c_str(), "wb");
+    if (!f) return false;
+    const size_t put = std::fwrite(data, 1, length, f);
+    const bool closed = std::fclose(f) == 0;
+    return put == length && closed;
+}
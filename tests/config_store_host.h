@@ -0,0 +1,10 @@
+#ifndef CONFIG_STORE_HOST_H
+#define CONFIG_STORE_HOST_H
+
+// Desktop config store (main/config_store.h): the record lives in a file, so a saved
+// config survives a simulated power cycle (simBoot()) like it survives a reset on the
+// board. Without a file (the default) reads and writes fail, as on a board whose
+// storage is unavailable, and the firmware boots on its defaults.
+void configStoreHostSetPath(const char *path);  // nullptr = no storage
+
+#endif // CONFIG_STORE_HOST_H
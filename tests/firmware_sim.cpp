@@ -0,0 +1,60 @@
+#include "firmware_sim.h"
+#include "main/config.h"
+
+#include <algorithm>
+
+// Sketch entry points (compiled from main/main.ino by sim_sketch.cpp).
+void setup();
+void loop();
+
+static unsigned long loopCostMicros = 10;
+static SimTraceHook traceHook = nullptr;
+static void *traceCtx = nullptr;
+static uint64_t loopIterations = 0;
+
+void simBoot(uint64_t startNanos) {
+    virtualClockReset(startNanos);
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    traceHook = nullptr;
+    traceCtx = nullptr;
+    loopIterations = 0;
+    setup();
+}
+
+void simRunForMicros(uint64_t us) {
+    const uint64_t target = virtualClockNowNanos() + us * 1000ULL;
+
+    // loop() sleeps (__WFI) when no task is due, which moves the clock to the next
+    // interrupt or millis() tick; the limit keeps it from sleeping past the target.
+    mockSetSleepLimit(target);
+    while (virtualClockNowNanos() < target) {
+        // Charge the cost of waking up and running the due tasks.
+        virtualClockAdvanceTo(std::min<uint64_t>(target, virtualClockNowNanos() + (uint64_t)loopCostMicros * 1000ULL));
+        loop();
+        loopIterations++;
+        if (traceHook) traceHook(traceCtx);
+    }
+    mockSetSleepLimit(UINT64_MAX);
+}
+
+void simRunForMs(unsigned long ms) {
+    simRunForMicros((uint64_t)ms * 1000ULL);
+}
+
+void simSetLoopCostMicros(unsigned long us) {
+    loopCostMicros = us;
+}
+
+void simSetMicSignal(SimulatedAnalogSource fn, void *ctx) {
+    setSimulatedAnalogSource(MIC_PIN, fn, ctx);
+}
+
+void simSetTraceHook(SimTraceHook hook, void *ctx) {
+    traceHook = hook;
+    traceCtx = ctx;
+}
+
+uint64_t simLoopIterations() {
+    return loopIterations;
+}
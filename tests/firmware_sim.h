@@ -0,0 +1,39 @@
+#ifndef FIRMWARE_SIM_H
+#define FIRMWARE_SIM_H
+
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+/**
+ * Deterministic host simulator for the whole firmware (main/main.ino plus every main/ source).
+ *
+ * The real setup()/loop() run against the Arduino mocks on a virtual clock:
+ * the FspTimer shim fires the real audioTimerCallback at SAMPLE_RATE, and
+ * loop() is stepped between interrupts. loop() sleeps (__WFI) whenever no task is
+ * due, which skips the idle gap to the next interrupt or millisecond boundary,
+ * so hours of sculpture runtime run in well under a second of CPU time.
+ */
+
+// Power-cycle: reset the virtual clock (to startNanos), mocks and Serial hooks,
+// mute Serial echo, then run the firmware's setup().
+void simBoot(uint64_t startNanos = 0);
+
+// Run loop() until the virtual clock has advanced by the given amount.
+void simRunForMicros(uint64_t us);
+void simRunForMs(unsigned long ms);
+
+// Virtual time charged to every loop() iteration (default 10us). Serial output
+// can additionally cost time, see mockSerialSetTxBaud().
+void simSetLoopCostMicros(unsigned long us);
+
+// Drive the microphone pin from a callback (evaluated at every analogRead in the ISR).
+void simSetMicSignal(SimulatedAnalogSource fn, void *ctx);
+
+// Called after every loop() iteration (e.g. to record a state/PWM trace).
+typedef void (*SimTraceHook)(void *ctx);
+void simSetTraceHook(SimTraceHook hook, void *ctx);
+
+// loop() iterations executed since simBoot().
+uint64_t simLoopIterations();
+
+#endif // FIRMWARE_SIM_H
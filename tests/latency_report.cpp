@@ -0,0 +1,55 @@
+// Audio-to-motion latency of the simulated firmware on the DC motor model
+// (motion_latency.h), for the default settings and a sweep of motion profile,
+// enter debounce and enter threshold:
+//   ./latency_report [--tone COUNTS]...
+// By default at a loud tone (its level near AGC_TARGET_LEVEL, so the gain stays put
+// and the motion profile and motor dominate) and a quiet one (the AGC boosts it).
+#include "motion_latency.h"
+
+#include "main/config.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static std::string ms(double value) {
+    if (value < 0.0) return "never";
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(0) << value;
+    return os.str();
+}
+
+int main(int argc, char **argv) {
+    std::vector<double> tones;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--tone") == 0 && i + 1 < argc && std::atof(argv[i + 1]) > 0.0) {
+            tones.push_back(std::atof(argv[++i]));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--tone COUNTS]..." << std::endl;
+            return 2;
+        }
+    }
+    if (tones.empty()) tones = {420.0, 40.0};
+
+    std::cout << "Envelope detector alone (" << ENVELOPE_AVERAGING_MS << " ms averaging, " << ENVELOPE_RELEASE_MS
+              << " ms release), onset -> 90 % of the settled level; the firmware is built with "
+              << ENVELOPE_ATTACK_MS << " ms attack:" << std::endl;
+    for (const EnvelopeRise &rise : envelopeRiseMs(tones.front())) {
+        std::cout << "  attack " << std::setw(2) << rise.attackMs << " ms: " << ms(rise.to90Ms) << " ms" << std::endl;
+    }
+
+    for (double tone : tones) {
+        std::cout << "\n200 Hz tone, " << tone << " counts peak (ms after the onset)" << std::endl;
+        std::cout << std::left << std::setw(36) << "settings" << std::right << std::setw(8) << "->PWM" << std::setw(10)
+                  << "->motion" << std::setw(8) << "->90%" << std::setw(8) << "PWM" << std::setw(8) << "RPM" << std::endl;
+        for (const LatencySettings &settings : latencySweep()) {
+            const LatencyResult r = measureMotionLatency(settings, tone);
+            std::cout << std::left << std::setw(36) << settings.name << std::right << std::setw(8) << ms(r.toPwmMs)
+                      << std::setw(10) << ms(r.toMotionMs) << std::setw(8) << ms(r.to90Ms) << std::setw(8)
+                      << ms(r.settledPwm) << std::setw(8) << ms(r.settledRpm) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -1,68 +1,179 @@
 #include "mock_arduino.h"
-#include <chrono>
-#include <map>
+#include "virtual_clock.h"
+#include <deque>
 
 MockSerial Serial;
 
+// Plain per-pin arrays (not maps): the simulator hits these millions of times.
+static const int MOCK_PIN_COUNT = 64;
+
+struct AnalogSource {
+    SimulatedAnalogSource fn;
+    void *ctx;
+};
+
 // State tracking for mock hardware
-static std::map<int, int> pinModes;
-static std::map<int, int> digitalPins;
-static std::map<int, int> analogInputs;
-static std::map<int, int> pwmOutputs;
-static auto startTime = std::chrono::steady_clock::now();
+static int pinModes[MOCK_PIN_COUNT];
+static int digitalPins[MOCK_PIN_COUNT];
+static int analogInputs[MOCK_PIN_COUNT];
+static bool analogInputSet[MOCK_PIN_COUNT];
+static AnalogSource analogSources[MOCK_PIN_COUNT];
+static int pwmOutputs[MOCK_PIN_COUNT];
+static unsigned long pwmWrites[MOCK_PIN_COUNT];
+struct PinInterrupt {
+    void (*isr)();
+    int mode;
+};
+static PinInterrupt pinInterrupts[MOCK_PIN_COUNT];
+static int analogResolutionBits = 10;
+
+static bool validPin(int pin) {
+    return pin >= 0 && pin < MOCK_PIN_COUNT;
+}
+
+// Serial state
+static bool serialEcho = true;
+static unsigned long serialTxBaud = 0;
+static uint64_t serialTxIdleAtNanos = 0;  // when the UART will have sent everything queued
+static std::deque<char> serialInput;
+static std::string *serialCapture = nullptr;
+
+static uint64_t serialByteNanos() {
+    // 8N1: 10 bit-times per byte.
+    return 10ULL * 1000000000ULL / serialTxBaud;
+}
+
+// Queue len bytes on the modelled UART, blocking while the TX buffer is full.
+static void serialTransmit(size_t len) {
+    if (serialTxBaud == 0) return;
+    const uint64_t byteNanos = serialByteNanos();
+    const uint64_t now = virtualClockNowNanos();
+    if (serialTxIdleAtNanos < now) serialTxIdleAtNanos = now;
+    serialTxIdleAtNanos += (uint64_t)len * byteNanos;
+    const uint64_t buffered = (uint64_t)MOCK_SERIAL_TX_BUFFER * byteNanos;
+    if (serialTxIdleAtNanos > now + buffered) virtualClockAdvanceTo(serialTxIdleAtNanos - buffered);
+}
+
+void MockSerial::begin(long baud) {
+    if (serialEcho) {
+        std::cout << "[Serial initialized at " << baud << " baud]" << std::endl;
+    }
+}
+
+bool MockSerial::wantsOutput() {
+    return serialEcho || serialTxBaud > 0 || serialCapture != nullptr;
+}
+
+void MockSerial::emit(const char *text) {
+    size_t len = 0;
+    while (text[len] != '\0') len++;
+
+    if (serialEcho) std::cout << text;
+    if (serialCapture) serialCapture->append(text, len);
+    serialTransmit(len);
+}
+
+size_t MockSerial::write(const uint8_t *data, size_t len) {
+    if (serialCapture) serialCapture->append(reinterpret_cast<const char *>(data), len);
+    serialTransmit(len);
+    return len;
+}
+
+int MockSerial::availableForWrite() {
+    if (serialTxBaud == 0) return MOCK_SERIAL_TX_BUFFER;
+    const uint64_t now = virtualClockNowNanos();
+    if (serialTxIdleAtNanos <= now) return MOCK_SERIAL_TX_BUFFER;
+    const uint64_t byteNanos = serialByteNanos();
+    const uint64_t queued = (serialTxIdleAtNanos - now + byteNanos - 1) / byteNanos;
+    return queued >= (uint64_t)MOCK_SERIAL_TX_BUFFER ? 0 : MOCK_SERIAL_TX_BUFFER - (int)queued;
+}
+
+int MockSerial::available() {
+    return (int)serialInput.size();
+}
+
+int MockSerial::read() {
+    if (serialInput.empty()) return -1;
+    const char c = serialInput.front();
+    serialInput.pop_front();
+    return (unsigned char)c;
+}
 
 void pinMode(int pin, int mode) {
-    pinModes[pin] = mode;
+    if (validPin(pin)) pinModes[pin] = mode;
 }
 
 void digitalWrite(int pin, int value) {
-    digitalPins[pin] = value;
+    if (validPin(pin)) digitalPins[pin] = value;
 }
 
 int digitalRead(int pin) {
-    return digitalPins[pin];
+    return validPin(pin) ? digitalPins[pin] : LOW;
 }
 
 void analogWrite(int pin, int value) {
+    if (!validPin(pin)) return;
     pwmOutputs[pin] = value;
+    pwmWrites[pin]++;
+}
+
+void analogReadResolution(int bits) {
+    analogResolutionBits = bits;
+}
+
+// Simulated inputs are 10-bit values; other resolutions see them scaled, like the
+// same voltage converted at that resolution.
+static int atResolution(int value10) {
+    if (value10 < 0) return 0;
+    if (analogResolutionBits <= 10) return value10 >> (10 - analogResolutionBits);
+    const int value = value10 << (analogResolutionBits - 10);
+    const int fullScale = (1 << analogResolutionBits) - 1;
+    return value > fullScale ? fullScale : value;
 }
 
 int analogRead(int pin) {
-    // Return simulated value or default
-    if (analogInputs.find(pin) != analogInputs.end()) {
-        return analogInputs[pin];
+    if (validPin(pin)) {
+        if (analogSources[pin].fn) {
+            return atResolution(analogSources[pin].fn(analogSources[pin].ctx));
+        }
+        // Return simulated value or default
+        if (analogInputSet[pin]) {
+            return atResolution(analogInputs[pin]);
+        }
     }
-    return 512; // Default to DC offset
+    return atResolution(512); // Default to DC offset
 }
 
+// millis()/micros() come from the virtual clock and wrap at 32 bits like the
+// RA4M1 core, so rollover behavior can be exercised deterministically.
 unsigned long millis() {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
-    return duration.count();
+    return (unsigned long)(uint32_t)(virtualClockNowNanos() / 1000000ULL);
 }
 
 unsigned long micros() {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
-    return duration.count();
+    return (unsigned long)(uint32_t)(virtualClockNowNanos() / 1000ULL);
+}
+
+static uint64_t sleepLimitNanos = UINT64_MAX;
+
+void __WFI() {
+    const uint64_t now = virtualClockNowNanos();
+    uint64_t wake = (now / 1000000ULL + 1) * 1000000ULL;
+    if (virtualClockNextEventNanos() < wake) wake = virtualClockNextEventNanos();
+    if (sleepLimitNanos < wake) wake = sleepLimitNanos;
+    virtualClockAdvanceTo(wake);
+}
+
+void mockSetSleepLimit(uint64_t nanos) {
+    sleepLimitNanos = nanos;
 }
 
 void delay(unsigned long ms) {
-    auto start = std::chrono::steady_clock::now();
-    while (true) {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start);
-        if (elapsed.count() >= ms) break;
-    }
+    virtualClockAdvanceBy((uint64_t)ms * 1000000ULL);
 }
 
 void delayMicroseconds(unsigned int us) {
-    auto start = std::chrono::steady_clock::now();
-    while (true) {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
-        if (elapsed.count() >= us) break;
-    }
+    virtualClockAdvanceBy((uint64_t)us * 1000ULL);
 }
 
 long map(long x, long in_min, long in_max, long out_min, long out_max) {
@@ -75,15 +186,88 @@ int constrain(int x, int min, int max) {
     return x;
 }
 
+int digitalPinToInterrupt(int pin) {
+    return validPin(pin) ? pin : -1;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+    if (!validPin(interrupt)) return;
+    pinInterrupts[interrupt].isr = isr;
+    pinInterrupts[interrupt].mode = mode;
+}
+
+void detachInterrupt(int interrupt) {
+    if (validPin(interrupt)) pinInterrupts[interrupt].isr = nullptr;
+}
+
 // Use std::abs directly, don't redefine
 // int abs(int x) is already in std namespace
 
 // Test helper functions
+void setSimulatedDigitalInput(int pin, int value) {
+    if (!validPin(pin)) return;
+    const int before = digitalPins[pin];
+    digitalPins[pin] = value ? HIGH : LOW;
+    const PinInterrupt &irq = pinInterrupts[pin];
+    if (irq.isr == nullptr || digitalPins[pin] == before) return;
+    const bool rising = digitalPins[pin] == HIGH;
+    if (irq.mode == CHANGE || (irq.mode == RISING && rising) || (irq.mode == FALLING && !rising)) irq.isr();
+}
+
 void setSimulatedAnalogInput(int pin, int value) {
+    if (!validPin(pin)) return;
     analogInputs[pin] = value;
+    analogInputSet[pin] = true;
 }
 
 int getSimulatedPWMOutput(int pin) {
-    return pwmOutputs[pin];
+    return validPin(pin) ? pwmOutputs[pin] : 0;
 }
 
+unsigned long getSimulatedPWMWriteCount(int pin) {
+    return validPin(pin) ? pwmWrites[pin] : 0;
+}
+
+void setSimulatedAnalogSource(int pin, SimulatedAnalogSource fn, void *ctx) {
+    if (!validPin(pin)) return;
+    analogSources[pin].fn = fn;
+    analogSources[pin].ctx = ctx;
+}
+
+void mockSerialSetEcho(bool echo) {
+    serialEcho = echo;
+}
+
+void mockSerialSetTxBaud(unsigned long baud) {
+    serialTxBaud = baud;
+}
+
+void mockSerialSetCapture(std::string *out) {
+    serialCapture = out;
+}
+
+void mockSerialInject(const char *input) {
+    while (*input) serialInput.push_back(*input++);
+}
+
+void resetMockArduino() {
+    for (int i = 0; i < MOCK_PIN_COUNT; i++) {
+        pinModes[i] = INPUT;
+        digitalPins[i] = LOW;
+        analogInputs[i] = 0;
+        analogInputSet[i] = false;
+        analogSources[i].fn = nullptr;
+        analogSources[i].ctx = nullptr;
+        pwmOutputs[i] = 0;
+        pwmWrites[i] = 0;
+        pinInterrupts[i].isr = nullptr;
+        pinInterrupts[i].mode = 0;
+    }
+    serialEcho = true;
+    serialTxBaud = 0;
+    serialTxIdleAtNanos = 0;
+    serialInput.clear();
+    serialCapture = nullptr;
+    sleepLimitNanos = UINT64_MAX;
+    analogResolutionBits = 10;
+}
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <sstream>
+#include <string>
 
 // Mock Arduino types
 typedef bool boolean;
@@ -19,6 +21,11 @@ typedef uint8_t byte;
 #define HIGH 1
 #define LOW 0
 
+// Mock interrupt modes
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
 // Mock Arduino constants
 #define A0 14
 #define A1 15
@@ -26,26 +33,53 @@ typedef uint8_t byte;
 #define A3 17
 
 // Mock Serial class
+// Text output is echoed to stdout unless muted; input is fed by tests via mockSerialInject().
+// Optionally models a UART at a given baud rate in virtual time: writes fill a
+// MOCK_SERIAL_TX_BUFFER-byte TX buffer that drains at the baud rate, and a write
+// blocks (advances the clock) only while the buffer is full, as on the board.
+static const int MOCK_SERIAL_TX_BUFFER = 64;
+
 class MockSerial {
 public:
-    void begin(long baud) {
-        std::cout << "[Serial initialized at " << baud << " baud]" << std::endl;
-    }
+    void begin(long baud);
     
-    void print(const char* str) { std::cout << str; }
-    void print(int val) { std::cout << val; }
-    void print(long val) { std::cout << val; }
-    void print(unsigned long val) { std::cout << val; }
-    void print(float val) { std::cout << val; }
+    void print(const char* str) { emit(str); }
+    void print(char c) { emitValue(c); }
+    void print(int val) { emitValue(val); }
+    void print(unsigned int val) { emitValue(val); }
+    void print(long val) { emitValue(val); }
+    void print(unsigned long val) { emitValue(val); }
+    void print(float val) { emitValue(val); }
     
-    void println(const char* str) { std::cout << str << std::endl; }
-    void println(int val) { std::cout << val << std::endl; }
-    void println(long val) { std::cout << val << std::endl; }
-    void println(unsigned long val) { std::cout << val << std::endl; }
-    void println(float val) { std::cout << val << std::endl; }
-    void println() { std::cout << std::endl; }
+    void println(const char* str) { emit(str); emit("\n"); }
+    void println(char c) { print(c); emit("\n"); }
+    void println(int val) { print(val); emit("\n"); }
+    void println(unsigned int val) { print(val); emit("\n"); }
+    void println(long val) { print(val); emit("\n"); }
+    void println(unsigned long val) { print(val); emit("\n"); }
+    void println(float val) { print(val); emit("\n"); }
+    void println() { emit("\n"); }
+
+    // Raw bytes (binary telemetry): never echoed, but captured and timed like text.
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t *data, size_t len);
+    int availableForWrite();
+
+    int available();
+    int read();
     
     operator bool() { return true; }
+
+private:
+    template <typename T>
+    void emitValue(const T &val) {
+        if (!wantsOutput()) return;  // muted, free and not captured: skip formatting entirely
+        std::ostringstream os;
+        os << val;
+        emit(os.str().c_str());
+    }
+    void emit(const char *text);
+    static bool wantsOutput();
 };
 
 extern MockSerial Serial;
@@ -56,17 +90,50 @@ void digitalWrite(int pin, int value);
 int digitalRead(int pin);
 void analogWrite(int pin, int value);
 int analogRead(int pin);
+void analogReadResolution(int bits);  // default 10
 unsigned long millis();
 unsigned long micros();
 void delay(unsigned long ms);
 void delayMicroseconds(unsigned int us);
 long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// Pin interrupts: every pin has one (its number). The handler runs from
+// setSimulatedDigitalInput() on a matching edge.
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
 int constrain(int x, int min, int max);
 int abs(int x);
 
-// Simulated analog input for testing
+// Cortex-M intrinsics (CMSIS). __WFI() sleeps in virtual time until the next interrupt:
+// the next virtual clock event or the next 1ms millis() tick (the core's tick timer),
+// but never past mockSetSleepLimit(). Masking interrupts has no effect on the desktop.
+void __WFI();
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+void mockSetSleepLimit(uint64_t nanos);  // UINT64_MAX = no limit (default)
+
+// Simulated inputs for testing. A digital input change runs the pin's attached
+// interrupt if the edge matches its mode.
+void setSimulatedDigitalInput(int pin, int value);
 void setSimulatedAnalogInput(int pin, int value);
 int getSimulatedPWMOutput(int pin);
+unsigned long getSimulatedPWMWriteCount(int pin);  // analogWrite() calls since reset
+
+// Time-varying analog input: fn(ctx) is evaluated on every analogRead(pin) and
+// overrides setSimulatedAnalogInput() for that pin. Pass nullptr to remove.
+typedef int (*SimulatedAnalogSource)(void *ctx);
+void setSimulatedAnalogSource(int pin, SimulatedAnalogSource fn, void *ctx);
+
+// Serial test hooks
+void mockSerialSetEcho(bool echo);            // print output to stdout (default: on)
+void mockSerialSetTxBaud(unsigned long baud); // 0 = free; else a UART at this baud (see MockSerial)
+void mockSerialInject(const char *input);     // queue bytes for Serial.read()
+void mockSerialSetCapture(std::string *out);  // append every byte written (text and binary); nullptr = off
+
+// Reset pins, PWM outputs, analog sources, pin interrupts and Serial hooks to power-on defaults.
+// (The virtual clock is reset separately, see virtual_clock.h.)
+void resetMockArduino();
 
 #endif // MOCK_ARDUINO_H
 
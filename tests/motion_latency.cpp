@@ -0,0 +1,149 @@
+#include "motion_latency.h"
+
+// Before the Arduino mocks, whose A1 / A2 pin macros collide with the biquad's parameters.
+#include "main/config.h"
+#include "main/dsp_filters.h"
+#include "main/envelope_follower.h"
+#include "main/motor_bank.h"
+#include "main/motor_controller.h"
+#include "main/runtime_config.h"
+
+#include "firmware_sim.h"
+#include "motor_plant.h"
+#include "signal_generators.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+LatencySettings defaultLatencySettings() {
+    static const MotorChannelConfig CHANNELS[] = MOTOR_CHANNEL_CONFIG;
+    return {"default", CHANNELS[0].motion, CHANNELS[0].curve, ACTIVE_ENTER_THRESHOLD, ACTIVE_ENTER_DEBOUNCE_MS};
+}
+
+std::vector<LatencySettings> latencySweep() {
+    std::vector<LatencySettings> sweep;
+    const LatencySettings base = defaultLatencySettings();
+    sweep.push_back(base);
+
+    static const char *const MOTIONS[] = {"smooth", "snappy"};
+    const uint8_t motions[] = {MOTOR_MOTION_SMOOTH, MOTOR_MOTION_SNAPPY};
+    const uint16_t debounces[] = {0, 50, 150};
+    const uint16_t thresholds[] = {10, 25};
+    for (int m = 0; m < 2; m++) {
+        for (uint16_t debounce : debounces) {
+            for (uint16_t threshold : thresholds) {
+                LatencySettings s = base;
+                s.motion = motions[m];
+                s.enterDebounceMs = debounce;
+                s.enterThreshold = threshold;
+                s.name = std::string(MOTIONS[m]) + " debounce=" + std::to_string(debounce) + " enter=" + std::to_string(threshold);
+                sweep.push_back(s);
+            }
+        }
+    }
+    return sweep;
+}
+
+namespace {
+
+struct Mic {
+    Tone tone;
+    uint64_t onsetNanos;  // UINT64_MAX: silent
+};
+
+int micSample(void *ctx) {
+    const Mic *mic = static_cast<const Mic *>(ctx);
+    const uint64_t now = virtualClockNowNanos();
+    if (now < mic->onsetNanos) return DC_OFFSET;
+    const long value = DC_OFFSET + std::lround(mic->tone((double)(now - mic->onsetNanos) / 1e9));
+    return (int)std::max(0L, std::min(1023L, value));
+}
+
+void setParam(const char *name, uint32_t value) {
+    const RuntimeConfigResult result = runtimeConfigSet(name, value);
+    assert(result == RUNTIME_CONFIG_OK);
+    (void)result;
+}
+
+}  // namespace
+
+LatencyResult measureMotionLatency(const LatencySettings &settings, double toneCounts, unsigned toneMs) {
+    LatencyResult r;
+    r.settings = settings;
+    r.toneCounts = toneCounts;
+
+    simBoot();
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+    rig.attach();
+    setParam("motor_motion", settings.motion);
+    setParam("motor_curve", settings.curve);
+    setParam("active_enter_threshold", settings.enterThreshold);
+    setParam("active_enter_debounce_ms", settings.enterDebounceMs);
+
+    // Settle the DC baseline (and apply the settings) in silence.
+    Mic mic = {{200.0, toneCounts}, UINT64_MAX};
+    simSetMicSignal(micSample, &mic);
+    simRunForMs(runtimeConfig().idleCalibrationWarmupMs + 500);
+    assert(rig.plant.rpm() == 0.0);
+
+    mic.onsetNanos = virtualClockNowNanos();
+    std::vector<double> rpm(toneMs), pwm(toneMs);
+    for (unsigned ms = 0; ms < toneMs; ms++) {
+        simRunForMs(1);
+        rpm[ms] = rig.plant.rpm();
+        pwm[ms] = getMotorChannelPwm(0);
+    }
+    simSetMicSignal(nullptr, nullptr);
+
+    const unsigned settleFrom = toneMs - toneMs / 5;
+    for (unsigned ms = settleFrom; ms < toneMs; ms++) {
+        r.settledRpm += rpm[ms];
+        r.settledPwm += pwm[ms];
+    }
+    r.settledRpm /= toneMs - settleFrom;
+    r.settledPwm /= toneMs - settleFrom;
+
+    // Sample k is the state 1 + k ms after the onset.
+    for (unsigned ms = 0; ms < toneMs; ms++) {
+        if (r.toPwmMs < 0.0 && pwm[ms] > 0.0) r.toPwmMs = ms + 1.0;
+        if (r.toMotionMs < 0.0 && rpm[ms] > 0.0) r.toMotionMs = ms + 1.0;
+        if (r.to90Ms < 0.0 && r.settledRpm > 0.0 && rpm[ms] >= 0.9 * r.settledRpm) r.to90Ms = ms + 1.0;
+    }
+    return r;
+}
+
+namespace {
+
+template <unsigned ATTACK_MS>
+EnvelopeRise envelopeRise(double toneCounts) {
+    EnvelopeFollower<ENVELOPE_MODE, timeConstantToQ15(ENVELOPE_AVERAGING_MS, SAMPLE_RATE),
+                     timeConstantToQ15(ATTACK_MS, SAMPLE_RATE), timeConstantToQ15(ENVELOPE_RELEASE_MS, SAMPLE_RATE)>
+        envelope;
+    // In the firmware's sample units (SAMPLE_FRACTION_BITS below a count), 2 s of tone.
+    const Tone tone = {200.0, toneCounts * (1 << SAMPLE_FRACTION_BITS)};
+    const unsigned samples = 2 * SAMPLE_RATE;
+    std::vector<int32_t> level(samples);
+    for (unsigned n = 0; n < samples; n++) {
+        level[n] = envelope.process((int32_t)std::lround(tone((double)n / SAMPLE_RATE)));
+    }
+    double settled = 0.0;
+    for (unsigned n = samples - samples / 5; n < samples; n++) settled += level[n];
+    settled /= samples / 5;
+
+    EnvelopeRise rise = {ATTACK_MS, -1.0};
+    for (unsigned n = 0; n < samples; n++) {
+        if (level[n] >= 0.9 * settled) {
+            rise.to90Ms = (n + 1) * 1000.0 / SAMPLE_RATE;
+            break;
+        }
+    }
+    return rise;
+}
+
+}  // namespace
+
+std::vector<EnvelopeRise> envelopeRiseMs(double toneCounts) {
+    return {envelopeRise<1>(toneCounts), envelopeRise<2>(toneCounts), envelopeRise<5>(toneCounts),
+            envelopeRise<10>(toneCounts), envelopeRise<20>(toneCounts)};
+}
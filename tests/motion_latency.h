@@ -0,0 +1,67 @@
+#ifndef MOTION_LATENCY_H
+#define MOTION_LATENCY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Audio-to-motion latency: how long the sculpture physically takes to answer a sound.
+ *
+ * The whole firmware runs on the simulator (firmware_sim.h) with a DC motor model
+ * (motor_plant.h) on MOTOR_PIN, driven by what the firmware writes with analogWrite().
+ * After the DC baseline settles in silence a 200 Hz tone starts abruptly and is held;
+ * channel 0's PWM and the motor's speed are sampled every millisecond. Measured from
+ * the onset:
+ *
+ * - to PWM:    first PWM > 0 (the firmware's part: envelope, debounce, FSM)
+ * - to motion: the shaft starts turning (after the kick breaks static friction)
+ * - to 90 %:   the speed first reaches 90 % of its settled value (mean over the
+ *              tone's last 20 %): the lag a viewer sees
+ *
+ * Settings are runtime config values (runtime_config.h), so one build sweeps them.
+ * The envelope time constants are compile-time: envelopeRiseMs() measures the
+ * detector alone for a range of attack times, and the whole-chain numbers are for
+ * the ENVELOPE_ATTACK_MS the firmware is built with.
+ *
+ * Virtual time and a fixed plant make every run identical.
+ */
+
+struct LatencySettings {
+    std::string name;
+    uint8_t motion;             // motor_motion.0 (MOTOR_MOTION_PROFILES index)
+    uint8_t curve;              // motor_curve.0 (MOTOR_CURVE_PROFILES index)
+    uint16_t enterThreshold;    // active_enter_threshold
+    uint16_t enterDebounceMs;   // active_enter_debounce_ms
+};
+
+struct LatencyResult {
+    LatencySettings settings;
+    double toneCounts = 0.0;   // peak, ADC counts
+    double toPwmMs = -1.0;     // -1: never
+    double toMotionMs = -1.0;
+    double to90Ms = -1.0;
+    double settledPwm = 0.0;
+    double settledRpm = 0.0;
+};
+
+// The config.h defaults.
+LatencySettings defaultLatencySettings();
+
+// Defaults, then each motion profile crossed with enter debounce and threshold values.
+std::vector<LatencySettings> latencySweep();
+
+// Boot the simulated firmware with `settings`, play a tone of `toneCounts` peak for
+// `toneMs` and measure (see above).
+LatencyResult measureMotionLatency(const LatencySettings &settings, double toneCounts, unsigned toneMs = 2000);
+
+struct EnvelopeRise {
+    unsigned attackMs;
+    double to90Ms;  // onset -> 90 % of the settled envelope
+};
+
+// The firmware's envelope detector (ENVELOPE_MODE, ENVELOPE_AVERAGING_MS,
+// ENVELOPE_RELEASE_MS) with attack times from 1 to 20 ms, on the same tone.
+std::vector<EnvelopeRise> envelopeRiseMs(double toneCounts);
+
+#endif // MOTION_LATENCY_H
@@ -0,0 +1,120 @@
+#ifndef MOTOR_PLANT_H
+#define MOTOR_PLANT_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+/**
+ * Brushed DC motor on a low-side PWM switch, for closed-loop tests on the host.
+ *
+ * Electrical: L di/dt = D x supply - R i - Ke w, with D the PWM duty (the PWM period
+ * is far below L/R, so the averaged voltage is used). The flyback diode keeps the
+ * current from reversing: no regenerative braking, a coasting motor just slows down.
+ * Mechanical: J dw/dt = Kt i - b w - Coulomb friction - load. A standing motor stays
+ * put until the torque beats static friction, which is why low PWM values stall.
+ *
+ * The current update is exact over a step (exponential towards its steady state);
+ * the speed is integrated explicitly, fine for steps well below J R / Kt^2.
+ */
+
+static const double MOTOR_PLANT_PI = 3.14159265358979323846;
+
+struct DcMotorParams {
+    double supplyVolts;
+    double resistanceOhms;
+    double inductanceHenries;
+    double torqueConstant;     // Nm/A, also the back-EMF constant in V s/rad
+    double inertia;            // kg m^2, rotor plus load
+    double viscousFriction;    // Nm s/rad
+    double coulombFriction;    // Nm while turning
+    double staticFriction;     // Nm to break away
+    int pulsesPerRev;          // tach pulses per revolution
+};
+
+// The sculpture's geared motor: about 2600 RPM at PWM 255 on 12V, stalls below PWM ~75,
+// electrical time constant 0.5ms, mechanical ~65ms.
+static const DcMotorParams NOMINAL_MOTOR = {12.0, 4.0, 0.002, 0.035, 2e-5, 1e-5, 0.02, 0.03, 12};
+
+class DcMotorPlant {
+public:
+    explicit DcMotorPlant(const DcMotorParams &params = NOMINAL_MOTOR) : p_(params) {}
+
+    // Change the supply (a sagging battery) or add a load torque while running.
+    void setSupplyVolts(double volts) { p_.supplyVolts = volts; }
+    void setLoadTorque(double nm) { load_ = nm; }
+    const DcMotorParams &params() const { return p_; }
+
+    // Advance dtSeconds with the PWM held at `pwm`; returns the tach pulses it produced.
+    int step(double dtSeconds, int pwm) {
+        const double duty = (pwm < 0 ? 0 : (pwm > 255 ? 255 : pwm)) / 255.0;
+        const double volts = duty * p_.supplyVolts;
+
+        const double steady = (volts - p_.torqueConstant * omega_) / p_.resistanceOhms;
+        const double decay = std::exp(-dtSeconds * p_.resistanceOhms / p_.inductanceHenries);
+        current_ = steady + (current_ - steady) * decay;
+        if (current_ < 0.0) current_ = 0.0;
+
+        const double drive = p_.torqueConstant * current_ - load_;
+        if (omega_ == 0.0 && std::fabs(drive) <= p_.staticFriction) {
+            // Stuck.
+        } else {
+            const double direction = (omega_ != 0.0) ? (omega_ > 0.0 ? 1.0 : -1.0) : (drive > 0.0 ? 1.0 : -1.0);
+            const double torque = drive - p_.viscousFriction * omega_ - direction * p_.coulombFriction;
+            const double next = omega_ + torque / p_.inertia * dtSeconds;
+            // Friction stops the motor; it does not turn it around.
+            omega_ = (next * direction < 0.0) ? 0.0 : next;
+        }
+
+        const double before = std::floor(angle_ * p_.pulsesPerRev / (2.0 * MOTOR_PLANT_PI));
+        angle_ += omega_ * dtSeconds;
+        const double after = std::floor(angle_ * p_.pulsesPerRev / (2.0 * MOTOR_PLANT_PI));
+        return (int)(after - before);
+    }
+
+    double rpm() const { return omega_ * 60.0 / (2.0 * MOTOR_PLANT_PI); }
+    double current() const { return current_; }
+
+private:
+    DcMotorParams p_;
+    double load_ = 0.0;
+    double current_ = 0.0;
+    double omega_ = 0.0;  // rad/s
+    double angle_ = 0.0;  // rad, for the tach
+};
+
+/**
+ * A plant wired to the mocked board: every tick it reads the PWM the firmware last
+ * wrote to `pwmPin` (analogWrite()) and, for each tach pulse, raises and drops
+ * `tachPin` (setSimulatedDigitalInput(), which runs an attached interrupt).
+ * Runs as a periodic interrupt on the virtual clock; attach after virtualClockReset().
+ */
+class MotorRig {
+public:
+    MotorRig(const DcMotorParams &params, int pwmPin, int tachPin, uint32_t tickMicros = 20)
+        : plant(params), pwmPin_(pwmPin), tachPin_(tachPin), tickMicros_(tickMicros) {}
+
+    void attach() { virtualClockAddPeriodic((uint64_t)tickMicros_ * 1000ULL, &MotorRig::tick, this); }
+
+    DcMotorPlant plant;
+    unsigned long pulses = 0;
+
+private:
+    static void tick(void *ctx) {
+        MotorRig *rig = static_cast<MotorRig *>(ctx);
+        const int n = rig->plant.step(rig->tickMicros_ * 1e-6, getSimulatedPWMOutput(rig->pwmPin_));
+        for (int i = 0; i < n; i++) {
+            setSimulatedDigitalInput(rig->tachPin_, HIGH);
+            setSimulatedDigitalInput(rig->tachPin_, LOW);
+            rig->pulses++;
+        }
+    }
+
+    int pwmPin_;
+    int tachPin_;
+    uint32_t tickMicros_;
+};
+
+#endif // MOTOR_PLANT_H
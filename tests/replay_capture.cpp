@@ -0,0 +1,71 @@
+// Replay a raw capture (tools/capture_record.py) through the firmware and check that it
+// reproduces the field trace:
+//   ./replay_capture capture.bin [trace.csv]
+// Exit status 0 if every tick matched, 1 on a mismatch or an unusable capture.
+#include "capture_replay.h"
+#include "main/raw_capture.h"
+#include "main/system_supervisor.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " capture.bin [trace.csv]" << std::endl;
+        return 2;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot read " << argv[1] << std::endl;
+        return 2;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    CaptureLog log;
+    if (!decodeCapture(bytes, log)) {
+        std::cerr << argv[1] << ": " << log.error << std::endl;
+        return 1;
+    }
+    const double fieldSeconds = log.events.empty() ? 0.0 : (uint32_t)(log.events.back().timeMs - log.startMs) / 1000.0;
+    std::cout << argv[1] << ": " << log.samples << " samples, " << log.ticks << " ticks, " << fieldSeconds
+              << " s" << (log.stopped ? "" : " (no stop frame)") << std::endl;
+    if (log.badFrames > 0) std::cout << "  " << log.badFrames << " frames failed the CRC" << std::endl;
+    if (log.lostFrames > 0) {
+        std::cout << "  " << log.lostFrames << " frames lost; replaying up to the gap" << std::endl;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const ReplayResult result = replayCapture(log);
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "replayed in " << wallSeconds * 1000.0 << " ms";
+    if (wallSeconds > 0.0) std::cout << " (" << fieldSeconds / wallSeconds << "x real time)";
+    std::cout << std::endl;
+
+    if (argc == 3) {
+        std::ofstream csv(argv[2]);
+        csv << "time_ms,amplitude,state,field_state,match";
+        for (int ch = 0; ch < MOTOR_CHANNELS; ch++) csv << ",pwm" << ch << ",field_pwm" << ch;
+        csv << "\n";
+        size_t tick = 0;
+        for (const CaptureEvent &ev : log.events) {
+            if (ev.type != RAW_CAPTURE_TICK || tick >= result.ticks.size()) continue;
+            const ReplayTick &t = result.ticks[tick++];
+            csv << t.timeMs << "," << t.amplitude << "," << getSystemStateName((SystemState)t.state) << ","
+                << getSystemStateName((SystemState)ev.state) << "," << (t.matches ? 1 : 0);
+            for (int ch = 0; ch < MOTOR_CHANNELS; ch++) csv << "," << (int)t.pwm[ch] << "," << (int)ev.pwm[ch];
+            csv << "\n";
+        }
+    }
+
+    if (result.mismatches > 0) {
+        const ReplayTick &t = result.ticks[result.firstMismatch];
+        std::cout << "MISMATCH: " << result.mismatches << " of " << result.ticks.size()
+                  << " ticks differ, first at " << t.timeMs << " ms (tick " << result.firstMismatch << ")"
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "OK: all " << result.ticks.size() << " ticks reproduce the field state and PWM" << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Run the response scenarios (response_scenarios.h) and write the metrics as JSON:
+//   ./response_report [report.json] [--quick]
+// Compare two reports (e.g. before and after a config.h change) with
+//   python3 ../tools/response_compare.py before.json after.json
+#include "response_scenarios.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static std::string stat(const MetricStats &s) {
+    if (s.count == 0) return s.missed ? "missed" : "-";
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(0) << s.meanMs << "/" << s.maxMs;
+    if (s.missed) os << " (" << s.missed << " missed)";
+    return os.str();
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    bool quick = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [report.json] [--quick]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::cout << std::left << std::setw(20) << "scenario" << std::setw(22) << "onset->motion ms"
+              << std::setw(22) << "->IDLE ms" << std::setw(12) << "overshoot" << std::setw(14) << "false/hour"
+              << "chatter" << std::endl;
+    std::cout << std::setw(20) << "" << std::setw(22) << "(mean/max)" << std::setw(22) << "(mean/max)" << std::endl;
+    std::vector<ScenarioMetrics> results;
+    for (const Scenario &scenario : standardScenarios(quick)) {
+        results.push_back(runScenario(scenario));
+        const ScenarioMetrics &m = results.back();
+        std::ostringstream overshoot, perHour;
+        overshoot << std::fixed << std::setprecision(1) << m.pwmOvershootPct << "%";
+        perHour << std::fixed << std::setprecision(1) << m.falseActivePerHour;
+        std::cout << std::setw(20) << m.name << std::setw(22) << stat(m.onsetToMotion) << std::setw(22)
+                  << stat(m.timeToIdle) << std::setw(12) << overshoot.str() << std::setw(14) << perHour.str()
+                  << m.chatter << std::endl;
+    }
+
+    if (path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "cannot write " << path << std::endl;
+            return 2;
+        }
+        writeResponseReport(out, results);
+        std::cout << "report: " << path << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "response_scenarios.h"
+#include "signal_generators.h"
+#include "firmware_sim.h"
+
+#include "main/config.h"
+#include "main/envelope_follower.h"
+#include "main/motor_controller.h"
+#include "main/runtime_config.h"
+#include "main/system_supervisor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+// Sound windows [first + k * period, first + k * period + length) for k < count.
+static std::vector<SoundWindow> periodicWindows(double first, double length, double period, int count) {
+    std::vector<SoundWindow> windows;
+    for (int k = 0; k < count; k++) windows.push_back({first + k * period, first + k * period + length});
+    return windows;
+}
+
+// `signal` inside the windows (its own time restarting at each), silence elsewhere.
+template <typename Signal>
+static ScenarioSignal gated(Signal signal, std::vector<SoundWindow> windows) {
+    return [signal, windows](double t) mutable {
+        for (const SoundWindow &w : windows) {
+            if (t >= w.start && t < w.end) return signal(t - w.start);
+        }
+        return 0.0;
+    };
+}
+
+std::vector<Scenario> standardScenarios(bool quick) {
+    std::vector<Scenario> s;
+
+    const std::vector<SoundWindow> bursts = periodicWindows(2.0, 2.0, 8.0, 8);
+    s.push_back({"tone_bursts_loud", "200 Hz, 150 counts peak: 2 s on, 6 s off", 66.0,
+                 [bursts] { return gated(ToneBurst{{200.0, 150.0}, 2000.0, 1e9, 5.0}, bursts); }, bursts});
+    s.push_back({"tone_bursts_quiet", "200 Hz, 25 counts peak (quiet, but above the enter threshold in a silent room): 2 s on, 6 s off", 66.0,
+                 [bursts] { return gated(ToneBurst{{200.0, 25.0}, 2000.0, 1e9, 5.0}, bursts); }, bursts});
+
+    const std::vector<SoundWindow> sweep = {{1.0, 21.0}};
+    s.push_back({"sine_sweep", "40 -> 480 Hz logarithmic over 20 s, 100 counts peak", 30.0,
+                 [sweep] { return gated(SineSweep{40.0, 480.0, 20.0, 100.0, true}, sweep); }, sweep});
+
+    const std::vector<SoundWindow> noise = periodicWindows(2.0, 3.0, 9.0, 6);
+    s.push_back({"pink_noise_bursts", "pink noise, 60 counts RMS: 3 s on, 6 s off", 56.0,
+                 [noise] { return gated(PinkNoise(60.0, 11), noise); }, noise});
+
+    const std::vector<SoundWindow> claps = periodicWindows(2.0, 3.2, 10.0, 5);
+    s.push_back({"clap_trains", "8 claps 400 ms apart (200 counts, 30 ms decay), every 10 s", 54.0,
+                 [claps] { return gated(ClapTrain(400.0, 200.0, 30.0, 23), claps); }, claps});
+
+    const std::vector<SoundWindow> music = periodicWindows(2.0, 20.0, 30.0, 3);
+    s.push_back({"music_like", "120 BPM kick / hi-hat / melody / pink bed: 20 s on, 10 s off", 92.0,
+                 [music] { return gated(MusicLike(120.0, 1.0, 37), music); }, music});
+
+    // Nothing should wake the sculpture here.
+    s.push_back({"silence_with_hum", "50 Hz mains hum (8 counts, harmonics) and 1.5 counts RMS white noise",
+                 quick ? 300.0 : 3600.0,
+                 [] {
+                     return [hum = Hum{50.0, 8.0}, hiss = WhiteNoise(1.5, 41)](double t) mutable {
+                         return hum(t) + hiss(t);
+                     };
+                 },
+                 {}});
+    s.push_back({"quiet_room", "pink noise, 6 counts RMS (ventilation, distant voices)", quick ? 300.0 : 1800.0,
+                 [] { return ScenarioSignal(PinkNoise(6.0, 53)); }, {}});
+    return s;
+}
+
+namespace {
+
+struct TracePoint {
+    uint64_t ms;  // since the scenario started
+    uint8_t state;
+    uint8_t pwm;
+};
+
+struct Run {
+    ScenarioSignal signal;
+    uint64_t startNanos;
+    std::vector<TracePoint> trace;  // every change of (state, PWM)
+};
+
+int scenarioSample(void *ctx) {
+    Run *run = static_cast<Run *>(ctx);
+    const double t = (double)(virtualClockNowNanos() - run->startNanos) / 1e9;
+    const long value = DC_OFFSET + std::lround(run->signal(t));
+    return (int)std::max(0L, std::min(1023L, value));
+}
+
+void recordTrace(void *ctx) {
+    Run *run = static_cast<Run *>(ctx);
+    const uint8_t state = (uint8_t)getSystemState();
+    const uint8_t pwm = (uint8_t)getMotorChannelPwm(0);
+    if (!run->trace.empty() && run->trace.back().state == state && run->trace.back().pwm == pwm) return;
+    run->trace.push_back({(virtualClockNowNanos() - run->startNanos) / 1000000ULL, state, pwm});
+}
+
+void addSample(MetricStats &stats, double ms) {
+    stats.meanMs += (ms - stats.meanMs) / (double)(++stats.count);
+    stats.maxMs = std::max(stats.maxMs, ms);
+}
+
+// Index of the trace point in effect at `ms`.
+size_t pointAt(const std::vector<TracePoint> &trace, uint64_t ms) {
+    size_t i = 0;
+    while (i + 1 < trace.size() && trace[i + 1].ms <= ms) i++;
+    return i;
+}
+
+}  // namespace
+
+ScenarioMetrics runScenario(const Scenario &scenario) {
+    ScenarioMetrics m;
+    m.name = scenario.name;
+    m.seconds = scenario.seconds;
+    m.windows = (unsigned)scenario.sound.size();
+
+    // Boot in silence and let the DC baseline settle first.
+    simBoot();
+    simSetMicSignal([](void *) { return (int)DC_OFFSET; }, nullptr);
+    simRunForMs(runtimeConfig().idleCalibrationWarmupMs + 500);
+
+    Run run;
+    run.signal = scenario.makeSignal();
+    run.startNanos = virtualClockNowNanos();
+    simSetMicSignal(scenarioSample, &run);
+    simSetTraceHook(recordTrace, &run);
+    recordTrace(&run);
+    const auto t0 = std::chrono::steady_clock::now();
+    simRunForMs((unsigned long)(scenario.seconds * 1000.0));
+    m.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    simSetTraceHook(nullptr, nullptr);
+    simSetMicSignal(nullptr, nullptr);
+
+    const std::vector<TracePoint> &trace = run.trace;
+    const uint64_t endMs = (uint64_t)(scenario.seconds * 1000.0);
+    unsigned windowsWithMotion = 0;
+    for (size_t w = 0; w < scenario.sound.size(); w++) {
+        const uint64_t start = (uint64_t)(scenario.sound[w].start * 1000.0);
+        const uint64_t end = (uint64_t)(scenario.sound[w].end * 1000.0);
+        const uint64_t next = (w + 1 < scenario.sound.size()) ? (uint64_t)(scenario.sound[w + 1].start * 1000.0) : endMs;
+
+        // Onset to motion.
+        bool moved = false;
+        for (size_t i = pointAt(trace, start); i < trace.size() && trace[i].ms < end; i++) {
+            if (trace[i].pwm > 0) {
+                addSample(m.onsetToMotion, (double)(std::max(trace[i].ms, start) - start));
+                moved = true;
+                break;
+            }
+        }
+        if (!moved) {
+            m.onsetToMotion.missed++;
+            continue;
+        }
+        windowsWithMotion++;
+
+        // Time to IDLE after the sound stops.
+        bool idled = false;
+        for (size_t i = pointAt(trace, end); i < trace.size() && trace[i].ms < next; i++) {
+            if (trace[i].state == SYSTEM_IDLE) {
+                addSample(m.timeToIdle, (double)(std::max(trace[i].ms, end) - end));
+                idled = true;
+                break;
+            }
+        }
+        if (!idled) m.timeToIdle.missed++;
+
+        // Overshoot: peak against the time-weighted mean over the window's last 20%.
+        const uint64_t settleFrom = end - (end - start) / 5;
+        double weighted = 0.0;
+        int peak = 0;
+        for (size_t i = pointAt(trace, start); i < trace.size() && trace[i].ms < end; i++) {
+            const uint64_t from = std::max(trace[i].ms, start);
+            const uint64_t to = (i + 1 < trace.size()) ? std::min(trace[i + 1].ms, end) : end;
+            peak = std::max(peak, (int)trace[i].pwm);
+            if (to > settleFrom) weighted += (double)trace[i].pwm * (double)(to - std::max(from, settleFrom));
+        }
+        const double settled = weighted / (double)(end - settleFrom);
+        if (settled > 0.0) {
+            m.pwmOvershootPct = std::max(m.pwmOvershootPct, 100.0 * std::max(0.0, peak - settled) / settled);
+        }
+    }
+
+    // ACTIVE entries and exits, time in ACTIVE, entries outside every window.
+    unsigned activeEdges = 0;
+    double activeMs = 0.0;
+    for (size_t i = 0; i < trace.size(); i++) {
+        const bool active = trace[i].state == SYSTEM_ACTIVE;
+        const bool wasActive = i > 0 && trace[i - 1].state == SYSTEM_ACTIVE;
+        if (active != wasActive && i > 0) activeEdges++;
+        if (active) activeMs += (double)((i + 1 < trace.size() ? trace[i + 1].ms : endMs) - trace[i].ms);
+        if (active && !wasActive) {
+            bool expected = false;
+            for (const SoundWindow &w : scenario.sound) {
+                const double ms = (double)trace[i].ms;
+                if (ms >= w.start * 1000.0 && ms < w.end * 1000.0 + FALSE_ACTIVE_GRACE_MS) expected = true;
+            }
+            if (!expected) m.falseActive++;
+        }
+    }
+    double soundSeconds = 0.0;
+    for (const SoundWindow &w : scenario.sound) soundSeconds += w.end - w.start;
+    m.quietHours = (scenario.seconds - soundSeconds) / 3600.0;
+    m.falseActivePerHour = m.quietHours > 0.0 ? m.falseActive / m.quietHours : 0.0;
+    m.chatter = activeEdges > 2 * windowsWithMotion ? activeEdges - 2 * windowsWithMotion : 0;
+    m.activeSeconds = activeMs / 1000.0;
+    return m;
+}
+
+static void writeStats(std::ostream &out, const char *key, const MetricStats &s) {
+    out << "      \"" << key << "\": {\"count\": " << s.count << ", \"missed\": " << s.missed << ", \"mean_ms\": ";
+    if (s.count > 0) {
+        out << s.meanMs << ", \"max_ms\": " << s.maxMs;
+    } else {
+        out << "null, \"max_ms\": null";
+    }
+    out << "},\n";
+}
+
+void writeResponseReport(std::ostream &out, const std::vector<ScenarioMetrics> &results) {
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"config\": {\n";
+    out << "    \"sample_rate\": " << SAMPLE_RATE << ",\n";
+    static const char *const ENVELOPE_MODE_NAMES[] = {"rectified", "rms", "peak"};
+    out << "    \"envelope_mode\": \"" << ENVELOPE_MODE_NAMES[ENVELOPE_MODE] << "\",\n";
+    out << "    \"envelope_averaging_ms\": " << ENVELOPE_AVERAGING_MS << ",\n";
+    out << "    \"envelope_attack_ms\": " << ENVELOPE_ATTACK_MS << ",\n";
+    out << "    \"envelope_release_ms\": " << ENVELOPE_RELEASE_MS << ",\n";
+    out << "    \"noise_floor_rise_shift\": " << NOISE_FLOOR_RISE_SHIFT << ",\n";
+    out << "    \"noise_floor_fall_shift\": " << NOISE_FLOOR_FALL_SHIFT << ",\n";
+    out << "    \"agc\": " << (ENABLE_AGC ? "true" : "false") << ",\n";
+    out << "    \"agc_target_level\": " << AGC_TARGET_LEVEL << ",\n";
+    out << "    \"min_motor_speed\": " << MIN_MOTOR_SPEED << ",\n";
+    out << "    \"max_motor_speed\": " << MAX_MOTOR_SPEED;
+    for (size_t p = 0; p < getRuntimeConfigParamCount(); p++) {
+        const RuntimeConfigParam &param = getRuntimeConfigParam(p);
+        for (int ch = 0; ch < param.count; ch++) {
+            std::string name = param.name;
+            if (param.perChannel) name += "." + std::to_string(ch);
+            uint32_t value = 0;
+            runtimeConfigGet(name.c_str(), value);
+            out << ",\n    \"" << name << "\": " << value;
+        }
+    }
+    out << "\n  },\n  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScenarioMetrics &m = results[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << m.name << "\",\n";
+        out << "      \"seconds\": " << m.seconds << ",\n";
+        out << "      \"windows\": " << m.windows << ",\n";
+        writeStats(out, "onset_to_motion", m.onsetToMotion);
+        writeStats(out, "time_to_idle", m.timeToIdle);
+        out << "      \"pwm_overshoot_pct\": " << m.pwmOvershootPct << ",\n";
+        out << "      \"false_active\": " << m.falseActive << ",\n";
+        out << "      \"false_active_per_hour\": " << m.falseActivePerHour << ",\n";
+        out << "      \"chatter\": " << m.chatter << ",\n";
+        out << "      \"active_seconds\": " << m.activeSeconds << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
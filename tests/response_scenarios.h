@@ -0,0 +1,82 @@
+#ifndef RESPONSE_SCENARIOS_H
+#define RESPONSE_SCENARIOS_H
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * How the sculpture reacts to sound, measured on the whole firmware (firmware_sim.h):
+ * each scenario plays a signal built from signal_generators.h into the microphone
+ * pin, in virtual time, and the supervisor state and channel 0 PWM are traced after
+ * every loop() iteration. The metrics below are computed from that trace against
+ * the scenario's sound windows (the spans in which the signal is meant to drive
+ * the sculpture):
+ *
+ * - onset to motion: window start -> first PWM > 0
+ * - time to IDLE:    window end -> state IDLE
+ * - PWM overshoot:   peak PWM in a window above its settled level (time-weighted mean
+ *                    over the window's last 20%), in % of the settled level
+ * - false ACTIVE:    entries to ACTIVE outside every window (plus FALSE_ACTIVE_GRACE_MS
+ *                    after it), per hour of quiet time
+ * - chatter:         IDLE <-> ACTIVE transitions beyond one entry and one exit per
+ *                    window that moved the motor
+ *
+ * Results depend only on the firmware and config.h: virtual time and seeded noise
+ * make every run identical, so two reports can be compared number for number.
+ */
+
+static const unsigned long FALSE_ACTIVE_GRACE_MS = 500;
+
+struct SoundWindow {
+    double start;  // s since the scenario started
+    double end;
+};
+
+// AC counts at t s; called once per sample, in time order.
+typedef std::function<double(double)> ScenarioSignal;
+
+struct Scenario {
+    std::string name;
+    std::string description;
+    double seconds;                               // total, trailing quiet included
+    std::function<ScenarioSignal()> makeSignal;   // a fresh (re-seeded) signal for each run
+    std::vector<SoundWindow> sound;
+};
+
+// The standard set: tone bursts (loud and near the threshold), a sine sweep, pink
+// noise bursts, clap trains, music-like passages, and silence with mains hum and
+// with room noise. `quick` shortens the long quiet scenarios (for the unit test).
+std::vector<Scenario> standardScenarios(bool quick = false);
+
+struct MetricStats {
+    unsigned count = 0;   // windows measured
+    unsigned missed = 0;  // windows where it never happened
+    double meanMs = 0.0;
+    double maxMs = 0.0;
+};
+
+struct ScenarioMetrics {
+    std::string name;
+    double seconds = 0.0;
+    unsigned windows = 0;
+    MetricStats onsetToMotion;
+    MetricStats timeToIdle;
+    double pwmOvershootPct = 0.0;           // worst window
+    unsigned falseActive = 0;
+    double quietHours = 0.0;
+    double falseActivePerHour = 0.0;
+    unsigned chatter = 0;
+    double activeSeconds = 0.0;             // total time in ACTIVE
+    double wallMs = 0.0;                    // host time to simulate it
+};
+
+// Boot the simulated firmware, let it calibrate in silence, play the scenario.
+ScenarioMetrics runScenario(const Scenario &scenario);
+
+// JSON report: the runtime config the scenarios ran with (every '$' parameter) and
+// one object per scenario.
+void writeResponseReport(std::ostream &out, const std::vector<ScenarioMetrics> &results);
+
+#endif // RESPONSE_SCENARIOS_H
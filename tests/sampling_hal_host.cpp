@@ -0,0 +1,55 @@
+// Desktop implementation of the block sampling HAL (main/sampling_hal.h).
+//
+// The FspTimer shim's event link stands in for the ELC: at every timer period one
+// "conversion" reads the analog pin (the mock / simulated signal) into the filling half
+// of the ping-pong buffer, exactly like ADC + DMA on the board, and a full half is
+// handed to the block handler in one call. No per-sample callback reaches the firmware,
+// and stopping the timer stops sampling, so the fault paths behave as on hardware.
+#include "main/sampling_hal.h"
+#include "main/config.h"
+#include "arduino_shim/FspTimer.h"
+#include "mock_arduino.h"
+
+static uint16_t blockBuffer[2][SAMPLE_BLOCK_SIZE];
+static uint8_t fillingHalf = 0;
+static uint16_t fill = 0;
+static unsigned long blockCount = 0;
+static int adcPin = -1;
+static SampleBlockHandler blockHandler = nullptr;
+static FspTimer *linkedTimer = nullptr;
+
+static void convert(void *ctx) {
+    (void)ctx;
+    blockBuffer[fillingHalf][fill++] = (uint16_t)analogRead(adcPin);
+    if (fill < SAMPLE_BLOCK_SIZE) return;
+
+    // DMA transfer end: switch halves, then the block interrupt.
+    const uint8_t full = fillingHalf;
+    fillingHalf = full ^ 1;
+    fill = 0;
+    blockCount++;
+    if (blockHandler != nullptr) blockHandler(blockBuffer[full], SAMPLE_BLOCK_SIZE);
+}
+
+bool samplingHalBegin(FspTimer &timer, uint8_t timerChannel, int pin, SampleBlockHandler onBlock) {
+    (void)timerChannel;
+    samplingHalEnd();
+    adcPin = pin;
+    blockHandler = onBlock;
+    fillingHalf = 0;
+    fill = 0;
+    blockCount = 0;
+    linkedTimer = &timer;
+    fspTimerMockLinkEvent(timer, convert, nullptr);
+    return true;
+}
+
+void samplingHalEnd() {
+    if (linkedTimer != nullptr) fspTimerMockLinkEvent(*linkedTimer, nullptr, nullptr);
+    linkedTimer = nullptr;
+    blockHandler = nullptr;
+}
+
+unsigned long samplingHalBlockCount() {
+    return blockCount;
+}
@@ -0,0 +1,169 @@
+#ifndef SIGNAL_GENERATORS_H
+#define SIGNAL_GENERATORS_H
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Parametric microphone signals for the response scenarios (response_scenarios.h).
+ *
+ * Each generator returns the AC part of the microphone signal in ADC counts (the
+ * caller adds the DC bias) for t seconds since it started. The noise-based ones are
+ * stateful: call them once per sample, in time order, as the sampling ISR does. They
+ * are seeded, so a scenario produces the same samples on every run.
+ */
+
+static const double SIGNAL_PI = 3.14159265358979323846;
+
+// xorshift32: small, fast and identical on every host.
+struct NoiseSource {
+    uint32_t state;
+
+    explicit NoiseSource(uint32_t seed) : state(seed ? seed : 1) {}
+
+    // Uniform in [-1, 1).
+    double uniform() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (double)state / 2147483648.0 - 1.0;
+    }
+};
+
+struct Tone {
+    double hz;
+    double amplitude;  // peak, counts
+
+    double operator()(double t) const { return amplitude * std::sin(2.0 * SIGNAL_PI * hz * t); }
+};
+
+// Sine sweep from f0 to f1 Hz over `seconds` (then holding f1), phase-continuous;
+// logarithmic sweeps spend equal time per octave.
+struct SineSweep {
+    double f0;
+    double f1;
+    double seconds;
+    double amplitude;
+    bool logarithmic;
+
+    double phase(double t) const {
+        if (t > seconds) return phase(seconds) + 2.0 * SIGNAL_PI * f1 * (t - seconds);
+        if (!logarithmic) return 2.0 * SIGNAL_PI * (f0 * t + (f1 - f0) * t * t / (2.0 * seconds));
+        const double k = std::log(f1 / f0);
+        return 2.0 * SIGNAL_PI * f0 * seconds / k * (std::exp(k * t / seconds) - 1.0);
+    }
+    double frequency(double t) const {
+        if (t > seconds) return f1;
+        return logarithmic ? f0 * std::pow(f1 / f0, t / seconds) : f0 + (f1 - f0) * t / seconds;
+    }
+    double operator()(double t) const { return amplitude * std::sin(phase(t)); }
+};
+
+// Gaussian-ish white noise (sum of 4 uniforms) at the given RMS.
+struct WhiteNoise {
+    double rms;
+    NoiseSource noise;
+
+    WhiteNoise(double rmsCounts, uint32_t seed) : rms(rmsCounts), noise(seed) {}
+
+    double operator()(double) {
+        // Sum of 4 uniforms in [-1, 1): variance 4/3.
+        const double s = noise.uniform() + noise.uniform() + noise.uniform() + noise.uniform();
+        return rms * s * 0.8660254037844386;
+    }
+};
+
+// Pink (1/f) noise at the given RMS: white noise through Paul Kellet's
+// three-pole approximation (+/-0.5 dB above ~10 Hz at 1 kHz sampling).
+struct PinkNoise {
+    double rms;
+    WhiteNoise white;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+
+    PinkNoise(double rmsCounts, uint32_t seed) : rms(rmsCounts), white(1.0, seed) {}
+
+    double operator()(double t) {
+        const double w = white(t);
+        b0 = 0.99765 * b0 + w * 0.0990460;
+        b1 = 0.96300 * b1 + w * 0.2965164;
+        b2 = 0.57000 * b2 + w * 1.0526913;
+        // 2.98: the filter's gain for unit-variance white noise (measured), so
+        // `rms` is the output RMS.
+        return rms * (b0 + b1 + b2 + w * 0.1848) / 2.98;
+    }
+};
+
+// A sinusoidal tone switched on for onMs every periodMs, with raised-cosine ramps of
+// rampMs at both ends (no clicks).
+struct ToneBurst {
+    Tone tone;
+    double onMs;
+    double periodMs;
+    double rampMs;
+
+    double gain(double t) const {
+        const double inPeriod = std::fmod(t * 1000.0, periodMs);
+        if (inPeriod >= onMs) return 0.0;
+        const double edge = std::fmin(inPeriod, onMs - inPeriod);
+        if (rampMs <= 0.0 || edge >= rampMs) return 1.0;
+        return 0.5 - 0.5 * std::cos(SIGNAL_PI * edge / rampMs);
+    }
+    double operator()(double t) const { return gain(t) * tone(t); }
+};
+
+// Hand claps: a noise burst with an instant attack and an exponential decay
+// (decayMs time constant) every intervalMs.
+struct ClapTrain {
+    double intervalMs;
+    double amplitude;  // peak envelope, counts
+    double decayMs;
+    WhiteNoise noise;
+
+    ClapTrain(double interval, double peak, double decay, uint32_t seed)
+        : intervalMs(interval), amplitude(peak), decayMs(decay), noise(1.0, seed) {}
+
+    double envelope(double t) const {
+        const double since = std::fmod(t * 1000.0, intervalMs);
+        return amplitude * std::exp(-since / decayMs);
+    }
+    double operator()(double t) { return envelope(t) * std::fmax(-1.0, std::fmin(1.0, noise(t) / 2.0)); }
+};
+
+// Mains hum: fundamental plus the 2nd and 3rd harmonics at half and a quarter of it.
+struct Hum {
+    double hz;
+    double amplitude;
+
+    double operator()(double t) const {
+        const double w = 2.0 * SIGNAL_PI * hz * t;
+        return amplitude * (std::sin(w) + 0.5 * std::sin(2.0 * w + 0.3) + 0.25 * std::sin(3.0 * w + 1.1));
+    }
+};
+
+// Something like a band at `bpm`: a kick drum (decaying 55 Hz with a pitch drop) on
+// every beat, a hi-hat (short noise burst) on every off-beat, a melody note that
+// changes every beat, and a pink noise bed.
+struct MusicLike {
+    double bpm;
+    double level;  // scales every part; 1.0 = a loud room
+    PinkNoise bed;
+    WhiteNoise hat;
+
+    MusicLike(double beatsPerMinute, double gain, uint32_t seed)
+        : bpm(beatsPerMinute), level(gain), bed(12.0, seed), hat(1.0, seed * 7919u + 1u) {}
+
+    double operator()(double t) {
+        const double beat = 60.0 / bpm;
+        const double sinceBeat = std::fmod(t, beat);
+        const long beatIndex = (long)(t / beat);
+        const double kick = 110.0 * std::exp(-sinceBeat / 0.06) *
+                            std::sin(2.0 * SIGNAL_PI * (55.0 * sinceBeat + 40.0 * 0.03 * (1.0 - std::exp(-sinceBeat / 0.03))));
+        const double sinceHalf = std::fmod(t + beat / 2.0, beat);
+        const double hiHat = 35.0 * std::exp(-sinceHalf / 0.015) * hat(t);
+        static const double NOTES[4] = {220.0, 261.6, 329.6, 293.7};
+        const double melody = 45.0 * std::sin(2.0 * SIGNAL_PI * NOTES[beatIndex % 4] * t);
+        return level * (kick + hiHat + melody + bed(t));
+    }
+};
+
+#endif // SIGNAL_GENERATORS_H
@@ -0,0 +1,2 @@
+// Compiles the unmodified sketch for the host simulator (see firmware_sim.h).
+#include "../main/main.ino"
@@ -0,0 +1,58 @@
+// Reference decoder for the binary telemetry stream (main/telemetry.h), shared by
+// the host tests. Same rules as tools/telemetry_decode.py.
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include "main/telemetry.h"
+
+#include <string>
+#include <vector>
+
+struct Decoded {
+    uint16_t sequence;
+    TelemetryRecord record;
+    uint16_t drops;
+};
+
+// Scan for the sync bytes, check length / CRC, skip anything else a byte at a time.
+// Valid frames of other types (raw capture) are stepped over whole. badFrames counts
+// status frames that had a valid header but failed the CRC.
+inline std::vector<Decoded> decodeStream(const std::string &bytes, unsigned *badFrames = nullptr) {
+    std::vector<Decoded> out;
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(bytes.data());
+    size_t i = 0;
+    if (badFrames) *badFrames = 0;
+    while (i + TELEMETRY_FRAME_SIZE <= bytes.size()) {
+        if (b[i] != TELEMETRY_SYNC0 || b[i + 1] != TELEMETRY_SYNC1) {
+            i++;
+            continue;
+        }
+        const size_t frameSize = (size_t)b[i + 3] + 5;
+        const bool status = b[i + 2] == TELEMETRY_TYPE_STATUS && b[i + 3] == TELEMETRY_PAYLOAD_SIZE;
+        if (i + frameSize > bytes.size() ||
+            telemetryCrc8(b + i + 2, frameSize - 3) != b[i + frameSize - 1]) {
+            if (status && badFrames) (*badFrames)++;
+            i++;
+            continue;
+        }
+        if (!status) {
+            i += frameSize;
+            continue;
+        }
+        const uint8_t *p = b + i + 4;
+        Decoded d;
+        d.sequence = (uint16_t)(p[0] | p[1] << 8);
+        d.record.timestampMs = (uint32_t)p[2] | (uint32_t)p[3] << 8 | (uint32_t)p[4] << 16 | (uint32_t)p[5] << 24;
+        d.record.rawSample = (uint16_t)(p[6] | p[7] << 8);
+        d.record.amplitude = (uint16_t)(p[8] | p[9] << 8);
+        d.record.dcOffset = (uint16_t)(p[10] | p[11] << 8);
+        d.record.pwm = p[12];
+        d.record.state = p[13];
+        d.drops = (uint16_t)(p[14] | p[15] << 8);
+        out.push_back(d);
+        i += TELEMETRY_FRAME_SIZE;
+    }
+    return out;
+}
+
+#endif // TELEMETRY_DECODER_H
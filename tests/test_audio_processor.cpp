@@ -1,145 +1,210 @@
+// Tests the shipped audio processor (main/audio_processor.cpp, linked from the
+// firmware library): samples go in through the sample ring, as the ISR delivers them.
 #include "mock_arduino.h"
 
-// Define config constants locally to avoid Arduino.h dependency
-#define SAMPLE_RATE 1000
-#define BUFFER_SIZE 20
-#define DC_OFFSET 512
-#define MIN_MOTOR_SPEED 80
-#define MAX_MOTOR_SPEED 255
-#define MOTOR_UPDATE_INTERVAL 10
-
-// Copy audio processor implementation inline
-volatile int audioBuffer[BUFFER_SIZE];
-volatile int bufferIndex = 0;
-volatile bool newSampleReady = false;
-volatile int latestRawSample = 0;
-static int smoothedAmplitude = 0;
-
-void initAudioProcessor() {
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    audioBuffer[i] = DC_OFFSET;
-  }
-  bufferIndex = 0;
-  smoothedAmplitude = 0;
-  newSampleReady = false;
-}
+#include "main/config.h"
+#include "main/audio_processor.h"
+#include "main/sample_ring.h"
+#include "signal_generators.h"
 
-int processAudio() {
-  long sum = 0;
-  for (int i = 0; i < BUFFER_SIZE; i++) {
-    sum += audioBuffer[i];
-  }
-  int average = sum / BUFFER_SIZE;
-  int amplitude = std::abs(average - DC_OFFSET);
-  smoothedAmplitude = (smoothedAmplitude * 3 + amplitude * 7) / 10;
-  return smoothedAmplitude;
-}
+#include <cassert>
+#include <cmath>
+#include <iostream>
 
-int getSmoothedAmplitude() {
-  return smoothedAmplitude;
+// Feed `count` samples of a square wave (DC_OFFSET + offset +/- swing) in ring-sized
+// pieces and process them; returns the amplitude after the last piece.
+static int feed(int offset, int swing, unsigned count) {
+    int amplitude = 0;
+    unsigned sent = 0;
+    while (sent < count) {
+        for (unsigned i = 0; i < 64 && sent < count; i++, sent++) {
+            assert(sampleRingPush(DC_OFFSET + offset + ((sent & 1) ? swing : -swing)));
+        }
+        amplitude = processAudio();
+    }
+    return amplitude;
 }
 
-bool isNewSampleReady() {
-  return newSampleReady;
+static unsigned ms(unsigned millis) {
+    return millis * SAMPLE_RATE / 1000;
 }
 
-void clearSampleReadyFlag() {
-  newSampleReady = false;
+void test_audio_processor_initialization() {
+    std::cout << "Test: Audio Processor Initialization... ";
+
+    resetMockArduino();
+    sampleRingPush(700);
+    initAudioProcessor();
+
+    assert(getSmoothedAmplitude() == 0);
+    assert(!isNewSampleReady());  // the ring is flushed
+    assert(getDcOffsetEstimate() == DC_OFFSET);
+    assert(getShortWindowStats().mean == DC_OFFSET && getShortWindowStats().length == BUFFER_SIZE);
+    assert(getLongWindowStats().mean == DC_OFFSET && getLongWindowStats().length == STATS_LONG_WINDOW);
+    for (int b = 0; b < AUDIO_BAND_COUNT; b++) assert(getBandLevel((AudioBand)b) == 0);
+    assert(getBandBlockCount() == 0);
+
+    std::cout << "PASS" << std::endl;
 }
 
-#include <cassert>
-#include <iostream>
+void test_every_sample_processed_once() {
+    std::cout << "Test: Every Queued Sample Is Processed Exactly Once... ";
 
-void test_audio_processor_initialization() {
-    std::cout << "Test: Audio Processor Initialization... ";
-    
     initAudioProcessor();
-    
-    int amplitude = getSmoothedAmplitude();
-    assert(amplitude == 0);
+    // More than one drain batch, ending in a ramp the short window can be checked against.
+    for (int i = 0; i < 100; i++) assert(sampleRingPush(DC_OFFSET + i));
+    assert(isNewSampleReady());
+    processAudio();
     assert(!isNewSampleReady());
-    
+
+    const AudioWindowStats s = getShortWindowStats();
+    assert(s.min == DC_OFFSET + 100 - BUFFER_SIZE && s.max == DC_OFFSET + 99);
+    assert(s.mean == DC_OFFSET + 100 - (BUFFER_SIZE + 1) / 2);
+    // Nothing queued: a second call processes nothing and changes nothing.
+    processAudio();
+    assert(getShortWindowStats().mean == s.mean && getShortWindowStats().max == s.max);
+
     std::cout << "PASS" << std::endl;
 }
 
 void test_audio_processor_smoothing() {
-    std::cout << "Test: Audio Processor Smoothing... ";
-    
-    // Initialize
+    std::cout << "Test: Audio Processor Envelope Attack / Release... ";
+
     initAudioProcessor();
-    
-    // Manually fill buffer with loud audio (above DC offset)
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        audioBuffer[i] = 700;
-    }
-    
-    int amplitude = processAudio();
-    assert(amplitude > 0);
-    assert(amplitude >= 100 && amplitude <= 250);
-    
-    // Fill with silence
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        audioBuffer[i] = DC_OFFSET;
-    }
-    
-    // Let smoothing settle
-    for (int i = 0; i < 50; i++) {
-        amplitude = processAudio();
-    }
-    
-    assert(amplitude >= 0 && amplitude <= 20);
-    
+
+    // Loud square wave: the envelope reads its level within a few attack time constants.
+    int amplitude = feed(0, 200, ms(ENVELOPE_AVERAGING_MS + 6 * ENVELOPE_ATTACK_MS));
+    assert(amplitude >= 180 && amplitude <= 220);
+
+    // Silence: it decays over the release time, to zero.
+    amplitude = feed(0, 0, ms(ENVELOPE_RELEASE_MS));
+    assert(amplitude > 20 && amplitude < 200);
+    amplitude = feed(0, 0, ms(10 * ENVELOPE_RELEASE_MS));
+    assert(amplitude <= 2);
+
     std::cout << "PASS" << std::endl;
 }
 
-void test_audio_buffer_rolling() {
-    std::cout << "Test: Audio Buffer Rolling... ";
-    
+void test_dc_offset_removal() {
+    std::cout << "Test: DC Offset Removal and Auto-Calibration... ";
+
+    // Exactly at the DC offset: no amplitude.
     initAudioProcessor();
-    
-    // Simulate adding samples to buffer
-    for (int i = 0; i < BUFFER_SIZE * 2; i++) {
-        audioBuffer[bufferIndex] = 600 + (i % 10);
-        bufferIndex = (bufferIndex + 1) % BUFFER_SIZE;
-        newSampleReady = true;
-    }
-    
-    // Process should work without crashing
-    int amplitude = processAudio();
-    assert(amplitude >= 0 && amplitude <= 512);
-    
+    assert(feed(0, 0, 200) == 0);
+
+    // A shifted microphone bias is learned from the long window and stops reading as sound.
+    initAudioProcessor();
+    feed(100, 0, 2 * STATS_LONG_WINDOW + ms(10 * ENVELOPE_RELEASE_MS));
+    assert(getDcOffsetEstimate() == DC_OFFSET + 100);
+    assert(getSmoothedAmplitude() <= 2);
+    assert(feed(100, 150, ms(100)) >= 130);  // a tone on top of it is still heard
+
+    // With calibration off (ACTIVE) the estimate holds, so the offset reads as level,
+    // above or below the baseline alike.
+    initAudioProcessor();
+    setAutoCalibrationEnabled(false);
+    assert(feed(100, 0, ms(100)) >= 95);
+    assert(getDcOffsetEstimate() == DC_OFFSET);
+    initAudioProcessor();
+    setAutoCalibrationEnabled(false);
+    assert(feed(-100, 0, ms(100)) >= 95);
+
     std::cout << "PASS" << std::endl;
 }
 
-void test_dc_offset_removal() {
-    std::cout << "Test: DC Offset Removal... ";
-    
+void test_beat_tracking() {
+    std::cout << "Test: Onsets and Beat Tempo From the Sample Stream... ";
+
     initAudioProcessor();
-    
-    // Test with value exactly at DC offset
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        audioBuffer[i] = DC_OFFSET;
-    }
-    
-    int amplitude = processAudio();
-    assert(amplitude == 0);
-    
-    // Test with value above DC offset
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        audioBuffer[i] = DC_OFFSET + 100;
-    }
-    
-    amplitude = processAudio();
-    assert(amplitude > 0);
-    
-    // Test with value below DC offset
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        audioBuffer[i] = DC_OFFSET - 100;
+    assert(getOnsetCount() == 0 && !isBeatLocked() && getBeatPeriodMs() == 0);
+
+    // Eight seconds of music at 120 BPM, through the ring like the ISR delivers it.
+    MusicLike music(120.0, 1.0, 37);
+    for (unsigned n = 0; n < ms(8000);) {
+        for (unsigned i = 0; i < 64; i++, n++) {
+            assert(sampleRingPush(DC_OFFSET + (int)lround(music((double)n / SAMPLE_RATE))));
+        }
+        processAudio();
     }
-    
-    amplitude = processAudio();
-    assert(amplitude > 0); // Should be absolute value
-    
+#if ENABLE_BEAT_TRACKER
+    assert(getOnsetCount() >= 16);
+    assert(isBeatLocked());
+    assert(getBeatPeriodMs() >= 490 && getBeatPeriodMs() <= 510);
+    assert(getMsToNextBeat() < getBeatPeriodMs());
+#else
+    assert(getOnsetCount() == 0 && !isBeatLocked() && getBeatPeriodMs() == 0);
+#endif
+
+    // Re-initialising forgets the tempo.
+    initAudioProcessor();
+    assert(getOnsetCount() == 0 && !isBeatLocked() && getBeatPhase() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_dc_baseline_holdoff() {
+    std::cout << "Test: Ending Calibration Restores the Baseline From Before the Sound... ";
+
+    initAudioProcessor();
+    feed(0, 0, 2 * STATS_LONG_WINDOW);
+    assert(getDcOffsetEstimate() == DC_OFFSET);
+
+    // A sound with a low-frequency push (here: a plain offset) drags the long window's
+    // mean along before the supervisor ends calibration ...
+    feed(60, 0, ms(DC_BASELINE_HOLDOFF_MS) - 20);
+    assert(getDcOffsetEstimate() > DC_OFFSET + 10);
+    // ... which rolls back to the estimate from before the sound started.
+    setAutoCalibrationEnabled(false);
+    assert(getDcOffsetEstimate() == DC_OFFSET);
+    assert(feed(60, 0, ms(100)) >= 55);
+
+    // Enabling and disabling again holds the latest estimate.
+    setAutoCalibrationEnabled(true);
+    setAutoCalibrationEnabled(false);
+    assert(getDcOffsetEstimate() == DC_OFFSET);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_noise_floor_and_gain() {
+    std::cout << "Test: Noise Floor Follows the Room, AGC Normalizes the Sound... ";
+
+    // A steady room noise while calibrating (IDLE): the floor settles on it.
+    initAudioProcessor();
+    assert(getNoiseFloor() == NOISE_FLOOR_MIN && getAgcGain() == 256);
+    const int room = feed(0, 20, ms(5000));
+    assert(std::abs(getNoiseFloor() - room) <= 1);
+    // A quieter room is found faster than a louder one.
+    const int quiet = feed(0, 6, ms(1500));
+    assert(std::abs(getNoiseFloor() - quiet) <= 1);
+    feed(0, 20, ms(5000));
+    assert(std::abs(getNoiseFloor() - room) <= 1);
+
+    // Sound (ACTIVE, calibration off): the floor only creeps up; the gain learns the level.
+    setAutoCalibrationEnabled(false);
+    const int loud = feed(0, 100, ms(10000));
+    assert(getNoiseFloor() > room && getNoiseFloor() < room * 2);
+#if ENABLE_AGC
+    const int normalized = normalizeLevel(loud);
+    assert(std::abs(normalized - AGC_TARGET_LEVEL) <= AGC_TARGET_LEVEL / 20);
+    assert(normalizeLevel(getNoiseFloor()) == 0 && normalizeLevel(0) == 0);
+    assert(normalizeLevel(10000) == 32767);
+
+    // Back in IDLE the gain holds for the next sound.
+    const unsigned gain = getAgcGain();
+    setAutoCalibrationEnabled(true);
+    feed(0, 20, ms(3000));
+    assert(getAgcGain() == gain);
+
+    // A sound barely above the floor gets at most AGC_MAX_GAIN_PCT.
+    setAutoCalibrationEnabled(false);
+    feed(0, 24, ms(30000));
+    assert(getAgcGain() == AGC_MAX_GAIN_PCT * 256u / 100);
+#else
+    assert(getAgcGain() == 256);
+    assert(normalizeLevel(loud) == loud - getNoiseFloor() && normalizeLevel(0) == 0);
+#endif
+
     std::cout << "PASS" << std::endl;
 }
 
@@ -147,18 +212,15 @@ int main() {
     std::cout << "\n========================================" << std::endl;
     std::cout << "  AUDIO PROCESSOR TESTS" << std::endl;
     std::cout << "========================================\n" << std::endl;
-    
-    try {
-        test_audio_processor_initialization();
-        test_audio_processor_smoothing();
-        test_audio_buffer_rolling();
-        test_dc_offset_removal();
-        
-        std::cout << "\n✓ All Audio Processor tests passed!\n" << std::endl;
-        return 0;
-    } catch (const std::exception& e) {
-        std::cout << "\n✗ Test failed with exception: " << e.what() << std::endl;
-        return 1;
-    }
-}
 
+    test_audio_processor_initialization();
+    test_every_sample_processed_once();
+    test_audio_processor_smoothing();
+    test_dc_offset_removal();
+    test_dc_baseline_holdoff();
+    test_noise_floor_and_gain();
+    test_beat_tracking();
+
+    std::cout << "\n✓ All Audio Processor tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "main/beat_tracker.h"
+#include "signal_generators.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+// The firmware's configuration at 1 kHz: 8 ms frames, 60-180 BPM, 120 preferred.
+static const double FS = 1000.0;
+typedef BeatTracker<8, 41, 125, 62, 10> Tracker;
+
+static Tracker tracker;
+
+// Feed `seconds` of signal(t) starting at t0 (seconds, the signal's own time).
+static void feed(const std::function<double(double)> &signal, double t0, double seconds) {
+    const long start = lround(t0 * FS);
+    for (long n = start; n < start + lround(seconds * FS); n++) {
+        tracker.push((int32_t)lround(signal((double)n / FS)));
+    }
+}
+
+// Signed distance (in beats) from the tracker's beat to the true one, for a true
+// beat every `period` s starting at 0; now = t s.
+static double phaseError(double t, double period) {
+    const double truePhase = std::fmod(t, period) / period;
+    double e = tracker.phase() / 65536.0 - truePhase;
+    if (e > 0.5) e -= 1.0;
+    if (e < -0.5) e += 1.0;
+    return e;
+}
+
+static double trackerBpm() {
+    return tracker.periodQ8() ? 60.0 * FS * 256.0 / tracker.periodQ8() : 0.0;
+}
+
+void test_constexpr_tempo_weights() {
+    std::cout << "Test: Compile-Time Tempo Weights Match <cmath>... ";
+
+    // Built by the compiler: the table the constructor used to compute with libm.
+    static constexpr BeatTempoWeights<41, Tracker::LAGS, 62> weights = makeBeatTempoWeights<41, Tracker::LAGS, 62>();
+    for (int i = 0; i < Tracker::LAGS; i++) {
+        const double octaves = std::log2((double)(41 + i) / 62);
+        assert(weights.weight[i] == std::lround(32767.0 * std::exp(-0.5 * octaves * octaves)));
+    }
+    assert(weights.weight[62 - 41] == 32767);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_silence_and_hum_make_no_onsets() {
+    std::cout << "Test: Silence, hum and hiss: no onsets, no tempo... ";
+
+    tracker.reset();
+    feed([](double) { return 0.0; }, 0.0, 5.0);
+    assert(tracker.onsets() == 0 && !tracker.locked() && tracker.periodQ8() == 0);
+
+    Hum hum{50.0, 8.0};
+    WhiteNoise hiss(1.5, 41);
+    feed([&](double t) { return hum(t) + hiss(t); }, 0.0, 20.0);
+    assert(tracker.onsets() == 0 && !tracker.locked());
+    assert(tracker.phase() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_one_onset_per_burst() {
+    std::cout << "Test: One onset per tone burst, a frame or two after it starts... ";
+
+    tracker.reset();
+    // 200 Hz bursts of 150 ms every 700 ms: too sparse and irregular for a tempo.
+    const ToneBurst burst{{200.0, 120.0}, 150.0, 700.0, 2.0};
+    uint32_t onsets = tracker.onsets();
+    for (int k = 0; k < 10; k++) {
+        const double start = k * 0.7;
+        for (long n = lround(start * FS); n < lround((start + 0.7) * FS); n++) {
+            if (tracker.push((int32_t)lround(burst((double)n / FS)))) {
+                const double at = (double)n / FS - start;
+                assert(at >= 0.0 && at < 0.025);
+            }
+        }
+        assert(tracker.onsets() == onsets + 1);
+        onsets = tracker.onsets();
+    }
+    assert(tracker.lastOnsetStrength() >= 32);  // silence -> 120 counts: several octaves
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_tempo_and_phase_lock_to_music() {
+    std::cout << "Test: Tempo and beat phase lock to music at 90 / 120 / 150 BPM... ";
+
+    const double tempos[] = {90.0, 120.0, 150.0};
+    for (double bpm : tempos) {
+        tracker.reset();
+        MusicLike music(bpm, 1.0, 37);
+        const double period = 60.0 / bpm;
+        auto signal = [&](double t) { return music(t); };
+
+        feed(signal, 0.0, 4.0);
+        assert(tracker.locked());
+        feed(signal, 4.0, 6.0);
+        assert(tracker.locked());
+        assert(std::fabs(trackerBpm() - bpm) < 0.02 * bpm);
+        assert(std::fabs(phaseError(10.0, period)) < 0.05);
+
+        // Time to the next beat agrees with the phase.
+        const double toNext = tracker.samplesToNextBeat();
+        const double expected = (1.0 - tracker.phase() / 65536.0) * tracker.periodQ8() / 256.0;
+        assert(std::fabs(toNext - expected) <= 1.0);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_phase_moves_from_offbeats_to_beats() {
+    std::cout << "Test: Starting on an off-beat hi-hat, the phase settles on the kicks... ";
+
+    // Join the music half a beat in: the first sound is a hi-hat, the first kick
+    // comes 250 ms later.
+    const double bpms[] = {100.0, 120.0};
+    double worst = 0.0;
+    for (double bpm : bpms) {
+        tracker.reset();
+        MusicLike music(bpm, 1.0, 53);
+        const double period = 60.0 / bpm;
+        feed([&](double t) { return music(t); }, period / 2.0, 10.0);
+        assert(tracker.locked());
+        assert(std::fabs(trackerBpm() - bpm) < 0.02 * bpm);
+        const double e = phaseError(period / 2.0 + 10.0, period);
+        assert(std::fabs(e) < 0.05);
+        worst = std::fmax(worst, std::fabs(e));
+    }
+
+    std::cout << "PASS (phase error <= " << worst << " beat)" << std::endl;
+}
+
+void test_follows_a_tempo_change() {
+    std::cout << "Test: A tempo change (120 -> 90 BPM) is followed within seconds... ";
+
+    tracker.reset();
+    MusicLike fast(120.0, 1.0, 37), slow(90.0, 1.0, 38);
+    feed([&](double t) { return fast(t); }, 0.0, 10.0);
+    assert(tracker.locked() && std::fabs(trackerBpm() - 120.0) < 2.4);
+
+    double switchedAfter = -1.0;
+    for (int s = 0; s < 15 && switchedAfter < 0.0; s++) {
+        feed([&](double t) { return slow(t); }, s, 1.0);
+        if (tracker.locked() && std::fabs(trackerBpm() - 90.0) < 1.8) switchedAfter = s + 1.0;
+    }
+    assert(switchedAfter > 0.0 && switchedAfter <= 10.0);
+
+    std::cout << "PASS (" << switchedAfter << " s)" << std::endl;
+}
+
+void test_noise_never_locks() {
+    std::cout << "Test: Pink noise makes onsets but no tempo lock... ";
+
+    tracker.reset();
+    PinkNoise pink(60.0, 11);
+    bool everLocked = false;
+    for (int s = 0; s < 30; s++) {
+        feed([&](double t) { return pink(t); }, s, 1.0);
+        everLocked |= tracker.locked();
+    }
+    assert(tracker.onsets() > 0);
+    assert(!everLocked);
+
+    std::cout << "PASS (" << tracker.onsets() << " onsets in 30 s)" << std::endl;
+}
+
+void test_unlocks_when_the_music_stops() {
+    std::cout << "Test: Lock is lost once onsets stop; reset clears everything... ";
+
+    tracker.reset();
+    MusicLike music(120.0, 1.0, 37);
+    feed([&](double t) { return music(t); }, 0.0, 6.0);
+    assert(tracker.locked());
+    feed([](double) { return 0.0; }, 6.0, 3.0);
+    assert(!tracker.locked());
+
+    tracker.reset();
+    assert(tracker.onsets() == 0 && tracker.periodQ8() == 0 && tracker.phase() == 0 && !tracker.locked());
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_full_scale_no_overflow() {
+    std::cout << "Test: Full-scale clipped square beats stay in range... ";
+
+    tracker.reset();
+    // Square wave at +/-32767 switched on for 100 ms every 500 ms: worst-case levels
+    // and rises for the accumulators.
+    auto square = [](double t) {
+        const bool on = std::fmod(t, 0.5) < 0.1;
+        return on ? (std::fmod(t, 0.01) < 0.005 ? 32767.0 : -32767.0) : 0.0;
+    };
+    feed(square, 0.0, 20.0);
+    assert(tracker.locked());
+    assert(std::fabs(trackerBpm() - 120.0) < 2.4);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  BEAT TRACKER TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_constexpr_tempo_weights();
+    test_silence_and_hum_make_no_onsets();
+    test_one_onset_per_burst();
+    test_tempo_and_phase_lock_to_music();
+    test_phase_moves_from_offbeats_to_beats();
+    test_follows_a_tempo_change();
+    test_noise_never_locks();
+    test_unlocks_when_the_music_stops();
+    test_full_scale_no_overflow();
+
+    std::cout << "\n✓ All Beat Tracker tests passed!\n" << std::endl;
+    return 0;
+}
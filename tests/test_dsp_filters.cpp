@@ -0,0 +1,196 @@
+#include "main/fixed_point.h"
+#include "main/dsp_filters.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+void test_q15_conversion_and_saturation() {
+    std::cout << "Test: Q15/Q31 Conversion and Saturation... ";
+
+    static_assert(q15(0.5) == 16384, "q15 rounds to nearest");
+    static_assert(q15(-1.0) == Q15_MIN, "q15 lower bound");
+    static_assert(q15(1.0) == Q15_MAX, "q15 saturates at +1");
+    static_assert(q31(0.25) == (1 << 29), "q31 scale");
+
+    assert(qadd15(30000, 30000) == Q15_MAX);
+    assert(qsub15(-30000, 30000) == Q15_MIN);
+    assert(qadd31(Q31_MAX, 1) == Q31_MAX);
+    assert(qsub31(Q31_MIN, 1) == Q31_MIN);
+
+    assert(qmul15(q15(0.5), q15(0.5)) == q15(0.25));
+    assert(qmul15(Q15_MIN, Q15_MIN) == Q15_MAX);  // -1 * -1 is the only overflow
+    assert(qmul31(q31(0.5), q31(-0.5)) == q31(-0.25));
+    assert(qmul31(Q31_MIN, Q31_MIN) == Q31_MAX);
+
+    // Rounded, not truncated: -3 * 0.5 = -1.5 rounds towards +inf (to -1), never to -2.
+    assert(scaleQ15(3, q15(0.5)) == 2);
+    assert(scaleQ15(-3, q15(0.5)) == -1);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ema_settles_without_bias() {
+    std::cout << "Test: EMA Settles Exactly on a Steady Level... ";
+
+    // The old integer EMA stalls short of the input; the fixed-point one does not.
+    int legacy = 0;
+    EmaFilter<q15(0.7)> ema;
+    int32_t y = 0;
+    for (int i = 0; i < 100; i++) {
+        legacy = (legacy * 3 + 100 * 7) / 10;
+        y = ema.process(100);
+    }
+    assert(legacy == 99);
+    assert(y == 100);
+
+    // ...and back down to zero, and for a slow filter too.
+    for (int i = 0; i < 100; i++) y = ema.process(0);
+    assert(y == 0);
+
+    EmaFilter<q15(0.01)> slow;
+    slow.reset(-500);
+    for (int i = 0; i < 5000; i++) y = slow.process(1234);
+    assert(y == 1234);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ema_first_step_response() {
+    std::cout << "Test: EMA Step Response Matches alpha... ";
+
+    EmaFilter<q15(0.25)> ema;
+    assert(ema.process(400) == 100);
+    assert(ema.process(400) == 175);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_high_pass_and_dc_blocker_remove_dc() {
+    std::cout << "Test: High-Pass and DC Blocker Remove DC Exactly... ";
+
+    OnePoleHighPass<q15(0.05)> hpf;
+    DcBlocker<q15(0.99)> blocker;
+    assert(hpf.reset(512) == 0);
+    assert(blocker.reset(512) == 0);
+
+    // A step away from the old level passes through at first, then decays to zero.
+    int32_t h = hpf.process(812);
+    int32_t b = blocker.process(812);
+    assert(h > 250 && b == 300);
+    for (int i = 0; i < 5000; i++) {
+        h = hpf.process(812);
+        b = blocker.process(812);
+    }
+    assert(h == 0);
+    assert(b == 0);
+
+    // A tone well above the corner passes with its amplitude nearly intact.
+    int32_t peak = 0;
+    for (int i = 0; i < 2000; i++) {
+        const int32_t x = 512 + (int32_t)lround(200.0 * std::sin(2.0 * 3.14159265358979 * 100.0 * i / 1000.0));
+        const int32_t y = blocker.process(x);
+        if (i > 1000 && std::abs(y) > peak) peak = std::abs(y);
+    }
+    assert(peak > 190 && peak < 210);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// 2nd-order Butterworth low-pass, fc = 10 Hz at fs = 1 kHz (RBJ cookbook, Q = 0.7071).
+typedef Biquad<biquadCoef(0.00094469), biquadCoef(0.00188938), biquadCoef(0.00094469),
+               biquadCoef(-1.91119707), biquadCoef(0.91497583)> LowPass10Hz;
+
+void test_biquad_low_pass() {
+    std::cout << "Test: Biquad Low-Pass DC Gain and Attenuation... ";
+
+    LowPass10Hz lpf;
+    assert(lpf.reset(512) == 512);
+    assert(lpf.process(512) == 512);
+
+    // Step settles exactly on the new level (no truncation offset or limit cycle).
+    int32_t y = 0;
+    for (int i = 0; i < 3000; i++) y = lpf.process(700);
+    assert(y == 700);
+    for (int i = 0; i < 100; i++) assert(lpf.process(700) == 700);
+
+    // A 200 Hz tone (4+ octaves above fc) is attenuated by ~50 dB.
+    int32_t peak = 0;
+    for (int i = 0; i < 3000; i++) {
+        const int32_t x = (int32_t)lround(1000.0 * std::sin(2.0 * 3.14159265358979 * 200.0 * i / 1000.0));
+        y = lpf.process(x);
+        if (i > 2000 && std::abs(y - 0) > peak) peak = std::abs(y);
+    }
+    assert(peak <= 5);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_filter_chain_composition() {
+    std::cout << "Test: FilterChain Composition... ";
+
+    FilterChain<> passThrough;
+    assert(FilterChain<>::stages() == 0);
+    assert(passThrough.process(-42) == -42);
+
+    // DC blocker then EMA: reset settles every stage in order.
+    typedef FilterChain<DcBlocker<q15(0.995)>, EmaFilter<q15(0.5)>> Chain;
+    assert(Chain::stages() == 2);
+    Chain chain;
+    assert(chain.reset(512) == 0);
+
+    // Same result as running the stages by hand.
+    DcBlocker<q15(0.995)> a;
+    EmaFilter<q15(0.5)> b;
+    a.reset(512);
+    b.reset(0);
+    for (int i = 0; i < 1000; i++) {
+        const int32_t x = 512 + ((i / 50) % 2 ? 100 : -100);
+        assert(chain.process(x) == b.process(a.process(x)));
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_extreme_inputs_do_not_wrap() {
+    std::cout << "Test: Filters Handle Full-Scale Inputs... ";
+
+    EmaFilter<q15(0.9)> ema;
+    OnePoleHighPass<q15(0.1)> hpf;
+    LowPass10Hz lpf;
+    ema.reset(-32767);
+    hpf.reset(-32767);
+    lpf.reset(-32767);
+    int32_t e = 0, h = 0, l = 0;
+    for (int i = 0; i < 5000; i++) {
+        e = ema.process(32767);
+        h = hpf.process(32767);
+        l = lpf.process(32767);
+        assert(e >= -32767 && e <= 32767);
+        assert(h >= 0 && h <= 65534);
+    }
+    assert(e == 32767);
+    assert(h == 0);
+    assert(l == 32767);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  FIXED-POINT DSP FILTER TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_q15_conversion_and_saturation();
+    test_ema_settles_without_bias();
+    test_ema_first_step_response();
+    test_high_pass_and_dc_blocker_remove_dc();
+    test_biquad_low_pass();
+    test_filter_chain_composition();
+    test_extreme_inputs_do_not_wrap();
+
+    std::cout << "\n✓ All DSP Filter tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "main/envelope_follower.h"
+#include "main/dsp_filters.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+static const double PI = 3.14159265358979323846;
+static const double FS = 1000.0;
+
+// 1kHz sample rate, 10ms averaging, 5ms attack, 150ms release (the config.h defaults).
+static const q15_t AVERAGE = timeConstantToQ15(10, FS);
+static const q15_t ATTACK = timeConstantToQ15(5, FS);
+static const q15_t RELEASE = timeConstantToQ15(150, FS);
+
+typedef EnvelopeFollower<ENVELOPE_RECTIFIED, AVERAGE, ATTACK, RELEASE> RectifiedEnvelope;
+typedef EnvelopeFollower<ENVELOPE_RMS, AVERAGE, ATTACK, RELEASE> RmsEnvelope;
+typedef EnvelopeFollower<ENVELOPE_PEAK, AVERAGE, ATTACK, RELEASE> PeakEnvelope;
+
+static int32_t tone(int n, double amplitude, double hz) {
+    return (int32_t)lround(amplitude * std::sin(2.0 * PI * hz * n / FS));
+}
+
+// Run a tone long enough to settle, then return the envelope's min and max over the last 500 samples.
+template <typename Env>
+static void settleOnTone(Env &env, double amplitude, double hz, int32_t *lo, int32_t *hi) {
+    *lo = INT32_MAX;
+    *hi = INT32_MIN;
+    for (int n = 0; n < 3000; n++) {
+        const int32_t y = env.process(tone(n, amplitude, hz));
+        if (n >= 2500) {
+            if (y < *lo) *lo = y;
+            if (y > *hi) *hi = y;
+        }
+    }
+}
+
+void test_time_constant_conversion() {
+    std::cout << "Test: Time Constant -> Q15 Weight... ";
+
+    static_assert(timeConstantToQ15(0, 1000) == Q15_MAX, "0ms follows immediately");
+    static_assert(timeConstantToQ15(10, 1000) > timeConstantToQ15(20, 1000), "longer = slower");
+    // Within 2% of the exact 1 - exp(-1/tau) for tau >= 2 samples.
+    for (int ms = 2; ms <= 1000; ms *= 2) {
+        const double exact = 1.0 - std::exp(-1.0 / ms);
+        const double approx = timeConstantToQ15(ms, FS) / 32768.0;
+        assert(std::fabs(approx - exact) / exact < 0.02);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_isqrt_rounds_to_nearest() {
+    std::cout << "Test: Integer Square Root... ";
+
+    for (uint32_t n = 0; n < 200000; n++) {
+        const uint16_t r = isqrt32(n);
+        assert(std::fabs((double)r - std::sqrt((double)n)) <= 0.5);
+    }
+    assert(isqrt32(0xFFFFFFFFu) == 0xFFFF);
+    assert(isqrt32(1u << 30) == 32768);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_modes_measure_expected_levels() {
+    std::cout << "Test: Envelope Modes on a Sine (mean / RMS / peak)... ";
+
+    // 100Hz sine, amplitude 300: rectified mean 2A/pi = 191, RMS A/sqrt(2) = 212, peak 300.
+    RectifiedEnvelope rect;
+    RmsEnvelope rms;
+    PeakEnvelope peak;
+    int32_t lo, hi;
+
+    // (Fast attack rides slightly above the averaged level: a few % high.)
+    settleOnTone(rect, 300, 100, &lo, &hi);
+    assert(lo >= 188 && hi <= 200);
+
+    settleOnTone(rms, 300, 100, &lo, &hi);
+    assert(lo >= 210 && hi <= 222);
+
+    settleOnTone(peak, 300, 100, &lo, &hi);
+    assert(lo >= 270 && hi <= 300);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_averaging_first_cancels_a_tone() {
+    std::cout << "Test: Tone Is Not Cancelled (vs. average-then-rectify)... ";
+
+    // The old path: |mean of the last 20 samples| around DC. A 100Hz tone spans two
+    // full periods in 20ms, so it averages out to ~0 while the envelope sees it.
+    RmsEnvelope rms;
+    int32_t window[20] = {0};
+    int32_t legacy = 0, y = 0;
+    for (int n = 0; n < 1000; n++) {
+        const int32_t x = tone(n, 300, 100);
+        window[n % 20] = x;
+        int32_t sum = 0;
+        for (int i = 0; i < 20; i++) sum += window[i];
+        legacy = std::abs(sum / 20);
+        y = rms.process(x);
+    }
+    assert(legacy <= 2);
+    assert(y > 200);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_attack_faster_than_release() {
+    std::cout << "Test: Independent Attack and Release... ";
+
+    RectifiedEnvelope env;
+    // Attack: averaging (10ms) then attack (5ms) cover most of a step within 20ms.
+    int32_t y = 0;
+    for (int n = 0; n < 20; n++) y = env.process(400);
+    assert(y > 280 && y < 340);
+    for (int n = 0; n < 100; n++) y = env.process(-400);  // polarity does not matter
+    assert(y == 400);
+
+    // Release: 150ms to ~37%, and eventually exactly zero (no stuck fractional residue).
+    for (int n = 0; n < 150; n++) y = env.process(0);
+    assert(y > 140 && y < 175);
+    for (int n = 0; n < 5000; n++) y = env.process(0);
+    assert(y == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_peak_decays_towards_zero_not_signal() {
+    std::cout << "Test: Peak Mode Holds Peaks... ";
+
+    // After a spike, both modes release; on the following quiet tone peak mode
+    // settles near the tone's peaks and rectified mode near its average.
+    PeakEnvelope peak;
+    RectifiedEnvelope rect;
+    peak.process(1000);
+    rect.process(1000);
+    int32_t p = 0, r = 0;
+    for (int n = 0; n < 2000; n++) {
+        p = peak.process(tone(n, 100, 50));
+        r = rect.process(tone(n, 100, 50));
+    }
+    assert(p > r);
+    assert(p >= 80 && p <= 100);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_full_scale_input() {
+    std::cout << "Test: Envelope Handles Full-Scale Input... ";
+
+    RmsEnvelope rms;
+    PeakEnvelope peak;
+    int32_t y = 0, p = 0;
+    for (int n = 0; n < 2000; n++) {
+        y = rms.process((n & 1) ? 70000 : -70000);  // clipped to the Q15 range
+        p = peak.process(INT32_MIN);
+    }
+    assert(y == 32767);
+    assert(p == 32767);
+    assert(rms.reset(0) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  ENVELOPE FOLLOWER TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_time_constant_conversion();
+    test_isqrt_rounds_to_nearest();
+    test_modes_measure_expected_levels();
+    test_averaging_first_cancels_a_tone();
+    test_attack_faster_than_release();
+    test_peak_decays_towards_zero_not_signal();
+    test_full_scale_input();
+
+    std::cout << "\n✓ All Envelope Follower tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include "main/fsm.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// A small door: CLOSED <-> OPEN, CLOSED <-> LOCKED (only when the key is present).
+enum DoorState { CLOSED, OPEN, LOCKED, DOOR_STATES };
+enum DoorEvent { PUSH, PULL, TURN_KEY };
+
+// Every action appends a token, so tests can check what ran and in which order.
+static std::string actions;
+static bool haveKey = false;
+static unsigned long openTicks = 0;
+
+static void enterClosed(unsigned long) { actions += "+closed "; }
+static void exitClosed(unsigned long) { actions += "-closed "; }
+static void enterOpen(unsigned long) { actions += "+open "; }
+static void exitOpen(unsigned long) { actions += "-open "; }
+static void duringOpen(unsigned long) { openTicks++; }
+static void enterLocked(unsigned long) { actions += "+locked "; }
+static bool keyPresent(unsigned long) { return haveKey; }
+
+static constexpr FsmStateDef DOOR[] = {
+    {CLOSED, "CLOSED", enterClosed, exitClosed, nullptr},
+    {OPEN, "OPEN", enterOpen, exitOpen, duringOpen},
+    {LOCKED, "LOCKED", enterLocked, nullptr, nullptr},
+};
+
+static constexpr FsmTransition<DoorEvent> DOOR_ROWS[] = {
+    {fsmStateMask(CLOSED), PUSH, nullptr, OPEN, "pushed"},
+    {fsmStateMask(OPEN), PULL, nullptr, CLOSED, "pulled"},
+    {fsmStateMask(CLOSED), TURN_KEY, keyPresent, LOCKED, "locked"},
+    {fsmStateMask(LOCKED), TURN_KEY, keyPresent, CLOSED, "unlocked"},
+    // Fallback without the key: unlocks LOCKED; for CLOSED it is a self-transition (ignored).
+    {fsmStateMask(CLOSED, LOCKED), TURN_KEY, nullptr, CLOSED, "jiggled"},
+};
+
+static_assert(fsmStatesInOrder(DOOR), "door states in enum order");
+static_assert(fsmTransitionsValid<DOOR_STATES>(DOOR_ROWS), "door rows valid");
+
+// The validators reject tables that are out of order or point outside the machine.
+static constexpr FsmStateDef SWAPPED[] = {
+    {OPEN, "OPEN", nullptr, nullptr, nullptr},
+    {CLOSED, "CLOSED", nullptr, nullptr, nullptr},
+};
+static constexpr FsmTransition<DoorEvent> BAD_TARGET[] = {
+    {fsmStateMask(CLOSED), PUSH, nullptr, 7, "nowhere"},
+};
+static constexpr FsmTransition<DoorEvent> NO_SOURCE[] = {
+    {0, PUSH, nullptr, OPEN, "from nowhere"},
+};
+static_assert(!fsmStatesInOrder(SWAPPED), "swapped states rejected");
+static_assert(!fsmTransitionsValid<DOOR_STATES>(BAD_TARGET), "bad target rejected");
+static_assert(!fsmTransitionsValid<DOOR_STATES>(NO_SOURCE), "empty source mask rejected");
+static_assert(fsmStateMask(CLOSED, LOCKED) == 0x5, "mask bits");
+
+typedef Fsm<DoorState, DoorEvent, DOOR, DOOR_ROWS, 4> Door;
+static_assert(Door::STATES == DOOR_STATES && Door::ROWS == 5, "table sizes");
+
+static void resetActions() {
+    actions.clear();
+    haveKey = false;
+    openTicks = 0;
+}
+
+void test_start_runs_entry_only() {
+    std::cout << "Test: start() Enters the Initial State... ";
+
+    resetActions();
+    Door door;
+    door.start(CLOSED, 100);
+    assert(door.state() == CLOSED);
+    assert(door.enteredMs() == 100);
+    assert(actions == "+closed ");
+    assert(door.traceSize() == 0);
+    assert(std::strcmp(door.stateName(LOCKED), "LOCKED") == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_exit_then_entry_on_transition() {
+    std::cout << "Test: Transition Runs exit(from) Then entry(to)... ";
+
+    resetActions();
+    Door door;
+    door.start(CLOSED, 0);
+    actions.clear();
+
+    assert(door.dispatch(PUSH, 10));
+    assert(door.state() == OPEN);
+    assert(door.enteredMs() == 10);
+    assert(std::strcmp(door.cause(), "pushed") == 0);
+    assert(actions == "-closed +open ");
+
+    // No row for PUSH in OPEN: nothing happens.
+    actions.clear();
+    assert(!door.dispatch(PUSH, 20));
+    assert(door.state() == OPEN);
+    assert(door.enteredMs() == 10);
+    assert(actions.empty());
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_during_only_in_its_state() {
+    std::cout << "Test: during() Runs Only While in the State... ";
+
+    resetActions();
+    Door door;
+    door.start(CLOSED, 0);
+    for (int i = 0; i < 5; i++) door.tick(i);
+    assert(openTicks == 0);
+    door.dispatch(PUSH, 5);
+    for (int i = 0; i < 5; i++) door.tick(6 + i);
+    assert(openTicks == 5);
+    door.dispatch(PULL, 20);
+    door.tick(21);
+    assert(openTicks == 5);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_guards_and_row_priority() {
+    std::cout << "Test: Guards Block Rows, First Enabled Row Wins... ";
+
+    resetActions();
+    Door door;
+    door.start(CLOSED, 0);
+    actions.clear();
+
+    // No key: "locked" is blocked, "jiggled" would be CLOSED -> CLOSED, which is ignored
+    // without running exit/entry.
+    assert(!door.dispatch(TURN_KEY, 1));
+    assert(door.state() == CLOSED);
+    assert(actions.empty());
+    assert(door.traceSize() == 0);
+
+    haveKey = true;
+    assert(door.dispatch(TURN_KEY, 2));
+    assert(door.state() == LOCKED);
+    assert(std::strcmp(door.cause(), "locked") == 0);
+
+    // From LOCKED the guarded row comes first...
+    assert(door.dispatch(TURN_KEY, 3));
+    assert(std::strcmp(door.cause(), "unlocked") == 0);
+    // ...and without the key the fallback row applies.
+    assert(door.dispatch(TURN_KEY, 4));
+    assert(door.state() == LOCKED);
+    haveKey = false;
+    assert(door.dispatch(TURN_KEY, 5));
+    assert(door.state() == CLOSED);
+    assert(std::strcmp(door.cause(), "jiggled") == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_trace_ring() {
+    std::cout << "Test: Transition Trace Keeps the Last N, Oldest First... ";
+
+    resetActions();
+    Door door;
+    door.start(CLOSED, 0);
+    door.dispatch(PUSH, 10);
+    door.dispatch(PULL, 20);
+    assert(door.traceSize() == 2);
+    assert(door.traceAt(0).timestampMs == 10);
+    assert(door.traceAt(0).from == CLOSED && door.traceAt(0).to == OPEN);
+    assert(std::strcmp(door.traceAt(0).cause, "pushed") == 0);
+    assert(door.traceAt(1).from == OPEN && door.traceAt(1).to == CLOSED);
+
+    // Six more transitions into a 4-entry ring: the last four remain, in order.
+    for (int i = 0; i < 3; i++) {
+        door.dispatch(PUSH, 30 + 20 * i);
+        door.dispatch(PULL, 40 + 20 * i);
+    }
+    assert(door.transitionCount() == 8);
+    assert(door.traceSize() == 4);
+    assert(door.traceAt(0).timestampMs == 50);
+    assert(door.traceAt(3).timestampMs == 80);
+    assert(door.traceAt(3).to == CLOSED);
+
+    // start() clears it.
+    door.start(OPEN, 100);
+    assert(door.traceSize() == 0);
+    assert(door.transitionCount() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  FSM ENGINE TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_start_runs_entry_only();
+    test_exit_then_entry_on_transition();
+    test_during_only_in_its_state();
+    test_guards_and_row_priority();
+    test_trace_ring();
+
+    std::cout << "\n✓ All FSM engine tests passed!\n" << std::endl;
+    return 0;
+}
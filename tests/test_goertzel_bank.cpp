@@ -0,0 +1,166 @@
+#include "main/goertzel_bank.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+static const double PI = 3.14159265358979323846;
+static const double FS = 1000.0;
+
+// The firmware configuration: 32-sample blocks, bins 1..16 (31.25Hz apart).
+typedef GoertzelBank<32, 1, 16> Bank;
+
+static int32_t tone(unsigned n, double amplitude, double hz, double phase = 0.0) {
+    return (int32_t)lround(amplitude * std::sin(2.0 * PI * hz * n / FS + phase));
+}
+
+// Feed whole blocks of a tone; returns after the last block completed.
+static void feedTone(Bank &bank, double amplitude, double hz, unsigned blocks, double phase = 0.0) {
+    unsigned completed = 0;
+    for (unsigned n = 0; completed < blocks; n++) {
+        if (bank.push(tone(n, amplitude, hz, phase))) completed++;
+    }
+}
+
+void test_block_cadence() {
+    std::cout << "Test: Goertzel Bank Block Cadence... ";
+
+    Bank bank;
+    assert(Bank::BINS == 16);
+    assert(Bank::length() == 32);
+    for (int n = 0; n < 31; n++) assert(!bank.push(100));
+    assert(bank.fill() == 31);
+    assert(bank.push(100));
+    assert(bank.fill() == 0);
+    assert(bank.blocks() == 1);
+
+    bank.reset();
+    assert(bank.blocks() == 0);
+    assert(bank.binPower(5) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_constexpr_tables() {
+    std::cout << "Test: Compile-Time Coefficients And Window Match <cmath>... ";
+
+    for (double x = -40.0; x <= 40.0; x += 0.0731) {
+        assert(std::fabs(constCos(x) - std::cos(x)) < 1e-13);
+    }
+    // Built by the compiler: the same tables the constructor used to compute with libm.
+    static constexpr GoertzelTables<32, 1, 16, 14> small = makeGoertzelTables<32, 1, 16, 14>();
+    static constexpr GoertzelTables<1024, 1, 512, 14> big = makeGoertzelTables<1024, 1, 512, 14>();
+    for (int i = 0; i < 16; i++) assert(small.coef[i] == std::lround(2.0 * std::cos(2.0 * PI * (1 + i) / 32) * 16384));
+    for (int n = 0; n < 32; n++) assert(small.window[n] == q15(0.5 - 0.5 * std::cos(2.0 * PI * n / 32)));
+    for (int i = 0; i < 512; i++) assert(big.coef[i] == std::lround(2.0 * std::cos(2.0 * PI * (1 + i) / 1024) * 16384));
+    for (int n = 0; n < 1024; n++) assert(big.window[n] == q15(0.5 - 0.5 * std::cos(2.0 * PI * n / 1024)));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_matches_float_dft() {
+    std::cout << "Test: Goertzel Powers Match a Hann-Windowed DFT... ";
+
+    Bank bank;
+    int32_t x[32];
+    uint32_t lcg = 7;
+    for (unsigned n = 0; n < 32; n++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        x[n] = tone(n, 200, 93.0) + tone(n, 80, 281.0) + (int32_t)((lcg >> 24) % 41) - 20;
+        bank.push(x[n]);
+    }
+    for (unsigned k = 1; k <= 16; k++) {
+        double re = 0, im = 0;
+        for (unsigned n = 0; n < 32; n++) {
+            const double w = 0.5 - 0.5 * std::cos(2.0 * PI * n / 32);
+            re += x[n] * w * std::cos(2.0 * PI * k * n / 32);
+            im -= x[n] * w * std::sin(2.0 * PI * k * n / 32);
+        }
+        const double expected = re * re + im * im;
+        const double got = (double)bank.binPower((uint16_t)k);
+        assert(std::fabs(got - expected) <= 0.01 * expected + 2000.0);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_tone_lands_in_its_band() {
+    std::cout << "Test: Tones Land in Bass / Mid / Treble... ";
+
+    // Bands as configured: bass bins 1-4, mid 5-9, treble 10-16.
+    const double freqs[3] = {62.5, 218.75, 406.25};
+    for (int b = 0; b < 3; b++) {
+        Bank bank;
+        feedTone(bank, 300, freqs[b], 3);
+        const int bass = bank.bandLevel(1, 4);
+        const int mid = bank.bandLevel(5, 9);
+        const int treble = bank.bandLevel(10, 16);
+        const int levels[3] = {bass, mid, treble};
+        // Reads as the tone's amplitude, and the other bands stay far below.
+        assert(levels[b] >= 270 && levels[b] <= 330);
+        for (int o = 0; o < 3; o++) {
+            if (o != b) assert(levels[o] < levels[b] / 5);
+        }
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_level_independent_of_phase_and_bin_offset() {
+    std::cout << "Test: Band Level Independent of Phase / Bin Offset... ";
+
+    // A tone between bins (here 1/3 of the way) still reads close to its amplitude
+    // when the band covers its neighbours.
+    for (int p = 0; p < 8; p++) {
+        Bank bank;
+        feedTone(bank, 200, 72.9, 2, p * PI / 4);
+        const int level = bank.bandLevel(1, 5);
+        assert(level >= 170 && level <= 230);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_silence_and_dc() {
+    std::cout << "Test: Silence and DC Read as (Near) Zero... ";
+
+    Bank bank;
+    for (int n = 0; n < 64; n++) bank.push(0);
+    assert(bank.bandLevel(1, 16) == 0);
+
+    // A small DC residue only leaks into bin 1 (Hann window), and weakly.
+    for (int n = 0; n < 64; n++) bank.push(10);
+    assert(bank.bandLevel(2, 16) == 0);
+    assert(bank.bandLevel(1, 1) <= 10);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_full_scale_no_overflow() {
+    std::cout << "Test: Full-Scale Input Does Not Overflow... ";
+
+    GoertzelBank<1024, 1, 512> big;
+    for (unsigned n = 0; n < 1024; n++) big.push(tone(n, 32767, 250.0));
+    const int level = big.bandLevel(200, 312);
+    assert(level >= 32000 && level <= 33500);
+
+    std::cout << "PASS (" << level << ")" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  GOERTZEL BANK TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_block_cadence();
+    test_constexpr_tables();
+    test_matches_float_dft();
+    test_tone_lands_in_its_band();
+    test_level_independent_of_phase_and_bin_offset();
+    test_silence_and_dc();
+    test_full_scale_no_overflow();
+
+    std::cout << "\n✓ All Goertzel Bank tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include "motion_latency.h"
+#include "motor_plant.h"
+
+#include "main/config.h"
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+static const double LOUD = 420.0;  // peak counts; near AGC_TARGET_LEVEL
+static const double QUIET = 40.0;
+
+// Steady speed of the model at `pwm` (RPM): Kt (V - Ke w) / R = b w + Coulomb friction.
+static double steadyRpm(const DcMotorParams &p, int pwm) {
+    const double volts = p.supplyVolts * pwm / 255.0;
+    const double k = p.torqueConstant;
+    const double omega = (k * volts / p.resistanceOhms - p.coulombFriction) /
+                         (k * k / p.resistanceOhms + p.viscousFriction);
+    return omega * 60.0 / (2.0 * MOTOR_PLANT_PI);
+}
+
+// --- The motor model ---
+
+void test_plant_steady_state_and_time_constants() {
+    std::cout << "Test: Motor Model Steady State And Time Constants... ";
+
+    const DcMotorParams &p = NOMINAL_MOTOR;
+    const double dt = 20e-6;
+
+    // Full PWM from rest: the analytic steady state, and 63 % of it one mechanical
+    // time constant (J R / Kt^2, the electrical one is 100x shorter) in.
+    DcMotorPlant plant(p);
+    const double tauM = p.inertia * p.resistanceOhms / (p.torqueConstant * p.torqueConstant);
+    const double final = steadyRpm(p, 255);
+    double atTau = 0.0;
+    for (int n = 1; n <= (int)(1.0 / dt); n++) {
+        plant.step(dt, 255);
+        if (n == (int)(tauM / dt)) atTau = plant.rpm();
+    }
+    assert(std::fabs(plant.rpm() - final) < final * 0.005);
+    assert(final > 2400.0 && final < 2800.0);
+    assert(atTau > 0.58 * final && atTau < 0.68 * final);
+
+    // Locked rotor (no back-EMF): the current reaches 63 % of V / R after L / R.
+    DcMotorParams locked = p;
+    locked.staticFriction = 1.0;
+    DcMotorPlant stalled(locked);
+    const double tauE = p.inductanceHenries / p.resistanceOhms;
+    for (int n = 0; n < (int)std::lround(tauE / 1e-6); n++) stalled.step(1e-6, 255);
+    assert(std::fabs(stalled.current() - 0.632 * p.supplyVolts / p.resistanceOhms) < 0.01);
+    assert(stalled.rpm() == 0.0);
+
+    // Tach: SPEED_TACH_PULSES_PER_REV pulses per revolution.
+    int pulses = 0;
+    for (int n = 0; n < (int)(1.0 / dt); n++) pulses += plant.step(dt, 255);
+    assert(std::fabs(pulses - final / 60.0 * p.pulsesPerRev) <= 1.0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_plant_stalls_below_min_motor_speed() {
+    std::cout << "Test: Motor Model Stalls Below MIN_MOTOR_SPEED... ";
+
+    // From rest a PWM a little under the firmware's floor does not break static friction.
+    DcMotorPlant plant;
+    for (int n = 0; n < 50000; n++) plant.step(20e-6, MIN_MOTOR_SPEED - 8);
+    assert(plant.rpm() == 0.0);
+    // At the floor it starts.
+    for (int n = 0; n < 50000; n++) plant.step(20e-6, MIN_MOTOR_SPEED);
+    assert(plant.rpm() > 0.0);
+    // Once turning, it keeps going a little below the floor (Coulomb < static friction)...
+    for (int n = 0; n < 50000; n++) plant.step(20e-6, MIN_MOTOR_SPEED - 8);
+    assert(plant.rpm() > 0.0);
+    // ...and coasts to a stop with the output off, never backwards, the current never negative.
+    for (int n = 0; n < 100000; n++) {
+        plant.step(20e-6, 0);
+        assert(plant.rpm() >= 0.0 && plant.current() >= 0.0);
+    }
+    assert(plant.rpm() == 0.0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+static unsigned long tachEdges = 0;
+static void countTach() { tachEdges++; }
+
+void test_rig_follows_analog_write() {
+    std::cout << "Test: Motor Model Driven By analogWrite()... ";
+
+    virtualClockReset();
+    resetMockArduino();
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+    rig.attach();
+    tachEdges = 0;
+    attachInterrupt(digitalPinToInterrupt(TACH_PIN), countTach, RISING);
+
+    analogWrite(MOTOR_PIN, 200);
+    virtualClockAdvanceBy(1000000000ULL);
+    assert(std::fabs(rig.plant.rpm() - steadyRpm(NOMINAL_MOTOR, 200)) < steadyRpm(NOMINAL_MOTOR, 200) * 0.01);
+    assert(tachEdges == rig.pulses && tachEdges > 100);
+
+    analogWrite(MOTOR_PIN, 0);
+    virtualClockAdvanceBy(1000000000ULL);
+    assert(rig.plant.rpm() == 0.0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// --- Audio to motion on the whole firmware ---
+
+void test_default_latency() {
+    std::cout << "Test: Onset To 90% Speed With The Default Settings... ";
+
+    const LatencySettings settings = defaultLatencySettings();
+    const LatencyResult loud = measureMotionLatency(settings, LOUD);
+    // The firmware answers once the debounce is over; the kick starts the motor at once.
+    assert(loud.toPwmMs >= settings.enterDebounceMs && loud.toPwmMs <= settings.enterDebounceMs + 40.0);
+    assert(loud.toMotionMs >= loud.toPwmMs && loud.toMotionMs <= loud.toPwmMs + 5.0);
+    assert(loud.to90Ms > loud.toMotionMs && loud.to90Ms < 500.0);
+    assert(loud.settledPwm > MIN_MOTOR_SPEED && loud.settledRpm > 500.0);
+
+    // A quiet sound still moves the motor, above its stall floor.
+    const LatencyResult quiet = measureMotionLatency(settings, QUIET);
+    assert(quiet.to90Ms > 0.0 && quiet.settledPwm >= MIN_MOTOR_SPEED && quiet.settledRpm > 0.0);
+
+    // Virtual time: the same numbers every run.
+    const LatencyResult again = measureMotionLatency(settings, LOUD);
+    assert(again.toPwmMs == loud.toPwmMs && again.to90Ms == loud.to90Ms && again.settledRpm == loud.settledRpm);
+
+    std::cout << "PASS (PWM " << loud.toPwmMs << " ms, 90% speed " << loud.to90Ms << " ms)" << std::endl;
+}
+
+void test_latency_follows_the_settings() {
+    std::cout << "Test: Latency Across Debounce, Motion Profile And Threshold... ";
+
+    LatencySettings s = defaultLatencySettings();
+    s.motion = MOTOR_MOTION_SMOOTH;
+    s.enterDebounceMs = 0;
+    const LatencyResult smooth0 = measureMotionLatency(s, LOUD);
+    s.enterDebounceMs = 150;
+    const LatencyResult smooth150 = measureMotionLatency(s, LOUD);
+    // The debounce delays the start by its length, to a supervisor tick, and the 90 %
+    // point by at most that (the level has settled further by the time it starts).
+    assert(std::fabs(smooth150.toPwmMs - smooth0.toPwmMs - 150.0) <= MOTOR_UPDATE_INTERVAL);
+    assert(smooth150.to90Ms > smooth0.to90Ms && smooth150.to90Ms <= smooth0.to90Ms + 150.0 + MOTOR_UPDATE_INTERVAL);
+
+    // The snappy profile gets there sooner, to the same speed.
+    s.enterDebounceMs = 0;
+    s.motion = MOTOR_MOTION_SNAPPY;
+    const LatencyResult snappy0 = measureMotionLatency(s, LOUD);
+    assert(snappy0.to90Ms < smooth0.to90Ms);
+    assert(std::fabs(snappy0.settledRpm - smooth0.settledRpm) < smooth0.settledRpm * 0.02);
+
+    // An enter threshold above the sound's level: the sculpture never wakes.
+    s.enterThreshold = 400;
+    const LatencyResult deaf = measureMotionLatency(s, QUIET);
+    assert(deaf.toPwmMs < 0.0 && deaf.toMotionMs < 0.0 && deaf.to90Ms < 0.0 && deaf.settledRpm == 0.0);
+
+    // The sweep covers both profiles and every debounce with the defaults first.
+    const std::vector<LatencySettings> sweep = latencySweep();
+    assert(sweep.size() == 13 && sweep.front().name == "default");
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_envelope_rise_with_attack() {
+    std::cout << "Test: Envelope Rise Time Grows With The Attack Time... ";
+
+    const std::vector<EnvelopeRise> rises = envelopeRiseMs(LOUD);
+    assert(rises.size() == 5);
+    for (size_t i = 0; i < rises.size(); i++) {
+        assert(rises[i].to90Ms > 0.0);
+        // The averaging stage bounds it from below.
+        assert(rises[i].to90Ms >= ENVELOPE_AVERAGING_MS);
+        if (i > 0) assert(rises[i].to90Ms > rises[i - 1].to90Ms && rises[i].attackMs > rises[i - 1].attackMs);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  MOTION LATENCY TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_plant_steady_state_and_time_constants();
+    test_plant_stalls_below_min_motor_speed();
+    test_rig_follows_analog_write();
+    test_default_latency();
+    test_latency_follows_the_settings();
+    test_envelope_rise_with_attack();
+
+    std::cout << "\n✓ All Motion Latency tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "main/motion_profile.h"
+#include "main/config.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+// The firmware's "smooth" profile at its 10ms update: 8 PWM/tick, 1 PWM/tick^2,
+// 0.25 PWM/tick^3 (full acceleration after 4 ticks).
+static constexpr MotionProfileSpec SMOOTH = {"smooth", 800, 10000, 250000, 80, 200, 30};
+static constexpr MotionLimits M = makeMotionLimits(SMOOTH, 10);
+static_assert(M.maxVelocity == 8 * MOTION_ONE, "velocity per tick, Q8");
+static_assert(M.maxAccel == 1 * MOTION_ONE, "acceleration per tick^2, Q8");
+static_assert(M.maxJerk == MOTION_ONE / 4, "jerk per tick^3, Q8");
+static_assert(M.kickTicks == 3 && M.kickPwm == 200 && M.floorPwm == 80, "kick and floor");
+static_assert(motionProfileValid(SMOOTH, 10), "smooth profile valid");
+
+// Profiles that do not fit the fixed-point ranges are rejected.
+static constexpr MotionProfileSpec NO_JERK = {"bad", 800, 10000, 0, 0, 0, 0};
+static constexpr MotionProfileSpec TOO_FAST = {"bad", 30000, 10000, 250000, 0, 0, 0};
+static constexpr MotionProfileSpec SLOW_RAMP = {"bad", 800, 100000, 10000, 0, 0, 0};
+static constexpr MotionProfileSpec FAST_RAMP = {"bad", 800, 10000, 1000000, 0, 0, 0};
+static constexpr MotionProfileSpec LONG_KICK = {"bad", 800, 10000, 250000, 0, 255, 3000};
+static_assert(!motionProfileValid(NO_JERK, 10), "zero jerk rejected");
+static_assert(!motionProfileValid(TOO_FAST, 10), "velocity over 255 PWM/tick rejected");
+static_assert(!motionProfileValid(SLOW_RAMP, 10), "acceleration ramp over MOTION_MAX_RAMP_TICKS rejected");
+static_assert(!motionProfileValid(FAST_RAMP, 10), "acceleration ramp under MOTION_MIN_RAMP_TICKS rejected");
+static_assert(!motionProfileValid(LONG_KICK, 10), "kick over 255 ticks rejected");
+
+// The firmware's profiles, and valid ones at the edges of the ranges: 1 PWM/tick with
+// a 5-tick ramp, the longest ramp, the shortest ramp at full speed, and the steepest.
+static constexpr MotionProfileSpec SHIPPED[] = MOTOR_MOTION_PROFILES;
+static constexpr MotionProfileSpec EDGES[] = {
+    {"crawl", 100, 200, 4000, 0, 0, 0},
+    {"long_ramp", 8000, 50000, 100000, 0, 0, 0},
+    {"short_ramp", 25500, 640000, 16000000, 0, 0, 0},
+    {"steep", 25500, 1250000, 20000000, 0, 0, 0},
+    {"steepest", 25500, 2500000, 40000000, 0, 0, 0},
+};
+static_assert(motionProfilesValid(SHIPPED, MOTOR_UPDATE_INTERVAL), "shipped profiles valid");
+static_assert(motionProfilesValid(EDGES, 10), "edge profiles valid");
+
+struct Run {
+    int ticks;          // until settled on the target
+    int32_t overshoot;  // Q8, past the target in the direction of travel
+};
+
+// Drive from `from` to `to` (PWM), checking the limits every tick and that the motion
+// never heads away from the target.
+static Run drive(MotionState &s, int from, int to, const MotionLimits &m) {
+    s.pos = from * MOTION_ONE;
+    s.vel = 0;
+    s.acc = 0;
+    const int32_t target = to * MOTION_ONE;
+    const int dir = to > from ? 1 : -1;
+    Run run = {0, 0};
+    for (int tick = 1; tick <= 2000; tick++) {
+        const MotionState before = s;
+        motionStep(s, target, m);
+        assert(s.acc - before.acc <= m.maxJerk && before.acc - s.acc <= m.maxJerk);
+        assert(s.acc <= m.maxAccel && -s.acc <= m.maxAccel);
+        assert(s.vel <= m.maxVelocity && -s.vel <= m.maxVelocity);
+        assert(s.vel * dir >= 0);
+        const int32_t past = (s.pos - target) * dir;
+        if (past > run.overshoot) run.overshoot = past;
+        if (s.pos == target && s.vel == 0 && s.acc == 0) {
+            run.ticks = tick;
+            return run;
+        }
+    }
+    assert(false && "did not settle");
+    return run;
+}
+
+// Time-optimal jerk-limited rest-to-rest move (continuous), in ticks.
+static double optimalTicks(double distance, const MotionLimits &m) {
+    const double v = (double)m.maxVelocity / MOTION_ONE;
+    const double a = (double)m.maxAccel / MOTION_ONE;
+    const double j = (double)m.maxJerk / MOTION_ONE;
+    // Reaching v takes v/a + a/j and covers v * (v/a + a/j); cruise covers the rest.
+    const double accelTime = v / a + a / j;
+    if (distance >= v * accelTime) return accelTime + distance / v;
+    // Shorter moves peak below v: find the peak velocity whose speed-up and slow-down
+    // (t each, covering peak * t together) fit the distance.
+    double lo = 0.0, hi = v;
+    for (int i = 0; i < 60; i++) {
+        const double mid = (lo + hi) / 2;
+        const double t = (mid * j >= a * a) ? mid / a + a / j : 2 * std::sqrt(mid / j);
+        if (mid * t <= distance) lo = mid;
+        else hi = mid;
+    }
+    const double t = (lo * j >= a * a) ? lo / a + a / j : 2 * std::sqrt(lo / j);
+    return 2 * t;
+}
+
+void test_isqrt_and_stop_distance() {
+    std::cout << "Test: Fixed-Point sqrt and Stop Distance... ";
+
+    for (uint32_t x = 0; x < 200000; x += 7) {
+        const uint32_t r = motionIsqrt(x);
+        assert((uint64_t)r * r <= x && (uint64_t)(r + 1) * (r + 1) > x);
+    }
+    assert(motionIsqrt(0xFFFFFFFFu) == 65535);
+
+    // Braking from rest acceleration: never shorter than the exact distance, and close to it.
+    for (int32_t v = 0; v <= M.maxVelocity; v += 3) {
+        const double a = M.maxAccel, j = M.maxJerk;
+        const double exact = (v * j >= a * a) ? v * (v / a + a / j) / 2 : v * std::sqrt(v / j);
+        const int64_t d = motionBrakeDistance(M, v);
+        assert(d >= exact - 1e-6 && d <= exact * 1.01 + 2);
+        assert(motionStopDistance(M, v, 0) == d);
+    }
+    // A forward acceleration adds its ramp-out; braking already under way shortens it.
+    assert(motionStopDistance(M, 4 * MOTION_ONE, M.maxAccel) > motionBrakeDistance(M, 4 * MOTION_ONE));
+    assert(motionStopDistance(M, 4 * MOTION_ONE, -M.maxAccel) < motionBrakeDistance(M, 4 * MOTION_ONE));
+    assert(motionStopDistance(M, 0, -M.maxJerk) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+static const int MOVES[][2] = {{80, 255}, {255, 80}, {80, 81}, {100, 140}, {0, 255}, {255, 0},
+                               {200, 90}, {200, 80}, {120, 100}, {0, 1}, {0, 10}, {254, 255}};
+
+void test_moves_are_jerk_limited_and_near_optimal() {
+    std::cout << "Test: Moves Stay Within Limits and Near the Optimal Time... ";
+
+    static constexpr MotionLimitsSet<sizeof(SHIPPED) / sizeof(SHIPPED[0])> shipped =
+        makeMotionLimitsSet(SHIPPED, MOTOR_UPDATE_INTERVAL);
+    for (const MotionLimits &m : shipped.limits) {
+        for (const auto &move : MOVES) {
+            MotionState s = {};
+            const Run run = drive(s, move[0], move[1], m);
+            const double best = optimalTicks(std::abs(move[1] - move[0]), m);
+            // Within 1.5x (plus the final creep) of the continuous optimum, at most 1 PWM past the target.
+            assert(run.ticks <= best * 1.5 + 4);
+            assert(run.overshoot <= MOTION_ONE);
+        }
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_edge_profiles_stay_on_target() {
+    std::cout << "Test: Profiles at the Edges of the Valid Range Land Without Overshoot... ";
+
+    static constexpr MotionLimitsSet<sizeof(EDGES) / sizeof(EDGES[0])> edges = makeMotionLimitsSet(EDGES, 10);
+    for (const MotionLimits &m : edges.limits) {
+        for (const auto &move : MOVES) {
+            MotionState s = {};
+            const Run run = drive(s, move[0], move[1], m);
+            assert(run.ticks <= optimalTicks(std::abs(move[1] - move[0]), m) * 1.5 + 4);
+            assert(run.overshoot <= MOTION_ONE);
+        }
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_retarget_mid_move() {
+    std::cout << "Test: Reversing Mid-Move Stays Jerk-Limited and Settles... ";
+
+    MotionState s = {80 * MOTION_ONE, 0, 0};
+    for (int tick = 0; tick < 12; tick++) motionStep(s, 255 * MOTION_ONE, M);
+    assert(s.vel > 0);
+    // Now back down while still accelerating upwards.
+    MotionState before = s;
+    for (int tick = 0; tick < 200; tick++) {
+        motionStep(s, 100 * MOTION_ONE, M);
+        assert(s.acc - before.acc <= M.maxJerk && before.acc - s.acc <= M.maxJerk);
+        before = s;
+    }
+    assert(s.pos == 100 * MOTION_ONE && s.vel == 0 && s.acc == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_smooth_acceleration_profile() {
+    std::cout << "Test: Acceleration Ramps Instead of Stepping (S-Curve)... ";
+
+    MotionState s = {80 * MOTION_ONE, 0, 0};
+    // The first ticks of a long move: acceleration grows by exactly one jerk step each.
+    for (int tick = 1; tick <= 4; tick++) {
+        motionStep(s, 255 * MOTION_ONE, M);
+        assert(s.acc == tick * M.maxJerk);
+    }
+    // ...and eases back to zero as the velocity reaches its limit: cruise, no acceleration.
+    int tick = 0;
+    while (!(s.vel == M.maxVelocity && s.acc == 0) && tick < 20) {
+        motionStep(s, 255 * MOTION_ONE, M);
+        tick++;
+    }
+    assert(tick < 20);
+    for (tick = 0; tick < 4; tick++) {
+        motionStep(s, 255 * MOTION_ONE, M);
+        assert(s.vel == M.maxVelocity && s.acc == 0);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  MOTION PROFILE TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_isqrt_and_stop_distance();
+    test_moves_are_jerk_limited_and_near_optimal();
+    test_edge_profiles_stay_on_target();
+    test_retarget_mid_move();
+    test_smooth_acceleration_profile();
+
+    std::cout << "\n✓ All motion profile tests passed!\n" << std::endl;
+    return 0;
+}
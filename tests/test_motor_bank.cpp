@@ -0,0 +1,239 @@
+#include "main/motor_bank.h"
+#include "main/motor_controller.h"
+#include "main/config.h"
+
+#include <cassert>
+#include <iostream>
+
+// Five response curves with different ranges and shapes.
+static constexpr PwmCurveSpec SPECS[] = {
+    {"linear", PWM_CURVE_LINEAR, 0, 10, 200, 40, 255, 0, {}},
+    {"log", PWM_CURVE_LOG, 30, 12, 300, 50, 240, 0, {}},
+    {"gamma", PWM_CURVE_GAMMA, 200, 20, 400, 60, 200, 0, {}},
+    {"steps", PWM_CURVE_PIECEWISE, 0, 8, 512, 70, 255, 3, {{0, 0}, {500, 900}, {1000, 1000}}},
+    {"narrow", PWM_CURVE_LINEAR, 0, 100, 150, 0, 255, 0, {}},
+};
+static constexpr PwmCurveSet<5> CURVES = makePwmCurves(SPECS);
+
+// Three motion profiles at the firmware's 10ms update: kick + floor, floor only, neither.
+static constexpr MotionProfileSpec MOTION_SPECS[] = {
+    {"kick", 800, 10000, 250000, 60, 220, 30},
+    {"floor", 1200, 20000, 500000, 40, 0, 0},
+    {"free", 500, 5000, 100000, 0, 0, 0},
+};
+static_assert(motionProfilesValid(MOTION_SPECS, 10), "test motion profiles valid");
+static constexpr MotionLimitsSet<3> MOTIONS = makeMotionLimitsSet(MOTION_SPECS, 10);
+
+// 16 motors, the size of our larger installations: pins 20..35, four per source,
+// each with its own curve and motion profile.
+typedef MotorBank<16> Bank;
+static const int FIRST_PIN = 20;
+
+static MotorChannelConfig channelConfig(int ch) {
+    MotorChannelConfig c;
+    c.pin = (uint8_t)(FIRST_PIN + ch);
+    c.source = (uint8_t)(ch % MOTOR_SOURCE_COUNT);
+    c.curve = (uint8_t)(ch % 5);
+    c.motion = (uint8_t)(ch % 3);
+    return c;
+}
+
+static void configureBank(Bank &bank) {
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    for (int ch = 0; ch < 16; ch++) bank.configure((uint8_t)ch, channelConfig(ch));
+}
+
+static int expectedTarget(const MotorChannelConfig &c, int level) {
+    return CURVES.curves[c.curve](level);
+}
+
+void test_configuration_round_trip() {
+    std::cout << "Test: Motor Bank Per-Channel Configuration... ";
+
+    Bank bank(CURVES.curves, 5, MOTIONS.limits, 3);
+    configureBank(bank);
+    assert(Bank::channels() == 16);
+    for (int ch = 0; ch < 16; ch++) {
+        const MotorChannelConfig want = channelConfig(ch);
+        const MotorChannelConfig got = bank.config((uint8_t)ch);
+        assert(got.pin == want.pin && got.source == want.source);
+        assert(got.curve == want.curve && got.motion == want.motion);
+        assert(bank.pwm((uint8_t)ch) == 0);
+    }
+    // Out of range: ignored / zero; an unknown curve falls back to curve 0.
+    bank.configure(16, channelConfig(0));
+    assert(bank.pwm(16) == 0 && bank.target(16) == 0);
+    MotorChannelConfig unknown = channelConfig(3);
+    unknown.curve = 9;
+    unknown.motion = 3;
+    bank.configure(3, unknown);
+    assert(bank.config(3).curve == 0 && bank.config(3).motion == 0);
+    assert(bank.mapLevel(3, 150) == CURVES.curves[0](150));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_mapping_per_channel() {
+    std::cout << "Test: Motor Bank Maps Each Channel With Its Own Curve... ";
+
+    Bank bank(CURVES.curves, 5, MOTIONS.limits, 3);
+    configureBank(bank);
+    for (int ch = 0; ch < 16; ch++) {
+        const MotorChannelConfig c = channelConfig(ch);
+        for (int level = -5; level < 600; level++) {
+            assert(bank.mapLevel((uint8_t)ch, level) == expectedTarget(c, level));
+        }
+    }
+    // The linear curve is Arduino map() over its range.
+    for (int level = 11; level <= 200; level++) {
+        assert(bank.mapLevel(0, level) == (int)map(level, 10, 200, 40, 255));
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_update_moves_each_channel_within_limits() {
+    std::cout << "Test: Motor Bank Update Moves Every Channel Within Its Limits... ";
+
+    Bank bank(CURVES.curves, 5, MOTIONS.limits, 3);
+    configureBank(bank);
+    const int levels[MOTOR_SOURCE_COUNT] = {150, 300, 80, 5};
+    MotionState prev[16] = {};
+
+    for (int tick = 1; tick <= 300; tick++) {
+        bank.update(levels);
+        for (int ch = 0; ch < 16; ch++) {
+            const MotorChannelConfig c = channelConfig(ch);
+            const MotionLimits &m = MOTIONS.limits[c.motion];
+            const int target = expectedTarget(c, levels[c.source]);
+            const MotionState s = bank.motion((uint8_t)ch);
+            const int pwm = bank.pwm((uint8_t)ch);
+            assert(bank.target((uint8_t)ch) == target);
+            assert(getSimulatedPWMOutput(c.pin) == pwm);
+
+            if (target == 0) {
+                assert(pwm == 0 && s.pos == 0);
+                continue;
+            }
+            // Kick pulse first (the first update counts), never inside the stall band.
+            if (tick <= m.kickTicks) {
+                assert(pwm == m.kickPwm);
+                continue;
+            }
+            assert(pwm >= m.floorPwm);
+            assert(s.acc - prev[ch].acc <= m.maxJerk && prev[ch].acc - s.acc <= m.maxJerk);
+            assert(s.acc <= m.maxAccel && -s.acc <= m.maxAccel);
+            assert(s.vel <= m.maxVelocity && -s.vel <= m.maxVelocity);
+            prev[ch] = s;
+        }
+    }
+    // Everyone has arrived and is at rest.
+    for (int ch = 0; ch < 16; ch++) {
+        const int goal = expectedTarget(channelConfig(ch), levels[channelConfig(ch).source]);
+        const int floor = MOTIONS.limits[channelConfig(ch).motion].floorPwm;
+        assert(bank.pwm((uint8_t)ch) == (goal == 0 ? 0 : (goal > floor ? goal : floor)));
+        assert(bank.motion((uint8_t)ch).vel == 0);
+    }
+    assert(!bank.stopped());
+
+    // Quiet: every channel ramps down to its floor, then cuts out.
+    const int quiet[MOTOR_SOURCE_COUNT] = {0, 0, 0, 0};
+    int lastPwm[16];
+    for (int ch = 0; ch < 16; ch++) lastPwm[ch] = bank.pwm((uint8_t)ch);
+    for (int tick = 0; tick < 300; tick++) {
+        bank.update(quiet);
+        for (int ch = 0; ch < 16; ch++) {
+            const int pwm = bank.pwm((uint8_t)ch);
+            const int floor = MOTIONS.limits[channelConfig(ch).motion].floorPwm;
+            assert(pwm <= lastPwm[ch]);
+            assert(pwm == 0 || pwm >= floor);
+            lastPwm[ch] = pwm;
+        }
+    }
+    assert(bank.stopped());
+    for (int ch = 0; ch < 16; ch++) assert(getSimulatedPWMOutput(FIRST_PIN + ch) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_pins_written_only_on_change() {
+    std::cout << "Test: Motor Bank Writes Only Channels Whose PWM Changed... ";
+
+    Bank bank(CURVES.curves, 5, MOTIONS.limits, 3);
+    configureBank(bank);
+    // Only the bass channels (source 1) have anything to do.
+    const int levels[MOTOR_SOURCE_COUNT] = {0, 400, 0, 0};
+    for (int tick = 0; tick < 300; tick++) bank.update(levels);
+    unsigned long settled[16];
+    for (int ch = 0; ch < 16; ch++) {
+        settled[ch] = getSimulatedPWMWriteCount(FIRST_PIN + ch);
+        if (channelConfig(ch).source != MOTOR_SOURCE_BASS) {
+            assert(settled[ch] == 0);
+        } else {
+            assert(settled[ch] > 0);
+            assert(bank.pwm((uint8_t)ch) == bank.target((uint8_t)ch));
+        }
+    }
+    // At the target nothing is rewritten.
+    for (int tick = 0; tick < 100; tick++) bank.update(levels);
+    for (int ch = 0; ch < 16; ch++) assert(getSimulatedPWMWriteCount(FIRST_PIN + ch) == settled[ch]);
+
+    bank.stopAll();
+    for (int ch = 0; ch < 16; ch++) assert(getSimulatedPWMOutput(FIRST_PIN + ch) == 0);
+    assert(bank.stopped());
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_default_channel() {
+    std::cout << "Test: Default Channel 0: Linear Curve, Smooth Profile... ";
+
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    initMotorController();
+    const MotorChannelConfig c = getMotorChannelConfig(0);
+    assert(c.pin == MOTOR_PIN && c.source == MOTOR_SOURCE_AMPLITUDE);
+    assert(c.curve == MOTOR_CURVE_LINEAR && c.motion == MOTOR_MOTION_SMOOTH);
+    for (int amp = -5; amp < 600; amp++) {
+        const int expected = amp <= ACTIVE_EXIT_THRESHOLD
+            ? 0 : (int)map(amp > 512 ? 512 : amp, ACTIVE_EXIT_THRESHOLD, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
+        assert(clampAndMapAmplitudeToTargetPwm(amp) == expected);
+    }
+
+    // A loud onset: kick, then a jerk-limited climb to the target, which is held.
+    const MotionLimits *m = getMotorMotionLimits(MOTOR_MOTION_SMOOTH);
+    assert(m != nullptr && getMotorMotionLimits(getMotorMotionCount()) == nullptr);
+    const int levels[MOTOR_SOURCE_COUNT] = {300, 0, 0, 0};
+    const int target = clampAndMapAmplitudeToTargetPwm(300);
+    for (int tick = 1; tick <= 100; tick++) {
+        updateMotorBank(levels);
+        assert(getMotorChannelTarget(0) == target);
+        if (tick <= m->kickTicks) assert(getMotorChannelPwm(0) == m->kickPwm);
+        else assert(getMotorChannelPwm(0) >= MIN_MOTOR_SPEED);
+        assert(getSimulatedPWMOutput(MOTOR_PIN) == getMotorChannelPwm(0));
+    }
+    assert(getMotorChannelPwm(0) == target);
+    assert(getMotorChannelMotion(0).vel == 0);
+    stopMotor();
+    assert(motorsStopped());
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+    assert(getMotorChannelPwm(MOTOR_CHANNELS) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  MOTOR BANK TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_configuration_round_trip();
+    test_mapping_per_channel();
+    test_update_moves_each_channel_within_limits();
+    test_pins_written_only_on_change();
+    test_default_channel();
+
+    std::cout << "\n✓ All Motor Bank tests passed!\n" << std::endl;
+    return 0;
+}
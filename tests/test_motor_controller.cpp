@@ -1,141 +1,111 @@
+// Tests the shipped motor controller (main/motor_controller.cpp, linked from the
+// firmware library) through its public API and the simulated PWM pins.
 #include "mock_arduino.h"
 
-// Define config constants locally
-#define MOTOR_PIN 2
-#define MIN_MOTOR_SPEED 80
-#define MAX_MOTOR_SPEED 255
-#define DEBUG_INTERVAL 100
-
-// Copy motor controller implementation inline
-static unsigned long lastDebugTime = 0;
-
-void initMotorController() {
-  pinMode(MOTOR_PIN, OUTPUT);
-  analogWrite(MOTOR_PIN, 0);
-}
-
-void updateMotorSpeed(int amplitude) {
-  int motorSpeed = map(amplitude, 0, 512, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
-  motorSpeed = constrain(motorSpeed, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
-  analogWrite(MOTOR_PIN, motorSpeed);
-  
-  unsigned long currentTime = millis();
-  if (currentTime - lastDebugTime >= DEBUG_INTERVAL) {
-    Serial.print("Amplitude: ");
-    Serial.print(amplitude);
-    Serial.print(" | Motor Speed: ");
-    Serial.println(motorSpeed);
-    lastDebugTime = currentTime;
-  }
-}
-
-void stopMotor() {
-  analogWrite(MOTOR_PIN, 0);
-}
-
-void setMotorSpeed(int speed) {
-  speed = constrain(speed, 0, 255);
-  analogWrite(MOTOR_PIN, speed);
-}
+#include "main/config.h"
+#include "main/motor_controller.h"
 
 #include <cassert>
 #include <iostream>
 
 void test_motor_controller_initialization() {
     std::cout << "Test: Motor Controller Initialization... ";
-    
+
+    resetMockArduino();
     initMotorController();
-    
-    // Check that motor stops on init
-    int pwm = getSimulatedPWMOutput(MOTOR_PIN);
-    assert(pwm == 0);
-    
+
+    // Every configured channel is stopped, pin 0 included.
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+    assert(motorsStopped());
+    for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+        assert(getMotorChannelPwm(ch) == 0 && getMotorChannelTarget(ch) == 0);
+    }
+    assert(getMotorChannelPwm(MOTOR_CHANNELS) == 0);  // out of range reads as stopped
+
     std::cout << "PASS" << std::endl;
 }
 
 void test_motor_speed_mapping() {
     std::cout << "Test: Motor Speed Mapping... ";
-    
+
     initMotorController();
-    
-    // Test minimum amplitude
+
+    // The whole 0..512 range onto [MIN_MOTOR_SPEED..MAX_MOTOR_SPEED], never below the minimum.
     updateMotorSpeed(0);
-    delay(10);
-    int pwm = getSimulatedPWMOutput(MOTOR_PIN);
-    assert(pwm >= MIN_MOTOR_SPEED && pwm <= MAX_MOTOR_SPEED);
-    
-    // Test medium amplitude
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == MIN_MOTOR_SPEED);
     updateMotorSpeed(256);
-    delay(10);
-    pwm = getSimulatedPWMOutput(MOTOR_PIN);
-    assert(pwm >= MIN_MOTOR_SPEED && pwm <= MAX_MOTOR_SPEED);
-    
-    // Test maximum amplitude
+    const int mid = getSimulatedPWMOutput(MOTOR_PIN);
+    assert(mid > MIN_MOTOR_SPEED + 80 && mid < MAX_MOTOR_SPEED - 80);
     updateMotorSpeed(512);
-    delay(10);
-    pwm = getSimulatedPWMOutput(MOTOR_PIN);
-    assert(pwm >= MIN_MOTOR_SPEED && pwm <= MAX_MOTOR_SPEED);
-    
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == MAX_MOTOR_SPEED);
+    updateMotorSpeed(2000);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == MAX_MOTOR_SPEED);
+
     std::cout << "PASS" << std::endl;
 }
 
 void test_motor_speed_constraints() {
     std::cout << "Test: Motor Speed Constraints... ";
-    
+
     initMotorController();
-    
-    // Test that speed is constrained within valid PWM range
+
     setMotorSpeed(0);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
-    
     setMotorSpeed(128);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 128);
-    
+    assert(getMotorChannelPwm(0) == 128);
     setMotorSpeed(255);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 255);
-    
-    // Test out-of-range values
+
+    // Out-of-range values are clamped to the PWM range.
     setMotorSpeed(-50);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
-    
     setMotorSpeed(300);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 255);
-    
+
     std::cout << "PASS" << std::endl;
 }
 
 void test_motor_stop() {
     std::cout << "Test: Motor Stop... ";
-    
+
     initMotorController();
-    
-    // Set motor to some speed
+
     setMotorSpeed(200);
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 200);
-    
-    // Stop motor
+    assert(!motorsStopped());
+
     stopMotor();
     assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
-    
+    assert(motorsStopped());
+
     std::cout << "PASS" << std::endl;
 }
 
 void test_amplitude_response() {
-    std::cout << "Test: Amplitude Response... ";
-    
+    std::cout << "Test: ACTIVE Amplitude -> Target PWM... ";
+
+    // At or below ACTIVE_EXIT_THRESHOLD: no drive; above it the linear profile, rising.
+    assert(clampAndMapAmplitudeToTargetPwm(0) == 0);
+    assert(clampAndMapAmplitudeToTargetPwm(ACTIVE_EXIT_THRESHOLD) == 0);
+    assert(clampAndMapAmplitudeToTargetPwm(ACTIVE_EXIT_THRESHOLD + 1) >= MIN_MOTOR_SPEED);
+    assert(clampAndMapAmplitudeToTargetPwm(512) == MAX_MOTOR_SPEED);
+    int previous = 0;
+    for (int a = ACTIVE_EXIT_THRESHOLD + 1; a <= 512; a++) {
+        const int pwm = clampAndMapAmplitudeToTargetPwm(a);
+        assert(pwm >= previous && pwm <= MAX_MOTOR_SPEED);
+        previous = pwm;
+    }
+
+    // The bank drives channel 0 towards its mapped target over a few updates.
     initMotorController();
-    
-    // Test that higher amplitude gives higher speed
-    updateMotorSpeed(100);
-    delay(10);
-    int speed1 = getSimulatedPWMOutput(MOTOR_PIN);
-    
-    updateMotorSpeed(300);
-    delay(10);
-    int speed2 = getSimulatedPWMOutput(MOTOR_PIN);
-    
-    assert(speed2 > speed1);
-    
+    int levels[MOTOR_SOURCE_COUNT] = {};
+    levels[MOTOR_SOURCE_AMPLITUDE] = 300;
+    for (int tick = 0; tick < 200; tick++) updateMotorBank(levels);
+    assert(getMotorChannelTarget(0) > MIN_MOTOR_SPEED);
+    assert(getMotorChannelPwm(0) == getMotorChannelTarget(0));
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == getMotorChannelPwm(0));
+
     std::cout << "PASS" << std::endl;
 }
 
@@ -143,19 +113,13 @@ int main() {
     std::cout << "\n========================================" << std::endl;
     std::cout << "  MOTOR CONTROLLER TESTS" << std::endl;
     std::cout << "========================================\n" << std::endl;
-    
-    try {
-        test_motor_controller_initialization();
-        test_motor_speed_mapping();
-        test_motor_speed_constraints();
-        test_motor_stop();
-        test_amplitude_response();
-        
-        std::cout << "\n✓ All Motor Controller tests passed!\n" << std::endl;
-        return 0;
-    } catch (const std::exception& e) {
-        std::cout << "\n✗ Test failed with exception: " << e.what() << std::endl;
-        return 1;
-    }
-}
 
+    test_motor_controller_initialization();
+    test_motor_speed_mapping();
+    test_motor_speed_constraints();
+    test_motor_stop();
+    test_amplitude_response();
+
+    std::cout << "\n✓ All Motor Controller tests passed!\n" << std::endl;
+    return 0;
+}
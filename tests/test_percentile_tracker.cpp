@@ -0,0 +1,136 @@
+#include "main/percentile_tracker.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Fraction of `levels` (counts) strictly below the tracker's value.
+static double fractionBelow(const std::vector<uint32_t> &levels, const PercentileTracker &tracker) {
+    size_t below = 0;
+    for (uint32_t level : levels) {
+        if ((level << 8) < tracker.valueQ8()) below++;
+    }
+    return (double)below / levels.size();
+}
+
+void test_tracks_a_steady_level_exactly() {
+    std::cout << "Test: A steady level is reached exactly, from above and below... ";
+
+    PercentileTracker tracker;
+    tracker.reset(0, 0);
+    int pushes = 0;
+    while (tracker.valueQ8() != (1000u << 8)) {
+        tracker.push(1000u << 8, 7, 5);
+        assert(tracker.valueQ8() <= (1000u << 8));  // never overshoots
+        assert(++pushes < 5000);
+    }
+    for (int i = 0; i < 100; i++) tracker.push(1000u << 8, 7, 5);
+    assert(tracker.value() == 1000);
+
+    while (tracker.valueQ8() != (3u << 8)) {
+        tracker.push(3u << 8, 7, 5);
+        assert(tracker.valueQ8() >= (3u << 8));
+        assert(++pushes < 10000);
+    }
+    assert(tracker.value() == 3);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_settles_on_the_expected_percentile() {
+    std::cout << "Test: Settles on 2^-rise / (2^-rise + 2^-fall) of the inputs... ";
+
+    struct Case { uint8_t rise, fall; double percentile; };
+    const Case cases[] = {
+        {7, 5, 0.2},          // the noise floor
+        {8, 4, 1.0 / 17.0},
+        {6, 9, 8.0 / 9.0},    // the AGC reference
+        {6, 6, 0.5},
+    };
+    for (const Case &c : cases) {
+        // Levels spread over two decades, like a room's envelope.
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<double> logLevel(std::log(10.0), std::log(1000.0));
+        std::vector<uint32_t> levels(200000);
+        for (uint32_t &level : levels) level = (uint32_t)lround(std::exp(logLevel(rng)));
+
+        PercentileTracker tracker;
+        tracker.reset(100u << 8, 1u << 8);
+        double sum = 0.0;
+        int samples = 0;
+        for (size_t i = 0; i < levels.size(); i++) {
+            tracker.push(levels[i] << 8, c.rise, c.fall);
+            if (i >= levels.size() / 2 && i % 1000 == 0) {
+                sum += fractionBelow(levels, tracker);
+                samples++;
+            }
+        }
+        const double measured = sum / samples;
+        assert(std::fabs(measured - c.percentile) < 0.04);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_relative_steps() {
+    std::cout << "Test: Steps are relative: as fast at 20 counts as at 2000... ";
+
+    // Pushes to rise by a factor of e from `start` towards a much higher input.
+    auto pushesToRise = [](uint32_t start) {
+        PercentileTracker tracker;
+        tracker.reset(start << 8, 0);
+        const double goal = std::exp(1.0) * (start << 8);
+        int pushes = 0;
+        while (tracker.valueQ8() < goal) {
+            tracker.push(1u << 23, 7, 5);
+            pushes++;
+        }
+        return pushes;
+    };
+    const int low = pushesToRise(20), high = pushesToRise(2000);
+    assert(std::abs(high - 128) <= 2);  // 2^7 pushes per e-fold
+    assert(low <= high && high - low <= 5);  // the +1 only speeds up tiny values
+
+    std::cout << "PASS (" << low << " / " << high << " pushes)" << std::endl;
+}
+
+void test_minimum_and_maximum() {
+    std::cout << "Test: Clamped to the minimum and below 2^24... ";
+
+    PercentileTracker tracker;
+    tracker.reset(0, 5u << 8);
+    assert(tracker.value() == 5);
+    for (int i = 0; i < 1000; i++) tracker.push(0, 7, 5);
+    assert(tracker.valueQ8() == (5u << 8));
+
+    tracker.reset(1u << 23, 0);
+    for (int i = 0; i < 10000; i++) tracker.push(UINT32_MAX, 0, 0);
+    assert(tracker.valueQ8() == (1u << 24));
+    for (int i = 0; i < 10000; i++) tracker.push(0, 0, 0);
+    assert(tracker.valueQ8() == 0);
+
+    // The shifts may change between calls (fast acquisition, then slow).
+    tracker.reset(0, 0);
+    for (int i = 0; i < 400; i++) tracker.push(50u << 8, 5, 5);
+    for (int i = 0; i < 400; i++) tracker.push(50u << 8, 7, 5);
+    assert(tracker.valueQ8() == (50u << 8));
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  PERCENTILE TRACKER TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_tracks_a_steady_level_exactly();
+    test_settles_on_the_expected_percentile();
+    test_relative_steps();
+    test_minimum_and_maximum();
+
+    std::cout << "\n✓ All Percentile Tracker tests passed!\n" << std::endl;
+    return 0;
+}
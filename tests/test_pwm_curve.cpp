@@ -0,0 +1,138 @@
+#include "main/pwm_curve.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// Shaped like the firmware's profiles: [8..512] onto [80..255].
+static constexpr PwmCurveSpec LINEAR = {"linear", PWM_CURVE_LINEAR, 0, 8, 512, 80, 255, 0, {}};
+static constexpr PwmCurveSpec LOG = {"log", PWM_CURVE_LOG, 20, 8, 512, 80, 255, 0, {}};
+static constexpr PwmCurveSpec GAMMA_LIFT = {"gamma", PWM_CURVE_GAMMA, 50, 8, 512, 80, 255, 0, {}};
+static constexpr PwmCurveSpec GAMMA_HOLD = {"gamma2", PWM_CURVE_GAMMA, 220, 8, 512, 80, 255, 0, {}};
+static constexpr PwmCurveSpec PIECEWISE = {"custom", PWM_CURVE_PIECEWISE, 0, 8, 512, 80, 255,
+                                           4, {{0, 0}, {150, 400}, {500, 800}, {1000, 1000}}};
+
+static constexpr PwmCurveSpec SPECS[] = {LINEAR, LOG, GAMMA_LIFT, GAMMA_HOLD, PIECEWISE};
+static constexpr PwmCurveSet<5> CURVES = makePwmCurves(SPECS);
+
+// The tables are compile-time constants.
+static_assert(pwmCurveSpecsValid(SPECS), "test specs valid");
+static_assert(CURVES.curves[0].pwm[8] == 0 && CURVES.curves[0].pwm[9] == 80, "linear starts at minPwm");
+static_assert(CURVES.curves[0].pwm[512] == 255, "linear ends at maxPwm");
+static_assert(CURVES.curves[1](1000) == 255 && CURVES.curves[1](-3) == 0, "lookups clamp the level");
+
+// Invalid specs are caught at compile time too.
+static constexpr PwmCurveSpec BAD_RANGE = {"bad", PWM_CURVE_LINEAR, 0, 300, 200, 80, 255, 0, {}};
+static constexpr PwmCurveSpec BAD_LEVEL = {"bad", PWM_CURVE_LINEAR, 0, 8, 600, 80, 255, 0, {}};
+static constexpr PwmCurveSpec BAD_PWM = {"bad", PWM_CURVE_LINEAR, 0, 8, 512, 200, 100, 0, {}};
+static constexpr PwmCurveSpec BAD_GAMMA = {"bad", PWM_CURVE_GAMMA, 0, 8, 512, 80, 255, 0, {}};
+static constexpr PwmCurveSpec BAD_POINTS = {"bad", PWM_CURVE_PIECEWISE, 0, 8, 512, 80, 255,
+                                            3, {{0, 0}, {600, 500}, {500, 1000}}};
+static constexpr PwmCurveSpec OPEN_END = {"bad", PWM_CURVE_PIECEWISE, 0, 8, 512, 80, 255,
+                                          2, {{0, 0}, {900, 1000}}};
+static_assert(!pwmCurveSpecValid(BAD_RANGE), "inputHigh <= inputLow rejected");
+static_assert(!pwmCurveSpecValid(BAD_LEVEL), "inputHigh past PWM_CURVE_MAX_LEVEL rejected");
+static_assert(!pwmCurveSpecValid(BAD_PWM), "maxPwm < minPwm rejected");
+static_assert(!pwmCurveSpecValid(BAD_GAMMA), "gamma 0 rejected");
+static_assert(!pwmCurveSpecValid(BAD_POINTS), "decreasing x rejected");
+static_assert(!pwmCurveSpecValid(OPEN_END), "piecewise must end at x = 1000");
+
+// Float reference: the shape at each level, rounded the same way.
+static int reference(const PwmCurveSpec &spec, int level, double (*shape)(double, double)) {
+    if (level <= spec.inputLow) return 0;
+    const int a = level > spec.inputHigh ? spec.inputHigh : level;
+    const double x = (double)(a - spec.inputLow) / (spec.inputHigh - spec.inputLow);
+    return spec.minPwm + (int)(shape(x, spec.param) * (spec.maxPwm - spec.minPwm) + 0.5);
+}
+
+static double logShape(double x, double k) { return std::log(1.0 + k * x) / std::log(1.0 + k); }
+static double gammaShape(double x, double g) { return std::pow(x, g / 100.0); }
+static double piecewiseShape(double x, double) {
+    // (0, 0) (150, 400) (500, 800) (1000, 1000), permille
+    if (x <= 0.15) return x / 0.15 * 0.4;
+    if (x <= 0.5) return 0.4 + (x - 0.15) / 0.35 * 0.4;
+    return 0.8 + (x - 0.5) / 0.5 * 0.2;
+}
+
+void test_constexpr_math() {
+    std::cout << "Test: constexpr ln / exp Match <cmath>... ";
+
+    for (double x = 1e-4; x < 2000.0; x *= 1.37) {
+        assert(std::fabs(constLn(x) - std::log(x)) < 1e-12 * (1.0 + std::fabs(std::log(x))));
+    }
+    for (double x = -20.0; x <= 20.0; x += 0.173) {
+        assert(std::fabs(constExp(x) - std::exp(x)) <= 1e-12 * std::exp(x));
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_linear_is_map() {
+    std::cout << "Test: Linear Curve Equals map() Over Its Range... ";
+
+    const PwmCurve &curve = CURVES.curves[0];
+    for (int level = -10; level <= 700; level++) {
+        int expected = 0;
+        if (level > 8) expected = 80 + ((level > 512 ? 512 : level) - 8) * 175 / 504;
+        assert(curve(level) == expected);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_log_and_gamma_shapes() {
+    std::cout << "Test: Log and Gamma Tables Follow Their Formulas... ";
+
+    for (int level = 0; level <= PWM_CURVE_MAX_LEVEL; level++) {
+        assert(std::abs(CURVES.curves[1](level) - reference(LOG, level, logShape)) <= 1);
+        assert(std::abs(CURVES.curves[2](level) - reference(GAMMA_LIFT, level, gammaShape)) <= 1);
+        assert(std::abs(CURVES.curves[3](level) - reference(GAMMA_HOLD, level, gammaShape)) <= 1);
+    }
+
+    // Every curve rises monotonically from minPwm to maxPwm.
+    for (int c = 0; c < 5; c++) {
+        assert(CURVES.curves[c](9) >= 80 && CURVES.curves[c](512) == 255);
+        for (int level = 10; level <= PWM_CURVE_MAX_LEVEL; level++) {
+            assert(CURVES.curves[c](level) >= CURVES.curves[c](level - 1));
+        }
+    }
+
+    // The perceptual curves move quiet passages more than the line does; gamma > 1 less.
+    const int quiet = 58;  // 10% of the input span
+    assert(CURVES.curves[1](quiet) > CURVES.curves[0](quiet) + 40);
+    assert(CURVES.curves[2](quiet) > CURVES.curves[0](quiet) + 20);
+    assert(CURVES.curves[3](quiet) < CURVES.curves[0](quiet));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_piecewise_points() {
+    std::cout << "Test: Piecewise Curve Passes Through Its Points... ";
+
+    const PwmCurve &curve = CURVES.curves[4];
+    for (int level = 0; level <= PWM_CURVE_MAX_LEVEL; level++) {
+        assert(std::abs(curve(level) - reference(PIECEWISE, level, piecewiseShape)) <= 1);
+    }
+    // On a breakpoint the table holds the point itself: x = 500 permille is level 260,
+    // y = 800 permille of the 175 PWM span.
+    assert(curve(260) == 80 + 140);
+    // Points at the ends: just above inputLow ~minPwm, inputHigh maxPwm.
+    assert(curve(9) <= 81 && curve(512) == 255);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  PWM CURVE TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_constexpr_math();
+    test_linear_is_map();
+    test_log_and_gamma_shapes();
+    test_piecewise_points();
+
+    std::cout << "\n✓ All PWM curve tests passed!\n" << std::endl;
+    return 0;
+}
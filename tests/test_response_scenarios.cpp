@@ -0,0 +1,221 @@
+#include "response_scenarios.h"
+#include "signal_generators.h"
+
+#include "main/config.h"
+#include "main/runtime_config.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const double FS = (double)SAMPLE_RATE;
+
+template <typename Signal>
+static std::vector<double> render(Signal signal, double seconds) {
+    std::vector<double> samples;
+    for (long n = 0; n < (long)(seconds * FS); n++) samples.push_back(signal((double)n / FS));
+    return samples;
+}
+
+static double rmsOf(const std::vector<double> &x) {
+    double sum = 0.0;
+    for (double v : x) sum += v * v;
+    return std::sqrt(sum / (double)x.size());
+}
+
+// Power at `hz` (Goertzel over the whole buffer, normalized by its length).
+static double powerAt(const std::vector<double> &x, double hz) {
+    const double coeff = 2.0 * std::cos(2.0 * SIGNAL_PI * hz / FS);
+    double s1 = 0.0, s2 = 0.0;
+    for (double v : x) {
+        const double s0 = v + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return (s1 * s1 + s2 * s2 - coeff * s1 * s2) / (double)x.size();
+}
+
+static const Scenario &findScenario(const std::vector<Scenario> &scenarios, const std::string &name) {
+    for (const Scenario &s : scenarios) {
+        if (s.name == name) return s;
+    }
+    assert(false && "no such scenario");
+    return scenarios.front();
+}
+
+void test_sweep_follows_its_frequency() {
+    std::cout << "Test: Sine sweep frequency... ";
+
+    const SineSweep sweep{40.0, 480.0, 20.0, 100.0, true};
+    // Zero crossings over 1 s at the start, middle and end against the nominal frequency.
+    const double at[] = {0.0, 9.5, 19.0};
+    for (double t0 : at) {
+        int crossings = 0;
+        double previous = sweep(t0);
+        for (int n = 1; n <= (int)FS; n++) {
+            const double v = sweep(t0 + n / FS);
+            if ((previous < 0.0) != (v < 0.0)) crossings++;
+            previous = v;
+        }
+        const double measured = crossings / 2.0;
+        const double nominal = sweep.frequency(t0 + 0.5);
+        assert(std::fabs(measured - nominal) < 0.1 * nominal + 1.0);
+    }
+    assert(std::fabs(sweep.frequency(10.0) - std::sqrt(40.0 * 480.0)) < 0.01);  // log: geometric middle
+    assert(sweep.frequency(25.0) == 480.0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_noise_level_and_spectrum() {
+    std::cout << "Test: White and pink noise level and spectrum... ";
+
+    const std::vector<double> white = render(WhiteNoise(10.0, 3), 60.0);
+    const std::vector<double> pink = render(PinkNoise(10.0, 3), 60.0);
+    assert(std::fabs(rmsOf(white) - 10.0) < 0.3);
+    assert(std::fabs(rmsOf(pink) - 10.0) < 1.0);
+
+    // Average 21 bins around each frequency; pink falls 10 dB per decade (a power
+    // ratio of 20 from 20 to 400 Hz), white is flat.
+    auto band = [](const std::vector<double> &x, double hz) {
+        double p = 0.0;
+        for (int k = -10; k <= 10; k++) p += powerAt(x, hz + k * 0.1);
+        return p / 21.0;
+    };
+    const double pinkRatio = band(pink, 20.0) / band(pink, 400.0);
+    const double whiteRatio = band(white, 20.0) / band(white, 400.0);
+    assert(pinkRatio > 10.0 && pinkRatio < 40.0);
+    assert(whiteRatio > 0.3 && whiteRatio < 3.0);
+
+    std::cout << "PASS (pink 20/400 Hz power ratio " << pinkRatio << ")" << std::endl;
+}
+
+void test_generators_are_deterministic() {
+    std::cout << "Test: Seeded generators repeat... ";
+
+    assert(render(PinkNoise(20.0, 7), 2.0) == render(PinkNoise(20.0, 7), 2.0));
+    assert(render(PinkNoise(20.0, 7), 2.0) != render(PinkNoise(20.0, 8), 2.0));
+    assert(render(MusicLike(120.0, 1.0, 9), 2.0) == render(MusicLike(120.0, 1.0, 9), 2.0));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_bursts_claps_and_hum() {
+    std::cout << "Test: Tone bursts, claps and hum... ";
+
+    const ToneBurst burst{{200.0, 100.0}, 500.0, 1000.0, 5.0};
+    assert(burst.gain(0.0) == 0.0);
+    assert(burst.gain(0.25) == 1.0);
+    assert(burst.gain(0.7) == 0.0);
+    assert(burst.gain(0.0025) > 0.0 && burst.gain(0.0025) < 1.0);  // ramping up
+
+    const ClapTrain claps(400.0, 200.0, 30.0, 5);
+    assert(claps.envelope(0.0) == 200.0);
+    assert(std::fabs(claps.envelope(0.030) - 200.0 / std::exp(1.0)) < 0.5);
+    assert(claps.envelope(0.400) == 200.0);
+
+    const Hum hum{50.0, 8.0};
+    double peak = 0.0;
+    for (const double v : render(hum, 1.0)) peak = std::fmax(peak, std::fabs(v));
+    assert(peak > 8.0 && peak < 8.0 * 1.75);
+    assert(std::fabs(hum(0.0213) - hum(0.0013)) < 1e-6);  // periodic at 50 Hz
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_loud_bursts_drive_the_sculpture() {
+    std::cout << "Test: Loud tone bursts wake, move and release the sculpture... ";
+
+    const std::vector<Scenario> scenarios = standardScenarios(true);
+    const Scenario &scenario = findScenario(scenarios, "tone_bursts_loud");
+    const ScenarioMetrics m = runScenario(scenario);
+
+    assert(m.windows == scenario.sound.size());
+    assert(m.onsetToMotion.count == m.windows && m.onsetToMotion.missed == 0);
+    // Attack, debounce and the start kick: well under a quarter second.
+    assert(m.onsetToMotion.meanMs > 0.0 && m.onsetToMotion.maxMs < 250.0);
+    // Back to IDLE after the idle timeout, plus the envelope release.
+    assert(m.timeToIdle.count == m.windows);
+    assert(m.timeToIdle.meanMs >= (double)runtimeConfig().idleTimeoutMs &&
+           m.timeToIdle.maxMs < runtimeConfig().idleTimeoutMs + 2000.0);
+    assert(m.falseActive == 0);
+    assert(m.chatter == 0);
+    assert(m.activeSeconds > 2.0 * m.windows);
+
+    // Virtual time and seeded signals: a second run gives the same numbers.
+    const ScenarioMetrics again = runScenario(scenario);
+    assert(again.onsetToMotion.meanMs == m.onsetToMotion.meanMs);
+    assert(again.timeToIdle.maxMs == m.timeToIdle.maxMs);
+    assert(again.pwmOvershootPct == m.pwmOvershootPct);
+
+    std::cout << "PASS (onset->motion " << m.onsetToMotion.meanMs << " ms, ->IDLE " << m.timeToIdle.meanMs
+              << " ms)" << std::endl;
+}
+
+void test_hum_never_wakes_the_sculpture() {
+    std::cout << "Test: Mains hum and hiss never wake the sculpture... ";
+
+    const std::vector<Scenario> scenarios = standardScenarios(true);
+    const ScenarioMetrics m = runScenario(findScenario(scenarios, "silence_with_hum"));
+
+    assert(m.windows == 0);
+    assert(m.falseActive == 0 && m.falseActivePerHour == 0.0);
+    assert(m.activeSeconds == 0.0);
+    assert(m.quietHours > 0.0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_report_is_json_with_config() {
+    std::cout << "Test: Report carries the config and every metric... ";
+
+    const std::vector<Scenario> scenarios = standardScenarios(true);
+    std::vector<ScenarioMetrics> results;
+    results.push_back(runScenario(findScenario(scenarios, "clap_trains")));
+    results.push_back(runScenario(findScenario(scenarios, "silence_with_hum")));
+    std::ostringstream out;
+    writeResponseReport(out, results);
+    const std::string json = out.str();
+
+    const char *keys[] = {"\"config\"", "\"sample_rate\"", "\"envelope_mode\"", "\"scenarios\"",
+                          "\"onset_to_motion\"", "\"time_to_idle\"", "\"pwm_overshoot_pct\"",
+                          "\"false_active_per_hour\"", "\"chatter\"", "\"clap_trains\"", "\"silence_with_hum\""};
+    for (const char *key : keys) assert(json.find(key) != std::string::npos);
+    for (size_t p = 0; p < getRuntimeConfigParamCount(); p++) {
+        assert(json.find(std::string("\"") + getRuntimeConfigParam(p).name) != std::string::npos);
+    }
+    // Nothing to time in the hum scenario: null, not 0.
+    assert(json.find("\"mean_ms\": null") != std::string::npos);
+
+    // Balanced braces and brackets, ending with the top-level object.
+    int depth = 0;
+    for (char c : json) {
+        if (c == '{' || c == '[') depth++;
+        if (c == '}' || c == ']') depth--;
+        assert(depth >= 0);
+    }
+    assert(depth == 0);
+    assert(json.front() == '{' && json.substr(json.size() - 2) == "}\n");
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  RESPONSE SCENARIO TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_sweep_follows_its_frequency();
+    test_noise_level_and_spectrum();
+    test_generators_are_deterministic();
+    test_bursts_claps_and_hum();
+    test_loud_bursts_drive_the_sculpture();
+    test_hum_never_wakes_the_sculpture();
+    test_report_is_json_with_config();
+
+    std::cout << "\n✓ All Response Scenario tests passed!\n" << std::endl;
+    return 0;
+}
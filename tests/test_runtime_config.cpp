@@ -0,0 +1,261 @@
+#include "main/runtime_config.h"
+#include "main/motor_controller.h"
+#include "main/config.h"
+#include "config_store_host.h"
+#include "mock_arduino.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static const char *const STORE_PATH = "test_runtime_config.bin";
+
+static void resetStore() {
+    std::remove(STORE_PATH);
+    configStoreHostSetPath(STORE_PATH);
+}
+
+// Type a console line and write out every reply it produces.
+static std::string console(const char *line) {
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    for (const char *c = line; *c; c++) assert(runtimeConfigConsoleFeed(*c));
+    while (runtimeConfigServiceReply()) {
+    }
+    assert(!runtimeConfigReplyPending());
+    mockSerialSetCapture(nullptr);
+    return wire;
+}
+
+void test_defaults_from_config_h() {
+    std::cout << "Test: Defaults Come From config.h, Nothing Stored Yet... ";
+
+    resetStore();
+    initRuntimeConfig();
+    const RuntimeConfig &c = runtimeConfig();
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_NOT_STORED);
+    assert(c.activeEnterThreshold == ACTIVE_ENTER_THRESHOLD && c.activeExitThreshold == ACTIVE_EXIT_THRESHOLD);
+    assert(c.activeEnterFloorPct == ACTIVE_ENTER_FLOOR_PCT && c.activeExitFloorPct == ACTIVE_EXIT_FLOOR_PCT);
+    assert(c.activeEnterDebounceMs == ACTIVE_ENTER_DEBOUNCE_MS && c.idleTimeoutMs == IDLE_TIMEOUT_MS);
+    assert(c.idleCalibrationWarmupMs == IDLE_CALIBRATION_WARMUP_MS);
+    assert(c.sampleStallTimeoutMs == SAMPLE_STALL_TIMEOUT_MS);
+    assert(c.sampleJitterFaultCount == SAMPLE_JITTER_FAULT_COUNT && c.sampleJitterWindowMs == SAMPLE_JITTER_WINDOW_MS);
+    const MotorChannelConfig rows[] = MOTOR_CHANNEL_CONFIG;
+    for (int ch = 0; ch < MOTOR_CHANNELS; ch++) {
+        assert(c.motorCurve[ch] == rows[ch].curve && c.motorMotion[ch] == rows[ch].motion);
+    }
+    assert(runtimeConfigCheck(c) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigGeneration() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_set_is_validated_and_staged() {
+    std::cout << "Test: Set Validates, Stages, and Applies Atomically... ";
+
+    resetStore();
+    initRuntimeConfig();
+    uint32_t v = 0;
+    assert(runtimeConfigGet("idle_timeout_ms", v) == RUNTIME_CONFIG_OK && v == IDLE_TIMEOUT_MS);
+    assert(runtimeConfigGet("no_such_knob", v) == RUNTIME_CONFIG_UNKNOWN_NAME);
+    assert(runtimeConfigGet("idle_timeout_ms.0", v) == RUNTIME_CONFIG_UNKNOWN_NAME);  // not per channel
+    assert(runtimeConfigGet("motor_curve.0", v) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigGet("motor_curve.x", v) == RUNTIME_CONFIG_UNKNOWN_NAME);
+    char pastLast[32];
+    std::snprintf(pastLast, sizeof(pastLast), "motor_curve.%d", MOTOR_CHANNELS);
+    assert(runtimeConfigGet(pastLast, v) == RUNTIME_CONFIG_UNKNOWN_NAME);
+
+    // Out of range, or in range but inconsistent with the rest: rejected, nothing staged.
+    assert(runtimeConfigSet("idle_timeout_ms", 5) == RUNTIME_CONFIG_OUT_OF_RANGE);
+    assert(runtimeConfigSet("active_exit_threshold", ACTIVE_ENTER_THRESHOLD) == RUNTIME_CONFIG_INCONSISTENT);
+    assert(runtimeConfigSet("active_exit_floor_pct", ACTIVE_ENTER_FLOOR_PCT) == RUNTIME_CONFIG_INCONSISTENT);
+    assert(runtimeConfigSet("active_enter_floor_pct", 99) == RUNTIME_CONFIG_OUT_OF_RANGE);
+    assert(runtimeConfigSet("motor_curve", getMotorCurveCount()) == RUNTIME_CONFIG_INCONSISTENT);
+    assert(runtimeConfigSet("motor_motion", getMotorMotionCount()) == RUNTIME_CONFIG_INCONSISTENT);
+    assert(!runtimeConfigApplyPending());
+
+    // Several edits are staged, then become active together.
+    assert(runtimeConfigSet("idle_timeout_ms", 3000) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigSet("active_enter_threshold", 40) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigSet("motor_motion.0", MOTOR_MOTION_SNAPPY) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS && runtimeConfig().activeEnterThreshold == ACTIVE_ENTER_THRESHOLD);
+    assert(runtimeConfigPending().idleTimeoutMs == 3000);
+    assert(runtimeConfigGet("idle_timeout_ms", v) == RUNTIME_CONFIG_OK && v == 3000);  // get reads what is staged
+
+    assert(runtimeConfigApplyPending());
+    assert(runtimeConfig().idleTimeoutMs == 3000 && runtimeConfig().activeEnterThreshold == 40);
+    assert(runtimeConfig().motorMotion[0] == MOTOR_MOTION_SNAPPY);
+    assert(runtimeConfigGeneration() == 1);
+    assert(!runtimeConfigApplyPending());
+
+    // Setting a value it already has is no change.
+    assert(runtimeConfigSet("idle_timeout_ms", 3000) == RUNTIME_CONFIG_OK);
+    assert(!runtimeConfigApplyPending() && runtimeConfigGeneration() == 1);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_record_encoding() {
+    std::cout << "Test: Stored Record: Round Trip, CRC, Version... ";
+
+    // CRC-32 check value (zlib / IEEE).
+    assert(runtimeConfigCrc32(reinterpret_cast<const uint8_t *>("123456789"), 9) == 0xCBF43926UL);
+
+    resetStore();
+    initRuntimeConfig();
+    RuntimeConfig edited = runtimeConfigDefaults();
+    edited.idleTimeoutMs = 123456;
+    edited.sampleJitterFaultCount = 0;
+    edited.motorCurve[MOTOR_CHANNELS - 1] = MOTOR_CURVE_LOG;
+
+    uint8_t record[RUNTIME_CONFIG_RECORD_SIZE];
+    runtimeConfigEncode(edited, record);
+    assert(record[0] == 'K' && record[1] == 'C' && record[2] == 'F' && record[3] == 'G');
+    RuntimeConfig decoded = runtimeConfigDefaults();
+    assert(runtimeConfigDecode(record, decoded) == RUNTIME_CONFIG_OK);
+    assert(std::memcmp(&decoded, &edited, sizeof(decoded)) == 0);
+
+    // Any flipped bit fails the CRC and leaves the output alone.
+    for (size_t i = 8; i < RUNTIME_CONFIG_RECORD_SIZE; i++) {
+        uint8_t bad[RUNTIME_CONFIG_RECORD_SIZE];
+        std::memcpy(bad, record, sizeof(bad));
+        bad[i] ^= 0x10;
+        RuntimeConfig out = runtimeConfigDefaults();
+        assert(runtimeConfigDecode(bad, out) == RUNTIME_CONFIG_BAD_CRC);
+        assert(out.idleTimeoutMs == IDLE_TIMEOUT_MS);
+    }
+    // Another version, or erased flash.
+    uint8_t other[RUNTIME_CONFIG_RECORD_SIZE];
+    std::memcpy(other, record, sizeof(other));
+    other[4] = RUNTIME_CONFIG_VERSION + 1;
+    assert(runtimeConfigDecode(other, decoded) == RUNTIME_CONFIG_BAD_RECORD);
+    std::memset(other, 0xFF, sizeof(other));
+    assert(runtimeConfigDecode(other, decoded) == RUNTIME_CONFIG_BAD_RECORD);
+
+    // A correctly sealed record with a value out of range is still refused.
+    RuntimeConfig wild = edited;
+    wild.idleTimeoutMs = 1;
+    runtimeConfigEncode(wild, other);
+    assert(runtimeConfigDecode(other, decoded) == RUNTIME_CONFIG_OUT_OF_RANGE);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_save_and_boot_from_store() {
+    std::cout << "Test: Save, Then Boot From the Store; Corrupt Store -> Defaults... ";
+
+    resetStore();
+    initRuntimeConfig();
+    assert(runtimeConfigSet("idle_timeout_ms", 4500) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigSet("active_enter_debounce_ms", 80) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigSave() == RUNTIME_CONFIG_OK);  // saves what is staged
+
+    initRuntimeConfig();  // power cycle
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_OK);
+    assert(runtimeConfig().idleTimeoutMs == 4500 && runtimeConfig().activeEnterDebounceMs == 80);
+    assert(runtimeConfigGeneration() == 0 && !runtimeConfigApplyPending());
+
+    // $defaults then $load: back to the stored values.
+    assert(runtimeConfigStage(runtimeConfigDefaults()) == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigApplyPending() && runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS);
+    assert(runtimeConfigLoad() == RUNTIME_CONFIG_OK);
+    assert(runtimeConfigApplyPending() && runtimeConfig().idleTimeoutMs == 4500);
+
+    // One byte of the stored record damaged: the defaults are used.
+    FILE *f = std::fopen(STORE_PATH, "r+b");
+    assert(f);
+    std::fseek(f, 10, SEEK_SET);
+    std::fputc(0x5A, f);
+    std::fclose(f);
+    initRuntimeConfig();
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_BAD_CRC);
+    assert(runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS);
+
+    // No storage at all: saving fails, nothing else does.
+    configStoreHostSetPath(nullptr);
+    initRuntimeConfig();
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_NOT_STORED);
+    assert(runtimeConfigSave() == RUNTIME_CONFIG_STORE_FAILED);
+
+    std::remove(STORE_PATH);
+    std::cout << "PASS" << std::endl;
+}
+
+void test_serial_console() {
+    std::cout << "Test: '$' Console: get / set / list / save, Errors... ";
+
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    resetStore();
+    initRuntimeConfig();
+
+    // Other characters are left to the supervisor's single-key commands.
+    assert(!runtimeConfigConsoleFeed('p'));
+    assert(!runtimeConfigConsoleFeed('\n'));
+
+    assert(console("$get idle_timeout_ms\n") == "cfg idle_timeout_ms=" + std::to_string(IDLE_TIMEOUT_MS) + "\n");
+    assert(console("$set idle_timeout_ms 2500\r") == "cfg idle_timeout_ms=2500 (pending)\n");
+    assert(runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS && runtimeConfigApplyPending());
+    assert(console("$set idle_timeout_ms 5\n") == "cfg error: out of range\n");
+    assert(console("$set idle_timeout_ms -1\n") == "cfg error: out of range\n");
+    assert(console("$set idle_timeout_ms 12ab\n") == "cfg error: out of range\n");
+    // Past 32 bits: refused, not truncated (4294967297 would otherwise be taken as 1).
+    assert(console("$set beat_accent_pct 4294967297\n") == "cfg error: out of range\n");
+    assert(console("$set idle_timeout_ms 18446744073709551616\n") == "cfg error: out of range\n");
+    assert(console("$set bogus 1\n") == "cfg error: unknown name\n");
+    assert(console("$frobnicate\n").find("cfg error: commands:") == 0);
+    assert(console("$\n").find("cfg error: commands:") == 0);
+    assert(console(("$get " + std::string(80, 'x') + "\n").c_str()) == "cfg error: line too long\n");
+
+    // $list: a header, then one line per element with its range.
+    const std::string list = console("$list\n");
+    assert(list.find("cfg v" + std::to_string(RUNTIME_CONFIG_VERSION) + " changed since boot") == 0);
+    assert(list.find("cfg idle_timeout_ms=2500 [100..3600000]\n") != std::string::npos);
+    assert(list.find("cfg motor_curve.0=") != std::string::npos);
+    size_t lines = 0;
+    for (char c : list) lines += (c == '\n');
+    size_t elements = 0;
+    for (size_t i = 0; i < getRuntimeConfigParamCount(); i++) elements += getRuntimeConfigParam(i).count;
+    assert(lines == 1 + elements);
+
+    assert(console("$save\n") == "cfg saved\n");
+    assert(console("$defaults\n") == "cfg defaults (pending)\n");
+    assert(runtimeConfigApplyPending() && runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS);
+    assert(console("$load\n") == "cfg loaded (pending)\n");
+    assert(runtimeConfigApplyPending() && runtimeConfig().idleTimeoutMs == 2500);
+
+    // A second command arriving while a reply is still being written waits its turn.
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    for (const char *c = "$get idle_timeout_ms\n$get active_enter_threshold\n"; *c; c++) {
+        if (runtimeConfigConsoleBusy()) break;
+        assert(runtimeConfigConsoleFeed(*c));
+    }
+    assert(runtimeConfigConsoleBusy() && runtimeConfigReplyPending());
+    while (runtimeConfigServiceReply()) {
+    }
+    mockSerialSetCapture(nullptr);
+    assert(!runtimeConfigConsoleBusy());
+    assert(wire == "cfg idle_timeout_ms=2500\ncfg active_enter_threshold=" + std::to_string(ACTIVE_ENTER_THRESHOLD) + "\n");
+
+    std::remove(STORE_PATH);
+    configStoreHostSetPath(nullptr);
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  RUNTIME CONFIG TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_defaults_from_config_h();
+    test_set_is_validated_and_staged();
+    test_record_encoding();
+    test_save_and_boot_from_store();
+    test_serial_console();
+
+    std::cout << "\n✓ All runtime config tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "main/config.h"
+#include "main/sample_ring.h"
+
+#include <cassert>
+#include <iostream>
+
+void test_ring_fifo_order() {
+    std::cout << "Test: Sample Ring FIFO Order... ";
+
+    sampleRingReset();
+    assert(sampleRingAvailable() == 0);
+
+    for (int i = 0; i < 10; i++) {
+        assert(sampleRingPush(100 + i));
+    }
+    assert(sampleRingAvailable() == 10);
+
+    for (int i = 0; i < 10; i++) {
+        int s = 0;
+        assert(sampleRingPop(&s));
+        assert(s == 100 + i);
+    }
+
+    int s = 0;
+    assert(!sampleRingPop(&s));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ring_batch_drain_sequence() {
+    std::cout << "Test: Sample Ring Batch Drain... ";
+
+    sampleRingReset();
+    const uint32_t startSeq = sampleRingHeadSequence();
+
+    // Interleave producer and consumer across the wrap point several times.
+    int expected = 0;
+    int next = 0;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < SAMPLE_RING_SIZE / 2 + 3; i++) {
+            assert(sampleRingPush(next++));
+        }
+
+        int batch[SAMPLE_RING_SIZE];
+        uint32_t firstSeq = 0;
+        const unsigned n = sampleRingDrain(batch, SAMPLE_RING_SIZE, &firstSeq);
+        assert(n == (unsigned)(SAMPLE_RING_SIZE / 2 + 3));
+        assert(firstSeq == startSeq + (uint32_t)expected);
+        for (unsigned i = 0; i < n; i++) {
+            assert(batch[i] == expected++);
+        }
+    }
+    assert(getSampleRingOverrunCount() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ring_overrun_and_high_water() {
+    std::cout << "Test: Sample Ring Overrun Accounting... ";
+
+    sampleRingReset();
+
+    for (int i = 0; i < SAMPLE_RING_SIZE; i++) {
+        assert(sampleRingPush(i));
+    }
+    // Full: new samples are dropped, queued samples are untouched.
+    assert(!sampleRingPush(-1));
+    assert(!sampleRingPush(-2));
+    assert(getSampleRingOverrunCount() == 2);
+    assert(getSampleRingHighWaterMark() == SAMPLE_RING_SIZE);
+
+    int s = 0;
+    assert(sampleRingPop(&s) && s == 0);
+    assert(sampleRingPush(SAMPLE_RING_SIZE));
+
+    // Every accepted sample comes out exactly once, in order.
+    for (int i = 1; i <= SAMPLE_RING_SIZE; i++) {
+        assert(sampleRingPop(&s));
+        assert(s == i);
+    }
+    assert(sampleRingAvailable() == 0);
+
+    // A reset only asks the producer to clear its counters: they read as 0 at once,
+    // and the next push starts them again from there.
+    for (int i = 0; i < 3; i++) sampleRingPush(i);
+    sampleRingReset();
+    assert(sampleRingAvailable() == 0);
+    assert(getSampleRingOverrunCount() == 0 && getSampleRingHighWaterMark() == 0);
+    assert(sampleRingPush(7));
+    assert(getSampleRingOverrunCount() == 0 && getSampleRingHighWaterMark() == 1);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ring_snapshot() {
+    std::cout << "Test: Sample Ring Snapshot... ";
+
+    sampleRingReset();
+    for (int i = 0; i < 40; i++) {
+        sampleRingPush(i);
+    }
+    // Consume everything; the snapshot still sees the most recent published samples.
+    int drain[SAMPLE_RING_SIZE];
+    sampleRingDrain(drain, SAMPLE_RING_SIZE, nullptr);
+
+    int snap[8];
+    uint32_t endSeq = 0;
+    assert(sampleRingSnapshot(snap, 8, &endSeq) == 8);
+    assert(endSeq == sampleRingHeadSequence());
+    for (int i = 0; i < 8; i++) {
+        assert(snap[i] == 32 + i);
+    }
+
+    // Snapshot never covers the whole ring (a slot may be mid-write).
+    int big[SAMPLE_RING_SIZE];
+    assert(sampleRingSnapshot(big, SAMPLE_RING_SIZE, nullptr) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ring_snapshot_across_sequence_wrap() {
+    std::cout << "Test: Sample Ring Snapshot Across the 32-bit Sequence Wrap... ";
+
+    // ~49.7 days at 1 kHz: the head is about to wrap.
+    sampleRingRestartAt(0xFFFFFFFFUL - 35);
+    int snap[8];
+    for (int i = 0; i < 3; i++) sampleRingPush(i);
+    assert(sampleRingSnapshot(snap, 8, nullptr) == 0);  // only 3 published
+
+    for (int i = 3; i < 40; i++) sampleRingPush(i);
+    assert(sampleRingHeadSequence() == 4);  // wrapped, now below the snapshot length
+    uint32_t endSeq = 0;
+    assert(sampleRingSnapshot(snap, 8, &endSeq) == 8);
+    assert(endSeq == 4);
+    for (int i = 0; i < 8; i++) assert(snap[i] == 32 + i);
+
+    int s = 0;
+    for (int i = 0; i < 40; i++) assert(sampleRingPop(&s) && s == i);
+    assert(!sampleRingPop(&s));
+
+    sampleRingRestartAt(0);
+    std::cout << "PASS" << std::endl;
+}
+
+void test_ring_block_push() {
+    std::cout << "Test: Sample Ring Block Push... ";
+
+    sampleRingReset();
+    uint16_t block[SAMPLE_BLOCK_SIZE];
+    int next = 0;
+    // Whole blocks in, sample-wise out, across the wrap point.
+    for (int round = 0; round < 3 * SAMPLE_RING_SIZE / SAMPLE_BLOCK_SIZE; round++) {
+        for (int i = 0; i < SAMPLE_BLOCK_SIZE; i++) block[i] = (uint16_t)(round * SAMPLE_BLOCK_SIZE + i);
+        assert(sampleRingPushBlock(block, SAMPLE_BLOCK_SIZE) == SAMPLE_BLOCK_SIZE);
+        int s = 0;
+        for (int i = 0; i < SAMPLE_BLOCK_SIZE; i++) {
+            assert(sampleRingPop(&s));
+            assert(s == next++);
+        }
+    }
+
+    // A block that does not fit is cut short; the rest counts as overruns.
+    sampleRingReset();
+    for (int i = 0; i < SAMPLE_RING_SIZE - 5; i++) sampleRingPush(i);
+    assert(sampleRingPushBlock(block, SAMPLE_BLOCK_SIZE) == 5);
+    assert(getSampleRingOverrunCount() == SAMPLE_BLOCK_SIZE - 5);
+    assert(getSampleRingHighWaterMark() == SAMPLE_RING_SIZE);
+    assert(sampleRingPushBlock(block, SAMPLE_BLOCK_SIZE) == 0);
+    assert(sampleRingAvailable() == SAMPLE_RING_SIZE);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  SAMPLE RING TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_ring_fifo_order();
+    test_ring_batch_drain_sequence();
+    test_ring_overrun_and_high_water();
+    test_ring_snapshot();
+    test_ring_snapshot_across_sequence_wrap();
+    test_ring_block_push();
+
+    std::cout << "\n✓ All Sample Ring tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "main/scheduler.h"
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static std::string order;
+static uint64_t workNanos = 0;  // virtual time each task run takes
+
+static void taskA() { order += 'A'; virtualClockAdvanceBy(workNanos); }
+static void taskS() { order += 'S'; virtualClockAdvanceBy(workNanos); }
+static void taskC() { order += 'C'; virtualClockAdvanceBy(workNanos); }
+
+static void resetAll() {
+    virtualClockReset();
+    resetMockArduino();
+    initScheduler();
+    order.clear();
+    workNanos = 0;
+}
+
+// The sketch's loop(): run what is due, then sleep until the next interrupt.
+static void runFor(uint64_t ms) {
+    const uint64_t target = virtualClockNowNanos() + ms * 1000000ULL;
+    mockSetSleepLimit(target);
+    while (virtualClockNowNanos() < target) {
+        schedulerRunReady();
+        schedulerSleep();
+    }
+    mockSetSleepLimit(UINT64_MAX);
+}
+
+// Sampling "interrupt" on the virtual clock.
+static void signalAudio(void *ctx) {
+    (void)ctx;
+    schedulerSignal(TASK_AUDIO);
+}
+
+void test_periodic_cadence() {
+    std::cout << "Test: Periodic Tasks Run Once per Period... ";
+
+    resetAll();
+    schedulerAddPeriodic(TASK_SUPERVISOR, "supervisor", taskS, 10);
+    schedulerAddPeriodic(TASK_STATUS, "status", taskC, 50);
+    assert(schedulerWorkPending());  // first release: now
+    runFor(1000);
+
+    assert(getTaskStats(TASK_SUPERVISOR).runs == 100);
+    assert(getTaskStats(TASK_STATUS).runs == 20);
+    assert(getTaskStats(TASK_SUPERVISOR).misses == 0 && getTaskStats(TASK_STATUS).misses == 0);
+    assert(getTaskStats(TASK_SUPERVISOR).worstResponseUs == 0);
+    assert(getTaskPeriodMs(TASK_SUPERVISOR) == 10 && getTaskPeriodMs(TASK_AUDIO) == 0);
+    assert(std::strcmp(getTaskName(TASK_STATUS), "status") == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_event_task_and_priority() {
+    std::cout << "Test: Event Task Runs on Signal, Before Lower Priorities... ";
+
+    resetAll();
+    schedulerAddEvent(TASK_AUDIO, "audio", taskA, 5);
+    schedulerAddPeriodic(TASK_SUPERVISOR, "supervisor", taskS, 10);
+    assert(getTaskStats(TASK_AUDIO).runs == 0);
+
+    // Nothing signaled: only the periodic task runs.
+    order.clear();
+    schedulerRunReady();
+    assert(order == "S");
+    assert(!schedulerWorkPending());
+
+    // Two signals before it runs merge into one run.
+    virtualClockAdvanceBy(10000000ULL);
+    schedulerSignal(TASK_AUDIO);
+    schedulerSignal(TASK_AUDIO);
+    order.clear();
+    schedulerRunReady();
+    assert(order == "AS");
+    assert(getTaskStats(TASK_AUDIO).runs == 1);
+
+    // Driven by a 1kHz interrupt, the task runs once per sample.
+    virtualClockAddPeriodic(1000000ULL, signalAudio, nullptr);
+    runFor(100);
+    assert(getTaskStats(TASK_AUDIO).runs == 100);  // (the signal at the very end is still pending)
+    assert(getTaskStats(TASK_AUDIO).misses == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sleep_waits_for_interrupt() {
+    std::cout << "Test: Sleep Advances to the Next Interrupt or 1ms Tick... ";
+
+    resetAll();
+    virtualClockAdvanceBy(200000ULL);  // 0.2ms
+    virtualClockAddPeriodic(300000ULL, signalAudio, nullptr);
+    schedulerAddEvent(TASK_AUDIO, "audio", taskA, 5);
+
+    schedulerSleep();  // next interrupt at 0.5ms
+    assert(virtualClockNowNanos() == 500000ULL);
+    assert(schedulerWorkPending());
+    schedulerSleep();  // work pending: no sleep
+    assert(virtualClockNowNanos() == 500000ULL);
+    schedulerRunReady();
+    schedulerSleep();  // 0.8ms interrupt
+    assert(virtualClockNowNanos() == 800000ULL);
+
+    // No interrupt source: the millis() tick still wakes the CPU every ms.
+    resetAll();
+    virtualClockAdvanceBy(200000ULL);
+    schedulerSleep();
+    assert(virtualClockNowNanos() == 1000000ULL);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_deadline_misses() {
+    std::cout << "Test: Late Completions and Skipped Releases Count as Misses... ";
+
+    resetAll();
+    schedulerAddEvent(TASK_AUDIO, "audio", taskA, 5);
+    schedulerAddPeriodic(TASK_SUPERVISOR, "supervisor", taskS, 10);
+    schedulerAddPeriodic(TASK_SERIAL, "serial", taskC, 5, 2);
+
+    // Each run takes 3ms. Serial (period 5ms, deadline 2ms) only starts at 6ms: its
+    // release at 0 was overtaken by the one at 5 (skipped), which then ends 4ms late.
+    workNanos = 3000000ULL;
+    schedulerSignal(TASK_AUDIO);
+    schedulerRunReady();  // A: 0-3ms, S: 3-6ms, C: 6-9ms
+    assert(order == "ASC");
+    assert(getTaskStats(TASK_AUDIO).misses == 0);
+    assert(getTaskStats(TASK_AUDIO).worstResponseUs == 3000);
+    assert(getTaskStats(TASK_SUPERVISOR).misses == 0);
+    assert(getTaskStats(TASK_SERIAL).misses == 2);
+    assert(getTaskStats(TASK_SERIAL).worstResponseUs == 4000);
+
+    // A stall until 26ms: serial runs once, for its latest release (25ms); the ones at
+    // 10, 15 and 20 are missed. Both tasks keep their phase.
+    workNanos = 0;
+    virtualClockAdvanceBy(17000000ULL);  // now 26ms
+    order.clear();
+    schedulerRunReady();
+    assert(order == "SC");
+    assert(getTaskStats(TASK_SERIAL).runs == 2);
+    assert(getTaskStats(TASK_SERIAL).misses == 2 + 3);
+    // Supervisor: releases at 10 and 20 -> 10 skipped, 20 ran at 26 (deadline 10, in time).
+    assert(getTaskStats(TASK_SUPERVISOR).misses == 1);
+    virtualClockAdvanceBy(3999000ULL);  // 29.999ms: not yet
+    order.clear();
+    schedulerRunReady();
+    assert(order.empty());
+    virtualClockAdvanceBy(1000ULL);
+    schedulerRunReady();
+    assert(order == "SC");
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_micros_wrap() {
+    std::cout << "Test: Scheduler Across the micros() Wrap... ";
+
+    // Start 20ms before micros() wraps at 2^32 us.
+    resetAll();
+    virtualClockReset((0x100000000ULL - 20000ULL) * 1000ULL);
+    schedulerAddPeriodic(TASK_SUPERVISOR, "supervisor", taskS, 10);
+    runFor(100);
+    assert(getTaskStats(TASK_SUPERVISOR).runs == 10);
+    assert(getTaskStats(TASK_SUPERVISOR).misses == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  SCHEDULER TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_periodic_cadence();
+    test_event_task_and_priority();
+    test_sleep_waits_for_interrupt();
+    test_deadline_misses();
+    test_micros_wrap();
+
+    std::cout << "\n✓ All Scheduler tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,800 @@
+#include "firmware_sim.h"
+#include "arduino_shim/FspTimer.h"
+
+#include "main/config.h"
+#include "main/system_supervisor.h"
+#include "main/timer_setup.h"
+#include "main/sample_ring.h"
+#include "main/audio_processor.h"
+#include "main/motor_controller.h"
+#include "main/telemetry.h"
+#include "main/loop_profiler.h"
+#include "main/sample_jitter.h"
+#include "main/scheduler.h"
+#include "main/runtime_config.h"
+#include "config_store_host.h"
+#include "telemetry_decoder.h"
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Defined in main/timer_setup.cpp
+extern FspTimer audioTimer;
+
+// Built twice: with the timer ISR backend (samples arrive one at a time) and with
+// the block backend (test_simulator_block: SAMPLE_BLOCK_SIZE at a time), and the block
+// backend oversampling (test_simulator_oversampled: SAMPLE_BLOCK_SIZE conversions make
+// SAMPLE_BLOCK_SIZE / ADC_OVERSAMPLING samples).
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA && ADC_OVERSAMPLING > 1
+static const unsigned long SAMPLES_PER_DELIVERY = SAMPLE_BLOCK_SIZE / ADC_OVERSAMPLING;
+static const char *const BACKEND_NAME = "OVERSAMPLED BLOCK SAMPLING";
+#elif SAMPLING_BACKEND == SAMPLING_BACKEND_BLOCK_DMA
+static const unsigned long SAMPLES_PER_DELIVERY = SAMPLE_BLOCK_SIZE;
+static const char *const BACKEND_NAME = "BLOCK SAMPLING";
+#else
+static const unsigned long SAMPLES_PER_DELIVERY = 1;
+static const char *const BACKEND_NAME = "TIMER ISR SAMPLING";
+#endif
+// Time between deliveries: extra latency the assertions below allow for.
+static const unsigned long DELIVERY_MS = SAMPLES_PER_DELIVERY * 1000UL / SAMPLE_RATE;
+
+static const double PI = 3.14159265358979323846;
+
+// Amplitude gain of the ADC path at `hz`: 1, or the decimator's sinc^ADC_CIC_ORDER droop.
+static double inputGain(double hz) {
+#if ADC_OVERSAMPLING > 1
+    const double g = std::sin(PI * hz / SAMPLE_RATE) / (ADC_OVERSAMPLING * std::sin(PI * hz / (SAMPLE_RATE * ADC_OVERSAMPLING)));
+    return std::pow(g, ADC_CIC_ORDER);
+#else
+    (void)hz;
+    return 1.0;
+#endif
+}
+
+// A real tone around DC_OFFSET, sampled at the ISR's time. ctx: a Tone, or null for
+// the default 200Hz, +/-150 counts.
+struct Tone {
+    double hz;
+    double amplitude;
+};
+
+static int toneSignal(void *ctx) {
+    static const Tone defaultTone = {200.0, 150.0};
+    const Tone *tone = ctx ? static_cast<const Tone *>(ctx) : &defaultTone;
+    const double t = (micros() % 1000000UL) / 1e6;
+    return DC_OFFSET + (int)lround(tone->amplitude * std::sin(2.0 * PI * tone->hz * t));
+}
+
+// Quiet room at DC_OFFSET.
+static int silenceSignal(void *ctx) {
+    (void)ctx;
+    return DC_OFFSET;
+}
+
+// Microphone bias drifting upwards by 1 count every 250ms, no sound at all.
+static int driftSignal(void *ctx) {
+    (void)ctx;
+    return DC_OFFSET + (int)(millis() / 250) % 64;
+}
+
+// A lobby: a steady 100Hz ventilation rumble (+/-40 counts, louder than a quiet room's
+// whole wake threshold), plus a Tone on top if ctx is one.
+static int lobbySignal(void *ctx) {
+    const double t = (micros() % 1000000UL) / 1e6;
+    double v = 40.0 * std::sin(2.0 * PI * 100.0 * t);
+    if (ctx) {
+        const Tone *tone = static_cast<const Tone *>(ctx);
+        v += tone->amplitude * std::sin(2.0 * PI * tone->hz * t);
+    }
+    return DC_OFFSET + (int)lround(v);
+}
+
+// A steady 200Hz tone with a kick drum (decaying 55Hz) every 500ms: 120 BPM, beats
+// at whole half-seconds of the simulated clock.
+static int kickSignal(void *ctx) {
+    (void)ctx;
+    const double t = (micros() % 1000000UL) / 1e6;
+    const double sinceBeat = std::fmod(t, 0.5);
+    const double kick = 200.0 * std::exp(-sinceBeat / 0.05) * std::sin(2.0 * PI * 55.0 * sinceBeat);
+    return DC_OFFSET + (int)lround(60.0 * std::sin(2.0 * PI * 200.0 * t) + kick);
+}
+
+// Run until the supervisor reaches `target` (or maxMs elapses); returns elapsed ms.
+static unsigned long runUntilState(SystemState target, unsigned long maxMs) {
+    const unsigned long start = millis();
+    while (getSystemState() != target && millis() - start < maxMs) {
+        simRunForMs(1);
+    }
+    return millis() - start;
+}
+
+// FNV-1a over (millis, state, PWM) after every loop() iteration.
+struct TraceHash {
+    uint64_t h;
+};
+
+static void hashTrace(void *ctx) {
+    TraceHash *t = static_cast<TraceHash *>(ctx);
+    const uint32_t words[3] = {
+        (uint32_t)millis(), (uint32_t)getSystemState(), (uint32_t)getSimulatedPWMOutput(MOTOR_PIN)};
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(words);
+    for (size_t i = 0; i < sizeof(words); i++) {
+        t->h = (t->h ^ p[i]) * 1099511628211ULL;
+    }
+}
+
+static uint64_t runScriptedScenario() {
+    TraceHash trace = {1469598103934665603ULL};
+    simBoot();
+    simSetTraceHook(hashTrace, &trace);
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(1000);
+    simSetMicSignal(toneSignal, nullptr);
+    simRunForMs(3000);
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(5000);
+    return trace.h;
+}
+
+void test_sim_boot_to_idle() {
+    std::cout << "Test: Simulator Boot -> IDLE... ";
+
+    simBoot();
+    const unsigned long count0 = getAudioSampleCount();
+    simRunForMs(5 * DELIVERY_MS);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(isAudioTimerOk());
+    assert(getAudioSampleCount() - count0 == 5 * SAMPLES_PER_DELIVERY);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sim_active_then_idle_timeout() {
+    std::cout << "Test: Simulator ACTIVE -> IDLE after IDLE_TIMEOUT_MS... ";
+
+    simBoot();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(IDLE_CALIBRATION_WARMUP_MS + 100);
+    assert(getSystemState() == SYSTEM_IDLE);
+
+    simSetMicSignal(toneSignal, nullptr);
+    runUntilState(SYSTEM_ACTIVE, 1000);
+    assert(getSystemState() == SYSTEM_ACTIVE);
+    simRunForMs(1000);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) > 0);
+    assert(getMotorChannelPwm(0) == getSimulatedPWMOutput(MOTOR_PIN));
+
+    // RMS envelope of the tone (150 / sqrt(2) = 106; the fast attack reads a few % high).
+    assert(getSmoothedAmplitude() >= lround(104 * inputGain(200.0)) && getSmoothedAmplitude() <= lround(112 * inputGain(200.0)));
+
+    // Silence: the envelope releases over a few ENVELOPE_RELEASE_MS (RMS: 106 -> the exit
+    // threshold's 5 counts in ln(21) x 2 of them), then IDLE_TIMEOUT_MS runs.
+    simSetMicSignal(silenceSignal, nullptr);
+    const unsigned long toIdle = runUntilState(SYSTEM_IDLE, IDLE_TIMEOUT_MS * 3);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(toIdle > IDLE_TIMEOUT_MS);
+    assert(toIdle < IDLE_TIMEOUT_MS + 7 * ENVELOPE_RELEASE_MS);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+
+    std::cout << "PASS (" << toIdle << " ms)" << std::endl;
+}
+
+void test_sim_envelope_attack_and_release() {
+    std::cout << "Test: Simulator Envelope Fast Attack / Steady Release... ";
+
+    simBoot();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(IDLE_CALIBRATION_WARMUP_MS + 100);
+
+    // Attack: most of the way up within the averaging plus a few attack time constants.
+    simSetMicSignal(toneSignal, nullptr);
+    simRunForMs(ENVELOPE_AVERAGING_MS + 4 * ENVELOPE_ATTACK_MS + DELIVERY_MS);
+    const int attacked = getSmoothedAmplitude();
+    assert(attacked > lround(90 * inputGain(200.0)));
+
+    // Release: one time constant later the mean square is down to ~1/e (RMS ~1/sqrt(e)).
+    simRunForMs(200);
+    const int held = getSmoothedAmplitude();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(ENVELOPE_RELEASE_MS);
+    const int released = getSmoothedAmplitude();
+    assert(released > held / 2 && released < held * 3 / 4);
+
+    std::cout << "PASS (" << attacked << " -> " << held << " -> " << released << ")" << std::endl;
+}
+
+void test_sim_bias_drift_does_not_wake_motor() {
+    std::cout << "Test: Simulator Slow Mic Bias Drift Stays IDLE... ";
+
+    simBoot();
+    simSetMicSignal(driftSignal, nullptr);
+    simRunForMs(15000);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(getSmoothedAmplitude() < ACTIVE_ENTER_THRESHOLD);
+    assert(getDcOffsetEstimate() > DC_OFFSET + 50);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sim_thresholds_follow_noise_floor() {
+    std::cout << "Test: Simulator Wake Threshold Follows the Room's Noise Floor... ";
+
+    // Powered up in a lobby, the rumble wakes it before the floor has been learned; the
+    // floor creeps up to it in ACTIVE, then it is IDLE and stays there.
+    simBoot();
+    simSetMicSignal(lobbySignal, nullptr);
+    simRunForMs(1000);
+    assert(getSystemState() == SYSTEM_ACTIVE);
+    assert(runUntilState(SYSTEM_IDLE, 60000) < 45000);
+    simRunForMs(5000);
+    const int rumble = getSmoothedAmplitude();
+    assert(rumble > ACTIVE_ENTER_THRESHOLD);
+    const int lobbyFloor = getNoiseFloor();
+    assert(std::abs(lobbyFloor - rumble) <= 2);
+    for (int s = 0; s < 60; s++) {
+        simRunForMs(1000);
+        assert(getSystemState() == SYSTEM_IDLE);
+    }
+
+    // A voice 12dB over the rumble (the enter threshold is 4x the floor) wakes it; the rumble alone puts it back to sleep.
+    // (As it reaches the envelope: oversampling's decimator takes 6dB off 440Hz.)
+    Tone voice = {440.0, 200.0 / inputGain(440.0)};
+    simSetMicSignal(lobbySignal, &voice);
+    assert(runUntilState(SYSTEM_ACTIVE, 500) < 200);
+    simRunForMs(3000);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) > 0);
+    simSetMicSignal(lobbySignal, nullptr);
+    assert(runUntilState(SYSTEM_IDLE, IDLE_TIMEOUT_MS * 3) < IDLE_TIMEOUT_MS * 2);
+
+    // In a silent hall a tone quieter than the lobby's rumble is enough.
+    simBoot();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(2000);
+    Tone whisper = {300.0, 18.0 / inputGain(300.0)};
+    simSetMicSignal(toneSignal, &whisper);
+    assert(runUntilState(SYSTEM_ACTIVE, 1000) < 500);
+    assert(getSmoothedAmplitude() < rumble);
+
+    std::cout << "PASS (rumble " << rumble << ", floor " << lobbyFloor << ")" << std::endl;
+}
+
+void test_sim_band_levels() {
+    std::cout << "Test: Simulator Band Levels Separate Bass / Mid / Treble... ";
+
+    // One tone per band (bin centres, so each reads close to its amplitude).
+    Tone tones[AUDIO_BAND_COUNT] = {{62.5, 120.0}, {218.75, 120.0}, {406.25, 120.0}};
+    for (int b = 0; b < AUDIO_BAND_COUNT; b++) {
+        simBoot();
+        simSetMicSignal(silenceSignal, nullptr);
+        simRunForMs(IDLE_CALIBRATION_WARMUP_MS);
+        const unsigned long blocks0 = getBandBlockCount();
+        simSetMicSignal(toneSignal, &tones[b]);
+        simRunForMs(4 * BAND_BLOCK_SIZE + DELIVERY_MS);
+        assert(getBandBlockCount() - blocks0 >= 3);
+
+        const int level = getBandLevel((AudioBand)b);
+        assert(level >= lround(100 * inputGain(tones[b].hz)) && level <= lround(140 * inputGain(tones[b].hz)));
+        for (int o = 0; o < AUDIO_BAND_COUNT; o++) {
+            if (o != b) assert(getBandLevel((AudioBand)o) < level / 4);
+        }
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+// Mean PWM per 20ms slot of the beat over `beats` beats (slot 0 starts on the beat).
+static void pwmByBeatSlot(unsigned beats, double slots[25]) {
+    for (int i = 0; i < 25; i++) slots[i] = 0.0;
+    for (unsigned n = 0; n < beats * 500; n++) {
+        simRunForMs(1);
+        slots[(millis() % 500) / 20] += getSimulatedPWMOutput(MOTOR_PIN) / (20.0 * beats);
+    }
+}
+
+void test_sim_beat_accent() {
+    std::cout << "Test: Simulator Beat Accent Lifts the Motor Just Before Each Beat... ";
+
+    double plain[25], accented[25];
+    for (int run = 0; run < 2; run++) {
+        simBoot();
+        simSetMicSignal(silenceSignal, nullptr);
+        simRunForMs(IDLE_CALIBRATION_WARMUP_MS + 100);
+        if (run == 0) assert(runtimeConfigSet("beat_accent_pct", 0) == RUNTIME_CONFIG_OK);
+        simSetMicSignal(kickSignal, nullptr);
+        simRunForMs(6000);
+        assert(getSystemState() == SYSTEM_ACTIVE);
+#if ENABLE_BEAT_TRACKER
+        assert(isBeatLocked());
+        assert(getBeatPeriodMs() >= 495 && getBeatPeriodMs() <= 505);
+#endif
+        pwmByBeatSlot(8, run == 0 ? plain : accented);
+    }
+
+    // The accent runs from BEAT_LEAD_MS before the beat for BEAT_ACCENT_MS; the motion
+    // profile stretches it over the next ~300ms. Later in the beat the drive is unchanged.
+    double lift = 0.0, elsewhere = 0.0;
+    for (int i = 0; i < 25; i++) {
+        const double diff = accented[i] - plain[i];
+        if (i * 20 < 360) {
+            lift = std::fmax(lift, diff);
+        } else if (i * 20 < 500 - BEAT_LEAD_MS) {
+            elsewhere = std::fmax(elsewhere, std::fabs(diff));
+        }
+    }
+    const double onBeat = accented[0] - plain[0];
+#if ENABLE_BEAT_TRACKER
+    assert(onBeat >= 4.0);
+    assert(lift >= 6.0);
+    assert(elsewhere < 2.0);
+#else
+    assert(onBeat == 0.0 && lift == 0.0 && elsewhere == 0.0);
+#endif
+
+    std::cout << "PASS (+" << onBeat << " PWM on the beat, +" << lift << " peak, " << elsewhere << " late in the beat)" << std::endl;
+}
+
+void test_sim_sample_stall_fault() {
+    std::cout << "Test: Simulator Sample Stall -> FAULT... ";
+
+    simBoot();
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    mockSerialSetTxBaud(9600);
+    simRunForMs(100);
+    assert(getSystemState() == SYSTEM_IDLE);
+
+    audioTimer.stop();
+    const unsigned long toFault = runUntilState(SYSTEM_FAULT, 1000);
+    assert(getSystemState() == SYSTEM_FAULT);
+    assert(isFaultLatched());
+    // (The last delivery before the stop may have been up to DELIVERY_MS earlier, and
+    // the supervisor task notices on its next MOTOR_UPDATE_INTERVAL tick.)
+    assert(toFault + DELIVERY_MS > SAMPLE_STALL_TIMEOUT_MS && toFault <= SAMPLE_STALL_TIMEOUT_MS + MOTOR_UPDATE_INTERVAL + 1);
+
+    // The reason goes out whole, between telemetry frames, not through the middle of one.
+    simRunForMs(200);
+    const std::string line = std::string("FAULT: ") + getLastFaultReason() + "\n";
+    assert(wire.find(line) != std::string::npos);
+#if ENABLE_BINARY_TELEMETRY
+    unsigned bad = 0;
+    const std::vector<Decoded> got = decodeStream(wire, &bad);
+    assert(bad == 0);
+    for (size_t i = 1; i < got.size(); i++) assert(got[i].sequence == (uint16_t)(got[i - 1].sequence + 1));
+#endif
+
+    // Restart sampling and recover over Serial.
+    audioTimer.start();
+    mockSerialInject("r");
+    simRunForMs(SERIAL_POLL_INTERVAL_MS + MOTOR_UPDATE_INTERVAL);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(!isFaultLatched());
+
+    std::cout << "PASS (" << toFault << " ms)" << std::endl;
+}
+
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_TIMER_ISR && SAMPLE_JITTER_FAULT_COUNT > 0
+// Sampling interrupt entry latency: `lateNanos` on every `every`-th interrupt,
+// plus a little deterministic noise on the others.
+struct IrqLatency {
+    unsigned every;
+    uint64_t lateNanos;
+    unsigned n;
+};
+
+static uint64_t irqLatency(void *ctx) {
+    IrqLatency *l = static_cast<IrqLatency *>(ctx);
+    l->n++;
+    if (l->every != 0 && l->n % l->every == 0) return l->lateNanos;
+    return (l->n * 7919u) % 20000u;  // 0-20us
+}
+
+void test_sim_sampling_jitter_fault() {
+    std::cout << "Test: Simulator Sampling Jitter -> FAULT... ";
+
+    simBoot();
+    simSetMicSignal(toneSignal, nullptr);
+    // Noise well under the limit, plus one interrupt held off 300us every 2s: no fault.
+    IrqLatency latency = {2000, 300000, 0};
+    fspTimerMockSetIrqLatency(audioTimer, irqLatency, &latency);
+    simRunForMs(5000);
+    assert(!isFaultLatched());
+    assert(getSystemState() == SYSTEM_ACTIVE);
+    assert(getSampleJitterOverLimitCount() == 4);
+    // (300us late, less the noise on the interrupt before it)
+    assert(getSampleJitterWorstMicros() >= 280 && getSampleJitterWorstMicros() <= 300);
+
+    // Starved every 50ms: 40 violations per second -> FAULT, motor off.
+    latency.every = 50;
+    const unsigned long toFault = runUntilState(SYSTEM_FAULT, SAMPLE_JITTER_WINDOW_MS * 2);
+    assert(getSystemState() == SYSTEM_FAULT);
+    assert(std::strcmp(getLastFaultReason(), "audio sampling jitter over limit") == 0);
+    assert(toFault <= SAMPLE_JITTER_WINDOW_MS);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+
+    // Once the interrupt is serviced on time again, 'r' recovers and it stays up.
+    fspTimerMockSetIrqLatency(audioTimer, nullptr, nullptr);
+    mockSerialInject("r");
+    simRunForMs(SAMPLE_JITTER_WINDOW_MS * 3);
+    assert(!isFaultLatched());
+    assert(getSystemState() == SYSTEM_ACTIVE);
+
+    std::cout << "PASS (" << toFault << " ms)" << std::endl;
+}
+#endif
+
+void test_sim_outputs_written_on_edges_only() {
+    std::cout << "Test: Simulator Motor Written Only in ACTIVE and on Leaving It... ";
+
+    simBoot();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(100);
+    assert(getSystemState() == SYSTEM_IDLE);
+
+    // IDLE ticks leave the PWM pin alone.
+    unsigned long writes = getSimulatedPWMWriteCount(MOTOR_PIN);
+    simRunForMs(2000);
+    assert(getSimulatedPWMWriteCount(MOTOR_PIN) == writes);
+
+    simSetMicSignal(toneSignal, nullptr);
+    runUntilState(SYSTEM_ACTIVE, 2000);
+    simRunForMs(10000);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) > 0);
+    // Once at its target (the AGC has settled) the PWM is not rewritten every tick, only
+    // when the slowly creeping noise floor moves the target by a whole PWM step.
+    writes = getSimulatedPWMWriteCount(MOTOR_PIN);
+    simRunForMs(1000);
+    assert(getSimulatedPWMWriteCount(MOTOR_PIN) - writes <= 2);
+    writes = getSimulatedPWMWriteCount(MOTOR_PIN);
+
+    // SHUTDOWN: one write to stop the motor, then nothing.
+    mockSerialInject("s");
+    simRunForMs(SERIAL_POLL_INTERVAL_MS + 1);
+    assert(getSystemState() == SYSTEM_SHUTDOWN);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+    assert(getSimulatedPWMWriteCount(MOTOR_PIN) == writes + 1);
+    simRunForMs(2000);
+    assert(getSimulatedPWMWriteCount(MOTOR_PIN) == writes + 1);
+
+    // Trace: ... IDLE -> ACTIVE -> SHUTDOWN, with its cause and time.
+    const size_t n = getSupervisorTraceSize();
+    assert(n >= 3);
+    const FsmTraceEntry &last = getSupervisorTraceEntry(n - 1);
+    assert(last.from == SYSTEM_ACTIVE && last.to == SYSTEM_SHUTDOWN);
+    assert(std::strcmp(last.cause, "shutdown command") == 0);
+    assert(millis() - last.timestampMs >= 2000);
+    assert(getSupervisorTraceEntry(n - 2).to == SYSTEM_ACTIVE);
+
+    // Wake to IDLE, then stall the timer: no writes while faulted either.
+    mockSerialInject("w");
+    simRunForMs(SERIAL_POLL_INTERVAL_MS + 1);
+    assert(getSystemState() == SYSTEM_IDLE);
+    audioTimer.stop();
+    runUntilState(SYSTEM_FAULT, 1000);
+    assert(getSystemState() == SYSTEM_FAULT);
+    simRunForMs(2000);
+    assert(getSimulatedPWMWriteCount(MOTOR_PIN) == writes + 1);
+    audioTimer.start();
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sim_timer_begin_failure() {
+    std::cout << "Test: Simulator Timer Failure -> FAULT... ";
+
+    fspTimerMockFailNextBegin();
+    simBoot();
+    simRunForMs(5);
+    assert(!isAudioTimerOk());
+    assert(getSystemState() == SYSTEM_FAULT);
+    assert(std::strcmp(getLastFaultReason(), "audio timer failed to start") == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sim_every_sample_processed_under_logging_load() {
+    std::cout << "Test: Simulator Logging Load (9600 baud) Loses No Samples... ";
+
+    // Firmware counters are "since power-on"; the simulator reboots within one process.
+    simBoot();
+    const unsigned long count0 = getAudioSampleCount();
+    const uint32_t seq0 = sampleRingHeadSequence();
+    mockSerialSetTxBaud(9600);
+    simSetMicSignal(toneSignal, nullptr);
+    simRunForMs(10000);
+
+    // Every sample the ISR took was accepted by the ring and drained by loop().
+    assert(getSampleRingOverrunCount() == 0);
+    // (A blocking print can carry loop() slightly past the 10s mark.)
+    assert(getAudioSampleCount() - count0 >= 10000 - SAMPLES_PER_DELIVERY);
+    assert(sampleRingHeadSequence() - seq0 == getAudioSampleCount() - count0);
+
+    std::cout << "PASS (ring hwm=" << getSampleRingHighWaterMark() << ")" << std::endl;
+}
+
+// Longest virtual-time gap between consecutive loop() iterations.
+struct LoopGap {
+    uint64_t lastNanos;
+    uint64_t maxGapNanos;
+};
+
+static void recordLoopGap(void *ctx) {
+    LoopGap *g = static_cast<LoopGap *>(ctx);
+    const uint64_t now = virtualClockNowNanos();
+    if (g->lastNanos != 0 && now - g->lastNanos > g->maxGapNanos) g->maxGapNanos = now - g->lastNanos;
+    g->lastNanos = now;
+}
+
+void test_sim_binary_telemetry() {
+    std::cout << "Test: Simulator Binary Telemetry at 9600 Baud Never Blocks loop()... ";
+
+    simBoot();
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    mockSerialSetTxBaud(9600);
+    LoopGap gap = {0, 0};
+    simSetTraceHook(recordLoopGap, &gap);
+
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(IDLE_CALIBRATION_WARMUP_MS + 100);
+    simSetMicSignal(toneSignal, nullptr);
+    simRunForMs(2000);
+    assert(getSystemState() == SYSTEM_ACTIVE);
+    simSetMicSignal(silenceSignal, nullptr);
+    runUntilState(SYSTEM_IDLE, IDLE_TIMEOUT_MS * 3);
+    simRunForMs(500);
+    const unsigned long endMs = millis();
+
+    // loop() only ever waits for the next interrupt / millisecond, never for the UART.
+    assert(gap.maxGapNanos <= 1000000ULL);
+
+    unsigned bad = 0;
+    const std::vector<Decoded> got = decodeStream(wire, &bad);
+    assert(bad == 0);
+    assert(getTelemetryDropCount() == 0);
+    // One record per TELEMETRY_INTERVAL_MS plus the state changes, no gaps.
+    assert(got.size() >= endMs / TELEMETRY_INTERVAL_MS - 2);
+    bool sawActive = false, sawDrive = false, sawIdleAfterActive = false;
+    for (size_t i = 0; i < got.size(); i++) {
+        if (i > 0) {
+            assert(got[i].sequence == (uint16_t)(got[i - 1].sequence + 1));
+            assert(got[i].record.timestampMs >= got[i - 1].record.timestampMs);
+            assert(got[i].record.timestampMs - got[i - 1].record.timestampMs <= TELEMETRY_INTERVAL_MS);
+        }
+        assert(got[i].drops == 0);
+        const SystemState s = (SystemState)got[i].record.state;
+        if (s == SYSTEM_ACTIVE) sawActive = true;
+        if (s == SYSTEM_ACTIVE && got[i].record.pwm > 0 && got[i].record.amplitude > 90) sawDrive = true;
+        if (s == SYSTEM_IDLE && sawActive) sawIdleAfterActive = true;
+        assert(got[i].record.dcOffset > DC_OFFSET - 20 && got[i].record.dcOffset < DC_OFFSET + 20);
+    }
+    assert(sawActive && sawDrive && sawIdleAfterActive);
+
+    std::cout << "PASS (" << got.size() << " records, loop gap <= " << gap.maxGapNanos / 1000 << " us)"
+              << std::endl;
+}
+
+#if ENABLE_LOOP_PROFILER
+void test_sim_loop_profile_report() {
+    std::cout << "Test: Simulator 'p' Loop Timing Report Shares the UART With Telemetry... ";
+
+    simBoot();
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    mockSerialSetTxBaud(9600);
+    LoopGap gap = {0, 0};
+    simSetTraceHook(recordLoopGap, &gap);
+
+    simSetMicSignal(toneSignal, nullptr);
+    simRunForMs(1000);
+    const unsigned long overruns0 = getSampleRingOverrunCount();
+    mockSerialInject("p");
+    simRunForMs(3000);
+
+    // The report trickles out between frames; loop() never waits for it.
+    assert(gap.maxGapNanos <= 1000000ULL);
+    assert(getSampleRingOverrunCount() == overruns0);
+    assert(getStageStats(STAGE_PROCESS_AUDIO).count > 0);
+    assert(getStageStats(STAGE_LOOP_TOTAL).count >= getStageStats(STAGE_PROCESS_AUDIO).count);
+    for (int s = 0; s < LOOP_STAGE_COUNT; s++) {
+        const std::string line = std::string("prof ") + getLoopStageName((LoopStage)s) + " n=";
+        assert(wire.find(line) != std::string::npos);
+    }
+    // The supervisor's transition trace closes the report.
+    assert(wire.find("prof fsm ") != std::string::npos);
+    assert(wire.find(" INIT -> IDLE (startup checks passed)") != std::string::npos);
+    assert(wire.find(" IDLE -> ACTIVE (audio above enter threshold)") != std::string::npos);
+#if ENABLE_BINARY_TELEMETRY
+    unsigned bad = 0;
+    const std::vector<Decoded> got = decodeStream(wire, &bad);
+    assert(bad == 0);
+    assert(got.size() >= 3000 / TELEMETRY_INTERVAL_MS);
+#endif
+
+    std::cout << "PASS" << std::endl;
+}
+#endif
+
+void test_sim_runtime_config_over_serial() {
+    std::cout << "Test: Simulator '$' Config Commands Retune the Running Firmware and Persist... ";
+
+    // Distinct file per backend: both simulator binaries may run at once.
+    const std::string storePath = std::string("test_simulator_") + BACKEND_NAME[0] + "_config.bin";
+    std::remove(storePath.c_str());
+    configStoreHostSetPath(storePath.c_str());
+
+    simBoot();
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_NOT_STORED);
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    mockSerialSetTxBaud(9600);
+    LoopGap gap = {0, 0};
+    simSetTraceHook(recordLoopGap, &gap);
+
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(IDLE_CALIBRATION_WARMUP_MS + 100);
+    const uint32_t generation0 = runtimeConfigGeneration();
+    mockSerialInject("$set idle_timeout_ms 500\n$set motor_motion.0 1\n$get idle_timeout_ms\n$set bogus 1\n");
+    simRunForMs(500);
+
+    // Replies trickle out between telemetry frames; loop() never waits for them.
+    assert(gap.maxGapNanos <= 1000000ULL);
+    assert(wire.find("cfg idle_timeout_ms=500 (pending)\n") != std::string::npos);
+    assert(wire.find("cfg motor_motion.0=1 (pending)\n") != std::string::npos);
+    assert(wire.find("cfg idle_timeout_ms=500\n") != std::string::npos);
+    assert(wire.find("cfg error: unknown name\n") != std::string::npos);
+#if ENABLE_BINARY_TELEMETRY
+    unsigned bad = 0;
+    decodeStream(wire, &bad);
+    assert(bad == 0);
+#endif
+
+    // Applied at a supervisor tick: the bank runs the new profile, the FSM the new timeout.
+    assert(runtimeConfigGeneration() > generation0);
+    assert(runtimeConfig().idleTimeoutMs == 500);
+    assert(getMotorChannelConfig(0).motion == 1);
+    simSetMicSignal(toneSignal, nullptr);
+    runUntilState(SYSTEM_ACTIVE, 1000);
+    assert(getSystemState() == SYSTEM_ACTIVE);
+    simRunForMs(1000);
+    simSetMicSignal(silenceSignal, nullptr);
+    const unsigned long toIdle = runUntilState(SYSTEM_IDLE, IDLE_TIMEOUT_MS);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(toIdle > 500 && toIdle < 500 + 7 * ENVELOPE_RELEASE_MS);
+
+    // Not saved: a power cycle forgets it. Saved: it survives.
+    simBoot();
+    assert(runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS);
+    mockSerialSetCapture(&wire);
+    wire.clear();
+    mockSerialInject("$set idle_timeout_ms 500\n$save\n");
+    simRunForMs(500);
+    assert(wire.find("cfg saved\n") != std::string::npos);
+    simBoot();
+    assert(runtimeConfigLoadResult() == RUNTIME_CONFIG_OK);
+    assert(runtimeConfig().idleTimeoutMs == 500);
+
+    configStoreHostSetPath(nullptr);
+    std::remove(storePath.c_str());
+    simBoot();
+    assert(runtimeConfig().idleTimeoutMs == IDLE_TIMEOUT_MS);
+
+    std::cout << "PASS (" << toIdle << " ms to IDLE)" << std::endl;
+}
+
+void test_sim_scheduler_sleeps_and_meets_deadlines() {
+    std::cout << "Test: Simulator Tasks Run at Their Rates, Deadline Misses Counted... ";
+
+    simBoot();
+    mockSerialSetTxBaud(9600);
+    simSetMicSignal(toneSignal, nullptr);
+    const uint64_t iterations0 = simLoopIterations();
+    simRunForMs(10000);
+
+    // loop() sleeps between interrupts instead of spinning: about one pass per
+    // conversion / 1ms tick (on the host every conversion is a virtual-clock interrupt,
+    // with ADC_OVERSAMPLING of them per ms; the board's DMA would not wake the CPU).
+    const uint64_t passes = simLoopIterations() - iterations0;
+    assert(passes <= 2 * 10000 * ADC_OVERSAMPLING);
+
+#if ENABLE_BINARY_TELEMETRY
+    // Nothing blocks: audio runs once per delivery, the periodic tasks once per period.
+    assert(getTaskStats(TASK_AUDIO).runs >= 10000 / DELIVERY_MS - 1);
+    assert(getTaskStats(TASK_SUPERVISOR).runs >= 10000 / MOTOR_UPDATE_INTERVAL);
+    assert(getTaskStats(TASK_SUPERVISOR).runs <= 10000 / MOTOR_UPDATE_INTERVAL + 1);
+    assert(getTaskStats(TASK_SERIAL).runs >= 10000 / SERIAL_POLL_INTERVAL_MS);
+    assert(getTaskStats(TASK_STATUS).runs >= 10000 / getTaskPeriodMs(TASK_STATUS));
+    for (int t = 0; t < TASK_COUNT; t++) {
+        assert(getTaskStats((TaskId)t).misses == 0);
+    }
+    assert(getTaskStats(TASK_AUDIO).worstResponseUs < AUDIO_TASK_DEADLINE_MS * 1000UL);
+#else
+    // Text output blocks at 9600 baud: the tasks behind it miss deadlines (and say so),
+    // but the sample ring bridges the gaps.
+    assert(getTaskStats(TASK_AUDIO).misses > 0);
+    assert(getTaskStats(TASK_AUDIO).worstResponseUs > AUDIO_TASK_DEADLINE_MS * 1000UL);
+    assert(getSampleRingOverrunCount() == 0);
+#endif
+
+    std::cout << "PASS (" << passes / 10 << " loop() passes/s, audio misses "
+              << getTaskStats(TASK_AUDIO).misses << ")" << std::endl;
+}
+
+void test_sim_deterministic() {
+    std::cout << "Test: Simulator Bit-for-Bit Reproducible... ";
+
+    const uint64_t a = runScriptedScenario();
+    const uint64_t b = runScriptedScenario();
+    assert(a == b);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_sim_hours_of_runtime() {
+    std::cout << "Test: Simulator 1 Hour of Runtime... ";
+
+    const auto start = std::chrono::steady_clock::now();
+    simBoot();
+    const unsigned long count0 = getAudioSampleCount();
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(60UL * 60UL * 1000UL);
+    const auto wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(getAudioSampleCount() - count0 == 3600000UL);
+    assert(getSampleRingOverrunCount() == 0);
+
+    std::cout << "PASS (" << wallMs << " ms wall)" << std::endl;
+}
+
+void test_sim_millis_rollover() {
+    std::cout << "Test: Simulator millis() Rollover... ";
+
+    // Boot 2 seconds before the 32-bit millis() wrap and run through it.
+    simBoot((uint64_t)(0xFFFFFFFFULL - 2000ULL) * 1000000ULL);
+    simSetMicSignal(silenceSignal, nullptr);
+    simRunForMs(5000);
+    assert(getSystemState() == SYSTEM_IDLE);
+    assert(!isFaultLatched());
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  FIRMWARE SIMULATOR TESTS (" << BACKEND_NAME << ")" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_sim_boot_to_idle();
+    test_sim_active_then_idle_timeout();
+    test_sim_envelope_attack_and_release();
+    test_sim_bias_drift_does_not_wake_motor();
+    test_sim_thresholds_follow_noise_floor();
+    test_sim_band_levels();
+    test_sim_beat_accent();
+    test_sim_sample_stall_fault();
+#if SAMPLING_BACKEND == SAMPLING_BACKEND_TIMER_ISR && SAMPLE_JITTER_FAULT_COUNT > 0
+    test_sim_sampling_jitter_fault();
+#endif
+    test_sim_timer_begin_failure();
+    test_sim_outputs_written_on_edges_only();
+    test_sim_every_sample_processed_under_logging_load();
+#if ENABLE_BINARY_TELEMETRY
+    test_sim_binary_telemetry();
+#endif
+#if ENABLE_LOOP_PROFILER
+    test_sim_loop_profile_report();
+#endif
+    test_sim_runtime_config_over_serial();
+    test_sim_scheduler_sleeps_and_meets_deadlines();
+    test_sim_deterministic();
+    test_sim_hours_of_runtime();
+    test_sim_millis_rollover();
+
+    std::cout << "\n✓ All Firmware Simulator tests passed!\n" << std::endl;
+    return 0;
+}
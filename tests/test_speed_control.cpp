@@ -0,0 +1,488 @@
+#include "main/speed_control.h"
+#include "main/speed_pid.h"
+#include "main/motor_bank.h"
+#include "main/config.h"
+#include "mock_arduino.h"
+#include "motor_plant.h"
+#include "signal_generators.h"
+#include "virtual_clock.h"
+#include "arduino_shim/FspTimer.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+static constexpr SpeedPidSpec FIRMWARE_SPEC = SPEED_PID_GAINS;
+static constexpr SpeedPidGains FIRMWARE_GAINS = makeSpeedPidGains(FIRMWARE_SPEC, SPEED_CONTROL_HZ);
+
+static void runForMs(double ms) {
+    virtualClockAdvanceBy((uint64_t)(ms * 1e6));
+}
+
+static void resetBoard() {
+    virtualClockReset();
+    resetMockArduino();
+    mockSerialSetEcho(false);
+}
+
+// The loop on `params`, commanded to `pwm` (0 = not yet) after start-up.
+static void startClosedLoop(MotorRig &rig, int pwm) {
+    resetBoard();
+    initSpeedControl();
+    assert(isSpeedControlOk());
+    rig.attach();
+    if (pwm > 0) setSpeedCommand(MOTOR_PIN, (uint8_t)pwm);
+}
+
+// The same motor driven open loop (no timer for the speed loop: commands go straight to the pin).
+static void startOpenLoop(MotorRig &rig, int pwm) {
+    resetBoard();
+    fspTimerMockFailNextBegin();
+    initSpeedControl();
+    assert(!isSpeedControlOk());
+    rig.attach();
+    setSpeedCommand(MOTOR_PIN, (uint8_t)pwm);
+}
+
+// Plant speed statistics over the next `ms`, sampled every millisecond.
+struct SpeedStats {
+    double mean;
+    double min;
+    double max;
+};
+
+static SpeedStats observe(const MotorRig &rig, int ms) {
+    SpeedStats s = {0.0, 1e9, -1e9};
+    for (int i = 0; i < ms; i++) {
+        runForMs(1);
+        const double rpm = rig.plant.rpm();
+        s.mean += rpm;
+        if (rpm < s.min) s.min = rpm;
+        if (rpm > s.max) s.max = rpm;
+    }
+    s.mean /= ms;
+    return s;
+}
+
+static double setpointFor(int pwm) {
+    return (double)pwm * SPEED_MAX_RPM / 255.0;
+}
+
+// Step from standstill: peak overshoot (fraction of the setpoint) and the time after
+// which the speed stays within `band` of it (ms), over `ms`.
+struct StepResponse {
+    double overshoot;
+    int settleMs;
+};
+
+static StepResponse stepResponse(const DcMotorParams &params, int pwm, double band, int ms) {
+    MotorRig rig(params, MOTOR_PIN, TACH_PIN);
+    startClosedLoop(rig, pwm);
+    const double target = setpointFor(pwm);
+    StepResponse r = {0.0, 0};
+    for (int t = 1; t <= ms; t++) {
+        runForMs(1);
+        const double rpm = rig.plant.rpm();
+        if (rpm - target > r.overshoot * target) r.overshoot = (rpm - target) / target;
+        if (std::fabs(rpm - target) > band * target) r.settleMs = t;
+    }
+    return r;
+}
+
+// --- PID ---
+
+// The same law in floating point.
+struct ReferencePid {
+    double integral = 0.0;
+    double lastMeasured = 0.0;
+    bool primed = false;
+
+    double update(const SpeedPidSpec &spec, double hz, double setpoint, double measured, double ff) {
+        const double scale = 255.0 / spec.maxRpm / 100.0;
+        const double kp = spec.kpPct * scale;
+        const double ki = spec.kiPctPerS * scale / hz;
+        const double kd = spec.kdPctMs * scale * hz / 1000.0;
+        const double error = setpoint - measured;
+        const double derivative = primed ? -kd * (measured - lastMeasured) : 0.0;
+        lastMeasured = measured;
+        primed = true;
+        const double base = ff + kp * error + derivative;
+        const double unclamped = base + integral;
+        if (!(unclamped >= 255.0 && error > 0) && !(unclamped <= 0.0 && error < 0)) {
+            integral += ki * error;
+            if (integral > spec.integralLimitPwm) integral = spec.integralLimitPwm;
+            if (integral < -spec.integralLimitPwm) integral = -spec.integralLimitPwm;
+        }
+        const double out = base + integral;
+        return out < 0.0 ? 0.0 : (out > 255.0 ? 255.0 : out);
+    }
+};
+
+void test_pid_matches_reference() {
+    std::cout << "Test: Speed PID Matches Floating-Point Reference... ";
+
+    const SpeedPidSpec specs[] = {FIRMWARE_SPEC, {80, 400, 0, 3000, 60}, {200, 3000, 20, 1800, 200}};
+    for (const SpeedPidSpec &spec : specs) {
+        assert(speedPidSpecValid(spec, SPEED_CONTROL_HZ));
+        const SpeedPidGains g = makeSpeedPidGains(spec, SPEED_CONTROL_HZ);
+        SpeedPid pid;
+        ReferencePid ref;
+        NoiseSource noise(1234);
+        const int setpoint = spec.maxRpm * 2 / 3;
+        const uint8_t ff = (uint8_t)(setpoint * 255 / spec.maxRpm);
+        double measured = 0.0;
+        double worst = 0.0;
+        for (int i = 0; i < 2000; i++) {
+            // A slow first-order "motor" with measurement noise.
+            measured += (setpoint * (0.8 + 0.2 * std::sin(i * 0.01)) - measured) * 0.02;
+            const int m = (int)(measured + 40.0 * noise.uniform());
+            const int out = pid.update(setpoint, m, ff, g);
+            const double want = ref.update(spec, SPEED_CONTROL_HZ, setpoint, m, ff);
+            worst = std::fmax(worst, std::fabs(out - want));
+        }
+        assert(worst <= 1.0);
+    }
+
+    // Out-of-range specs are rejected at compile time.
+    static_assert(!speedPidSpecValid({0, 100, 0, 2600, 100}, 200), "kp required");
+    static_assert(!speedPidSpecValid({150, 1, 0, 2600, 100}, 200), "ki rounded to nothing");
+    static_assert(!speedPidSpecValid({60000, 0, 0, 100, 100}, 200), "kp term overflows");
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_pid_anti_windup() {
+    std::cout << "Test: Speed PID Anti-Windup While Saturated... ";
+
+    const SpeedPidGains &g = FIRMWARE_GAINS;
+    SpeedPid pid;
+
+    // A stalled motor far below a high setpoint: the output pins at 255 and the
+    // integrator stops where saturation began instead of growing for 2 seconds.
+    int32_t atSaturation = 0;
+    for (int i = 0; i < 2 * SPEED_CONTROL_HZ; i++) {
+        const uint8_t out = pid.update(2400, 0, 235, g);
+        assert(out == 255);
+        if (i == 0) atSaturation = pid.integral();
+        assert(pid.integral() == atSaturation);
+    }
+    assert(atSaturation < g.integralLimit);
+    // Once the motor catches up the output leaves saturation on the next tick.
+    assert(pid.update(2400, 2400, 235, g) < 255);
+
+    // The integrator is clamped to its share of the output.
+    SpeedPid slow;
+    for (int i = 0; i < 10 * SPEED_CONTROL_HZ; i++) slow.update(1000, 950, 60, g);
+    assert(slow.integral() == g.integralLimit);
+    for (int i = 0; i < 10 * SPEED_CONTROL_HZ; i++) slow.update(1000, 1050, 140, g);
+    assert(slow.integral() == -g.integralLimit);
+
+    // Saturated low: overspeeding with the output at 0 does not wind down.
+    SpeedPid over;
+    over.update(500, 2500, 49, g);
+    const int32_t low = over.integral();
+    for (int i = 0; i < SPEED_CONTROL_HZ; i++) assert(over.update(500, 2500, 49, g) == 0);
+    assert(over.integral() == low);
+
+    // Setpoint 0: off, and the state is cleared.
+    assert(slow.update(0, 1000, 0, g) == 0);
+    assert(slow.integral() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// --- Tach measurement ---
+
+static void tachPulse(void *ctx) {
+    (void)ctx;
+    setSimulatedDigitalInput(TACH_PIN, HIGH);
+    setSimulatedDigitalInput(TACH_PIN, LOW);
+}
+
+void test_tach_measurement() {
+    std::cout << "Test: Tach Pulses Measured As RPM... ";
+
+    // No motor on the pin; a pulse train at a known rate.
+    const double rpms[] = {150.0, 900.0, 2000.0, 4500.0};
+    for (double rpm : rpms) {
+        resetBoard();
+        initSpeedControl();
+        setSpeedCommand(MOTOR_PIN, 100);
+        const uint64_t period = (uint64_t)(60e9 / (rpm * SPEED_TACH_PULSES_PER_REV));
+        const int handle = virtualClockAddPeriodic(period, tachPulse, nullptr);
+        runForMs(600);
+        assert(std::fabs(getMeasuredRpm() - rpm) <= rpm * 0.01 + 1.0);
+        assert(!isSpeedFeedbackLost());
+
+        // Pulses stop: the reading falls (bounded by the time since the last edge),
+        // then reads 0 after SPEED_TACH_TIMEOUT_MS.
+        virtualClockRemove(handle);
+        runForMs(SPEED_TACH_TIMEOUT_MS / 2);
+        assert(getMeasuredRpm() < rpm);
+        runForMs(SPEED_TACH_TIMEOUT_MS);
+        assert(getMeasuredRpm() == 0);
+    }
+
+    // A glitch right after an edge is not a pulse.
+    resetBoard();
+    initSpeedControl();
+    setSimulatedDigitalInput(TACH_PIN, HIGH);
+    setSimulatedDigitalInput(TACH_PIN, LOW);
+    runForMs(SPEED_TACH_MIN_PERIOD_US / 2 / 1000.0);
+    setSimulatedDigitalInput(TACH_PIN, HIGH);
+    setSimulatedDigitalInput(TACH_PIN, LOW);
+    assert(getTachPulseCount() == 1);
+    runForMs(SPEED_TACH_MIN_PERIOD_US / 1000.0);
+    setSimulatedDigitalInput(TACH_PIN, HIGH);
+    assert(getTachPulseCount() == 2);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// --- Closed loop on the motor model ---
+
+void test_step_response() {
+    std::cout << "Test: Speed Loop Step Response... ";
+
+    const int pwms[] = {110, 160, 220};
+    for (int pwm : pwms) {
+        const StepResponse r = stepResponse(NOMINAL_MOTOR, pwm, 0.03, 1500);
+        assert(r.overshoot < 0.10);
+        assert(r.settleMs < 600);
+    }
+
+    // Steady state: the setpoint, and the reading agrees with the motor.
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+    startClosedLoop(rig, 180);
+    runForMs(1500);
+    const SpeedStats s = observe(rig, 500);
+    assert(std::fabs(s.mean - setpointFor(180)) < setpointFor(180) * 0.01);
+    assert(s.max - s.min < setpointFor(180) * 0.03);
+    assert(std::fabs(getMeasuredRpm() - s.mean) < s.mean * 0.03);
+    assert(getSpeedSetpointRpm() == (uint16_t)setpointFor(180));
+
+    // 0 stops the motor at once.
+    setSpeedCommand(MOTOR_PIN, 0);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+    runForMs(1000);
+    assert(rig.plant.rpm() == 0.0 && getSpeedControlPwm() == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// Speed after a disturbance, closed vs open loop, as a fraction of the undisturbed speed.
+struct Rejection {
+    double closedLoop;
+    double openLoop;
+};
+
+template <typename Disturb>
+static Rejection disturbanceRejection(int pwm, Disturb disturb) {
+    Rejection r = {0.0, 0.0};
+    for (int closed = 0; closed < 2; closed++) {
+        MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+        if (closed) {
+            startClosedLoop(rig, pwm);
+        } else {
+            startOpenLoop(rig, pwm);
+        }
+        runForMs(1500);
+        const double before = observe(rig, 200).mean;
+        disturb(rig.plant);
+        runForMs(800);
+        const double after = observe(rig, 200).mean;
+        (closed ? r.closedLoop : r.openLoop) = after / before;
+    }
+    return r;
+}
+
+void test_supply_and_load_rejection() {
+    std::cout << "Test: Speed Holds Through Supply Sag And Load... ";
+
+    // The battery sags from 12V to 10V.
+    const Rejection sag = disturbanceRejection(170, [](DcMotorPlant &p) { p.setSupplyVolts(10.0); });
+    assert(sag.openLoop < 0.85);
+    assert(std::fabs(sag.closedLoop - 1.0) < 0.02);
+
+    // The sculpture's arm catches (a third of the stall torque margin).
+    const Rejection load = disturbanceRejection(170, [](DcMotorPlant &p) { p.setLoadTorque(0.012); });
+    assert(load.openLoop < 0.85);
+    assert(std::fabs(load.closedLoop - 1.0) < 0.02);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_mismatched_motors_match_speed() {
+    std::cout << "Test: Different Motors Run At The Same Speed... ";
+
+    // Production spread: a weaker, stiffer motor and a stronger, freer one.
+    DcMotorParams weak = NOMINAL_MOTOR;
+    weak.torqueConstant = 0.032;
+    weak.coulombFriction = 0.026;
+    DcMotorParams strong = NOMINAL_MOTOR;
+    strong.torqueConstant = 0.038;
+    strong.coulombFriction = 0.015;
+
+    double open[2], closed[2];
+    const DcMotorParams *motors[2] = {&weak, &strong};
+    for (int i = 0; i < 2; i++) {
+        MotorRig a(*motors[i], MOTOR_PIN, TACH_PIN);
+        startOpenLoop(a, 150);
+        runForMs(1500);
+        open[i] = observe(a, 200).mean;
+
+        MotorRig b(*motors[i], MOTOR_PIN, TACH_PIN);
+        startClosedLoop(b, 150);
+        runForMs(1500);
+        closed[i] = observe(b, 200).mean;
+    }
+    assert(std::fabs(open[0] - open[1]) > setpointFor(150) * 0.08);
+    assert(std::fabs(closed[0] - closed[1]) < setpointFor(150) * 0.02);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_saturation_recovery() {
+    std::cout << "Test: Speed Loop Recovers From Saturation... ";
+
+    // An unreachable setpoint (the supply sagged to 9V): the output pins at 255. When
+    // the supply comes back the loop must not overshoot from a wound-up integrator.
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+    rig.plant.setSupplyVolts(9.0);
+    startClosedLoop(rig, 230);
+    runForMs(2000);
+    assert(getSpeedControlPwm() == 255);
+    assert(rig.plant.rpm() < setpointFor(230) * 0.9);
+
+    rig.plant.setSupplyVolts(12.0);
+    double peak = 0.0;
+    for (int t = 0; t < 1500; t++) {
+        runForMs(1);
+        peak = std::fmax(peak, rig.plant.rpm());
+    }
+    assert(peak < setpointFor(230) * 1.05);
+    assert(std::fabs(observe(rig, 200).mean - setpointFor(230)) < setpointFor(230) * 0.02);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_feedback_loss_falls_back_to_open_loop() {
+    std::cout << "Test: Lost Tach Falls Back To Open Loop... ";
+
+    // The tach wire is off: the motor turns but no pulse arrives.
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, 40);
+    startClosedLoop(rig, 160);
+    runForMs(SPEED_FEEDBACK_TIMEOUT_MS / 2);
+    assert(!isSpeedFeedbackLost());
+    runForMs(SPEED_FEEDBACK_TIMEOUT_MS);
+    assert(isSpeedFeedbackLost());
+    assert(getSpeedFeedbackLossCount() == 1);
+    // Driven at the feed-forward, not at full output chasing a speed it never sees.
+    assert(getSpeedControlPwm() == 160);
+    runForMs(1000);
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 160);
+    // Open loop the speed is only roughly right (friction takes its share).
+    assert(std::fabs(rig.plant.rpm() - setpointFor(160)) < setpointFor(160) * 0.2);
+
+    // A stop clears it; without a setpoint a silent tach is not a fault.
+    setSpeedCommand(MOTOR_PIN, 0);
+    runForMs(SPEED_FEEDBACK_TIMEOUT_MS * 2);
+    assert(!isSpeedFeedbackLost());
+    assert(getSpeedFeedbackLossCount() == 1);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_stable_across_plant_variation() {
+    std::cout << "Test: Speed Loop Stable Across Motor Variation... ";
+
+    // Inertia (a heavier arm), supply and friction swept around nominal, at low, middle
+    // and high speed: no sustained oscillation and no steady-state error where the
+    // speed is reachable.
+    const double inertias[] = {0.5, 1.0, 3.0};
+    const double supplies[] = {10.5, 12.0, 13.5};
+    const double frictions[] = {0.7, 1.0, 1.4};
+    const int pwms[] = {100, 170, 220};
+    int cases = 0;
+    for (double inertia : inertias) {
+        for (double supply : supplies) {
+            for (double friction : frictions) {
+                for (int pwm : pwms) {
+                    DcMotorParams m = NOMINAL_MOTOR;
+                    m.inertia *= inertia;
+                    m.supplyVolts = supply;
+                    m.coulombFriction *= friction;
+                    m.staticFriction *= friction;
+                    MotorRig rig(m, MOTOR_PIN, TACH_PIN);
+                    startClosedLoop(rig, pwm);
+                    runForMs(2500);
+                    const SpeedStats s = observe(rig, 500);
+                    const double target = setpointFor(pwm);
+                    if (getSpeedControlPwm() == 255) continue;  // beyond this motor
+                    assert(std::fabs(s.mean - target) < target * 0.02);
+                    assert(s.max - s.min < target * 0.05);
+                    cases++;
+                }
+            }
+        }
+    }
+    assert(cases >= 70);
+
+    std::cout << "PASS" << std::endl;
+}
+
+// --- Motor bank output hook ---
+
+static constexpr PwmCurveSpec CURVE_SPECS[] = {{"linear", PWM_CURVE_LINEAR, 0, 0, 510, 0, 255, 0, {}}};
+static constexpr PwmCurveSet<1> CURVES = makePwmCurves(CURVE_SPECS);
+static constexpr MotionProfileSpec MOTION_SPECS[] = {{"instant", 60000, 6000000, 600000000, 0, 0, 0}};
+static constexpr MotionLimitsSet<1> MOTIONS = makeMotionLimitsSet(MOTION_SPECS, 10);
+
+void test_motor_bank_speed_channel() {
+    std::cout << "Test: Motor Bank Drives The Speed Channel Through The Loop... ";
+
+    MotorRig rig(NOMINAL_MOTOR, MOTOR_PIN, TACH_PIN);
+    startClosedLoop(rig, 0);
+    MotorBank<2> bank(CURVES.curves, 1, MOTIONS.limits, 1);
+    bank.configure(SPEED_CONTROL_CHANNEL, {MOTOR_PIN, MOTOR_SOURCE_AMPLITUDE, 0, 0});
+    bank.configure(1 - SPEED_CONTROL_CHANNEL, {9, MOTOR_SOURCE_BASS, 0, 0});
+    bank.setOutput(speedControlMotorOutput);
+
+    int levels[MOTOR_SOURCE_COUNT] = {400, 300, 0, 0};
+    for (int i = 0; i < 150; i++) {
+        bank.update(levels);
+        runForMs(10);
+    }
+    const uint8_t speedPwm = bank.pwm(SPEED_CONTROL_CHANNEL);
+    assert(speedPwm == 200);
+    // The speed channel's PWM is the loop's command; the other channel is written as is.
+    assert(getSpeedSetpointRpm() == (uint16_t)setpointFor(speedPwm));
+    assert(std::fabs(rig.plant.rpm() - setpointFor(speedPwm)) < setpointFor(speedPwm) * 0.02);
+    assert(getSimulatedPWMOutput(9) == bank.pwm(1 - SPEED_CONTROL_CHANNEL));
+
+    bank.stopAll();
+    assert(getSimulatedPWMOutput(MOTOR_PIN) == 0);
+    assert(getSimulatedPWMOutput(9) == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  SPEED CONTROL TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_pid_matches_reference();
+    test_pid_anti_windup();
+    test_tach_measurement();
+    test_step_response();
+    test_supply_and_load_rejection();
+    test_mismatched_motors_match_speed();
+    test_saturation_recovery();
+    test_feedback_loss_falls_back_to_open_loop();
+    test_stable_across_plant_variation();
+    test_motor_bank_speed_channel();
+
+    std::cout << "\n✓ All Speed Control tests passed!\n" << std::endl;
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "main/config.h"
+#include "main/telemetry.h"
+#include "telemetry_decoder.h"
+#include "mock_arduino.h"
+#include "virtual_clock.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static TelemetryRecord makeRecord(uint32_t t) {
+    TelemetryRecord r;
+    r.timestampMs = t;
+    r.rawSample = (uint16_t)(500 + t % 50);
+    r.amplitude = (uint16_t)(t % 300);
+    r.dcOffset = 512;
+    r.pwm = (uint8_t)(t % 256);
+    r.state = (uint8_t)(t % 5);
+    return r;
+}
+
+static void resetAll(unsigned long baud) {
+    virtualClockReset();
+    resetMockArduino();
+    mockSerialSetEcho(false);
+    mockSerialSetTxBaud(baud);
+    initTelemetry();
+}
+
+void test_frame_layout() {
+    std::cout << "Test: Telemetry Frame Layout and CRC... ";
+
+    TelemetryRecord r;
+    r.timestampMs = 0x12345678;
+    r.rawSample = 0x0203;
+    r.amplitude = 0x0405;
+    r.dcOffset = 0x0607;
+    r.pwm = 0x08;
+    r.state = 0x02;
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    assert(telemetryEncode(r, 0xBEEF, 0x0009, frame) == 21);
+
+    const uint8_t expected[20] = {0xA5, 0x5A, 0x01, 16,   0xEF, 0xBE, 0x78, 0x56, 0x34, 0x12,
+                                  0x03, 0x02, 0x05, 0x04, 0x07, 0x06, 0x08, 0x02, 0x09, 0x00};
+    assert(std::memcmp(frame, expected, sizeof(expected)) == 0);
+    // CRC-8/0x07 check value, and the trailer covers type..payload.
+    assert(telemetryCrc8(reinterpret_cast<const uint8_t *>("123456789"), 9) == 0xF4);
+    assert(frame[20] == telemetryCrc8(frame + 2, 18));
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_round_trip_through_serial() {
+    std::cout << "Test: Records Round-Trip Through the Serial Stream... ";
+
+    resetAll(0);
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    for (uint32_t t = 0; t < 100; t++) {
+        assert(telemetrySend(makeRecord(t)));
+        telemetryFlush();
+    }
+    assert(telemetryPending() == 0);
+
+    const std::vector<Decoded> got = decodeStream(wire);
+    assert(got.size() == 100);
+    for (uint32_t t = 0; t < 100; t++) {
+        const TelemetryRecord e = makeRecord(t);
+        assert(got[t].sequence == t);
+        assert(got[t].record.timestampMs == e.timestampMs && got[t].record.rawSample == e.rawSample);
+        assert(got[t].record.amplitude == e.amplitude && got[t].record.dcOffset == e.dcOffset);
+        assert(got[t].record.pwm == e.pwm && got[t].record.state == e.state);
+        assert(got[t].drops == 0);
+    }
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_flush_never_blocks() {
+    std::cout << "Test: Flush Never Blocks at 9600 Baud... ";
+
+    resetAll(9600);
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    for (int i = 0; i < 5; i++) telemetrySend(makeRecord(i));
+
+    // Only what fits in the TX buffer goes out; the clock does not move.
+    const uint64_t t0 = virtualClockNowNanos();
+    assert(telemetryFlush() == (unsigned)MOCK_SERIAL_TX_BUFFER);
+    assert(telemetryFlush() == 0);
+    assert(virtualClockNowNanos() == t0);
+
+    // As the UART drains, later flushes send the rest, in order.
+    while (telemetryPending() > 0) {
+        virtualClockAdvanceBy(1000000);
+        telemetryFlush();
+    }
+    assert(virtualClockNowNanos() - t0 < 150000000ULL);  // 105 bytes at 960 bytes/s
+    assert(decodeStream(wire).size() == 5);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_full_queue_drops_and_counts() {
+    std::cout << "Test: Full Queue Drops Whole Records and Counts Them... ";
+
+    resetAll(9600);
+    std::string wire;
+    mockSerialSetCapture(&wire);
+
+    // Nothing flushed: the ring holds TELEMETRY_RING_SIZE / 21 records, the rest drop.
+    const unsigned capacity = TELEMETRY_RING_SIZE / TELEMETRY_FRAME_SIZE;
+    for (unsigned i = 0; i < capacity; i++) assert(telemetrySend(makeRecord(i)));
+    assert(!telemetrySend(makeRecord(capacity)));
+    assert(!telemetrySend(makeRecord(capacity + 1)));
+    assert(getTelemetryDropCount() == 2);
+
+    while (telemetryPending() > 0) {
+        virtualClockAdvanceBy(1000000);
+        telemetryFlush();
+    }
+    assert(telemetrySend(makeRecord(100)));
+    telemetryFlush();
+    virtualClockAdvanceBy(100000000);
+    telemetryFlush();
+
+    // Receivers see the drops both as a sequence gap and in the counter.
+    const std::vector<Decoded> got = decodeStream(wire);
+    assert(got.size() == capacity + 1);
+    assert(got[capacity].sequence == capacity + 2);
+    assert(got[capacity].drops == 2);
+    assert(got[capacity - 1].drops == 0);
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_decoder_resyncs_after_text_and_corruption() {
+    std::cout << "Test: Stream Resyncs After Text and a Corrupted Frame... ";
+
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    std::string wire = "=== boot banner ===\n";
+    telemetryEncode(makeRecord(1), 1, 0, frame);
+    wire.append(reinterpret_cast<const char *>(frame), 10);  // cut short by a text line
+    wire += "FAULT: something\n";
+    telemetryEncode(makeRecord(2), 2, 0, frame);
+    frame[8] ^= 0x40;  // flipped bit
+    wire.append(reinterpret_cast<const char *>(frame), sizeof(frame));
+    telemetryEncode(makeRecord(3), 3, 0, frame);
+    wire.append(reinterpret_cast<const char *>(frame), sizeof(frame));
+
+    unsigned bad = 0;
+    const std::vector<Decoded> got = decodeStream(wire, &bad);
+    assert(got.size() == 1);
+    assert(got[0].sequence == 3 && got[0].record.timestampMs == 3);
+    assert(bad == 2);  // the truncated frame and the corrupted one
+
+    std::cout << "PASS" << std::endl;
+}
+
+void test_variable_length_frames_share_the_queue() {
+    std::cout << "Test: Frames of Other Types Share the Queue and Are Never Split... ";
+
+    resetAll(9600);
+    std::string wire;
+    mockSerialSetCapture(&wire);
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    for (size_t i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t)(i * 37);
+    // The payload contains the sync pattern: decoders must step over the whole frame.
+    payload[10] = TELEMETRY_SYNC0;
+    payload[11] = TELEMETRY_SYNC1;
+    assert(!telemetrySendFrame(0x7E, payload, TELEMETRY_MAX_PAYLOAD + 1));
+    assert(getTelemetryDropCount() == 1);
+
+    assert(telemetrySend(makeRecord(1)));
+    assert(telemetrySendFrame(0x7E, payload, 200));
+    assert(telemetrySendFrame(0x7E, payload, 0));
+    assert(telemetrySend(makeRecord(2)));
+
+    // The first flush stops inside the long frame; finishing it writes exactly its rest.
+    telemetryFlush();
+    assert(wire.size() == (size_t)MOCK_SERIAL_TX_BUFFER);
+    assert(!telemetryFinishFrame());
+    while (!telemetryFinishFrame()) virtualClockAdvanceBy(1000000);
+    assert(wire.size() == 21 + 205);
+    assert(telemetryPending() == 5 + 21);
+
+    while (telemetryPending() > 0) {
+        virtualClockAdvanceBy(1000000);
+        telemetryFlush();
+    }
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(wire.data());
+    assert(b[21] == TELEMETRY_SYNC0 && b[23] == 0x7E && b[24] == 200);
+    assert(std::memcmp(b + 25, payload, 200) == 0);
+    assert(b[225] == telemetryCrc8(b + 23, 202));
+    assert(b[226 + 3] == 0 && b[226 + 4] == telemetryCrc8(b + 228, 2));
+
+    unsigned bad = 0;
+    const std::vector<Decoded> got = decodeStream(wire, &bad);
+    assert(bad == 0);
+    assert(got.size() == 2);
+    assert(got[0].record.timestampMs == 1 && got[1].record.timestampMs == 2);
+    assert(got[1].sequence == 1 && got[1].drops == 1);
+
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  TELEMETRY TESTS" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    test_frame_layout();
+    test_round_trip_through_serial();
+    test_flush_never_blocks();
+    test_full_queue_drops_and_counts();
+    test_decoder_resyncs_after_text_and_corruption();
+    test_variable_length_frames_share_the_queue();
+
+    std::cout << "\n✓ All Telemetry tests passed!\n" << std::endl;
+    return 0;
+}
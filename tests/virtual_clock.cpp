@@ -0,0 +1,111 @@
+#include "virtual_clock.h"
+
+namespace {
+
+const int MAX_SOURCES = 8;
+
+struct InterruptSource {
+    bool active;
+    uint64_t periodNanos;
+    uint64_t nextDueNanos;
+    VirtualInterruptFn fn;
+    void *ctx;
+};
+
+uint64_t nowNanos = 0;
+uint64_t interruptCount = 0;
+uint32_t epoch = 0;
+bool inInterrupt = false;
+InterruptSource sources[MAX_SOURCES];
+int sourceLimit = 0;  // one past the highest slot ever used since reset
+
+// Index of the earliest due source at or before limit, or -1.
+int nextDueSource(uint64_t limit) {
+    int best = -1;
+    for (int i = 0; i < sourceLimit; i++) {
+        if (!sources[i].active || sources[i].nextDueNanos > limit) continue;
+        if (best < 0 || sources[i].nextDueNanos < sources[best].nextDueNanos) best = i;
+    }
+    return best;
+}
+
+} // namespace
+
+void virtualClockReset(uint64_t startNanos) {
+    nowNanos = startNanos;
+    interruptCount = 0;
+    inInterrupt = false;
+    epoch++;
+    sourceLimit = 0;
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        sources[i].active = false;
+    }
+}
+
+uint64_t virtualClockNowNanos() {
+    return nowNanos;
+}
+
+void virtualClockAdvanceTo(uint64_t targetNanos) {
+    if (targetNanos <= nowNanos) return;
+
+    if (inInterrupt) {
+        // Time spent inside a handler (e.g. a modeled slow peripheral) still passes,
+        // but other interrupts wait until the handler returns.
+        nowNanos = targetNanos;
+        return;
+    }
+
+    int i;
+    while ((i = nextDueSource(targetNanos)) >= 0) {
+        InterruptSource &src = sources[i];
+        if (src.nextDueNanos > nowNanos) nowNanos = src.nextDueNanos;
+        src.nextDueNanos += src.periodNanos;
+
+        inInterrupt = true;
+        interruptCount++;
+        src.fn(src.ctx);
+        inInterrupt = false;
+    }
+    if (targetNanos > nowNanos) nowNanos = targetNanos;
+}
+
+void virtualClockAdvanceBy(uint64_t deltaNanos) {
+    virtualClockAdvanceTo(nowNanos + deltaNanos);
+}
+
+int virtualClockAddPeriodic(uint64_t periodNanos, VirtualInterruptFn fn, void *ctx) {
+    if (periodNanos == 0 || fn == nullptr) return -1;
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        if (sources[i].active) continue;
+        sources[i].active = true;
+        sources[i].periodNanos = periodNanos;
+        sources[i].nextDueNanos = nowNanos + periodNanos;
+        sources[i].fn = fn;
+        sources[i].ctx = ctx;
+        if (i + 1 > sourceLimit) sourceLimit = i + 1;
+        return i;
+    }
+    return -1;
+}
+
+void virtualClockRemove(int handle) {
+    if (handle < 0 || handle >= MAX_SOURCES) return;
+    sources[handle].active = false;
+}
+
+uint64_t virtualClockNextEventNanos() {
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < sourceLimit; i++) {
+        if (sources[i].active && sources[i].nextDueNanos < next) next = sources[i].nextDueNanos;
+    }
+    return next;
+}
+
+uint64_t virtualClockInterruptCount() {
+    return interruptCount;
+}
+
+uint32_t virtualClockEpoch() {
+    return epoch;
+}
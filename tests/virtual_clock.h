@@ -0,0 +1,47 @@
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include <cstdint>
+
+/**
+ * Deterministic virtual time base for desktop tests.
+ *
+ * millis()/micros()/delay() in mock_arduino.cpp read and advance this clock instead
+ * of the wall clock, and periodic "interrupts" (e.g. the FspTimer mock driving
+ * audioTimerCallback) fire at their exact due times as the clock is advanced.
+ * Nothing here depends on host timing, so runs are bit-for-bit reproducible and
+ * hours of firmware time cost only the CPU needed to execute the firmware code.
+ */
+
+typedef void (*VirtualInterruptFn)(void *ctx);
+
+// Reset time to startNanos and remove all interrupt sources.
+void virtualClockReset(uint64_t startNanos = 0);
+
+// Current virtual time in nanoseconds.
+uint64_t virtualClockNowNanos();
+
+// Advance time, firing every due interrupt (earliest first, ties by registration order)
+// with the clock set to that interrupt's due time. Calls made from inside an interrupt
+// handler only move the clock (interrupts do not nest).
+void virtualClockAdvanceTo(uint64_t targetNanos);
+void virtualClockAdvanceBy(uint64_t deltaNanos);
+
+// Register a periodic interrupt; the first call happens one period from now.
+// Returns a handle (>= 0) or -1 if all slots are in use.
+int virtualClockAddPeriodic(uint64_t periodNanos, VirtualInterruptFn fn, void *ctx);
+
+// Remove a periodic interrupt (no-op for an invalid handle).
+void virtualClockRemove(int handle);
+
+// Due time of the next pending interrupt, or UINT64_MAX if none is registered.
+uint64_t virtualClockNextEventNanos();
+
+// Total number of interrupt handler invocations since the last reset.
+uint64_t virtualClockInterruptCount();
+
+// Incremented by every virtualClockReset(); lets interrupt owners detect that
+// their handle was invalidated by a reset (simulated power cycle).
+uint32_t virtualClockEpoch();
+
+#endif // VIRTUAL_CLOCK_H
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+Record a raw capture (main/raw_capture.h) from the sculpture for desktop replay.
+
+Usage:
+    capture_record.py /dev/ttyACM0 capture.bin [--seconds N] [--baud 115200]
+                                                   # needs pyserial
+    capture_record.py --check capture.bin          # summarize a recorded file
+
+Sends 'c' to start the capture (the sculpture restarts its signal chain), saves
+every byte it sends until Ctrl-C or --seconds, then sends 'c' again and keeps
+reading briefly so the STOP frame makes it into the file. The file is the raw
+serial stream (status frames and text included); replay it with
+    tests/replay_capture capture.bin [trace.csv]
+"""
+
+import argparse
+import sys
+import time
+
+from telemetry_decode import SYNC, crc8
+
+TYPE_CAPTURE = 0x02
+EVENT_NAMES = {1: "START", 2: "SAMPLES", 3: "TICK", 4: "COMMAND", 5: "CONFIG", 6: "STOP"}
+
+
+def varint(data, offset):
+    """Return (value, next offset) of a base-128 varint"""
+    value, shift = 0, 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, offset
+        shift += 7
+
+
+def summarize(data):
+    """Count the capture frames in a recorded stream; report sequence gaps and CRC failures"""
+    counts = {}
+    samples = gaps = bad = 0
+    last_sequence = None
+    i = 0
+    while True:
+        i = data.find(SYNC, i)
+        if i < 0 or i + 4 > len(data):
+            break
+        size = data[i + 3] + 5
+        if i + size > len(data):
+            break
+        frame = data[i:i + size]
+        if crc8(frame[2:size - 1]) != frame[size - 1]:
+            bad += 1
+            i += 1
+            continue
+        i += size
+        if frame[2] != TYPE_CAPTURE:
+            continue
+        sequence = frame[4] | (frame[5] << 8)
+        event = EVENT_NAMES.get(frame[6], str(frame[6]))
+        if event == "START":
+            last_sequence = None
+        elif last_sequence is not None and sequence != (last_sequence + 1) & 0xFFFF:
+            gaps += 1
+        last_sequence = sequence
+        counts[event] = counts.get(event, 0) + 1
+        samples += varint(frame, 7)[0]
+
+    frames = ", ".join(f"{counts[name]} {name}" for name in EVENT_NAMES.values() if name in counts)
+    print(f"{frames or 'no capture frames'}; {samples} samples "
+          f"({samples / 1000.0:.1f} s at 1 kHz), {gaps} sequence gaps, {bad} failed CRC")
+    if "START" not in counts:
+        print("warning: no START frame (was 'c' received?)", file=sys.stderr)
+    elif "STOP" not in counts:
+        print("warning: no STOP frame; the replay stops at the end of the file", file=sys.stderr)
+    return gaps == 0 and "START" in counts
+
+
+def record(port_name, path, baud, seconds):
+    try:
+        import serial
+    except ImportError:
+        print("Error: reading a serial port needs pyserial (pip install pyserial)", file=sys.stderr)
+        sys.exit(1)
+
+    data = bytearray()
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.reset_input_buffer()
+        port.write(b"c")
+        print(f"recording from {port_name}, Ctrl-C to stop", file=sys.stderr)
+        deadline = time.monotonic() + seconds if seconds else None
+        try:
+            while deadline is None or time.monotonic() < deadline:
+                data.extend(port.read(4096))
+        except KeyboardInterrupt:
+            pass
+        port.write(b"c")
+        drain = time.monotonic() + 0.5
+        while time.monotonic() < drain:
+            data.extend(port.read(4096))
+
+    with open(path, "wb") as f:
+        f.write(data)
+    print(f"{len(data)} bytes -> {path}", file=sys.stderr)
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Record a raw capture for desktop replay")
+    parser.add_argument("source", help="serial port (e.g. /dev/ttyACM0), or a file with --check")
+    parser.add_argument("output", nargs="?", help="capture file to write")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate (default: 115200)")
+    parser.add_argument("--seconds", type=float, default=0, help="stop after N seconds (default: Ctrl-C)")
+    parser.add_argument("--check", action="store_true", help="only summarize an existing capture file")
+    args = parser.parse_args()
+
+    if args.check:
+        with open(args.source, "rb") as f:
+            data = f.read()
+    else:
+        if not args.output:
+            parser.error("an output file is needed when recording")
+        data = record(args.source, args.output, args.baud, args.seconds)
+    sys.exit(0 if summarize(data) else 1)
+
+
+if __name__ == "__main__":
+    main()
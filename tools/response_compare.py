@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Compare two response reports (tests/response_report, tests/response_scenarios.h).
+
+Usage:
+    response_compare.py before.json after.json
+
+Prints the config parameters that differ, then every scenario metric side by side
+with its change. Lower is better for every metric except active time; changes for
+the worse are marked with '!'. The reports are deterministic, so any difference
+comes from the firmware or config.h, not from the run.
+"""
+
+import argparse
+import json
+import sys
+
+# (label, path into the scenario object)
+METRICS = [
+    ("onset->motion mean ms", ("onset_to_motion", "mean_ms")),
+    ("onset->motion max ms", ("onset_to_motion", "max_ms")),
+    ("onset->motion missed", ("onset_to_motion", "missed")),
+    ("->IDLE mean ms", ("time_to_idle", "mean_ms")),
+    ("->IDLE max ms", ("time_to_idle", "max_ms")),
+    ("->IDLE missed", ("time_to_idle", "missed")),
+    ("PWM overshoot %", ("pwm_overshoot_pct",)),
+    ("false ACTIVE / hour", ("false_active_per_hour",)),
+    ("chatter", ("chatter",)),
+    ("active s", ("active_seconds",)),
+]
+HIGHER_IS_BETTER = {"active s"}
+
+
+def lookup(scenario, path):
+    value = scenario
+    for key in path:
+        if not isinstance(value, dict) or key not in value:
+            return None
+        value = value[key]
+    return value
+
+
+def fmt(value):
+    if value is None:
+        return "-"
+    if isinstance(value, float):
+        return "%.1f" % value
+    return str(value)
+
+
+def compare(before, after, out):
+    """Write the differences between two reports; return the number of regressions"""
+    changed = [key for key in sorted(set(before["config"]) | set(after["config"]))
+               if before["config"].get(key) != after["config"].get(key)]
+    if changed:
+        out.write("config:\n")
+        for key in changed:
+            out.write("  %-32s %10s -> %s\n" % (key, fmt(before["config"].get(key)), fmt(after["config"].get(key))))
+        out.write("\n")
+
+    regressions = 0
+    old = {s["name"]: s for s in before["scenarios"]}
+    for scenario in after["scenarios"]:
+        name = scenario["name"]
+        if name not in old:
+            out.write("%s: new scenario\n\n" % name)
+            continue
+        out.write("%s:\n" % name)
+        for label, path in METRICS:
+            a, b = lookup(old[name], path), lookup(scenario, path)
+            mark = ""
+            if a is not None and b is not None and a != b:
+                worse = b < a if label in HIGHER_IS_BETTER else b > a
+                mark = "  %+.1f%s" % (b - a, " !" if worse else "")
+                regressions += worse
+            elif (a is None) != (b is None):
+                mark = "  (appeared)" if a is None else "  (gone)"
+            out.write("  %-24s %10s %10s%s\n" % (label, fmt(a), fmt(b), mark))
+        out.write("\n")
+    for name in old:
+        if name not in {s["name"] for s in after["scenarios"]}:
+            out.write("%s: removed\n\n" % name)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two response scenario reports")
+    parser.add_argument("before", help="report JSON (tests/response_report)")
+    parser.add_argument("after", help="report JSON to compare against it")
+    args = parser.parse_args()
+
+    with open(args.before) as f:
+        before = json.load(f)
+    with open(args.after) as f:
+        after = json.load(f)
+    regressions = compare(before, after, sys.stdout)
+    print("%d metric(s) worse" % regressions)
+
+
+if __name__ == "__main__":
+    main()
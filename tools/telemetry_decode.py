@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Decode the firmware's binary telemetry stream (main/telemetry.h) into CSV.
+
+Usage:
+    telemetry_decode.py capture.bin [out.csv]          # decode a saved capture
+    telemetry_decode.py /dev/ttyACM0 [out.csv] --baud 115200 [--seconds N]
+                                                        # live, needs pyserial
+
+Frames are located by their sync bytes and checked with the CRC; anything else
+in the stream (boot banner, FAULT messages) is skipped, and text lines are echoed
+to stderr; frames of other types (raw capture) are stepped over. Gaps in the sequence number are reported as dropped records.
+"""
+
+import argparse
+import csv
+import sys
+import time
+
+SYNC = b"\xA5\x5A"
+TYPE_STATUS = 0x01
+PAYLOAD_SIZE = 16
+FRAME_SIZE = 4 + PAYLOAD_SIZE + 1
+
+STATE_NAMES = ["INIT", "IDLE", "ACTIVE", "FAULT", "SHUTDOWN"]
+
+CSV_FIELDS = ["sequence", "timestamp_ms", "raw", "amplitude", "dc", "pwm", "state", "drops"]
+
+
+def crc8(data):
+    """CRC-8, polynomial 0x07, initial value 0 (same as telemetryCrc8())"""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def u16(data, offset):
+    return data[offset] | (data[offset + 1] << 8)
+
+
+def decode_frame(frame):
+    """Return a record dict for one complete, CRC-checked frame"""
+    p = frame[4:4 + PAYLOAD_SIZE]
+    state = p[13]
+    return {
+        "sequence": u16(p, 0),
+        "timestamp_ms": u16(p, 2) | (u16(p, 4) << 16),
+        "raw": u16(p, 6),
+        "amplitude": u16(p, 8),
+        "dc": u16(p, 10),
+        "pwm": p[12],
+        "state": STATE_NAMES[state] if state < len(STATE_NAMES) else str(state),
+        "drops": u16(p, 14),
+    }
+
+
+class StreamDecoder:
+    """Incremental decoder: feed() bytes as they arrive, get complete records back"""
+
+    def __init__(self, text_out=None):
+        self.buffer = bytearray()
+        self.text = bytearray()
+        self.text_out = text_out
+        self.bad_frames = 0
+        self.other_frames = 0
+        self.lost_records = 0
+        self.last_sequence = None
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        records = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                # Keep a trailing 0xA5: it may be the first sync byte of the next frame.
+                keep = 1 if self.buffer.endswith(SYNC[:1]) else 0
+                self._text(self.buffer[:len(self.buffer) - keep])
+                del self.buffer[:len(self.buffer) - keep]
+                break
+            self._text(self.buffer[:start])
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                break
+            size = self.buffer[3] + 5
+            is_status = self.buffer[2] == TYPE_STATUS and self.buffer[3] == PAYLOAD_SIZE
+            if len(self.buffer) < size:
+                break
+            frame = bytes(self.buffer[:size])
+            if crc8(frame[2:size - 1]) != frame[size - 1]:
+                if is_status:
+                    self.bad_frames += 1
+                self._text(self.buffer[:1])
+                del self.buffer[:1]
+                continue
+            if not is_status:
+                # Another frame type (raw capture, see capture_record.py): skip it whole.
+                self.other_frames += 1
+                del self.buffer[:size]
+                continue
+            del self.buffer[:FRAME_SIZE]
+            record = decode_frame(frame)
+            if self.last_sequence is not None:
+                self.lost_records += (record["sequence"] - self.last_sequence - 1) & 0xFFFF
+            self.last_sequence = record["sequence"]
+            records.append(record)
+        return records
+
+    def _text(self, data):
+        """Collect printable bytes between frames and echo complete lines"""
+        if self.text_out is None:
+            return
+        for byte in data:
+            if byte == 0x0A:
+                line = self.text.decode("ascii", "replace").strip()
+                if line:
+                    print(f"# {line}", file=self.text_out)
+                self.text.clear()
+            elif 0x20 <= byte < 0x7F:
+                self.text.append(byte)
+
+
+def read_chunks(source, baud, seconds):
+    """Yield byte chunks from a capture file or (with pyserial) a serial port"""
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        try:
+            import serial
+        except ImportError:
+            print("Error: reading a serial port needs pyserial (pip install pyserial)", file=sys.stderr)
+            sys.exit(1)
+        deadline = time.monotonic() + seconds if seconds else None
+        with serial.Serial(source, baud, timeout=0.1) as port:
+            while deadline is None or time.monotonic() < deadline:
+                chunk = port.read(4096)
+                if chunk:
+                    yield chunk
+    else:
+        with open(source, "rb") as f:
+            while True:
+                chunk = f.read(65536)
+                if not chunk:
+                    break
+                yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary telemetry into CSV")
+    parser.add_argument("source", help="capture file, or serial port (e.g. /dev/ttyACM0)")
+    parser.add_argument("output", nargs="?", help="CSV file (default: stdout)")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate (default: 115200)")
+    parser.add_argument("--seconds", type=float, default=0, help="stop reading a port after N seconds")
+    parser.add_argument("--quiet", action="store_true", help="do not echo text lines to stderr")
+    args = parser.parse_args()
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=CSV_FIELDS)
+    writer.writeheader()
+
+    decoder = StreamDecoder(text_out=None if args.quiet else sys.stderr)
+    count = 0
+    try:
+        for chunk in read_chunks(args.source, args.baud, args.seconds):
+            for record in decoder.feed(chunk):
+                writer.writerow(record)
+                count += 1
+            out.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+    print(f"{count} records, {decoder.lost_records} lost (sequence gaps), "
+          f"{decoder.bad_frames} failed CRC", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()